@@ -17,8 +17,17 @@
 #include "RetimingCommand.h"
 #include "IncrementalSaveCommand.h"
 #include "ShotMaskCommand.h"
+#include "ShotMaskNode.h"
 #include "CurveCleanerCommand.h"
-
+#include "OverlapCommand.h"
+#include "MovingHoldsCommand.h"
+#include "CycleCommand.h"
+#include "StaticChannelsCommand.h"
+#include "BakeReduceCommand.h"
+#include "BlockingToSplineCommand.h"
+#include "KeyHeatmapCommand.h"
+
+#include "ThreadPool.h"
 #include "ErrorReporting.h"
 
 // #include "config.h"
@@ -30,6 +39,9 @@
 //*********************************************************
 ANIMToolsUI g_animToolsUI;
 
+// The worker threads shared by the commands
+ThreadPool g_threadPool;
+
 //*********************************************************
 // Constants
 //*********************************************************
@@ -45,6 +57,13 @@ const char *incrementalSaveCmdName = "cieIncrementalSave";
 
 const char *shotMaskCmdName = "cieShotMask";
 const char *curveCleanerCmdName = "cieCleanCurves";
+const char *overlapCmdName = "cieOverlap";
+const char *movingHoldsCmdName = "cieMovingHolds";
+const char *cycleCmdName = "cieCycle";
+const char *staticChannelsCmdName = "cieStaticChannels";
+const char *bakeReduceCmdName = "cieBakeReduce";
+const char *blockingToSplineCmdName = "cieBlockingToSpline";
+const char *keyHeatmapCmdName = "cieKeyHeatmap";
 
 //*********************************************************
 // Functions
@@ -80,6 +99,14 @@ PLUGIN_EXPORT MStatus initializePlugin( MObject obj )
     // Add the script path and source required scripts
     else {
 
+        // Start the worker threads for the commands
+        g_threadPool.start();
+
+        // Keep retiming previews out of saved scenes
+        if( !RetimingCommand::addCallbacks()) {
+            pluginError( "ANIMTools", "initializePlugin", "Failed to add the retiming callbacks" );
+        }
+
         // Add the UI to Maya's menu
         if( !g_animToolsUI.addMenuItems()) {
             pluginError( "ANIMTools", "initializePlugin", "Failed to add menu items" );
@@ -148,6 +175,17 @@ PLUGIN_EXPORT MStatus uninitializePlugin( MObject obj )
         pluginError( "ANIMTools", "uninitializePlugin", "Failed to Deregister Commands" );
     }
 
+    // Stop the worker threads
+    g_threadPool.stop();
+
+    // Stop watching the scene for the shot mask details
+    ShotMaskDetails::removeCallbacks();
+
+    // Remove any retiming preview, nothing could discard
+    // it once the plugin is gone
+    RetimingCommand::clearPreview();
+    RetimingCommand::removeCallbacks();
+
 	return status;
 }
 
@@ -206,6 +244,16 @@ MStatus registerCommands( MObject obj )
         pluginError( "ANIMTools", "registerCommands", errorMsg + shotMaskCmdName );
     }
 
+    // Register the node that updates the shot mask
+    else if( !pluginFn.registerNode( ShotMaskNode::typeName,
+                                     ShotMaskNode::id,
+                                     ShotMaskNode::creator,
+                                     ShotMaskNode::initialize ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "registerCommands", errorMsg + ShotMaskNode::typeName );
+    }
+
     // Register the curve cleaner command
     else if( !pluginFn.registerCommand( curveCleanerCmdName,
                                         CurveCleanerCommand::creator,
@@ -215,6 +263,69 @@ MStatus registerCommands( MObject obj )
         pluginError( "ANIMTools", "registerCommands", errorMsg + curveCleanerCmdName );
     }
 
+    // Register the overlap command
+    else if( !pluginFn.registerCommand( overlapCmdName,
+                                        OverlapCommand::creator,
+                                        OverlapCommand::newSyntax ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "registerCommands", errorMsg + overlapCmdName );
+    }
+
+    // Register the moving holds command
+    else if( !pluginFn.registerCommand( movingHoldsCmdName,
+                                        MovingHoldsCommand::creator,
+                                        MovingHoldsCommand::newSyntax ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "registerCommands", errorMsg + movingHoldsCmdName );
+    }
+
+    // Register the cycle command
+    else if( !pluginFn.registerCommand( cycleCmdName,
+                                        CycleCommand::creator,
+                                        CycleCommand::newSyntax ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "registerCommands", errorMsg + cycleCmdName );
+    }
+
+    // Register the static channels command
+    else if( !pluginFn.registerCommand( staticChannelsCmdName,
+                                        StaticChannelsCommand::creator,
+                                        StaticChannelsCommand::newSyntax ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "registerCommands", errorMsg + staticChannelsCmdName );
+    }
+
+    // Register the bake reduce command
+    else if( !pluginFn.registerCommand( bakeReduceCmdName,
+                                        BakeReduceCommand::creator,
+                                        BakeReduceCommand::newSyntax ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "registerCommands", errorMsg + bakeReduceCmdName );
+    }
+
+    // Register the blocking to spline command
+    else if( !pluginFn.registerCommand( blockingToSplineCmdName,
+                                        BlockingToSplineCommand::creator,
+                                        BlockingToSplineCommand::newSyntax ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "registerCommands", errorMsg + blockingToSplineCmdName );
+    }
+
+    // Register the key heatmap command
+    else if( !pluginFn.registerCommand( keyHeatmapCmdName,
+                                        KeyHeatmapCommand::creator,
+                                        KeyHeatmapCommand::newSyntax ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "registerCommands", errorMsg + keyHeatmapCmdName );
+    }
+
     // Register the about command
     else if( !pluginFn.registerCommand( aboutCmdName,
                                         AboutCommand::creator,
@@ -273,6 +384,13 @@ MStatus deregisterCommands( MObject obj )
         pluginError( "ANIMTools", "deregisterCommands", errorMsg + shotMaskCmdName );
     }
 
+    // Deregister the shot mask node
+    if( !pluginFn.deregisterNode( ShotMaskNode::id ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "deregisterCommands", errorMsg + ShotMaskNode::typeName );
+    }
+
     // Deregister the curve cleaner command
     if( !pluginFn.deregisterCommand( curveCleanerCmdName ))
     {
@@ -280,6 +398,55 @@ MStatus deregisterCommands( MObject obj )
         pluginError( "ANIMTools", "deregisterCommands", errorMsg + curveCleanerCmdName );
     }
 
+    // Deregister the overlap command
+    if( !pluginFn.deregisterCommand( overlapCmdName ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "deregisterCommands", errorMsg + overlapCmdName );
+    }
+
+    // Deregister the moving holds command
+    if( !pluginFn.deregisterCommand( movingHoldsCmdName ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "deregisterCommands", errorMsg + movingHoldsCmdName );
+    }
+
+    // Deregister the cycle command
+    if( !pluginFn.deregisterCommand( cycleCmdName ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "deregisterCommands", errorMsg + cycleCmdName );
+    }
+
+    // Deregister the static channels command
+    if( !pluginFn.deregisterCommand( staticChannelsCmdName ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "deregisterCommands", errorMsg + staticChannelsCmdName );
+    }
+
+    // Deregister the bake reduce command
+    if( !pluginFn.deregisterCommand( bakeReduceCmdName ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "deregisterCommands", errorMsg + bakeReduceCmdName );
+    }
+
+    // Deregister the blocking to spline command
+    if( !pluginFn.deregisterCommand( blockingToSplineCmdName ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "deregisterCommands", errorMsg + blockingToSplineCmdName );
+    }
+
+    // Deregister the key heatmap command
+    if( !pluginFn.deregisterCommand( keyHeatmapCmdName ))
+    {
+        status = MS::kFailure;
+        pluginError( "ANIMTools", "deregisterCommands", errorMsg + keyHeatmapCmdName );
+    }
+
     // Deregister the about command
     if( !pluginFn.deregisterCommand( aboutCmdName ))
     {
@@ -0,0 +1,233 @@
+//*********************************************************
+// AnimCurveCollector.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "AnimCurveCollector.h"
+#include "ErrorReporting.h"
+//*********************************************************
+
+
+//*********************************************************
+// Name: AnimCurveCollector
+// Desc: Constructor
+//*********************************************************
+AnimCurveCollector::AnimCurveCollector()
+{
+}
+
+
+//*********************************************************
+// Name: ~AnimCurveCollector
+// Desc: Destructor
+//*********************************************************
+AnimCurveCollector::~AnimCurveCollector()
+{
+}
+
+
+//*********************************************************
+// Name: getSelectedObjects
+// Desc: Generates a list of all the selected objects
+//*********************************************************
+MStatus AnimCurveCollector::getSelectedObjects( MSelectionList &selectionList )
+{
+    MStatus status = MS::kFailure;
+    MSelectionList characterSetList;
+    MStringArray characterSets;
+
+    selectionList.clear();
+
+    // Selected Objects Include:
+    //    1) The Active Character Set (if in use) and its subset
+    //    2) Character Sets selected by the user (and their subsets)
+    //    3) Objects selected by the user
+    MGlobal::executeCommand( MString("cie_atbGetActiveCharacterSets"), characterSets, false, false );
+
+    for( unsigned int i = 0; i < characterSets.length(); i++ ) {
+        MGlobal::getSelectionListByName( characterSets[i], characterSetList );
+    }
+
+    MGlobal::executeCommand( MString("cie_atbGetSelectedCharacterSets"), characterSets, false, false );
+
+    for( unsigned int i = 0; i < characterSets.length(); i++ ) {
+        MGlobal::getSelectionListByName( characterSets[i], characterSetList );
+    }
+
+    // Retrive all of the currently selected objects
+    if( !MGlobal::getActiveSelectionList( selectionList )) {
+        pluginError( "AnimCurveCollector", "getSelectedObjects", "Failed to get active selection list" );
+    }
+    // At least one object must be selected
+    else if( characterSetList.length() == 0 && selectionList.length() == 0 ) {
+        pluginTrace( "AnimCurveCollector", "getSelectedObjects", "No Objects Selected" );
+    }
+    else
+        status = MS::kSuccess;
+
+    selectionList.merge( characterSetList );
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: getAnimCurves
+// Desc: Finds all of the anim curves for the objects in
+//       the selection list
+//*********************************************************
+MStatus AnimCurveCollector::getAnimCurves( const MSelectionList &selectionList,
+                                           std::vector<AnimCurveInfo> &animCurves )
+{
+    MStatus status = MS::kSuccess;
+
+    MObject dependNode;
+    MPlugArray plugArray;
+    unsigned int selectionIndex = 0;
+
+    MItSelectionList sIter( selectionList, MFn::kInvalid, &status );
+    if( !status ) {
+        pluginError( "AnimCurveCollector", "getAnimCurves", "Failed to creation SL iterator" );
+        return status;
+    }
+
+    for( ; !sIter.isDone(); sIter.next(), selectionIndex++ ) {
+        if( !sIter.getDependNode( dependNode )) {
+            pluginError( "AnimCurveCollector", "getAnimCurves", "Couldn't get dependency node" );
+            status = MS::kFailure;
+            break;
+        }
+
+        // The call to get connections doesn't clear the array
+        plugArray.clear();
+
+        MFnDependencyNode dependFn( dependNode );
+        if( !dependFn.getConnections( plugArray )) {
+            // This object has no animation curves
+            continue;
+        }
+
+        for( unsigned int index = 0; index < plugArray.length(); index++ ) {
+            if( plugArray[index].isKeyable() && !plugArray[index].isLocked() ) {
+                if( !(status = addAnimCurvesFromPlug( plugArray[index], dependNode,
+                                                      selectionIndex, animCurves ))) {
+                    break;
+                }
+            }
+        }
+
+        if( !status )
+            break;
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: addAnimCurvesFromPlug
+// Desc: Adds the anim curves upstream of the plug.  Only
+//       curves connected directly or through a single
+//       pairBlend/character node are used.
+//*********************************************************
+MStatus AnimCurveCollector::addAnimCurvesFromPlug( MPlug &plug,
+                                                   const MObject &node,
+                                                   unsigned int selectionIndex,
+                                                   std::vector<AnimCurveInfo> &animCurves )
+{
+    MStatus status = MS::kSuccess;
+    AnimCurveInfo animCurveInfo;
+
+    MItDependencyGraph dgIter( plug,
+                               MFn::kAnimCurve,
+                               MItDependencyGraph::kUpstream,
+                               MItDependencyGraph::kBreadthFirst,
+                               MItDependencyGraph::kNodeLevel,
+                               &status );
+    if( !status ) {
+        pluginError( "AnimCurveCollector", "addAnimCurvesFromPlug", "DG Iterator error" );
+        return status;
+    }
+
+    for( ; !dgIter.isDone(); dgIter.next() ) {
+        MObjectArray nodePath;
+        dgIter.getNodePath( nodePath );
+
+        int nodeParentIndex = 1;
+        if( nodePath.length() <= 2 ||
+            (nodePath.length() == 3 &&
+                (nodePath[nodeParentIndex].apiType() == MFn::kPairBlend ||
+                nodePath[nodeParentIndex].apiType() == MFn::kCharacter ))
+            )
+        {
+            MObject animCurve = dgIter.thisNode( &status );
+            if( !status ) {
+                pluginError( "AnimCurveCollector", "addAnimCurvesFromPlug", "Can't get AnimCurve node" );
+                break;
+            }
+
+            if( !isDuplicate( animCurve )) {
+                animCurveInfo.animCurve = animCurve;
+                animCurveInfo.node = node;
+                animCurveInfo.plug = plug;
+                animCurveInfo.isDirect = (nodePath.length() <= 2);
+                animCurveInfo.selectionIndex = selectionIndex;
+                animCurves.push_back( animCurveInfo );
+            }
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: isDuplicate
+// Desc: Returns true if the curve has already been found,
+//       otherwise records it and returns false
+//*********************************************************
+bool AnimCurveCollector::isDuplicate( const MObject &animCurve )
+{
+    MObjectHandle handle( animCurve );
+    unsigned int hashCode = handle.hashCode();
+
+    std::pair<std::multimap<unsigned int, MObjectHandle>::iterator,
+              std::multimap<unsigned int, MObjectHandle>::iterator> range =
+        foundCurves.equal_range( hashCode );
+
+    for( std::multimap<unsigned int, MObjectHandle>::iterator iter = range.first;
+         iter != range.second; iter++ ) {
+        if( (*iter).second.objectRef() == animCurve )
+            return true;
+    }
+
+    foundCurves.insert( std::make_pair( hashCode, handle ));
+
+    return false;
+}
+
+
+//*********************************************************
+// Name: isSteppedPlug
+// Desc: Returns true if the plug is a boolean or enum
+//       attribute
+//*********************************************************
+bool AnimCurveCollector::isSteppedPlug( const MPlug &plug )
+{
+    MObject attrObj = plug.attribute();
+
+    if( attrObj.apiType() == MFn::kEnumAttribute )
+        return true;
+
+    if( attrObj.apiType() == MFn::kNumericAttribute ) {
+        MFnNumericAttribute fnNumAttr( attrObj );
+        if( fnNumAttr.unitType() == MFnNumericData::kBoolean )
+            return true;
+    }
+
+    return false;
+}
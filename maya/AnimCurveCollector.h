@@ -0,0 +1,104 @@
+//*********************************************************
+// AnimCurveCollector.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __ANIM_CURVE_COLLECTOR_H_
+#define __ANIM_CURVE_COLLECTOR_H_
+
+//*********************************************************
+#include <maya/MGlobal.h>
+#include <maya/MSelectionList.h>
+#include <maya/MString.h>
+#include <maya/MStringArray.h>
+#include <maya/MObject.h>
+#include <maya/MObjectArray.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MPlug.h>
+#include <maya/MPlugArray.h>
+
+#include <maya/MFnDependencyNode.h>
+#include <maya/MFnNumericAttribute.h>
+#include <maya/MFnNumericData.h>
+
+#include <maya/MItSelectionList.h>
+#include <maya/MItDependencyGraph.h>
+
+#include <vector>
+#include <map>
+//*********************************************************
+
+//*********************************************************
+// Struct: AnimCurveInfo
+//
+// Desc:  An anim curve found by the collector along with
+//        the node and plug it animates
+//*********************************************************
+struct AnimCurveInfo
+{
+    // The anim curve node
+    MObject animCurve;
+
+    // The selected node the curve animates
+    MObject node;
+
+    // The plug on the node the curve animates
+    MPlug plug;
+
+    // Indicates the curve is connected directly to the
+    // plug, not through a pairBlend/character node
+    bool isDirect;
+
+    // The position of the node in the selection list
+    unsigned int selectionIndex;
+};
+
+//*********************************************************
+// Class: AnimCurveCollector
+//
+// Desc:  Finds the anim curves driving the selected
+//        objects.  Follows the same rules as the retiming
+//        and curve cleaner commands: curves connected
+//        directly to keyable, unlocked attributes or
+//        through a single pairBlend/character node.
+//*********************************************************
+class AnimCurveCollector
+{
+private:
+    // Hash codes of the curves found so far, used to skip
+    // curves shared between plugs (blend/character nodes)
+    std::multimap<unsigned int, MObjectHandle> foundCurves;
+
+    // Adds the curves upstream of the plug
+    MStatus addAnimCurvesFromPlug( MPlug &plug,
+                                   const MObject &node,
+                                   unsigned int selectionIndex,
+                                   std::vector<AnimCurveInfo> &animCurves );
+
+    // Returns true if the curve has already been found
+    bool isDuplicate( const MObject &animCurve );
+
+public:
+    // Constructor/Destructor
+    AnimCurveCollector();
+    ~AnimCurveCollector();
+
+    // Generates a list of the selected objects including
+    // the active and selected character sets.  Fails if
+    // nothing is selected.
+    static MStatus getSelectedObjects( MSelectionList &selectionList );
+
+    // Finds all of the anim curves for the objects in the
+    // selection list
+    MStatus getAnimCurves( const MSelectionList &selectionList,
+                           std::vector<AnimCurveInfo> &animCurves );
+
+    // Returns true if the plug is a boolean or enum
+    // attribute (keys on these must stay stepped)
+    static bool isSteppedPlug( const MPlug &plug );
+};
+
+#endif
@@ -0,0 +1,216 @@
+//*********************************************************
+// AnimCurveSnapshot.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "AnimCurveSnapshot.h"
+#include "ErrorReporting.h"
+
+#include <algorithm>
+//*********************************************************
+
+
+//*********************************************************
+// Name: AnimCurveSnapshot
+// Desc: Constructor
+//*********************************************************
+AnimCurveSnapshot::AnimCurveSnapshot()
+{
+}
+
+
+//*********************************************************
+// Name: ~AnimCurveSnapshot
+// Desc: Destructor
+//*********************************************************
+AnimCurveSnapshot::~AnimCurveSnapshot()
+{
+}
+
+
+//*********************************************************
+// Name: capture
+// Desc: Reads all of the key times and values from the
+//       curve
+//*********************************************************
+MStatus AnimCurveSnapshot::capture( MFnAnimCurve &animCurveFn )
+{
+    MStatus status = MS::kSuccess;
+    MTime::Unit uiUnit = MTime::uiUnit();
+
+    unsigned int numKeys = animCurveFn.numKeys( &status );
+    if( !status ) {
+        pluginError( "AnimCurveSnapshot", "capture", "Failed to get the number of keys" );
+        return status;
+    }
+
+    keyTimes.resize( numKeys );
+    keyValues.resize( numKeys );
+
+    for( unsigned int index = 0; index < numKeys; index++ ) {
+        keyTimes[index] = animCurveFn.time( index ).as( uiUnit );
+        keyValues[index] = animCurveFn.value( index );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: findClosest
+// Desc: Returns the index of the key closest to the given
+//       time
+//*********************************************************
+unsigned int AnimCurveSnapshot::findClosest( double time ) const
+{
+    std::vector<double>::const_iterator next =
+        std::lower_bound( keyTimes.begin(), keyTimes.end(), time );
+
+    unsigned int index = (unsigned int)(next - keyTimes.begin());
+
+    if( index == keyTimes.size() )
+        return index - 1;
+
+    // Pick the previous key if it is nearer
+    if( index > 0 && (time - keyTimes[index - 1]) < (keyTimes[index] - time) )
+        index--;
+
+    return index;
+}
+
+
+//*********************************************************
+// Name: writeKeyTimes
+// Desc: Moves every key on the curve from its original
+//       time to its new time.  Keys moving to the left
+//       are moved first from the lowest index up, then
+//       keys moving to the right are moved from the
+//       highest index down.  This way a key is never
+//       moved past one of its neighbours.
+//*********************************************************
+MStatus AnimCurveSnapshot::writeKeyTimes( MFnAnimCurve &animCurveFn,
+                                          const std::vector<double> &origKeyTimes,
+                                          const std::vector<double> &newKeyTimes,
+                                          MAnimCurveChange *pAnimCache )
+{
+    MStatus status = MS::kSuccess;
+    MTime::Unit uiUnit = MTime::uiUnit();
+
+    unsigned int numKeys = (unsigned int)origKeyTimes.size();
+
+    if( newKeyTimes.size() != numKeys || animCurveFn.numKeys() != numKeys ) {
+        pluginError( "AnimCurveSnapshot", "writeKeyTimes", "Key count does not match the curve" );
+        return MS::kFailure;
+    }
+
+    // Keys moving left
+    for( unsigned int index = 0; index < numKeys && status; index++ ) {
+        if( newKeyTimes[index] < origKeyTimes[index] )
+            status = animCurveFn.setTime( index, MTime( newKeyTimes[index], uiUnit ), pAnimCache );
+    }
+
+    // Keys moving right
+    for( unsigned int index = numKeys; index > 0 && status; index-- ) {
+        if( newKeyTimes[index - 1] > origKeyTimes[index - 1] )
+            status = animCurveFn.setTime( index - 1, MTime( newKeyTimes[index - 1], uiUnit ), pAnimCache );
+    }
+
+    if( !status )
+        pluginError( "AnimCurveSnapshot", "writeKeyTimes", "Failed to set key time" );
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: shiftKeyTimes
+// Desc: Shifts every key on the curve by the number of
+//       frames
+//*********************************************************
+MStatus AnimCurveSnapshot::shiftKeyTimes( MFnAnimCurve &animCurveFn,
+                                          double numFrames,
+                                          MAnimCurveChange *pAnimCache )
+{
+    MStatus status = MS::kSuccess;
+    MTime::Unit uiUnit = MTime::uiUnit();
+
+    unsigned int numKeys = animCurveFn.numKeys( &status );
+    if( !status || numFrames == 0.0 )
+        return status;
+
+    std::vector<double> origKeyTimes( numKeys );
+    std::vector<double> newKeyTimes( numKeys );
+
+    for( unsigned int index = 0; index < numKeys; index++ ) {
+        origKeyTimes[index] = animCurveFn.time( index ).as( uiUnit );
+        newKeyTimes[index] = origKeyTimes[index] + numFrames;
+    }
+
+    return writeKeyTimes( animCurveFn, origKeyTimes, newKeyTimes, pAnimCache );
+}
+
+//*********************************************************
+// Name: writeFixedTangents
+// Desc: Sets fixed tangents with the given angles on every
+//       key, so Maya doesn't recalculate them when the
+//       neighbouring keys change.  Locked tangents and
+//       weights are unlocked while they are set.
+//*********************************************************
+MStatus AnimCurveSnapshot::writeFixedTangents( MFnAnimCurve &animCurveFn,
+                                               const std::vector<double> &tangentAngles,
+                                               const std::vector<double> &inWeights,
+                                               const std::vector<double> &outWeights,
+                                               bool flatEnds,
+                                               MAnimCurveChange *pAnimCache )
+{
+    MStatus status = MS::kSuccess;
+
+    unsigned int numKeys = (unsigned int)tangentAngles.size();
+    bool isWeighted = animCurveFn.isWeighted();
+
+    if( animCurveFn.numKeys() != numKeys ) {
+        pluginError( "AnimCurveSnapshot", "writeFixedTangents", "Key count does not match the curve" );
+        return MS::kFailure;
+    }
+
+    for( unsigned int index = 0; index < numKeys && status; index++ ) {
+        bool isFlat = flatEnds && (index == 0 || index == numKeys - 1);
+        MFnAnimCurve::TangentType type = isFlat ? MFnAnimCurve::kTangentFlat : MFnAnimCurve::kTangentFixed;
+
+        bool isTangentLocked = animCurveFn.tangentsLocked( index );
+        bool isWeightLocked = animCurveFn.weightsLocked( index );
+        if( isTangentLocked )
+            animCurveFn.setTangentsLocked( index, false, pAnimCache );
+        if( isWeightLocked )
+            animCurveFn.setWeightsLocked( index, false, pAnimCache );
+
+        animCurveFn.setInTangentType( index, type, pAnimCache );
+        animCurveFn.setOutTangentType( index, type, pAnimCache );
+
+        if( !isFlat ) {
+            MAngle tangentAngle( tangentAngles[index] );
+
+            if( (status = animCurveFn.setAngle( index, tangentAngle, true, pAnimCache )) &&
+                (status = animCurveFn.setAngle( index, tangentAngle, false, pAnimCache )) &&
+                isWeighted )
+            {
+                animCurveFn.setWeight( index, inWeights[index], true, pAnimCache );
+                animCurveFn.setWeight( index, outWeights[index], false, pAnimCache );
+            }
+        }
+
+        if( isTangentLocked )
+            animCurveFn.setTangentsLocked( index, true, pAnimCache );
+        if( isWeightLocked )
+            animCurveFn.setWeightsLocked( index, true, pAnimCache );
+    }
+
+    if( !status )
+        pluginError( "AnimCurveSnapshot", "writeFixedTangents", "Failed to set the tangent angle" );
+
+    return status;
+}
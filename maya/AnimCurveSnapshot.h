@@ -0,0 +1,81 @@
+//*********************************************************
+// AnimCurveSnapshot.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __ANIM_CURVE_SNAPSHOT_H_
+#define __ANIM_CURVE_SNAPSHOT_H_
+
+//*********************************************************
+#include <maya/MGlobal.h>
+#include <maya/MTime.h>
+#include <maya/MAngle.h>
+#include <maya/MFnAnimCurve.h>
+#include <maya/MAnimCurveChange.h>
+
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: AnimCurveSnapshot
+//
+// Desc:  A copy of the key times and values of an anim
+//        curve.  Commands read a curve once into a
+//        snapshot, do all of their work on the arrays and
+//        then write the results back in bulk.
+//
+//        Key times are stored in frames (Maya's current
+//        UI time unit).
+//*********************************************************
+class AnimCurveSnapshot
+{
+public:
+    // The time of each key in frames
+    std::vector<double> keyTimes;
+
+    // The value of each key (in Maya's internal units)
+    std::vector<double> keyValues;
+
+    // Constructor/Destructor
+    AnimCurveSnapshot();
+    ~AnimCurveSnapshot();
+
+    // Reads all of the key times and values from the curve
+    MStatus capture( MFnAnimCurve &animCurveFn );
+
+    // Returns the number of keys in the snapshot
+    unsigned int numKeys() const { return (unsigned int)keyTimes.size(); }
+
+    // Returns the index of the key closest to the given
+    // time.  Must not be called on an empty snapshot.
+    unsigned int findClosest( double time ) const;
+
+    // Moves every key on the curve from its original time
+    // to its new time.  Keys are moved in an order that
+    // never passes a neighbouring key, so any new times
+    // that keep the keys in order can be written.
+    static MStatus writeKeyTimes( MFnAnimCurve &animCurveFn,
+                                  const std::vector<double> &origKeyTimes,
+                                  const std::vector<double> &newKeyTimes,
+                                  MAnimCurveChange *pAnimCache );
+
+    // Shifts every key on the curve by the number of frames
+    static MStatus shiftKeyTimes( MFnAnimCurve &animCurveFn,
+                                  double numFrames,
+                                  MAnimCurveChange *pAnimCache );
+
+    // Sets fixed tangents with the given angles (radians)
+    // on every key.  The weights are only set on weighted
+    // curves.  flatEnds makes the first and last keys flat.
+    static MStatus writeFixedTangents( MFnAnimCurve &animCurveFn,
+                                       const std::vector<double> &tangentAngles,
+                                       const std::vector<double> &inWeights,
+                                       const std::vector<double> &outWeights,
+                                       bool flatEnds,
+                                       MAnimCurveChange *pAnimCache );
+};
+
+#endif
@@ -0,0 +1,473 @@
+//*********************************************************
+// BakeReduceCommand.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "BakeReduceCommand.h"
+#include "ParallelFor.h"
+#include "ErrorReporting.h"
+
+#include <math.h>
+//*********************************************************
+
+//*********************************************************
+// Constants
+//*********************************************************
+const char *BakeReduceCommand::startTimeFlag = "-st";
+const char *BakeReduceCommand::startTimeLongFlag = "-startTime";
+const char *BakeReduceCommand::endTimeFlag = "-et";
+const char *BakeReduceCommand::endTimeLongFlag = "-endTime";
+const char *BakeReduceCommand::sampleByFlag = "-sb";
+const char *BakeReduceCommand::sampleByLongFlag = "-sampleBy";
+const char *BakeReduceCommand::toleranceFlag = "-tol";
+const char *BakeReduceCommand::toleranceLongFlag = "-tolerance";
+
+
+//*********************************************************
+// Name: BakeReduceCommand
+// Desc: Constructor
+//*********************************************************
+BakeReduceCommand::BakeReduceCommand()
+{
+    pluginTrace( "BakeReduceCommand", "BakeReduceCommand", "******* Bake Reduce Command *******" );
+
+    initialized = false;
+    numSamples = 0;
+    numKeysKept = 0;
+    maxReductionError = 0.0;
+
+    // Initialize the command flag defaults
+    MTime::Unit uiUnit = MTime::uiUnit();
+    startTime = MAnimControl::minTime().as( uiUnit );
+    endTime = MAnimControl::maxTime().as( uiUnit );
+    sampleBy = 1.0;
+    tolerance = 0.01;
+}
+
+
+//*********************************************************
+// Name: ~BakeReduceCommand
+// Desc: Destructor
+//*********************************************************
+BakeReduceCommand::~BakeReduceCommand()
+{
+    // Cleanup all memory allocated for this command
+    for( unsigned int i = 0; i < bakedPlugs.size(); i++ )
+        delete bakedPlugs[i].pAnimCache;
+}
+
+
+//*********************************************************
+// Name: doIt
+// Desc: All of the one-time setup and initialization
+//       code for the bake reduce command.  doIt is called
+//       by Maya when any command is executed in MEL.
+//       Any code that changes the state of Maya is
+//       handled by the redoIt method.
+//*********************************************************
+MStatus BakeReduceCommand::doIt( const MArgList &args )
+{
+    MStatus status = MS::kFailure;
+
+    if( !parseCommandFlags( args )) {
+        pluginError( "BakeReduceCommand", "doIt", "Failed to parse command flags" );
+    }
+    else if( !AnimCurveCollector::getSelectedObjects( selectionList )) {
+        MGlobal::displayError( "No Objects Selected" );
+    }
+    else if( !getDrivenPlugs() ) {
+        pluginError( "BakeReduceCommand", "doIt", "Failed to get the driven attributes" );
+    }
+    else if( bakedPlugs.empty() ) {
+        MGlobal::displayError( "No Driven Attributes" );
+    }
+    else if( !samplePlugs() ) {
+        pluginError( "BakeReduceCommand", "doIt", "Failed to sample the driven attributes" );
+    }
+    else {
+        // Every curve is reduced independently
+        parallelFor( (unsigned int)bakedPlugs.size(), [&]( unsigned int i ) {
+            BakedPlugACC &bakedPlug = bakedPlugs[i];
+
+            calcSampleSlopes( bakedPlug.keys );
+            bakedPlug.error = CurveReducer::reduce( bakedPlug.keys, tolerance, bakedPlug.keepKeys );
+        });
+
+        for( unsigned int i = 0; i < bakedPlugs.size(); i++ ) {
+            if( bakedPlugs[i].error > maxReductionError )
+                maxReductionError = bakedPlugs[i].error;
+        }
+
+        if( !(status = redoIt() )) {
+            pluginError( "BakeReduceCommand", "doIt", "Failed to redoIt" );
+        }
+        else {
+            MString result( "Result: " );
+            result += (unsigned int)bakedPlugs.size();
+            result += " curves baked, ";
+            result += numKeysKept;
+            result += " of ";
+            result += numSamples;
+            result += " keys kept";
+            MGlobal::displayInfo( result );
+            MGlobal::displayInfo( MString( "Max Error: " ) + maxReductionError );
+
+            setResult( (int)bakedPlugs.size() );
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: redoIt
+// Desc: Contains the code that changes the internal state
+//       of Maya.  It is called by Maya to redo.
+//*********************************************************
+MStatus BakeReduceCommand::redoIt()
+{
+    MStatus status = MS::kSuccess;
+
+    if( !initialized ) {
+        initialized = true;
+
+        if( !(status = createCurves() )) {
+            // Remove any curves that were created
+            undoIt();
+
+            pluginError( "BakeReduceCommand", "redoIt", "Failed to create the curves" );
+        }
+    }
+    else {
+        // The curves must exist before their keys are redone
+        status = dgModifier.doIt();
+
+        for( unsigned int i = 0; i < bakedPlugs.size() && status; i++ ) {
+            if( bakedPlugs[i].pAnimCache != NULL )
+                bakedPlugs[i].pAnimCache->redoIt();
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: undoIt
+// Desc: Contains the code to undo the internal state
+//       changes made by the bake reduce command (redoIt).
+//       It is called by Maya to undo.
+//*********************************************************
+MStatus BakeReduceCommand::undoIt()
+{
+    // The keys were added after the curves were created,
+    // so they are removed first
+    for( unsigned int i = 0; i < bakedPlugs.size(); i++ ) {
+        if( bakedPlugs[i].pAnimCache != NULL )
+            bakedPlugs[i].pAnimCache->undoIt();
+    }
+
+    return dgModifier.undoIt();
+}
+
+
+//*********************************************************
+// Name: newSyntax
+// Desc: Method for registering the command flags
+//       with Maya
+//*********************************************************
+MSyntax BakeReduceCommand::newSyntax()
+{
+    MSyntax syntax;
+    syntax.addFlag( startTimeFlag, startTimeLongFlag, MSyntax::kDouble );
+    syntax.addFlag( endTimeFlag, endTimeLongFlag, MSyntax::kDouble );
+    syntax.addFlag( sampleByFlag, sampleByLongFlag, MSyntax::kDouble );
+    syntax.addFlag( toleranceFlag, toleranceLongFlag, MSyntax::kDouble );
+
+    return syntax;
+}
+
+
+//*********************************************************
+// Name: parseCommandFlags
+// Desc: Parse the command flags and stores the values
+//       in the appropriate variables
+//*********************************************************
+MStatus BakeReduceCommand::parseCommandFlags( const MArgList &args )
+{
+    MStatus status = MS::kSuccess;
+
+    MArgDatabase argData( syntax(), args, &status );
+    if( !status ) {
+        pluginError( "BakeReduceCommand", "parseCommandFlags",
+                     "Failed to create MArgDatabase for the bake reduce command" );
+    }
+    else {
+        if( argData.isFlagSet( startTimeFlag ))
+            argData.getFlagArgument( startTimeFlag, 0, startTime );
+        if( argData.isFlagSet( endTimeFlag ))
+            argData.getFlagArgument( endTimeFlag, 0, endTime );
+        if( argData.isFlagSet( sampleByFlag ))
+            argData.getFlagArgument( sampleByFlag, 0, sampleBy );
+        if( argData.isFlagSet( toleranceFlag ))
+            argData.getFlagArgument( toleranceFlag, 0, tolerance );
+
+        if( endTime < startTime ) {
+            MGlobal::displayError( "The end time must be after the start time" );
+            status = MS::kFailure;
+        }
+        else if( sampleBy <= 0.0 ) {
+            MGlobal::displayError( "The sample rate must be greater than 0" );
+            status = MS::kFailure;
+        }
+        else if( tolerance < 0.0 ) {
+            MGlobal::displayError( "The tolerance must be greater than or equal to 0" );
+            status = MS::kFailure;
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: getDrivenPlugs
+// Desc: Finds the keyable, unlocked attributes of the
+//       selected objects that are driven by something
+//       other than an anim curve
+//*********************************************************
+MStatus BakeReduceCommand::getDrivenPlugs()
+{
+    MStatus status = MS::kSuccess;
+
+    MObject dependNode;
+    MPlugArray plugArray;
+
+    MItSelectionList sIter( selectionList, MFn::kInvalid, &status );
+    if( !status ) {
+        pluginError( "BakeReduceCommand", "getDrivenPlugs", "Failed to creation SL iterator" );
+    }
+
+    for( ; status && !sIter.isDone(); sIter.next() ) {
+        if( !sIter.getDependNode( dependNode )) {
+            pluginError( "BakeReduceCommand", "getDrivenPlugs", "Couldn't get dependency node" );
+            status = MS::kFailure;
+            break;
+        }
+
+        // The call to get connections doesn't clear the array
+        plugArray.clear();
+
+        MFnDependencyNode dependFn( dependNode );
+        if( !dependFn.getConnections( plugArray )) {
+            // This object has no connections
+            continue;
+        }
+
+        // The plugs found on this node start here
+        unsigned int firstPlug = (unsigned int)bakedPlugs.size();
+
+        for( unsigned int index = 0; index < plugArray.length(); index++ ) {
+            MPlug plug = plugArray[index];
+            BakedPlugACC bakedPlug;
+
+            if( !plug.isKeyable() || plug.isLocked() || !isDrivenPlug( plug, bakedPlug.source ))
+                continue;
+
+            // A plug is listed again when it is also a source
+            bool isDuplicate = false;
+            for( unsigned int i = firstPlug; i < bakedPlugs.size() && !isDuplicate; i++ )
+                isDuplicate = (bakedPlugs[i].plug == plug);
+
+            if( isDuplicate )
+                continue;
+
+            MFnAnimCurve animCurveFn;
+            bakedPlug.plug = plug;
+            bakedPlug.isAngular = (animCurveFn.timedAnimCurveTypeForPlug( plug ) == MFnAnimCurve::kAnimCurveTA);
+            bakedPlug.isStepped = AnimCurveCollector::isSteppedPlug( plug );
+            bakedPlug.error = 0.0;
+            bakedPlug.pAnimCache = NULL;
+
+            bakedPlugs.push_back( bakedPlug );
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: isDrivenPlug
+// Desc: Returns true if the plug is driven by something
+//       other than an anim curve.  Attributes connected
+//       to a character set are animated through it.
+//*********************************************************
+bool BakeReduceCommand::isDrivenPlug( const MPlug &plug, MPlug &source ) const
+{
+    MPlugArray sources;
+    bool isDriven = false;
+
+    if( plug.connectedTo( sources, true, false ) && sources.length() > 0 ) {
+        MObject sourceNode = sources[0].node();
+
+        if( !sourceNode.hasFn( MFn::kAnimCurve ) && !sourceNode.hasFn( MFn::kCharacter )) {
+            source = sources[0];
+            isDriven = true;
+        }
+    }
+
+    return isDriven;
+}
+
+
+//*********************************************************
+// Name: samplePlugs
+// Desc: Evaluates every driven plug over the frame range.
+//       Evaluating the graph isn't thread safe, so the
+//       samples are taken on the main thread a frame at a
+//       time.  Rotations are stored in degrees to match
+//       the tolerance.
+//*********************************************************
+MStatus BakeReduceCommand::samplePlugs()
+{
+    MStatus status = MS::kSuccess;
+    MTime::Unit uiUnit = MTime::uiUnit();
+
+    // A small epsilon keeps the end frame when the range
+    // is a whole number of samples
+    unsigned int numFrames = (unsigned int)floor( (endTime - startTime) / sampleBy + 1.0e-6 ) + 1;
+
+    for( unsigned int i = 0; i < bakedPlugs.size(); i++ )
+        bakedPlugs[i].keys.resize( numFrames );
+
+    for( unsigned int frame = 0; frame < numFrames && status; frame++ ) {
+        double time = startTime + frame * sampleBy;
+        MDGContext context( MTime( time, uiUnit ));
+
+        for( unsigned int i = 0; i < bakedPlugs.size(); i++ ) {
+            BakedPlugACC &bakedPlug = bakedPlugs[i];
+            CurveKey &key = bakedPlug.keys[frame];
+
+            key.time = time;
+            key.value = bakedPlug.plug.asDouble( context, &status );
+            if( !status ) {
+                pluginError( "BakeReduceCommand", "samplePlugs", "Failed to evaluate " + bakedPlug.plug.name() );
+                break;
+            }
+
+            if( bakedPlug.isAngular )
+                key.value = MAngle( key.value, MAngle::kRadians ).asDegrees();
+
+            key.inSlope = 0.0;
+            key.outSlope = 0.0;
+            key.isStepOut = bakedPlug.isStepped;
+        }
+    }
+
+    numSamples = numFrames * (unsigned int)bakedPlugs.size();
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: calcSampleSlopes
+// Desc: Sets the tangents of the sampled keys to the
+//       slope between the neighbouring samples (one sided
+//       at the ends).  Stepped keys stay flat.
+//*********************************************************
+void BakeReduceCommand::calcSampleSlopes( std::vector<CurveKey> &keys )
+{
+    unsigned int numKeys = (unsigned int)keys.size();
+
+    if( numKeys < 2 || keys[0].isStepOut )
+        return;
+
+    for( unsigned int i = 0; i < numKeys; i++ ) {
+        unsigned int prev = (i > 0) ? i - 1 : i;
+        unsigned int next = (i + 1 < numKeys) ? i + 1 : i;
+
+        double slope = (keys[next].value - keys[prev].value) / (keys[next].time - keys[prev].time);
+        keys[i].inSlope = slope;
+        keys[i].outSlope = slope;
+    }
+}
+
+
+//*********************************************************
+// Name: createCurves
+// Desc: Disconnects the drivers and connects new anim
+//       curves in a single modifier, then adds the kept
+//       keys with fixed tangents so each curve matches the
+//       shape the error was measured against
+//*********************************************************
+MStatus BakeReduceCommand::createCurves()
+{
+    MStatus status = MS::kSuccess;
+    MTime::Unit uiUnit = MTime::uiUnit();
+
+    for( unsigned int i = 0; i < bakedPlugs.size() && status; i++ ) {
+        BakedPlugACC &bakedPlug = bakedPlugs[i];
+        MFnAnimCurve animCurveFn;
+
+        if( !(status = dgModifier.disconnect( bakedPlug.source, bakedPlug.plug ))) {
+            pluginError( "BakeReduceCommand", "createCurves", "Failed to disconnect " + bakedPlug.plug.name() );
+            break;
+        }
+
+        bakedPlug.animCurve = animCurveFn.create( bakedPlug.plug, &dgModifier, &status );
+        if( !status ) {
+            pluginError( "BakeReduceCommand", "createCurves", "Failed to create the anim curve" );
+        }
+    }
+
+    if( status && !(status = dgModifier.doIt() )) {
+        pluginError( "BakeReduceCommand", "createCurves", "Failed to connect the anim curves" );
+    }
+
+    for( unsigned int i = 0; i < bakedPlugs.size() && status; i++ ) {
+        BakedPlugACC &bakedPlug = bakedPlugs[i];
+        MFnAnimCurve animCurveFn( bakedPlug.animCurve );
+
+        MFnAnimCurve::TangentType tangentType = bakedPlug.isStepped ? MFnAnimCurve::kTangentFlat :
+                                                                      MFnAnimCurve::kTangentFixed;
+        MFnAnimCurve::TangentType outTangentType = bakedPlug.isStepped ? MFnAnimCurve::kTangentStep :
+                                                                         MFnAnimCurve::kTangentFixed;
+
+        bakedPlug.pAnimCache = new MAnimCurveChange();
+
+        for( unsigned int index = 0; index < bakedPlug.keys.size(); index++ ) {
+            if( !bakedPlug.keepKeys[index] )
+                continue;
+
+            const CurveKey &key = bakedPlug.keys[index];
+            double value = key.value;
+            if( bakedPlug.isAngular )
+                value = MAngle( value, MAngle::kDegrees ).asRadians();
+
+            unsigned int keyIndex = animCurveFn.addKey( MTime( key.time, uiUnit ), value,
+                                                        tangentType, outTangentType,
+                                                        bakedPlug.pAnimCache, &status );
+            if( !status ) {
+                pluginError( "BakeReduceCommand", "createCurves", "Failed to add the key" );
+                break;
+            }
+
+            if( !bakedPlug.isStepped ) {
+                MAngle angle( atan( key.inSlope ), MAngle::kRadians );
+                animCurveFn.setTangent( keyIndex, angle, 1.0, true, bakedPlug.pAnimCache );
+                animCurveFn.setTangent( keyIndex, angle, 1.0, false, bakedPlug.pAnimCache );
+            }
+
+            numKeysKept++;
+        }
+    }
+
+    return status;
+}
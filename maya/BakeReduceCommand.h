@@ -0,0 +1,161 @@
+//*********************************************************
+// BakeReduceCommand.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __BAKE_REDUCE_COMMAND_H_
+#define __BAKE_REDUCE_COMMAND_H_
+
+//*********************************************************
+#include <maya/MPxCommand.h>
+
+#include <maya/MGlobal.h>
+#include <maya/MTime.h>
+#include <maya/MSyntax.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MSelectionList.h>
+#include <maya/MString.h>
+#include <maya/MAngle.h>
+#include <maya/MPlug.h>
+#include <maya/MPlugArray.h>
+#include <maya/MDGContext.h>
+#include <maya/MDGModifier.h>
+#include <maya/MAnimControl.h>
+#include <maya/MAnimCurveChange.h>
+
+#include <maya/MFnDependencyNode.h>
+#include <maya/MFnAnimCurve.h>
+
+#include <maya/MItSelectionList.h>
+
+#include "AnimCurveCollector.h"
+#include "CurveReducer.h"
+
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: BakeReduceCommand
+//
+// Desc: Bakes the keyable attributes of the selected
+//       objects that are driven by constraints, expressions
+//       or other nodes into anim curves, keeping only the
+//       keys needed to stay within the tolerance of the
+//       sampled values.  The driving nodes are disconnected
+//       but not deleted.
+//
+// Command: cieBakeReduce
+//
+// Flags: -startTime (-st)       (double)
+//
+//        -endTime (-et)         (double)
+//
+//        -sampleBy (-sb)        (double)
+//
+//        -tolerance (-tol)      (double)
+//
+//*********************************************************
+class BakeReduceCommand : public MPxCommand
+{
+private:
+    // A driven plug, its samples and the curve that
+    // replaces the driver (for undo/redo)
+    struct BakedPlugACC {
+        MPlug plug;
+        MPlug source;
+        bool isAngular;
+        bool isStepped;
+        std::vector<CurveKey> keys;
+        std::vector<bool> keepKeys;
+        double error;
+        MObject animCurve;
+        MAnimCurveChange* pAnimCache;
+    };
+
+    // Command flag constants
+    static const char *startTimeFlag, *startTimeLongFlag;
+    static const char *endTimeFlag, *endTimeLongFlag;
+    static const char *sampleByFlag, *sampleByLongFlag;
+    static const char *toleranceFlag, *toleranceLongFlag;
+
+    // The frame range to bake (defaults to the playback range)
+    double startTime;
+    double endTime;
+
+    // The number of frames between samples
+    double sampleBy;
+
+    // The largest change in value allowed when removing
+    // keys (degrees for rotations)
+    double tolerance;
+
+    // The objects currently selected in the Maya scene
+    MSelectionList selectionList;
+
+    // Indicates that the anim curve caches have been
+    // calculated for undo/redo
+    bool initialized;
+
+    // The driven plugs being baked
+    std::vector<BakedPlugACC> bakedPlugs;
+
+    // Disconnects the drivers and creates the anim
+    // curves (for undo/redo)
+    MDGModifier dgModifier;
+
+    // The number of samples taken and keys kept
+    unsigned int numSamples;
+    unsigned int numKeysKept;
+
+    // The largest error of all the reduced curves
+    double maxReductionError;
+
+    // Method to setup the command flags
+    MStatus parseCommandFlags( const MArgList &args );
+
+    // Finds the driven plugs on the selected objects
+    MStatus getDrivenPlugs();
+
+    // Returns true if the plug is driven by something
+    // other than an anim curve
+    bool isDrivenPlug( const MPlug &plug, MPlug &source ) const;
+
+    // Evaluates the driven plugs over the frame range
+    MStatus samplePlugs();
+
+    // Calculates the tangents of the sampled keys
+    // (safe to call from the thread pool)
+    static void calcSampleSlopes( std::vector<CurveKey> &keys );
+
+    // Replaces the drivers with anim curves holding the
+    // kept keys
+    MStatus createCurves();
+
+public:
+    // Constructor/Destructor
+    BakeReduceCommand();
+    ~BakeReduceCommand();
+
+    // Performs the command
+    virtual MStatus doIt( const MArgList &args );
+
+    // Performs the work that changes Maya's internal state
+    virtual MStatus redoIt();
+
+    // Undoes the changes to Maya's internal state
+    virtual MStatus undoIt();
+
+    // Indicates that Maya can undo/redo this command
+    virtual bool isUndoable() const { return true; }
+
+    // Allocates a command object to Maya (required)
+    static void *creator() { return new BakeReduceCommand; }
+
+    // Defines the set of flags allowed by this command
+    static MSyntax newSyntax();
+};
+
+#endif
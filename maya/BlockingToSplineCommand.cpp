@@ -0,0 +1,289 @@
+//*********************************************************
+// BlockingToSplineCommand.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "BlockingToSplineCommand.h"
+#include "ParallelFor.h"
+#include "ErrorReporting.h"
+//*********************************************************
+
+//*********************************************************
+// Constants
+//*********************************************************
+const char *BlockingToSplineCommand::solverFlag = "-sol";
+const char *BlockingToSplineCommand::solverLongFlag = "-solver";
+const char *BlockingToSplineCommand::weightFactorFlag = "-wf";
+const char *BlockingToSplineCommand::weightFactorLongFlag = "-weightFactor";
+
+
+//*********************************************************
+// Name: BlockingToSplineCommand
+// Desc: Constructor
+//*********************************************************
+BlockingToSplineCommand::BlockingToSplineCommand()
+{
+    pluginTrace( "BlockingToSplineCommand", "BlockingToSplineCommand", "******* Blocking To Spline Command *******" );
+
+    initialized = false;
+    numSteppedCurves = 0;
+
+    // Initialize the command flag defaults
+    solverType = TangentSolvers::kClamped;
+    weightFactor = 0.333;
+}
+
+
+//*********************************************************
+// Name: ~BlockingToSplineCommand
+// Desc: Destructor
+//*********************************************************
+BlockingToSplineCommand::~BlockingToSplineCommand()
+{
+    // Cleanup all memory allocated for this command
+    for( unsigned int i = 0; i < splineCurves.size(); i++ ) {
+        delete splineCurves[i].pAnimCurveFn;
+        delete splineCurves[i].pAnimCache;
+    }
+}
+
+
+//*********************************************************
+// Name: doIt
+// Desc: All of the one-time setup and initialization
+//       code for the blocking to spline command.  doIt is
+//       called by Maya when any command is executed in MEL.
+//       Any code that changes the state of Maya is
+//       handled by the redoIt method.
+//*********************************************************
+MStatus BlockingToSplineCommand::doIt( const MArgList &args )
+{
+    MStatus status = MS::kFailure;
+    AnimCurveCollector collector;
+    std::vector<AnimCurveInfo> animCurves;
+
+    if( !parseCommandFlags( args )) {
+        pluginError( "BlockingToSplineCommand", "doIt", "Failed to parse command flags" );
+    }
+    else if( !AnimCurveCollector::getSelectedObjects( selectionList )) {
+        MGlobal::displayError( "No Objects Selected" );
+    }
+    else if( !collector.getAnimCurves( selectionList, animCurves )) {
+        pluginError( "BlockingToSplineCommand", "doIt", "Failed to get the anim curves" );
+    }
+    else if( animCurves.empty() ) {
+        MGlobal::displayError( "No Keys Set" );
+    }
+    else if( !calcTangents( animCurves )) {
+        pluginError( "BlockingToSplineCommand", "doIt", "Failed to calculate the tangents" );
+    }
+    else if( !(status = redoIt() )) {
+        pluginError( "BlockingToSplineCommand", "doIt", "Failed to redoIt" );
+    }
+    else {
+        MString result( "Result: " );
+        result += (unsigned int)splineCurves.size();
+        result += " curves splined";
+        if( numSteppedCurves > 0 ) {
+            result += ", ";
+            result += numSteppedCurves;
+            result += " boolean/enum curves left stepped";
+        }
+        MGlobal::displayInfo( result );
+
+        setResult( (int)splineCurves.size() );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: redoIt
+// Desc: Contains the code that changes the internal state
+//       of Maya.  It is called by Maya to redo.
+//*********************************************************
+MStatus BlockingToSplineCommand::redoIt()
+{
+    MStatus status = MS::kSuccess;
+
+    if( !initialized ) {
+        initialized = true;
+
+        if( !(status = writeTangents() )) {
+            // Restore any curves that were changed
+            undoIt();
+
+            pluginError( "BlockingToSplineCommand", "redoIt", "Failed to write the tangents" );
+        }
+    }
+    else {
+        // Just use the anim curve cache to redo
+        for( unsigned int i = 0; i < splineCurves.size(); i++ )
+            splineCurves[i].pAnimCache->redoIt();
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: undoIt
+// Desc: Contains the code to undo the internal state
+//       changes made by the blocking to spline command
+//       (redoIt).  It is called by Maya to undo.
+//*********************************************************
+MStatus BlockingToSplineCommand::undoIt()
+{
+    MStatus status = MS::kSuccess;
+
+    for( unsigned int i = 0; i < splineCurves.size(); i++ )
+        splineCurves[i].pAnimCache->undoIt();
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: newSyntax
+// Desc: Method for registering the command flags
+//       with Maya
+//*********************************************************
+MSyntax BlockingToSplineCommand::newSyntax()
+{
+    MSyntax syntax;
+    syntax.addFlag( solverFlag, solverLongFlag, MSyntax::kString );
+    syntax.addFlag( weightFactorFlag, weightFactorLongFlag, MSyntax::kDouble );
+
+    return syntax;
+}
+
+
+//*********************************************************
+// Name: parseCommandFlags
+// Desc: Parse the command flags and stores the values
+//       in the appropriate variables
+//*********************************************************
+MStatus BlockingToSplineCommand::parseCommandFlags( const MArgList &args )
+{
+    MStatus status = MS::kSuccess;
+
+    MArgDatabase argData( syntax(), args, &status );
+    if( !status ) {
+        pluginError( "BlockingToSplineCommand", "parseCommandFlags",
+                     "Failed to create MArgDatabase for the blocking to spline command" );
+    }
+    else {
+        if( argData.isFlagSet( solverFlag )) {
+            MString strSolver;
+            argData.getFlagArgument( solverFlag, 0, strSolver );
+
+            if( strSolver == "clamped" )
+                solverType = TangentSolvers::kClamped;
+            else if( strSolver == "monotone" )
+                solverType = TangentSolvers::kMonotone;
+            else if( strSolver == "catmullRom" )
+                solverType = TangentSolvers::kCatmullRom;
+            else {
+                MGlobal::displayError( "Invalid arguement for -solver.  Use clamped, monotone or catmullRom." );
+                status = MS::kFailure;
+            }
+        }
+        if( argData.isFlagSet( weightFactorFlag ))
+            argData.getFlagArgument( weightFactorFlag, 0, weightFactor );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: calcTangents
+// Desc: Reads every curve that isn't on a boolean or enum
+//       attribute on the main thread, then solves the
+//       tangents of each curve on the thread pool.
+//       Rotations are read in degrees to match the
+//       tangent angles of the curve cleaner.
+//*********************************************************
+MStatus BlockingToSplineCommand::calcTangents( const std::vector<AnimCurveInfo> &animCurves )
+{
+    MStatus status = MS::kSuccess;
+    AnimCurveSnapshot snapshot;
+
+    splineCurves.reserve( animCurves.size() );
+
+    for( unsigned int i = 0; i < animCurves.size(); i++ ) {
+        if( AnimCurveCollector::isSteppedPlug( animCurves[i].plug )) {
+            numSteppedCurves++;
+            continue;
+        }
+
+        MFnAnimCurve *animCurveFn = new MFnAnimCurve( animCurves[i].animCurve, &status );
+        if( !status ) {
+            pluginError( "BlockingToSplineCommand", "calcTangents", "Can't get AnimCurve function set" );
+            delete animCurveFn;
+            break;
+        }
+
+        if( !(status = snapshot.capture( *animCurveFn ))) {
+            delete animCurveFn;
+            break;
+        }
+
+        SplineCurveACC splineCurve;
+        splineCurve.pAnimCurveFn = animCurveFn;
+        splineCurve.pAnimCache = new MAnimCurveChange();
+        splineCurve.keyTimes = snapshot.keyTimes;
+        splineCurve.keyValues = snapshot.keyValues;
+
+        if( animCurveFn->animCurveType() == MFnAnimCurve::kAnimCurveTA ) {
+            for( unsigned int index = 0; index < splineCurve.keyValues.size(); index++ )
+                splineCurve.keyValues[index] = MAngle( splineCurve.keyValues[index] ).asDegrees();
+        }
+
+        splineCurves.push_back( splineCurve );
+    }
+
+    if( status ) {
+        // Every curve is solved independently
+        parallelFor( (unsigned int)splineCurves.size(), [&]( unsigned int i ) {
+            SplineCurveACC &splineCurve = splineCurves[i];
+
+            TangentSolvers::solve( solverType, splineCurve.keyTimes, splineCurve.keyValues, weightFactor,
+                                   splineCurve.tangentAngles, splineCurve.inWeights, splineCurve.outWeights );
+        });
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: writeTangents
+// Desc: Sets the solved tangents on every curve.  The
+//       stepped out tangents are replaced along with the
+//       rest, so each curve is splined in one pass.
+//*********************************************************
+MStatus BlockingToSplineCommand::writeTangents()
+{
+    MStatus status = MS::kSuccess;
+
+    for( unsigned int i = 0; i < splineCurves.size() && status; i++ ) {
+        SplineCurveACC &splineCurve = splineCurves[i];
+
+        if( !(status = AnimCurveSnapshot::writeFixedTangents( *splineCurve.pAnimCurveFn,
+                                                              splineCurve.tangentAngles,
+                                                              splineCurve.inWeights,
+                                                              splineCurve.outWeights,
+                                                              false,
+                                                              splineCurve.pAnimCache ))) {
+            pluginError( "BlockingToSplineCommand", "writeTangents", "Failed to set the tangents" );
+        }
+    }
+
+    return status;
+}
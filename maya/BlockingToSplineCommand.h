@@ -0,0 +1,121 @@
+//*********************************************************
+// BlockingToSplineCommand.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __BLOCKING_TO_SPLINE_COMMAND_H_
+#define __BLOCKING_TO_SPLINE_COMMAND_H_
+
+//*********************************************************
+#include <maya/MPxCommand.h>
+
+#include <maya/MGlobal.h>
+#include <maya/MSyntax.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MSelectionList.h>
+#include <maya/MString.h>
+#include <maya/MAngle.h>
+#include <maya/MAnimCurveChange.h>
+
+#include <maya/MFnAnimCurve.h>
+
+#include "AnimCurveCollector.h"
+#include "AnimCurveSnapshot.h"
+#include "TangentSolvers.h"
+
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: BlockingToSplineCommand
+//
+// Desc: Converts the selected objects' stepped blocking
+//       curves to spline by setting fixed tangents from
+//       one of the tangent solvers on every key.  Curves on
+//       boolean and enum attributes stay stepped.  The keys
+//       themselves aren't changed, so breakdown ticks
+//       (keyTickDrawSpecial) are kept.
+//
+// Command: cieBlockingToSpline
+//
+// Flags: -solver (-sol)         (string) clamped, monotone or catmullRom
+//
+//        -weightFactor (-wf)    (double)
+//
+//*********************************************************
+class BlockingToSplineCommand : public MPxCommand
+{
+private:
+    // The keys and solved tangents of a curve and its
+    // curve change cache (for undo/redo)
+    struct SplineCurveACC {
+        MFnAnimCurve* pAnimCurveFn;
+        MAnimCurveChange* pAnimCache;
+        std::vector<double> keyTimes;
+        std::vector<double> keyValues;
+        std::vector<double> tangentAngles;
+        std::vector<double> inWeights;
+        std::vector<double> outWeights;
+    };
+
+    // Command flag constants
+    static const char *solverFlag, *solverLongFlag;
+    static const char *weightFactorFlag, *weightFactorLongFlag;
+
+    // The solver used to calculate the tangents
+    TangentSolvers::SolverType solverType;
+
+    // The weight of the tangents as a fraction of the
+    // neighbouring segments
+    double weightFactor;
+
+    // The objects currently selected in the Maya scene
+    MSelectionList selectionList;
+
+    // Indicates that the anim curve caches have been
+    // calculated for undo/redo
+    bool initialized;
+
+    // The curves being converted
+    std::vector<SplineCurveACC> splineCurves;
+
+    // The number of boolean/enum curves left stepped
+    unsigned int numSteppedCurves;
+
+    // Method to setup the command flags
+    MStatus parseCommandFlags( const MArgList &args );
+
+    // Reads the curves and solves their tangents
+    MStatus calcTangents( const std::vector<AnimCurveInfo> &animCurves );
+
+    // Sets the solved tangents on the curves
+    MStatus writeTangents();
+
+public:
+    // Constructor/Destructor
+    BlockingToSplineCommand();
+    ~BlockingToSplineCommand();
+
+    // Performs the command
+    virtual MStatus doIt( const MArgList &args );
+
+    // Performs the work that changes Maya's internal state
+    virtual MStatus redoIt();
+
+    // Undoes the changes to Maya's internal state
+    virtual MStatus undoIt();
+
+    // Indicates that Maya can undo/redo this command
+    virtual bool isUndoable() const { return true; }
+
+    // Allocates a command object to Maya (required)
+    static void *creator() { return new BlockingToSplineCommand; }
+
+    // Defines the set of flags allowed by this command
+    static MSyntax newSyntax();
+};
+
+#endif
@@ -0,0 +1,148 @@
+//*********************************************************
+// BurnInData.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "BurnInData.h"
+#include "ErrorReporting.h"
+
+#include <math.h>
+//*********************************************************
+
+//*********************************************************
+// Name: BurnInData
+// Desc: Constructor
+//*********************************************************
+BurnInData::BurnInData()
+{
+    numFrames = 0;
+    numDigitSlots = 0;
+    valid = false;
+}
+
+
+//*********************************************************
+// Name: build
+// Desc: Calculates the digits and timecode of every whole
+//       frame in the range, and gets the key types of the
+//       whole range from the timeline at once
+//*********************************************************
+MStatus BurnInData::build( const MTime &start, const MTime &end, const FrameCounterFormat &format,
+                           const KeyTypeTimeline &timeline )
+{
+    MStatus status = MS::kSuccess;
+
+    clear();
+
+    MTime::Unit unit = MTime::uiUnit();
+    long long startFrame = FrameCounterFormat::getFrame( start );
+    long long endFrame = FrameCounterFormat::getFrame( end );
+
+    startTime = MTime( (double)startFrame, unit );
+    counterFormat = format;
+
+    if( endFrame < startFrame ) {
+        pluginError( "BurnInData", "build", "The range ends before it starts" );
+        return MS::kInvalidParameter;
+    }
+
+    numFrames = (unsigned int)(endFrame - startFrame + 1);
+    numDigitSlots = counterFormat.getNumDigitSlots();
+
+    digits.resize( (size_t)numFrames * numDigitSlots );
+    negative.resize( numFrames );
+    timecodes.resize( numFrames );
+
+    FrameCounterFormat timecodeFormat;
+    timecodeFormat.format = FrameCounterFormat::kTimecode;
+
+    std::vector<int> frameDigits;
+    bool frameNegative = false;
+
+    for( unsigned int frame = 0; frame < numFrames; frame++ ) {
+        MTime time = startTime + (double)frame;
+
+        counterFormat.getDigits( time, frameDigits, frameNegative );
+        for( unsigned int slot = 0; slot < numDigitSlots && slot < frameDigits.size(); slot++ )
+            digits[(size_t)frame * numDigitSlots + slot] = frameDigits[slot];
+
+        negative[frame] = frameNegative;
+        timecodes[frame] = timecodeFormat.getText( time ).c_str();
+    }
+
+    timeline.getKeyTypes( startTime, numFrames, keyTypes );
+
+    valid = true;
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: getFrame
+// Desc: The index of a time is its distance from the
+//       start in frames of the UI unit
+//*********************************************************
+bool BurnInData::getFrame( const MTime &time, Frame &frame ) const
+{
+    if( !valid || numFrames == 0 )
+        return false;
+
+    double offset = time.as( startTime.unit() ) - startTime.value();
+    if( offset < 0.0 )
+        return false;
+
+    unsigned int index = (unsigned int)floor( offset + 0.5 );
+    if( index >= numFrames || !(startTime + (double)index == time) )
+        return false;
+
+    frame.digits = numDigitSlots > 0 ? &digits[(size_t)index * numDigitSlots] : NULL;
+    frame.numDigits = numDigitSlots;
+    frame.negative = negative[index] != 0;
+    frame.timecode = timecodes[index];
+    frame.keyType = keyTypes[index];
+
+    return true;
+}
+
+
+//*********************************************************
+// Name: matches
+// Desc: The range, the counter format and the UI unit all
+//       have to be the same
+//*********************************************************
+bool BurnInData::matches( const MTime &start, const MTime &end, const FrameCounterFormat &format ) const
+{
+    long long startFrame = FrameCounterFormat::getFrame( start );
+    long long endFrame = FrameCounterFormat::getFrame( end );
+
+    return startTime.unit() == MTime::uiUnit() &&
+           startFrame == (long long)floor( startTime.value() + 0.5 ) &&
+           endFrame - startFrame + 1 == (long long)numFrames &&
+           format.format == counterFormat.format &&
+           format.numDigits == counterFormat.numDigits &&
+           format.framesPerFoot == counterFormat.framesPerFoot &&
+           format.showSign == counterFormat.showSign;
+}
+
+
+//*********************************************************
+// Name: clear
+// Desc: Frees the stored frames
+//*********************************************************
+void BurnInData::clear()
+{
+    numFrames = 0;
+    numDigitSlots = 0;
+
+    digits.clear();
+    negative.clear();
+    timecodes.clear();
+    keyTypes.clear();
+
+    valid = false;
+}
@@ -0,0 +1,97 @@
+//*********************************************************
+// BurnInData.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __BURN_IN_DATA_H_
+#define __BURN_IN_DATA_H_
+
+//*********************************************************
+#include <maya/MStatus.h>
+#include <maya/MString.h>
+#include <maya/MTime.h>
+
+#include "FrameCounterFormat.h"
+#include "KeyTypeTimeline.h"
+
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: BurnInData
+//
+// Desc: Everything the shot mask shows on each frame of a
+//       range, calculated in one pass before a playblast.
+//       The counter digits, the timecode and the key type
+//       of every whole frame are stored by frame, so
+//       drawing a frame is an index into the arrays.
+//
+//       Sub-frames and times outside the range aren't
+//       stored, they have to be calculated as usual.
+//*********************************************************
+class BurnInData
+{
+public:
+    // What the mask shows on one frame
+    struct Frame {
+        // The counter digit of each digit slot, index 0 is
+        // the rightmost slot
+        const int *digits;
+        unsigned int numDigits;
+        bool negative;
+
+        // SMPTE timecode of the frame
+        MString timecode;
+
+        KeyTypeTimeline::KeyType keyType;
+    };
+
+private:
+    // The first frame in the UI unit and the frame count
+    MTime startTime;
+    unsigned int numFrames;
+
+    // The format the digits were calculated with
+    FrameCounterFormat counterFormat;
+
+    // numFrames * numDigitSlots digits, one row per frame
+    unsigned int numDigitSlots;
+    std::vector<int> digits;
+
+    std::vector<unsigned char> negative;
+    std::vector<MString> timecodes;
+    std::vector<KeyTypeTimeline::KeyType> keyTypes;
+
+    // False until built and after the keys change
+    bool valid;
+
+public:
+    // Constructor
+    BurnInData();
+
+    // Calculates every whole frame from start to end
+    MStatus build( const MTime &start, const MTime &end, const FrameCounterFormat &format,
+                   const KeyTypeTimeline &timeline );
+
+    // Gets the stored frame at a time.  Returns false for
+    // sub-frames and times outside the range.
+    bool getFrame( const MTime &time, Frame &frame ) const;
+
+    // Indicates the data was built for the range and
+    // format
+    bool matches( const MTime &start, const MTime &end, const FrameCounterFormat &format ) const;
+
+    // Marks the data as out of date
+    void invalidate() { valid = false; }
+
+    // Indicates the data matches the keys
+    bool isValid() const { return valid; }
+
+    // Frees the stored frames
+    void clear();
+};
+
+#endif
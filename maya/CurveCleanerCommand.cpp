@@ -9,6 +9,11 @@
 //*********************************************************
 #include "CurveCleanerCommand.h"
 #include "ErrorReporting.h"
+#include "ParallelFor.h"
+#include "TangentKernels.h"
+#include "EulerFilter.h"
+#include "AnimCurveCollector.h"
+#include "AnimCurveSnapshot.h"
 //*********************************************************
 
 //*********************************************************
@@ -26,6 +31,27 @@ const char *CurveCleanerCommand::weightFactorFlag = "-wf";
 const char *CurveCleanerCommand::weightFactorLongFlag = "-weightFactor";
 const char *CurveCleanerCommand::smoothAllSplinesFlag = "-sas";
 const char *CurveCleanerCommand::smoothAllSplinesLongFlag = "-smoothAllSplines";
+const char *CurveCleanerCommand::toleranceFlag = "-tol";
+const char *CurveCleanerCommand::toleranceLongFlag = "-tolerance";
+const char *CurveCleanerCommand::eulerFilterFlag = "-ef";
+const char *CurveCleanerCommand::eulerFilterLongFlag = "-eulerFilter";
+const char *CurveCleanerCommand::filterFlag = "-fl";
+const char *CurveCleanerCommand::filterLongFlag = "-filter";
+const char *CurveCleanerCommand::filterWidthFlag = "-fw";
+const char *CurveCleanerCommand::filterWidthLongFlag = "-filterWidth";
+const char *CurveCleanerCommand::startTimeFlag = "-st";
+const char *CurveCleanerCommand::startTimeLongFlag = "-startTime";
+const char *CurveCleanerCommand::endTimeFlag = "-et";
+const char *CurveCleanerCommand::endTimeLongFlag = "-endTime";
+const char *CurveCleanerCommand::solverFlag = "-sol";
+const char *CurveCleanerCommand::solverLongFlag = "-solver";
+
+// The default filter widths in frames: the gaussian's
+// standard deviation, the Savitzky-Golay half window and
+// the shortest period the Butterworth keeps
+static const double defaultGaussianWidth = 2.0;
+static const double defaultSavitzkyGolayWidth = 3.0;
+static const double defaultButterworthWidth = 6.0;
 
 //*********************************************************
 // Name: CurveCleanerCommand
@@ -39,14 +65,32 @@ CurveCleanerCommand::CurveCleanerCommand()
 
     numKeysRemoved = 0;
     numCurvesCleaned = 0;
+    numEulerKeysChanged = 0;
+    numCurvesSmoothed = 0;
+    numCurvesNotUniform = 0;
+    numCurvesTooNarrow = 0;
+    maxReductionError = 0.0;
 
     cleanTangents = false;
     removeRedundantKeys = false;
+    eulerFilter = false;
+    smoothCurves = false;
+    filterType = CurveSmoother::kGaussian;
+    useFilterWidth = false;
+    filterWidth = defaultGaussianWidth;
+    useStartTime = false;
+    startTime = 0.0;
+    useEndTime = false;
+    endTime = 0.0;
+    useTolerance = false;
+    tolerance = 0.0;
 
     startEndTangentType = MFnAnimCurve::kTangentSmooth;
     smoothingValue = 0.0;
     smoothAllSplines = false;
     weightFactor = 0.333;
+    useSolver = false;
+    solverType = TangentSolvers::kMonotone;
 }
 
 //*********************************************************
@@ -104,8 +148,21 @@ MStatus CurveCleanerCommand::doIt( const MArgList &args )
 
     if( status ) {
         MString result( "Result: " );
+        if( eulerFilter )
+            MGlobal::displayInfo( result + numEulerKeysChanged );
+        if( smoothCurves ) {
+            MGlobal::displayInfo( result + numCurvesSmoothed );
+            if( numCurvesNotUniform > 0 )
+                MGlobal::displayWarning( MString() + numCurvesNotUniform +
+                                         " curves not smoothed, their keys aren't evenly spaced" );
+            if( numCurvesTooNarrow > 0 )
+                MGlobal::displayWarning( MString() + numCurvesTooNarrow +
+                                         " curves not smoothed, the filter width is too narrow for their key spacing" );
+        }
         if( removeRedundantKeys )
             MGlobal::displayInfo( result + numKeysRemoved );
+        if( useTolerance )
+            MGlobal::displayInfo( MString( "Max Error: " ) + maxReductionError );
         if( cleanTangents )
             MGlobal::displayInfo( result + numCurvesCleaned );
     }
@@ -125,8 +182,32 @@ MStatus CurveCleanerCommand::redoIt()
     if( !initialized ) {
         initialized = true;
 
+        // Flips are removed first so they don't affect
+        // the other cleaning operations
+        if( status && eulerFilter ) {
+            if( !(status = eulerFilterSelected())) {
+                // Cleanup any keys that were affected
+                undoIt();
+
+                pluginError( "CurveCleanerCommand", "redoIt", "Failed to euler filter" );
+            }
+        }
+        // Noise is removed before the keys are reduced
+        if( status && smoothCurves ) {
+            if( !(status = smoothSelected())) {
+                // Cleanup any keys that were affected
+                undoIt();
+
+                pluginError( "CurveCleanerCommand", "redoIt", "Failed to smooth curves" );
+            }
+        }
         if( status && removeRedundantKeys ) {
-            if( !(status = removeRedundantKeysFromSelected())) {
+            if( useTolerance )
+                status = reduceKeysFromSelected();
+            else
+                status = removeRedundantKeysFromSelected();
+
+            if( !status ) {
                 // Cleanup any keys that were affected
                 undoIt();
 
@@ -201,6 +282,13 @@ MSyntax CurveCleanerCommand::newSyntax()
     syntax.addFlag( smoothnessFlag, smoothnessLongFlag, MSyntax::kDouble );
     syntax.addFlag( weightFactorFlag, weightFactorLongFlag, MSyntax::kDouble );
     syntax.addFlag( smoothAllSplinesFlag, smoothAllSplinesLongFlag, MSyntax::kBoolean );
+    syntax.addFlag( toleranceFlag, toleranceLongFlag, MSyntax::kDouble );
+    syntax.addFlag( eulerFilterFlag, eulerFilterLongFlag, MSyntax::kNoArg );
+    syntax.addFlag( filterFlag, filterLongFlag, MSyntax::kString );
+    syntax.addFlag( filterWidthFlag, filterWidthLongFlag, MSyntax::kDouble );
+    syntax.addFlag( startTimeFlag, startTimeLongFlag, MSyntax::kDouble );
+    syntax.addFlag( endTimeFlag, endTimeLongFlag, MSyntax::kDouble );
+    syntax.addFlag( solverFlag, solverLongFlag, MSyntax::kString );
 
     return syntax;
 }
@@ -226,6 +314,8 @@ MStatus CurveCleanerCommand::parseCommandFlags(const MArgList &args)
             cleanTangents = true;
         if( argData.isFlagSet( removeRedundantKeysFlag ))
             removeRedundantKeys = true;
+        if( argData.isFlagSet( eulerFilterFlag ))
+            eulerFilter = true;
 
         
         if( argData.isFlagSet( splineStartEndFlag )) {
@@ -244,8 +334,84 @@ MStatus CurveCleanerCommand::parseCommandFlags(const MArgList &args)
         if( argData.isFlagSet( weightFactorFlag ))
             argData.getFlagArgument( weightFactorFlag, 0, weightFactor );
 
+        // A tolerance implies redundant key removal
+        if( argData.isFlagSet( toleranceFlag )) {
+            argData.getFlagArgument( toleranceFlag, 0, tolerance );
+            useTolerance = true;
+            removeRedundantKeys = true;
+
+            if( tolerance < 0.0 ) {
+                MGlobal::displayError( "The tolerance must be greater than or equal to 0" );
+                status = MS::kFailure;
+            }
+        }
+
+        if( argData.isFlagSet( filterFlag )) {
+            MString strFilter;
+            argData.getFlagArgument( filterFlag, 0, strFilter );
+            smoothCurves = true;
+
+            if( strFilter == "gaussian" )
+                filterType = CurveSmoother::kGaussian;
+            else if( strFilter == "savitzkyGolay" )
+                filterType = CurveSmoother::kSavitzkyGolay;
+            else if( strFilter == "butterworth" )
+                filterType = CurveSmoother::kButterworth;
+            else {
+                MGlobal::displayError( "Invalid arguement for -filter.  Use gaussian, savitzkyGolay or butterworth." );
+                status = MS::kFailure;
+            }
+        }
+        if( argData.isFlagSet( filterWidthFlag )) {
+            argData.getFlagArgument( filterWidthFlag, 0, filterWidth );
+            useFilterWidth = true;
+
+            if( filterWidth <= 0.0 ) {
+                MGlobal::displayError( "The filter width must be greater than 0" );
+                status = MS::kFailure;
+            }
+        }
+        // A solver implies cleaning the tangents
+        if( argData.isFlagSet( solverFlag )) {
+            MString strSolver;
+            argData.getFlagArgument( solverFlag, 0, strSolver );
+            useSolver = true;
+            cleanTangents = true;
+
+            if( strSolver == "clamped" )
+                solverType = TangentSolvers::kClamped;
+            else if( strSolver == "monotone" )
+                solverType = TangentSolvers::kMonotone;
+            else if( strSolver == "catmullRom" )
+                solverType = TangentSolvers::kCatmullRom;
+            else {
+                MGlobal::displayError( "Invalid arguement for -solver.  Use clamped, monotone or catmullRom." );
+                status = MS::kFailure;
+            }
+        }
+        if( argData.isFlagSet( startTimeFlag )) {
+            argData.getFlagArgument( startTimeFlag, 0, startTime );
+            useStartTime = true;
+        }
+        if( argData.isFlagSet( endTimeFlag )) {
+            argData.getFlagArgument( endTimeFlag, 0, endTime );
+            useEndTime = true;
+        }
+
+        // Each filter needs its own width to do anything
+        // at a key every frame
+        if( !useFilterWidth ) {
+            if( filterType == CurveSmoother::kSavitzkyGolay )
+                filterWidth = defaultSavitzkyGolayWidth;
+            else if( filterType == CurveSmoother::kButterworth )
+                filterWidth = defaultButterworthWidth;
+            else
+                filterWidth = defaultGaussianWidth;
+        }
+
         // Default to clean tangents if no cleaning flags provided
-        if( cleanTangents == false && removeRedundantKeys == false )
+        if( cleanTangents == false && removeRedundantKeys == false &&
+            eulerFilter == false && smoothCurves == false )
             cleanTangents = true;
 
     }
@@ -260,46 +426,13 @@ MStatus CurveCleanerCommand::parseCommandFlags(const MArgList &args)
 //*********************************************************
 MStatus CurveCleanerCommand::getSelectedObjects()
 {
-    MStatus status = MS::kFailure;
-    MSelectionList characterSetList;
-
-    selectionList.clear();
-
-    // Selected Objects Include:
-    //    1) The Active Character Set (if in use) and its subset
-    //    2) Character Sets selected by the user (and their subsets)
-    //    3) Objects selected by the user
+    MStatus status = AnimCurveCollector::getSelectedObjects( selectionList );
 
-    // Get the character set if active (in Maya) and the associated character set subsets
-    MStringArray characterSets;
-    MGlobal::executeCommand( MString("cie_atbGetActiveCharacterSets"), characterSets, false, false );
-
-    // Create a selection list with all the character set/subsets
-    for( unsigned int i = 0; i < characterSets.length(); i++ ) {
-        MGlobal::getSelectionListByName( characterSets[i], characterSetList );
-    }
-
-    // Get the character sets selected (by user) and the associated character set subsets 
-    MGlobal::executeCommand( MString("cie_atbGetSelectedCharacterSets"), characterSets, false, false);
-
-    // Append to the selection list with all the selected character set/subsets
-    for( unsigned int i = 0; i < characterSets.length(); i++ ) {
-        MGlobal::getSelectionListByName( characterSets[i], characterSetList );
-    }
-
-    // Retrive all of the currently selected objects
-    if( !MGlobal::getActiveSelectionList( selectionList )) {
-        pluginError( "CurveCleanerCommand", "getSelectedObjects", "Failed to get active selection list" );
-    }
     // At least one object must be selected for this command
-    else if( characterSetList.length() == 0 && selectionList.length() == 0 ) {
+    if( !status ) {
         pluginError( "CurveCleanerCommand", "getSelectedObjects", "No Objects Selected" );
         MGlobal::displayError( "No Objects Selected" );
     }
-    else
-        status = MS::kSuccess;
-
-    selectionList.merge( characterSetList );
 
     return status;
 }
@@ -307,49 +440,75 @@ MStatus CurveCleanerCommand::getSelectedObjects()
 //*********************************************************
 // Name: getAnimCurveFnList
 // Desc: Generates a list of anim curve function sets to
-//       be operated on
+//       be operated on, the curves are found by the anim
+//       curve collector
 //*********************************************************
 MStatus CurveCleanerCommand::getAnimCurveFnList()
 {
     MStatus status = MS::kSuccess;
+    AnimCurveCollector collector;
+    std::vector<AnimCurveInfo> animCurves;
+    AnimCurveFnACC animCurveFnACC;
 
-    MObject dependNode;
-    MPlugArray plugArray;
+    if( !(status = collector.getAnimCurves( selectionList, animCurves ))) {
+        pluginError( "CurveCleanerCommand", "getAnimCurveFnList", "Failed to get the anim curves" );
+        return status;
+    }
 
-    // Create an iterator to traverse the selection list
-    MItSelectionList sIter( selectionList, MFn::kInvalid, &status );
-    if( !status ) {
-        pluginError( "CurveCleanerCommand", "getAnimCurveFnList", "Failed to creation SL iterator" );
+    for( unsigned int i = 0; i < animCurves.size(); i++ ) {
+        MFnAnimCurve *animCurveFn = new MFnAnimCurve( animCurves[i].animCurve, &status );
+        if( !status ) {
+            pluginError( "CurveCleanerCommand", "getAnimCurveFnList", "Can't get AnimCurve function set" );
+            delete animCurveFn;
+            break;
+        }
+
+        animCurveFnACC.pAnimCurveFn = animCurveFn;
+        animCurveFnACC.pAnimCache = new MAnimCurveChange();
+        animCurveFnACC.node = animCurves[i].node;
+
+        // Rotations through blend/character nodes
+        // aren't grouped for the euler filter
+        animCurveFnACC.rotateAxis = animCurves[i].isDirect ? getRotateAxis( animCurves[i].plug ) : -1;
+        animCurveFnACC.isStepped = AnimCurveCollector::isSteppedPlug( animCurves[i].plug );
+
+        animCurveFnList.push_back( animCurveFnACC );
     }
-    else {
 
-        // Traverse all of the dependency nodes for the selected objects
-        for( ; !sIter.isDone(); sIter.next() ) {
-            // Get the current dependency node
-            if( !sIter.getDependNode( dependNode )) {
-                pluginError( "CurveCleanerCommand", "getAnimCurveFnList", "Couldn't get dependency node" );
-                status = MS::kFailure;
-                break;
-            }
+    return status;
+}
 
-            // The call to get connections doesn't clear the array
-            // so me must do it manually
-            plugArray.clear();
+//*********************************************************
+// Name: getKeys
+// Desc: Reads the time and value of every key on the
+//       anim curve in a single pass.  Rotation values
+//       are converted to degrees.
+//*********************************************************
+MStatus CurveCleanerCommand::getKeys( MFnAnimCurve *pAnimCurveFn,
+                                      std::vector<double> &keyTimes,
+                                      std::vector<double> &keyValues )
+{
+    MStatus status = MS::kSuccess;
 
-            // Get all of the connections to this dependency node
-            MFnDependencyNode dependFn( dependNode );
-            if( !dependFn.getConnections( plugArray )) {
-                // This object has no animation curves... no keys to worry about
-                pluginTrace( "CurveCleanerCommand", "getAnimCurveFnList", "No keys on object" );
-                continue;
-            }
+    unsigned int numKeys = pAnimCurveFn->numKeys();
+    bool isAngular = (pAnimCurveFn->animCurveType() == MFnAnimCurve::kAnimCurveTA);
+    MTime::Unit uiUnit = MTime::uiUnit();
 
-            // Generate the list from the plugs
-            if( !getAnimCurveFnListFromPlugs( plugArray )) {
-                pluginError( "CurveCleanerCommand", "getAnimCurveFnList", "Failed to create list from Plugs" );
-                status = MS::kFailure;
-                break;
-            } 
+    keyTimes.resize( numKeys );
+    keyValues.resize( numKeys );
+
+    for( unsigned int index = 0; index < numKeys; index++ ) {
+        keyTimes[index] = pAnimCurveFn->time( index, &status ).as( uiUnit );
+        if( !status ) {
+            pluginError( "CurveCleanerCommand", "getKeys", "Failed to get the key time" );
+            break;
+        }
+
+        keyValues[index] = pAnimCurveFn->value( index );
+        if( isAngular ) {
+            // Convert the value to degrees from radians
+            MAngle angle( keyValues[index], MAngle::kRadians );
+            keyValues[index] = angle.asDegrees();
         }
     }
 
@@ -357,90 +516,117 @@ MStatus CurveCleanerCommand::getAnimCurveFnList()
 }
 
 //*********************************************************
-// Name: getAnimCurveFnListFromPlugs
-// Desc: Generates a list of anim curve function sets from
-//       an array of plugs
+// Name: getRotateAxis
+// Desc: Returns the rotate axis (0-2) driven by the plug
+//       or -1 if it isn't a child of the rotate attribute
 //*********************************************************
-MStatus CurveCleanerCommand::getAnimCurveFnListFromPlugs( MPlugArray plugArray )
+int CurveCleanerCommand::getRotateAxis( const MPlug &plug )
 {
-    MStatus status = MS::kSuccess;
-    AnimCurveFnACC animCurveFnACC;
+    int rotateAxis = -1;
 
-    // Check each connection for an upstream connections that is a kAnimCurve
-    for( unsigned int index = 0; index < plugArray.length(); index++ )
-    {
-        if( plugArray[index].isKeyable() && !plugArray[index].isLocked() )
-        {
-            // Create an iterator that will exclusively traverse AnimCurve nodes
-            MPlug currentPlug = plugArray[index];
-            MItDependencyGraph dgIter( currentPlug,
-                                       MFn::kAnimCurve,
-                                       MItDependencyGraph::kUpstream,
-                                       MItDependencyGraph::kBreadthFirst,
-                                       MItDependencyGraph::kNodeLevel,
-                                       &status );
-            if( !status ) {
-                pluginError( "CurveCleanerCommand", "getAnimCurveFnListFromPlugs", "DG Iterator error" );
+    if( plug.isChild() ) {
+        MPlug parentPlug = plug.parent();
+
+        if( parentPlug.partialName( false, false, false, false, false, true ) == "rotate" ) {
+            for( unsigned int axis = 0; axis < 3 && axis < parentPlug.numChildren(); axis++ ) {
+                if( parentPlug.child( axis ) == plug ) {
+                    rotateAxis = (int)axis;
+                    break;
+                }
             }
-            else {
-                // Retrieve the anim curve function sets
-                // and store them in the list
-                for( ; !dgIter.isDone(); dgIter.next() )
-                {
-                    MObjectArray nodePath;
-                    dgIter.getNodePath( nodePath );
-/*                  
-                    // *** Original solution that didn't support Blend/Charater nodes ***                    
-                    // Only use the anim curves directly connected to the attributes
-                    // >1 on a breadth first search is level 2.  Root will always be
-                    // last in path
-                    if( nodePath.length() > 2 )
-                        break;
-*/
-
-                    // At a depth of 1 in the DAG, the animation nodes are directly 
-                    // connected to animated object.  However, if the depth is greater
-                    // than one then we must accomodate both PairBlend nodes and 
-                    // Character Set nodes (which sit between the transform node and
-                    // the anim nodes.
-                    int nodeParentIndex = 1;
-                    if( nodePath.length() <= 2 || 
-                        (nodePath.length() == 3 && 
-                            (nodePath[nodeParentIndex].apiType() == MFn::kPairBlend ||
-                            nodePath[nodeParentIndex].apiType() == MFn::kCharacter ))
-                        )
-                    {
-                        MObject anim = dgIter.thisNode( &status );
-                        MFnAnimCurve *animCurveFn = new MFnAnimCurve( anim, &status );
-
-                        // Avoid adding duplicate anim curves to the list
-                        // Important when dealing with blend nodes
-                        MString curveName = animCurveFn->name();
-                        bool nameExists = false;
-
-                        animCurveListIter = animCurveFnList.begin();
-                        while( animCurveListIter != animCurveFnList.end() ) {
-                            if( ((AnimCurveFnACC)*animCurveListIter).pAnimCurveFn->name() == curveName ) {
-                                nameExists = true;
-                                break;
-                            }
-                            animCurveListIter++;
-                        }
-
-                        if( !nameExists ) {
-                            if( !status ) {
-                                pluginError( "CurveCleanerCommand", "getAnimCurveFnListFromPlugs", "Can't get AnimCurve function set" );
-                                delete animCurveFn;
-                            }
-                            // If there are no problems, add the function set to the list
-                            else {
-                                animCurveFnACC.pAnimCurveFn = animCurveFn;
-                                animCurveFnACC.pAnimCache = new MAnimCurveChange();
-                                animCurveFnList.push_back( animCurveFnACC );
-                            }
-                        }
-                    }
+        }
+    }
+
+    return rotateAxis;
+}
+
+//*********************************************************
+// Name: eulerFilterSelected
+// Desc: Removes the flips from the rotation curves of the
+//       selected objects.  The rotate curves are grouped by
+//       node and read on the main thread, each node is
+//       filtered on the thread pool and the changed values
+//       are written back on the main thread.
+//*********************************************************
+MStatus CurveCleanerCommand::eulerFilterSelected()
+{
+    MStatus status = MS::kSuccess;
+
+    std::vector<AnimCurveFnACC> animCurves( animCurveFnList.begin(), animCurveFnList.end() );
+    unsigned int numCurves = (unsigned int)animCurves.size();
+
+    std::vector< std::vector<double> > curveTimes( numCurves ), curveValues( numCurves );
+    std::vector<EulerCurveGroup> groups;
+
+    // The groups for each node hash code
+    std::multimap<unsigned int, unsigned int> groupsByNode;
+
+    for( unsigned int i = 0; i < numCurves; i++ ) {
+        const AnimCurveFnACC &animCurve = animCurves[i];
+
+        if( animCurve.rotateAxis < 0 ||
+            animCurve.pAnimCurveFn->animCurveType() != MFnAnimCurve::kAnimCurveTA )
+            continue;
+
+        if( !(status = getKeys( animCurve.pAnimCurveFn, curveTimes[i], curveValues[i] ))) {
+            pluginError( "CurveCleanerCommand", 
+                         "eulerFilterSelected", "Failed to get keys" );
+            break;
+        }
+
+        // Find the group for the curve's node
+        unsigned int hashCode = MObjectHandle( animCurve.node ).hashCode();
+        std::multimap<unsigned int, unsigned int>::iterator groupIter = groupsByNode.lower_bound( hashCode );
+        for( ; groupIter != groupsByNode.upper_bound( hashCode ); groupIter++ ) {
+            if( groups[groupIter->second].node == animCurve.node )
+                break;
+        }
+
+        unsigned int groupIndex;
+        if( groupIter != groupsByNode.upper_bound( hashCode ) ) {
+            groupIndex = groupIter->second;
+        }
+        else {
+            EulerCurveGroup group;
+            group.node = animCurve.node;
+            group.curveIndices[0] = group.curveIndices[1] = group.curveIndices[2] = -1;
+
+            // The flipped solution depends on the rotate order
+            MFnDependencyNode nodeFn( animCurve.node );
+            MPlug rotateOrderPlug = nodeFn.findPlug( "rotateOrder", &status );
+            group.middleAxis = EulerFilter::getMiddleAxis( status ? rotateOrderPlug.asShort() : 0 );
+            status = MS::kSuccess;
+
+            groupIndex = (unsigned int)groups.size();
+            groups.push_back( group );
+            groupsByNode.insert( std::make_pair( hashCode, groupIndex ));
+        }
+
+        groups[groupIndex].curveIndices[animCurve.rotateAxis] = (int)i;
+    }
+
+    if( status ) {
+        std::vector< std::vector<double> > filteredValues( curveValues );
+
+        // Every node is filtered independently
+        parallelFor( (unsigned int)groups.size(), [&]( unsigned int g ) {
+            filterEulerGroup( groups[g], curveTimes, filteredValues );
+        });
+
+        // Write the changed values back in radians
+        for( unsigned int i = 0; i < numCurves && status; i++ ) {
+            for( unsigned int index = 0; index < filteredValues[i].size(); index++ ) {
+                if( filteredValues[i][index] == curveValues[i][index] )
+                    continue;
+
+                MAngle angle( filteredValues[i][index], MAngle::kDegrees );
+                if( !(status = animCurves[i].pAnimCurveFn->setValue( index, angle.asRadians(), animCurves[i].pAnimCache ))) {
+                    pluginError( "CurveCleanerCommand", 
+                                 "eulerFilterSelected", "Failed to set the key value" );
+                    break;
                 }
+
+                numEulerKeysChanged++;
             }
         }
     }
@@ -449,31 +635,159 @@ MStatus CurveCleanerCommand::getAnimCurveFnListFromPlugs( MPlugArray plugArray )
 }
 
 //*********************************************************
-// Name: removeRedundantKeysFromSelected
-// Desc: Removes the keys from the selected objects'
-//       animation curves that don't affect the curve shape
+// Name: filterEulerGroup
+// Desc: Filters the rotation values of a node's curves.
+//       The closest equivalent rotation can only be found
+//       when all three curves have keys at the same times,
+//       otherwise each curve is only unwrapped.
 //*********************************************************
-MStatus CurveCleanerCommand::getKeyTimes( MFnAnimCurve *pAnimCurveFn, 
-                                         std::vector<MTime> *keyTimes )
+void CurveCleanerCommand::filterEulerGroup( const EulerCurveGroup &group,
+                                            const std::vector< std::vector<double> > &curveTimes,
+                                            std::vector< std::vector<double> > &curveValues )
+{
+    const int *indices = group.curveIndices;
+    bool keysMatch = (indices[0] >= 0 && indices[1] >= 0 && indices[2] >= 0 &&
+                      curveTimes[indices[0]] == curveTimes[indices[1]] &&
+                      curveTimes[indices[0]] == curveTimes[indices[2]]);
+
+    if( keysMatch ) {
+        EulerFilter::filter( curveValues[indices[0]],
+                             curveValues[indices[1]],
+                             curveValues[indices[2]],
+                             group.middleAxis );
+    }
+    else {
+        for( unsigned int axis = 0; axis < 3; axis++ ) {
+            if( indices[axis] >= 0 )
+                EulerFilter::unwrap( curveValues[indices[axis]] );
+        }
+    }
+}
+
+//*********************************************************
+// Name: smoothSelected
+// Desc: Filters the noise out of the key values on the
+//       selected objects' animation curves.  Only curves
+//       with evenly spaced keys in the frame range are
+//       smoothed.  The keys are read and written on the
+//       main thread and the curves are filtered on the
+//       thread pool.
+//*********************************************************
+MStatus CurveCleanerCommand::smoothSelected()
 {
     MStatus status = MS::kSuccess;
 
-    // Remove all elements from the vector
-    keyTimes->clear();
+    std::vector<AnimCurveFnACC> animCurves( animCurveFnList.begin(), animCurveFnList.end() );
+    unsigned int numCurves = (unsigned int)animCurves.size();
 
-    MObject animCurveObj = pAnimCurveFn->object();
-    MItKeyframe kfIter( animCurveObj, &status );
-    if( !status ) {
-        pluginError( "CurveCleanerCommand", "getKeyTimes", "Failed to get keyframe iterator" );  
+    std::vector< std::vector<double> > curveTimes( numCurves ), curveValues( numCurves );
+    std::vector< std::vector<double> > smoothedValues( numCurves );
+    std::vector<unsigned int> firstKeys( numCurves, 0 );
+    std::vector<double> sampleWidths( numCurves, 0.0 );
+
+    for( unsigned int i = 0; i < numCurves; i++ ) {
+        unsigned int firstKey, lastKey;
+
+        // Boolean and enum values can't be smoothed
+        if( animCurves[i].isStepped )
+            continue;
+
+        if( !(status = getKeys( animCurves[i].pAnimCurveFn, curveTimes[i], curveValues[i] ))) {
+            pluginError( "CurveCleanerCommand",
+                         "smoothSelected", "Failed to get keys" );
+            break;
+        }
+
+        if( !getSmoothingRange( curveTimes[i], firstKey, lastKey ))
+            continue;
+
+        if( !CurveSmoother::isUniform( curveTimes[i], firstKey, lastKey )) {
+            numCurvesNotUniform++;
+            continue;
+        }
+
+        // The filter works in keys rather than frames
+        double keySpacing = (curveTimes[i][lastKey] - curveTimes[i][firstKey]) / (lastKey - firstKey);
+        sampleWidths[i] = filterWidth / keySpacing;
+
+        if( !CurveSmoother::isEffective( filterType, sampleWidths[i] )) {
+            numCurvesTooNarrow++;
+            continue;
+        }
+
+        firstKeys[i] = firstKey;
+        smoothedValues[i].assign( curveValues[i].begin() + firstKey, curveValues[i].begin() + lastKey + 1 );
     }
 
-    for( kfIter.reset(); !kfIter.isDone(); kfIter.next() ) {
-        keyTimes->push_back( kfIter.time() );
+    if( status ) {
+        // Every curve is smoothed independently
+        parallelFor( numCurves, [&]( unsigned int i ) {
+            CurveSmoother::smooth( filterType, sampleWidths[i], smoothedValues[i] );
+        });
+
+        // Write the changed values back in internal units
+        for( unsigned int i = 0; i < numCurves && status; i++ ) {
+            if( smoothedValues[i].empty() )
+                continue;
+
+            MFnAnimCurve *pAnimCurveFn = animCurves[i].pAnimCurveFn;
+            bool isAngular = (pAnimCurveFn->animCurveType() == MFnAnimCurve::kAnimCurveTA);
+            bool isChanged = false;
+
+            for( unsigned int j = 0; j < smoothedValues[i].size(); j++ ) {
+                unsigned int index = firstKeys[i] + j;
+                double value = smoothedValues[i][j];
+
+                if( value == curveValues[i][index] )
+                    continue;
+
+                isChanged = true;
+                if( isAngular )
+                    value = MAngle( value, MAngle::kDegrees ).asRadians();
+
+                if( !(status = pAnimCurveFn->setValue( index, value, animCurves[i].pAnimCache ))) {
+                    pluginError( "CurveCleanerCommand",
+                                 "smoothSelected", "Failed to set the key value" );
+                    break;
+                }
+            }
+
+            if( isChanged )
+                numCurvesSmoothed++;
+        }
     }
 
     return status;
 }
 
+//*********************************************************
+// Name: getSmoothingRange
+// Desc: Finds the first and last keys within the start
+//       and end times.  Returns false if there are fewer
+//       than 3 keys to smooth.
+//*********************************************************
+bool CurveCleanerCommand::getSmoothingRange( const std::vector<double> &keyTimes,
+                                             unsigned int &firstKey,
+                                             unsigned int &lastKey ) const
+{
+    unsigned int numKeys = (unsigned int)keyTimes.size();
+
+    firstKey = 0;
+    while( firstKey < numKeys && useStartTime && keyTimes[firstKey] < startTime )
+        firstKey++;
+
+    lastKey = numKeys;
+    while( lastKey > firstKey && useEndTime && keyTimes[lastKey - 1] > endTime )
+        lastKey--;
+
+    // lastKey is one past the last key until here
+    bool hasKeys = (lastKey >= firstKey + 3);
+    if( hasKeys )
+        lastKey--;
+
+    return hasKeys;
+}
+
 //*********************************************************
 // Name: removeRedundantKeysFromSelected
 // Desc: Removes the keys from the selected objects'
@@ -514,41 +828,28 @@ MStatus CurveCleanerCommand::removeRedundantKeysFromAnimCurve( AnimCurveFnACC an
     MStatus status = MS::kSuccess;
 
     MFnAnimCurve *pAnimCurveFn = animCurveFnACC.pAnimCurveFn;
+    std::vector<double> keyTimes, keyValues;
 
-    // Get the time for each key on the anim curve
-    std::vector<MTime> keyTimes( pAnimCurveFn->numKeys() );
-    if( !(status = getKeyTimes( pAnimCurveFn, &keyTimes ) )) {
+    // Get the time and value for each key on the anim curve
+    if( !(status = getKeys( pAnimCurveFn, keyTimes, keyValues ))) {
         pluginError( "CurveCleanerCommand", 
-                     "removeRedundantKeysFromAnimCurve", "Failed to get key times" );
+                     "removeRedundantKeysFromAnimCurve", "Failed to get keys" );
     }
-    else {
-       // Get rid of the redundant keys   
-        double currentValue, prevValue, nextValue;
-        
-        // First and last keys will never be redundant
-        // Minimun of 3 keys for a possible key removal
-        if( keyTimes.size() > 2 ) {
-            prevValue = getKeyValue( pAnimCurveFn, keyTimes[0] );
-            
-            // Start on the second key and finish on the 
-            // second last key
-            for( unsigned int i = 1; i < (keyTimes.size() - 1); i++ ) {
-                currentValue = getKeyValue( pAnimCurveFn, keyTimes[i] );
-                nextValue = getKeyValue( pAnimCurveFn, keyTimes[i+1] );
-
-                if( (currentValue == prevValue) && (currentValue == nextValue) ) {
-                    // Remove the current key when it is the same
-                    // as the previous and next keys
-                    if( !removeKey( animCurveFnACC, keyTimes[i] )) {
-                        pluginError( "CurveCleanerCommand", 
-                                     "removeRedundantKeysFromAnimCurve", "Failed to remove key" );
-                    }
-                }
-                else {
-                    // Only update the previous value if the
-                    // current value was *not* removed
-                    prevValue = currentValue;
+    // First and last keys will never be redundant
+    // Minimun of 3 keys for a possible key removal
+    else if( keyValues.size() > 2 ) {
+        // A key is redundant when it is the same as the
+        // previous and next keys.  Keys are removed from
+        // the end so the remaining indices stay valid.
+        for( unsigned int i = (unsigned int)keyValues.size() - 2; i > 0; i-- ) {
+            if( (keyValues[i] == keyValues[i-1]) && (keyValues[i] == keyValues[i+1]) ) {
+                if( !(status = pAnimCurveFn->remove( i, animCurveFnACC.pAnimCache ))) {
+                    pluginError( "CurveCleanerCommand", 
+                                 "removeRedundantKeysFromAnimCurve", "Failed to remove key" );
+                    break;
                 }
+
+                numKeysRemoved++;
             }
         }
     }
@@ -557,83 +858,264 @@ MStatus CurveCleanerCommand::removeRedundantKeysFromAnimCurve( AnimCurveFnACC an
 }
 
 //*********************************************************
-// Name: getKeyValue
-// Desc: Returns the value of a key at a given time
+// Name: reduceKeysFromSelected
+// Desc: Removes the keys from the selected objects'
+//       animation curves that can be removed without
+//       the curve moving further than the tolerance.
+//       The curves are read and written on the main
+//       thread, while the reduction is done in parallel.
 //*********************************************************
-double CurveCleanerCommand::getKeyValue( MFnAnimCurve *pAnimCurveFn, MTime time )
+MStatus CurveCleanerCommand::reduceKeysFromSelected()
 {
-    unsigned int index = 0;
+    MStatus status = MS::kSuccess;
 
-    if( !(pAnimCurveFn->find( time, index )))
-        pluginError( "CurveCleanerCommand", 
-                     "getKeyValue", "Failed to find the key index" );
+    std::vector<AnimCurveFnACC> animCurves( animCurveFnList.begin(), animCurveFnList.end() );
+    unsigned int numCurves = (unsigned int)animCurves.size();
+
+    std::vector< std::vector<CurveKey> > curveKeys( numCurves );
+    std::vector< std::vector<bool> > keepKeys( numCurves );
+    std::vector<double> curveErrors( numCurves, 0.0 );
+
+    // Read the keys from every curve
+    for( unsigned int i = 0; i < numCurves; i++ ) {
+        // Weighted tangents aren't handled by the reducer, so
+        // only the exactly redundant keys are removed
+        if( animCurves[i].pAnimCurveFn->isWeighted() ) {
+            if( !(status = removeRedundantKeysFromAnimCurve( animCurves[i] ))) {
+                pluginError( "CurveCleanerCommand",
+                             "reduceKeysFromSelected", "Failed to remove keys from anim curve" );
+                break;
+            }
+        }
+        else if( !(status = readCurveKeys( animCurves[i].pAnimCurveFn, curveKeys[i] ))) {
+            pluginError( "CurveCleanerCommand",
+                         "reduceKeysFromSelected", "Failed to read the anim curve keys" );
+            break;
+        }
+    }
 
-    double value = pAnimCurveFn->value( index );
+    if( status ) {
+        // Every curve is reduced independently
+        parallelFor( numCurves, [&]( unsigned int i ) {
+            curveErrors[i] = CurveReducer::reduce( curveKeys[i], tolerance, keepKeys[i] );
+        });
+
+        for( unsigned int i = 0; i < numCurves; i++ ) {
+            if( !(status = removeReducedKeys( animCurves[i], keepKeys[i] ))) {
+                pluginError( "CurveCleanerCommand",
+                             "reduceKeysFromSelected", "Failed to remove keys from anim curve" );
+                break;
+            }
 
-    if( pAnimCurveFn->animCurveType() == MFnAnimCurve::kAnimCurveTA ) {
-        // Convert the value to degrees from radians
-        MAngle angle( value, MAngle::kRadians );
-        value = angle.asDegrees();
+            if( curveErrors[i] > maxReductionError )
+                maxReductionError = curveErrors[i];
+        }
     }
 
-    return value;
+    return status;
 }
 
 //*********************************************************
-// Name: removeKey
-// Desc: Removes a key at the given time
+// Name: readCurveKeys
+// Desc: Reads the keys of an anim curve for the curve
+//       reducer.  Rotation values are read in degrees to
+//       match the tangent angles.
 //*********************************************************
-MStatus CurveCleanerCommand::removeKey( CurveCleanerCommand::AnimCurveFnACC animCurveFnACC, MTime time )
+MStatus CurveCleanerCommand::readCurveKeys( MFnAnimCurve *pAnimCurveFn, std::vector<CurveKey> &keys )
 {
     MStatus status = MS::kSuccess;
+    std::vector<double> keyTimes, keyValues;
 
-    unsigned int index = 0;
+    if( !(status = getKeys( pAnimCurveFn, keyTimes, keyValues ))) {
+        pluginError( "CurveCleanerCommand", "readCurveKeys", "Failed to get keys" );
+    }
+    else {
+        unsigned int numKeys = (unsigned int)keyTimes.size();
+        keys.resize( numKeys );
 
-    if( !(animCurveFnACC.pAnimCurveFn->find( time, index )))
-        pluginError( "CurveCleanerCommand", 
-                     "getKeyValue", "Failed to find the key index" );   
+        for( unsigned int index = 0; index < numKeys; index++ ) {
+            CurveKey &key = keys[index];
+            MAngle angleIn, angleOut;
+            double weight;
 
-    status = animCurveFnACC.pAnimCurveFn->remove( index, animCurveFnACC.pAnimCache );
+            key.time = keyTimes[index];
+            key.value = keyValues[index];
+
+            pAnimCurveFn->getTangent( index, angleIn, weight, true );
+            pAnimCurveFn->getTangent( index, angleOut, weight, false );
+            key.inSlope = tan( angleIn.asRadians() );
+            key.outSlope = tan( angleOut.asRadians() );
+
+            key.isStepOut = (pAnimCurveFn->outTangentType( index ) == MFnAnimCurve::kTangentStep);
+        }
+    }
+
+    return status;
+}
+
+//*********************************************************
+// Name: removeReducedKeys
+// Desc: Removes the keys from the anim curve that the
+//       curve reducer didn't keep.  The tangents of the
+//       kept keys are frozen first so the curve keeps the
+//       shape the error was measured against.
+//*********************************************************
+MStatus CurveCleanerCommand::removeReducedKeys( AnimCurveFnACC animCurveFnACC,
+                                                const std::vector<bool> &keepKeys )
+{
+    MStatus status = MS::kSuccess;
+    unsigned int numKeys = (unsigned int)keepKeys.size();
+
+    for( unsigned int index = 0; index < numKeys; index++ ) {
+        if( keepKeys[index] &&
+            ((index > 0 && !keepKeys[index - 1]) || (index + 1 < numKeys && !keepKeys[index + 1])) )
+        {
+            freezeTangents( animCurveFnACC, index );
+        }
+    }
+
+    // Remove from the end so the remaining indices stay valid
+    for( unsigned int index = numKeys; index > 0; index-- ) {
+        if( keepKeys[index - 1] )
+            continue;
+
+        if( !(status = animCurveFnACC.pAnimCurveFn->remove( index - 1, animCurveFnACC.pAnimCache ))) {
+            pluginError( "CurveCleanerCommand",
+                         "removeReducedKeys", "Failed to remove key" );
+            break;
+        }
 
-    if( status )
         numKeysRemoved++;
+    }
 
     return status;
 }
 
+//*********************************************************
+// Name: freezeTangents
+// Desc: Changes the tangents of a key to fixed (keeping
+//       their current angles) unless they are already
+//       independent of the neighbouring keys
+//*********************************************************
+void CurveCleanerCommand::freezeTangents( AnimCurveFnACC animCurveFnACC, unsigned int index )
+{
+    MFnAnimCurve *pAnimCurveFn = animCurveFnACC.pAnimCurveFn;
+    MAnimCurveChange *pAnimCache = animCurveFnACC.pAnimCache;
+
+    for( unsigned int side = 0; side < 2; side++ ) {
+        bool isInTangent = (side == 0);
+        MFnAnimCurve::TangentType type = isInTangent ? pAnimCurveFn->inTangentType( index ) :
+                                                       pAnimCurveFn->outTangentType( index );
+
+        if( type == MFnAnimCurve::kTangentFixed ||
+            type == MFnAnimCurve::kTangentFlat ||
+            type == MFnAnimCurve::kTangentStep )
+            continue;
+
+        MAngle angle;
+        double weight;
+        pAnimCurveFn->getTangent( index, angle, weight, isInTangent );
+
+        bool isTangentLocked = pAnimCurveFn->tangentsLocked( index );
+        if( isTangentLocked )
+            pAnimCurveFn->setTangentsLocked( index, false, pAnimCache );
+
+        if( isInTangent )
+            pAnimCurveFn->setInTangentType( index, MFnAnimCurve::kTangentFixed, pAnimCache );
+        else
+            pAnimCurveFn->setOutTangentType( index, MFnAnimCurve::kTangentFixed, pAnimCache );
+        pAnimCurveFn->setTangent( index, angle, weight, isInTangent, pAnimCache );
+
+        if( isTangentLocked )
+            pAnimCurveFn->setTangentsLocked( index, true, pAnimCache );
+    }
+}
+
 //*********************************************************
 // Name: cleanTangentsOnSelected
 // Desc: Switches the tangents on peaks and valleys
 //       to flat, while splining the remaining keys
-//       for the anim curves on all selected objects
+//       for the anim curves on all selected objects.
+//       The keys of every curve are read first, the
+//       tangents are calculated on the thread pool and
+//       then written back to the curves.
 //*********************************************************
 MStatus CurveCleanerCommand::cleanTangentsOnSelected()
 {
     MStatus status = MS::kSuccess;
 
-    // Traverse each curve and remove redundant keys
-    if( !animCurveFnList.empty()) {
-        animCurveListIter = animCurveFnList.begin();
+    std::vector<AnimCurveFnACC> animCurves( animCurveFnList.begin(), animCurveFnList.end() );
+    unsigned int numCurves = (unsigned int)animCurves.size();
 
-        while( animCurveListIter != animCurveFnList.end() ) {
-            // Remove redundant keys from each curve
-            status = cleanTangentsOnAnimCurve( ( *animCurveListIter ) );
+    std::vector<CurveTangentData> curveData( numCurves );
+
+    // Read the keys from every curve
+    for( unsigned int i = 0; i < numCurves; i++ ) {
+        if( !(status = getKeys( animCurves[i].pAnimCurveFn, curveData[i].keyTimes, curveData[i].keyValues ))) {
+            pluginError( "CurveCleanerCommand", 
+                         "cleanTangentsOnSelected", "Failed to get keys" );
+            break;
+        }
+    }
+
+    if( status ) {
+        // Every curve is calculated independently
+        parallelFor( numCurves, [&]( unsigned int i ) {
+            calcCurveTangents( curveData[i] );
+        });
+
+        for( unsigned int i = 0; i < numCurves; i++ ) {
+            // Keys on boolean and enum attributes keep their
+            // stepped tangents
+            if( useSolver && animCurves[i].isStepped )
+                continue;
+
+            if( useSolver ) {
+                status = AnimCurveSnapshot::writeFixedTangents( *animCurves[i].pAnimCurveFn,
+                                                                curveData[i].tangentAngles,
+                                                                curveData[i].inWeights,
+                                                                curveData[i].outWeights,
+                                                                startEndTangentType == MFnAnimCurve::kTangentFlat,
+                                                                animCurves[i].pAnimCache );
+            }
+            else
+                status = cleanTangentsOnAnimCurve( animCurves[i], curveData[i] );
 
             if( !status ) {
                 pluginError( "CurveCleanerCommand", 
                              "cleanTangentsOnSelected", "Failed to clean tangents on anim curve" );
                 break;
             }
-            
-            numCurvesCleaned++;
 
-            animCurveListIter++;
+            numCurvesCleaned++;
         }
     }
 
     return status;
 }
 
+//*********************************************************
+// Name: calcCurveTangents
+// Desc: Calculates the peaks/valleys and the softened
+//       tangent angles for a curve.  Only uses the key
+//       data so it is safe to call from the thread pool.
+//       With a solver the tangents of every key are
+//       calculated by the solver instead.
+//*********************************************************
+void CurveCleanerCommand::calcCurveTangents( CurveTangentData &curveData ) const
+{
+    std::vector<double> segmentAngles;
+
+    if( useSolver ) {
+        TangentSolvers::solve( solverType, curveData.keyTimes, curveData.keyValues, weightFactor,
+                               curveData.tangentAngles, curveData.inWeights, curveData.outWeights );
+    }
+    else {
+        TangentKernels::getSegmentAngles( curveData.keyTimes, curveData.keyValues, segmentAngles );
+        TangentKernels::getPeaksAndValleys( curveData.keyValues, curveData.peakOrValley );
+        TangentKernels::getSoftenedAngles( segmentAngles, smoothingValue, curveData.tangentAngles );
+    }
+}
 
 //*********************************************************
 // Name: cleanTangentsOnAnimCurve
@@ -641,102 +1123,48 @@ MStatus CurveCleanerCommand::cleanTangentsOnSelected()
 //       to flat, while splining the remaining keys
 //       on an anim curve
 //*********************************************************
-MStatus CurveCleanerCommand::cleanTangentsOnAnimCurve( AnimCurveFnACC animCurveFnACC )
+MStatus CurveCleanerCommand::cleanTangentsOnAnimCurve( AnimCurveFnACC animCurveFnACC,
+                                                       const CurveTangentData &curveData )
 {
     MStatus status = MS::kSuccess;
 
-    MFnAnimCurve *pAnimCurveFn = animCurveFnACC.pAnimCurveFn;
+    const std::vector<double> &keyTimes = curveData.keyTimes;
+    const std::vector<unsigned char> &peakOrValley = curveData.peakOrValley;
+    unsigned int numKeys = (unsigned int)keyTimes.size();
 
-    // Get the time for each key on the anim curve
-    std::vector<MTime> keyTimes( pAnimCurveFn->numKeys() );
-    if( !(status = getKeyTimes( pAnimCurveFn, &keyTimes ) )) {
-        pluginError( "CurveCleanerCommand", 
-                     "cleanTangentsOnAnimCurve", "Failed to get key times" );
+    // First and last keys will be handed according to the tangent type flag
+    if( numKeys > 0 ) {
+        updateTangents( animCurveFnACC, keyTimes, 0, startEndTangentType, 0, false );
+    }
+    if( numKeys > 1 ) {
+        updateTangents( animCurveFnACC, keyTimes, numKeys - 1, startEndTangentType, 0, false );
     }
-    else {
-        std::vector<bool> peakOrValley( keyTimes.size(), false );
-
-        double currentValue, prevValue, nextValue, prevInequalValue, nextInequalValue;
-        MAngle angleIn, angleOut;
 
-        // First and last keys will be handed according to the tangent type flag
-        if( keyTimes.size() > 0 ) {
-            // Set the first tangent to spline
-            updateTangents( animCurveFnACC, &keyTimes, 0, startEndTangentType, 0, 0, true, false );
-            prevInequalValue = getKeyValue( pAnimCurveFn, keyTimes[0] );
+    // Start on the second key and finish on the 
+    // second last key
+    for( unsigned int i = 1; i + 1 < numKeys; i++ ) {
+        // Is the current key a valley or a peak, if so, the
+        // tangent type will be set to flat
+        if( peakOrValley[i] ) {
+            updateTangents( animCurveFnACC, keyTimes,
+                            i, 
+                            MFnAnimCurve::kTangentFlat,
+                            0, false );
         }
-        if( keyTimes.size() > 1 ) {
-            // Set the last tangent to spline
-            updateTangents( animCurveFnACC, &keyTimes, 
-                            (unsigned int)(keyTimes.size() - 1), startEndTangentType, 0, 0, true, false );
-        }
-
-        // Make a list that determines whether key is a peak or valley
-        for( unsigned int i = 1; i < (keyTimes.size() - 1); i++ ) {
-            prevValue = getKeyValue( pAnimCurveFn, keyTimes[i-1] );
-            currentValue =  getKeyValue( pAnimCurveFn, keyTimes[i] );
-            nextValue = getKeyValue( pAnimCurveFn, keyTimes[i+1] );
-
-            // Keep track of last inequal values to determine if
-            // the key is on a peak or a value
-            if( currentValue != prevValue )
-                prevInequalValue = prevValue;
-
-            if( currentValue != nextValue )
-                nextInequalValue = nextValue;
-            else {
-                // Find the next inequal value
-                for( unsigned int j = i+2; j < (keyTimes.size()); j++ ) {
-                    nextInequalValue = getKeyValue( pAnimCurveFn, keyTimes[j] );
-
-                    // exit the loop when a new inequal value is found
-                    if( nextInequalValue != currentValue )
-                        break;
-                }
-            }
-
-            if( (currentValue <= prevInequalValue && currentValue <= nextInequalValue) ||
-                (currentValue >= prevInequalValue && currentValue >= nextInequalValue) )
-            {
-                peakOrValley[i] = true;
-            }     
-        }
-
-        // Start on the second key and finish on the 
-        // second last key
-        for( unsigned int i = 1; i < (keyTimes.size() - 1); i++ ) {
-            prevValue = getKeyValue( pAnimCurveFn, keyTimes[i-1] );
-            currentValue =  getKeyValue( pAnimCurveFn, keyTimes[i] );
-            nextValue = getKeyValue( pAnimCurveFn, keyTimes[i+1] );
-            
-            angleIn = getAngle( prevValue, currentValue, keyTimes[i-1].value(), keyTimes[i].value() );
-            angleOut = getAngle( currentValue, nextValue, keyTimes[i].value(), keyTimes[i+1].value() );
-
-            // Is the current key a valley or a peak, if so, the
-            // tangent type will be set to flat
-
-            if( peakOrValley[i] ) {
-                updateTangents( animCurveFnACC, &keyTimes,
-                                i, 
-                                MFnAnimCurve::kTangentFlat,
-                                angleIn, angleOut, true, false );
-            }
-            else {
-                // Determine if the smoothing should be
-                // applied to the spline.  If not in a smooth all
-                // splines mode, only splines next to a peak or 
-                // valley will be smoothed
-                bool applySoftness = false;
-                if( smoothAllSplines || peakOrValley[i-1] || peakOrValley[i+1] )
-                    applySoftness = true;
-
-                // Set the tangent type to spline
-                updateTangents( animCurveFnACC, &keyTimes,
-                                i,
-                                MFnAnimCurve::kTangentSmooth,
-                                angleIn, angleOut, false, applySoftness );
-            }
-                
+        else {
+            // Determine if the smoothing should be
+            // applied to the spline.  If not in a smooth all
+            // splines mode, only splines next to a peak or 
+            // valley will be smoothed
+            bool applySoftness = false;
+            if( smoothAllSplines || peakOrValley[i-1] || peakOrValley[i+1] )
+                applySoftness = true;
+
+            // Set the tangent type to spline
+            updateTangents( animCurveFnACC, keyTimes,
+                            i,
+                            MFnAnimCurve::kTangentSmooth,
+                            MAngle( curveData.tangentAngles[i] ), applySoftness );
         }
     }
 
@@ -746,14 +1174,14 @@ MStatus CurveCleanerCommand::cleanTangentsOnAnimCurve( AnimCurveFnACC animCurveF
 //*********************************************************
 // Name: updateTangents
 // Desc: Modifies the current tangent type and, if 
-//       necessary, the tangent weight to avoid overshoots
+//       necessary, the tangent angle and weight to
+//       avoid overshoots
 //*********************************************************
 MStatus CurveCleanerCommand::updateTangents( AnimCurveFnACC animCurveFnACC,
-                                             std::vector<MTime> *keyTimes,
+                                             const std::vector<double> &keyTimes,
                                              unsigned int index,
                                              MFnAnimCurve::TangentType type,
-                                             MAngle angleIn, MAngle angleOut,
-                                             bool ignoreAngle,
+                                             MAngle tangentAngle,
                                              bool applySoftness )
 {
     MStatus status = MS::kSuccess;
@@ -775,57 +1203,25 @@ MStatus CurveCleanerCommand::updateTangents( AnimCurveFnACC animCurveFnACC,
         pAnimCurveFn->setWeightsLocked( index, false, pAnimCache );
     }
 
-    // The smallest angle is used to avoid overshoots
-    MAngle tangentAngle;
-    if( fabs(angleOut.asRadians()) > fabs(angleIn.asRadians()) )
-        tangentAngle = angleIn;
-    else
-        tangentAngle = angleOut;
-
-    // Adjust angle for smoothing if necessary
-    if( !ignoreAngle && applySoftness ) {
-        // Add in the smoothing value (softness)
-        double radianDiff = fabs( angleOut.asRadians() - angleIn.asRadians() );
-        double softness = radianDiff * smoothingValue;
-
-        // Add or subtract the softness depending on positive or negative slope
-        if( angleIn.asRadians() > angleOut.asRadians() ) {
-            // Positive Slope
-            if( angleIn.asRadians() > 0 || (angleIn.asRadians() == 0 && angleOut.asRadians() > 0) )
-                tangentAngle = MAngle( tangentAngle.asRadians() + softness );
-            // Negative Slope
-            else
-                tangentAngle = MAngle( tangentAngle.asRadians() - softness );
-        }
-        else {
-            // Positive Slope
-            if( angleIn.asRadians() > 0 || (angleIn.asRadians() == 0 && angleOut.asRadians() > 0) )
-                tangentAngle = MAngle( tangentAngle.asRadians() + softness );
-            // Negative Slope
-            else
-                tangentAngle = MAngle( tangentAngle.asRadians() - softness );
-            
-        }
-
+    // Use the softened angle for the tangent if necessary
+    if( applySoftness ) {
         // Set the new angle for the tangent
         pAnimCurveFn->setAngle( index, tangentAngle, true, pAnimCache );
         pAnimCurveFn->setAngle( index, tangentAngle, false, pAnimCache );
 
-        double deltaTime = 0.0, deltaValue = 0.0, newWeight; 
+        double deltaTime = 0.0, newWeight;
         
         // Update the in-tangent weight
         if( index != 0 ) {
-            deltaTime = (((*keyTimes)[index]).value() - ((*keyTimes)[index-1]).value());
-            deltaValue = pAnimCurveFn->value( index ) - pAnimCurveFn->value( index - 1 );
+            deltaTime = keyTimes[index] - keyTimes[index-1];
             newWeight =  ( deltaTime / cos( tangentAngle.asRadians() )) * weightFactor;
 
             pluginTrace( "CurveCleanerCommand", "updateTangents", MString("In Weight: " ) + newWeight );
 
             pAnimCurveFn->setWeight( index, newWeight, true, pAnimCache );
         }
-        if( index < ((unsigned int)keyTimes->size() - 1)) {
-            deltaTime = (((*keyTimes)[index+1]).value() - ((*keyTimes)[index]).value());
-            deltaValue = pAnimCurveFn->value( index+1 ) - pAnimCurveFn->value( index );
+        if( index < ((unsigned int)keyTimes.size() - 1)) {
+            deltaTime = keyTimes[index+1] - keyTimes[index];
             newWeight =  ( deltaTime / cos( tangentAngle.asRadians() )) * weightFactor;
 
             pAnimCurveFn->setWeight( index, newWeight, false, pAnimCache );
@@ -843,19 +1239,3 @@ MStatus CurveCleanerCommand::updateTangents( AnimCurveFnACC animCurveFnACC,
 
     return status;
 }
-
-//*********************************************************
-// Name: getAngle
-// Desc: Returns the angle for two points on a curve
-//*********************************************************
-MAngle CurveCleanerCommand::getAngle( double value1 , double value2,
-                                      double time1, double time2 )
-{
-    double valueDelta = value2 - value1;
-    double timeDelta = time2 - time1;
-
-    double radians = atan( valueDelta / timeDelta );
-
-    return MAngle( radians, MAngle::kRadians ); 
-
-}
\ No newline at end of file
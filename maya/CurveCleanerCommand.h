@@ -20,16 +20,21 @@
 #include <maya/MAngle.h>
 #include <maya/MPlug.h>
 #include <maya/MPlugArray.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MAnimCurveChange.h>
 
 #include <maya/MFnDependencyNode.h>
 #include <maya/MFnAnimCurve.h>
 
 #include <maya/MItSelectionList.h>
-#include <maya/MItDependencyGraph.h>
 #include <maya/MItKeyframe.h>
 
+#include "CurveReducer.h"
+#include "CurveSmoother.h"
+#include "TangentSolvers.h"
+
 #include <list>
+#include <map>
 #include <vector>
 #include <math.h>
 
@@ -56,6 +61,20 @@
 //
 //        -weightFactor (-wf)       (double)
 //
+//        -tolerance (-tol)         (double)
+//
+//        -eulerFilter (-ef)
+//
+//        -filter (-fl)             (string)
+//
+//        -filterWidth (-fw)        (double)
+//
+//        -startTime (-st)          (double)
+//
+//        -endTime (-et)            (double)
+//
+//        -solver (-sol)            (string)
+//
 //*********************************************************
 class CurveCleanerCommand : public MPxCommand
 {
@@ -65,6 +84,36 @@ private:
     struct AnimCurveFnACC {
         MFnAnimCurve* pAnimCurveFn;
         MAnimCurveChange* pAnimCache;
+
+        // The node the curve animates and the rotate axis
+        // (0-2) it drives (-1 if it isn't a rotate channel)
+        MObject node;
+        int rotateAxis;
+
+        // Indicates that the curve drives a boolean or
+        // enum attribute
+        bool isStepped;
+    };
+
+    // The rotate X/Y/Z curves of a node (indices into the
+    // list of curves, -1 when the axis has no curve)
+    struct EulerCurveGroup {
+        MObject node;
+        int curveIndices[3];
+        unsigned int middleAxis;
+    };
+
+    // The keys of a curve and the tangents calculated
+    // for them by the tangent kernels
+    struct CurveTangentData {
+        std::vector<double> keyTimes;
+        std::vector<double> keyValues;
+        std::vector<double> tangentAngles;
+        std::vector<unsigned char> peakOrValley;
+
+        // The weights calculated by the tangent solvers
+        std::vector<double> inWeights;
+        std::vector<double> outWeights;
     };
 
     // Command flag constants
@@ -74,6 +123,13 @@ private:
     static const char *smoothnessFlag, *smoothnessLongFlag;
     static const char *weightFactorFlag, *weightFactorLongFlag;
     static const char *smoothAllSplinesFlag, *smoothAllSplinesLongFlag;
+    static const char *toleranceFlag, *toleranceLongFlag;
+    static const char *eulerFilterFlag, *eulerFilterLongFlag;
+    static const char *filterFlag, *filterLongFlag;
+    static const char *filterWidthFlag, *filterWidthLongFlag;
+    static const char *startTimeFlag, *startTimeLongFlag;
+    static const char *endTimeFlag, *endTimeLongFlag;
+    static const char *solverFlag, *solverLongFlag;
 
     // Indicates that tangents should be updated
     // Flatten peaks and valleys and spline w/o overshoot
@@ -99,6 +155,59 @@ private:
     // are not locked
     double weightFactor;
 
+    // Indicates that the tangents should be calculated by
+    // one of the tangent solvers instead of being splined
+    bool useSolver;
+
+    // The solver used to calculate the tangents
+    TangentSolvers::SolverType solverType;
+
+    // Indicates that flips should be removed from the
+    // rotation curves before any other cleaning
+    bool eulerFilter;
+
+    // The number of keys changed by the euler filter
+    unsigned int numEulerKeysChanged;
+
+    // Indicates that the noise should be filtered out of
+    // the key values
+    bool smoothCurves;
+
+    // The filter used to smooth the key values
+    CurveSmoother::FilterType filterType;
+
+    // The width of the filter in frames, which defaults to
+    // a width for the filter type
+    bool useFilterWidth;
+    double filterWidth;
+
+    // The frame range of the keys to smooth
+    bool useStartTime;
+    double startTime;
+    bool useEndTime;
+    double endTime;
+
+    // The number of curves smoothed
+    unsigned int numCurvesSmoothed;
+
+    // The number of curves that couldn't be smoothed
+    // because their keys aren't evenly spaced
+    unsigned int numCurvesNotUniform;
+
+    // The number of curves that couldn't be smoothed
+    // because the filter is too narrow for their key spacing
+    unsigned int numCurvesTooNarrow;
+
+    // Indicates that keys should be removed as long as the
+    // curve stays within the tolerance of the original
+    bool useTolerance;
+
+    // The largest change in value allowed when removing keys
+    double tolerance;
+
+    // The largest change in value of all the reduced curves
+    double maxReductionError;
+
     // The number of redundant keys removed
     unsigned int numKeysRemoved;
 
@@ -128,17 +237,35 @@ private:
     // selected objects
     MStatus getAnimCurveFnList();
 
-    // Generates a list of anim curves from an array of plugs
-    MStatus getAnimCurveFnListFromPlugs( MPlugArray plugArray );
 
-    // Finds all of the times of keys on a given anim curve
-    MStatus getKeyTimes( MFnAnimCurve *pAnimCurveFn, std::vector<MTime> *keyTimes );
+    // Reads the times and values of all the keys
+    // on a given anim curve
+    MStatus getKeys( MFnAnimCurve *pAnimCurveFn,
+                     std::vector<double> &keyTimes,
+                     std::vector<double> &keyValues );
+
+    // Returns the rotate axis (0-2) driven by the plug
+    // or -1 if it isn't a rotate channel
+    int getRotateAxis( const MPlug &plug );
 
-    // Returns the value of a key at a given time
-    double getKeyValue( MFnAnimCurve *pAnimCurveFn, MTime time );
+    // Removes the flips from the rotation curves of
+    // the selected objects
+    MStatus eulerFilterSelected();
 
-    // Removes a key at the given time
-    MStatus removeKey( AnimCurveFnACC animCurveFnACC, MTime time );
+    // Filters the rotation values of a node's curves
+    // (safe to call from the thread pool)
+    static void filterEulerGroup( const EulerCurveGroup &group,
+                                  const std::vector< std::vector<double> > &curveTimes,
+                                  std::vector< std::vector<double> > &curveValues );
+
+    // Filters the noise out of the key values on the
+    // selected objects' animation curves
+    MStatus smoothSelected();
+
+    // Finds the keys within the smoothing frame range
+    bool getSmoothingRange( const std::vector<double> &keyTimes,
+                            unsigned int &firstKey,
+                            unsigned int &lastKey ) const;
 
     // Removes the keys from the selected objects'
     // animation curves that don't affect the curve shape
@@ -148,29 +275,46 @@ private:
     // don't affect the shape
     MStatus removeRedundantKeysFromAnimCurve( AnimCurveFnACC animCurveFnACC );
 
+    // Removes the keys from the selected objects'
+    // animation curves that are within the tolerance
+    MStatus reduceKeysFromSelected();
+
+    // Reads the keys of an anim curve for the curve reducer
+    MStatus readCurveKeys( MFnAnimCurve *pAnimCurveFn, std::vector<CurveKey> &keys );
+
+    // Removes the keys from the anim curve that the
+    // curve reducer didn't keep
+    MStatus removeReducedKeys( AnimCurveFnACC animCurveFnACC,
+                               const std::vector<bool> &keepKeys );
+
+    // Changes the tangents of a key to fixed so they aren't
+    // recalculated when the neighbouring keys are removed
+    void freezeTangents( AnimCurveFnACC animCurveFnACC, unsigned int index );
+
     // Switches the tangents on peaks and valleys
     // to flat, while splining the remaining keys
     // for the anim curves on all selected objects
     MStatus cleanTangentsOnSelected();
 
+    // Calculates the tangents for a curve's keys
+    // (safe to call from the thread pool)
+    void calcCurveTangents( CurveTangentData &curveData ) const;
+
     // Switches the tangents on peaks and valleys
     // to flat, while splining the remaining keys
     // on an anim curve
-    MStatus cleanTangentsOnAnimCurve( AnimCurveFnACC animCurveFnACC );
+    MStatus cleanTangentsOnAnimCurve( AnimCurveFnACC animCurveFnACC,
+                                      const CurveTangentData &curveData );
 
     // Modifies the current tangent type and, if necessary,
-    // the tangent weight to avoid overshoots
+    // the tangent angle and weight to avoid overshoots
     MStatus updateTangents( AnimCurveFnACC animCurveFnACC,
-                            std::vector<MTime> *keyTimes,
+                            const std::vector<double> &keyTimes,
                             unsigned int index,
                             MFnAnimCurve::TangentType type,
-                            MAngle angleIn, MAngle angleOut,
-                            bool ignoreAngle,
+                            MAngle tangentAngle,
                             bool applySoftness );
 
-    // Returns the slope for two points on a curve
-    MAngle getAngle( double value1, double value2, double time1, double time2 );
-
 public:
     // Constructor/Destructor
     CurveCleanerCommand();
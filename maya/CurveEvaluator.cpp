@@ -0,0 +1,69 @@
+//*********************************************************
+// CurveEvaluator.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "CurveEvaluator.h"
+//*********************************************************
+
+//*********************************************************
+// Name: evaluateSegment
+// Desc: Returns the value of the segment between two keys
+//       at the given time using the Hermite basis
+//       functions
+//*********************************************************
+double CurveEvaluator::evaluateSegment( const CurveKey &startKey,
+                                        const CurveKey &endKey,
+                                        double time )
+{
+    double length = endKey.time - startKey.time;
+
+    if( startKey.isStepOut || length <= 0.0 )
+        return (time < endKey.time) ? startKey.value : endKey.value;
+
+    double s = (time - startKey.time) / length;
+    double s2 = s * s;
+    double s3 = s2 * s;
+
+    double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+    double h10 = s3 - 2.0 * s2 + s;
+    double h01 = -2.0 * s3 + 3.0 * s2;
+    double h11 = s3 - s2;
+
+    return h00 * startKey.value +
+           h10 * length * startKey.outSlope +
+           h01 * endKey.value +
+           h11 * length * endKey.inSlope;
+}
+
+
+//*********************************************************
+// Name: evaluate
+// Desc: Returns the value of the curve at the given time.
+//       Times outside of the keys hold the end values.
+//*********************************************************
+double CurveEvaluator::evaluate( const std::vector<CurveKey> &keys, double time )
+{
+    if( keys.empty() )
+        return 0.0;
+    if( time <= keys.front().time )
+        return keys.front().value;
+    if( time >= keys.back().time )
+        return keys.back().value;
+
+    // Find the first key after the time
+    unsigned int low = 0, high = (unsigned int)keys.size() - 1;
+    while( high - low > 1 ) {
+        unsigned int middle = (low + high) / 2;
+        if( keys[middle].time <= time )
+            low = middle;
+        else
+            high = middle;
+    }
+
+    return evaluateSegment( keys[low], keys[high], time );
+}
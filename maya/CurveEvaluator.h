@@ -0,0 +1,56 @@
+//*********************************************************
+// CurveEvaluator.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __CURVE_EVALUATOR_H_
+#define __CURVE_EVALUATOR_H_
+
+//*********************************************************
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Struct: CurveKey
+//
+// Desc:  A key read from an anim curve.  Times are in
+//        frames, values are in UI units and the slopes are
+//        the change in value per frame.
+//*********************************************************
+struct CurveKey
+{
+    double time;
+    double value;
+    double inSlope;
+    double outSlope;
+
+    // The curve holds the key's value until the next key
+    bool isStepOut;
+};
+
+//*********************************************************
+// Class: CurveEvaluator
+//
+// Desc:  Evaluates the segments of a non-weighted anim
+//        curve as cubic Hermite splines.  The evaluator
+//        only works on plain key data so it can be used
+//        away from the main thread.
+//*********************************************************
+class CurveEvaluator
+{
+public:
+    // Returns the value of the segment between two keys at
+    // the given time
+    static double evaluateSegment( const CurveKey &startKey,
+                                   const CurveKey &endKey,
+                                   double time );
+
+    // Returns the value of the curve at the given time.
+    // Times outside of the keys hold the end values.
+    static double evaluate( const std::vector<CurveKey> &keys, double time );
+};
+
+#endif
@@ -0,0 +1,112 @@
+//*********************************************************
+// CurveReducer.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "CurveReducer.h"
+
+#include <math.h>
+//*********************************************************
+
+//*********************************************************
+// Name: getSpanError
+// Desc: Returns the largest error between the original
+//       curve and a single segment from the start key to
+//       the end key.  worstIndex is set to the key inside
+//       the span closest to the largest error.
+//*********************************************************
+double CurveReducer::getSpanError( const std::vector<CurveKey> &keys,
+                                   unsigned int startIndex,
+                                   unsigned int endIndex,
+                                   unsigned int &worstIndex )
+{
+    const CurveKey &startKey = keys[startIndex];
+    const CurveKey &endKey = keys[endIndex];
+    double maxError = 0.0;
+
+    worstIndex = startIndex + 1;
+
+    for( unsigned int i = startIndex; i < endIndex; i++ ) {
+        // The key itself (the start key is always exact)
+        if( i > startIndex ) {
+            double error = fabs( CurveEvaluator::evaluateSegment( startKey, endKey, keys[i].time ) -
+                                 keys[i].value );
+            if( error > maxError ) {
+                maxError = error;
+                worstIndex = i;
+            }
+        }
+
+        // The middle of the original segment
+        double middleTime = (keys[i].time + keys[i + 1].time) * 0.5;
+        double original = CurveEvaluator::evaluateSegment( keys[i], keys[i + 1], middleTime );
+        double error = fabs( CurveEvaluator::evaluateSegment( startKey, endKey, middleTime ) - original );
+        if( error > maxError ) {
+            maxError = error;
+
+            // Split on whichever key of the segment is inside the span
+            worstIndex = (i > startIndex) ? i : i + 1;
+        }
+    }
+
+    return maxError;
+}
+
+
+//*********************************************************
+// Name: reduce
+// Desc: Flags the keys to keep in keepKeys and returns the
+//       largest error of the reduced curve.  The first and
+//       last keys are always kept.
+//*********************************************************
+double CurveReducer::reduce( const std::vector<CurveKey> &keys,
+                             double tolerance,
+                             std::vector<bool> &keepKeys )
+{
+    unsigned int numKeys = (unsigned int)keys.size();
+    double maxError = 0.0;
+
+    keepKeys.assign( numKeys, true );
+    if( numKeys < 3 )
+        return maxError;
+
+    for( unsigned int i = 1; i < numKeys - 1; i++ )
+        keepKeys[i] = false;
+
+    // Spans still to be checked
+    std::vector<unsigned int> spanStack;
+    spanStack.push_back( 0 );
+    spanStack.push_back( numKeys - 1 );
+
+    while( !spanStack.empty() ) {
+        unsigned int endIndex = spanStack.back();
+        spanStack.pop_back();
+        unsigned int startIndex = spanStack.back();
+        spanStack.pop_back();
+
+        if( endIndex - startIndex < 2 )
+            continue;
+
+        unsigned int worstIndex;
+        double error = getSpanError( keys, startIndex, endIndex, worstIndex );
+
+        if( error > tolerance ) {
+            // Keep the worst key and check both halves
+            keepKeys[worstIndex] = true;
+
+            spanStack.push_back( startIndex );
+            spanStack.push_back( worstIndex );
+            spanStack.push_back( worstIndex );
+            spanStack.push_back( endIndex );
+        }
+        else if( error > maxError ) {
+            maxError = error;
+        }
+    }
+
+    return maxError;
+}
@@ -0,0 +1,50 @@
+//*********************************************************
+// CurveReducer.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __CURVE_REDUCER_H_
+#define __CURVE_REDUCER_H_
+
+//*********************************************************
+#include "CurveEvaluator.h"
+
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: CurveReducer
+//
+// Desc:  Finds the keys of a curve that can be removed
+//        while keeping the curve within an error tolerance.
+//        The curve is split at the key with the largest
+//        error (Douglas-Peucker) until every span between
+//        the kept keys is within the tolerance.
+//
+//        The error is measured at the removed keys and at
+//        the middle of each of the original segments.  The
+//        kept keys must keep their tangents for the error
+//        to hold.
+//*********************************************************
+class CurveReducer
+{
+private:
+    // Returns the largest error of the span between two
+    // keys and the index of the key where it occurs
+    static double getSpanError( const std::vector<CurveKey> &keys,
+                                unsigned int startIndex,
+                                unsigned int endIndex,
+                                unsigned int &worstIndex );
+
+public:
+    // Flags the keys to keep in keepKeys and returns the
+    // largest error of the reduced curve
+    static double reduce( const std::vector<CurveKey> &keys,
+                          double tolerance,
+                          std::vector<bool> &keepKeys );
+};
+
+#endif
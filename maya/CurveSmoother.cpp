@@ -0,0 +1,307 @@
+//*********************************************************
+// CurveSmoother.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "CurveSmoother.h"
+
+#include <algorithm>
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CURVE_SMOOTHER_SSE2
+#include <emmintrin.h>
+#endif
+//*********************************************************
+
+//*********************************************************
+// Constants
+//*********************************************************
+static const double pi = 3.14159265358979323846;
+
+// Keys closer than this fraction of the spacing to their
+// evenly spaced time are considered uniform
+static const double uniformTolerance = 1.0e-3;
+
+// Narrower filters than these don't change the values: a
+// gaussian barely reaches the neighbouring keys and the
+// Butterworth keeps every period of 2 samples or more
+static const double minGaussianSigma = 0.1;
+static const double minButterworthPeriod = 2.0;
+
+
+//*********************************************************
+// Name: isUniform
+// Desc: Returns true if the keys from first to last are
+//       evenly spaced in time
+//*********************************************************
+bool CurveSmoother::isUniform( const std::vector<double> &keyTimes,
+                               unsigned int first,
+                               unsigned int last )
+{
+    if( last <= first || last >= keyTimes.size() )
+        return false;
+
+    double spacing = (keyTimes[last] - keyTimes[first]) / (last - first);
+    if( spacing <= 0.0 )
+        return false;
+
+    for( unsigned int i = first + 1; i <= last; i++ ) {
+        if( fabs( keyTimes[i] - keyTimes[i - 1] - spacing ) > spacing * uniformTolerance )
+            return false;
+    }
+
+    return true;
+}
+
+
+//*********************************************************
+// Name: isEffective
+// Desc: Returns true if the filter is wide enough to change
+//       values at the given width in samples
+//*********************************************************
+bool CurveSmoother::isEffective( FilterType type, double width )
+{
+    switch( type ) {
+        case kGaussian:
+            return width >= minGaussianSigma;
+        case kSavitzkyGolay:
+            return floor( width + 0.5 ) >= 1.0;
+        case kButterworth:
+            return width > minButterworthPeriod;
+    }
+
+    return false;
+}
+
+
+//*********************************************************
+// Name: smooth
+// Desc: Smooths the values with the given filter.  Curves
+//       with fewer than 3 values are left alone.  The first
+//       and last values are kept.
+//*********************************************************
+void CurveSmoother::smooth( FilterType type, double width, std::vector<double> &values )
+{
+    std::vector<double> weights;
+
+    if( values.size() < 3 )
+        return;
+
+    double firstValue = values.front();
+    double lastValue = values.back();
+
+    switch( type ) {
+        case kGaussian:
+            getGaussianWeights( width, weights );
+            convolve( weights, values );
+            break;
+        case kSavitzkyGolay:
+            getSavitzkyGolayWeights( (unsigned int)floor( width + 0.5 ), weights );
+            convolve( weights, values );
+            break;
+        case kButterworth:
+            butterworth( width, values );
+            break;
+    }
+
+    pinEnds( firstValue, lastValue, values );
+}
+
+
+//*********************************************************
+// Name: getGaussianWeights
+// Desc: Calculates the normalized gaussian weights for a
+//       window of 3 standard deviations either side.  A
+//       sigma too small to affect the neighbouring keys
+//       gives no weights.
+//*********************************************************
+void CurveSmoother::getGaussianWeights( double sigma, std::vector<double> &weights )
+{
+    weights.clear();
+    if( sigma < minGaussianSigma )
+        return;
+
+    int halfWidth = (int)ceil( 3.0 * sigma );
+    double totalWeight = 0.0;
+
+    weights.resize( 2 * halfWidth + 1 );
+    for( int k = -halfWidth; k <= halfWidth; k++ ) {
+        weights[k + halfWidth] = exp( -(k * k) / (2.0 * sigma * sigma) );
+        totalWeight += weights[k + halfWidth];
+    }
+
+    for( unsigned int k = 0; k < weights.size(); k++ )
+        weights[k] /= totalWeight;
+}
+
+
+//*********************************************************
+// Name: getSavitzkyGolayWeights
+// Desc: Calculates the weights of a least squares
+//       quadratic fit over the window, evaluated at its
+//       centre.  Unlike a gaussian this keeps the height
+//       of peaks that are wider than the window.
+//*********************************************************
+void CurveSmoother::getSavitzkyGolayWeights( unsigned int halfWidth, std::vector<double> &weights )
+{
+    weights.clear();
+    if( halfWidth < 1 )
+        return;
+
+    double m = (double)halfWidth;
+    double norm = (2.0 * m - 1.0) * (2.0 * m + 1.0) * (2.0 * m + 3.0);
+
+    weights.resize( 2 * halfWidth + 1 );
+    for( int k = -(int)halfWidth; k <= (int)halfWidth; k++ )
+        weights[k + halfWidth] = (3.0 * (3.0 * m * m + 3.0 * m - 1.0) - 15.0 * k * k) / norm;
+}
+
+
+//*********************************************************
+// Name: getPaddedValues
+// Desc: Copies the values with padding keys on either
+//       side, reflected about the first and last values
+//       (2 * v[0] - v[k]).  Padding longer than the curve
+//       repeats the furthest reflected value.
+//*********************************************************
+void CurveSmoother::getPaddedValues( const std::vector<double> &values,
+                                     unsigned int padding,
+                                     std::vector<double> &paddedValues )
+{
+    unsigned int numValues = (unsigned int)values.size();
+    double firstValue = values[0];
+    double lastValue = values[numValues - 1];
+
+    paddedValues.resize( numValues + 2 * padding );
+    std::copy( values.begin(), values.end(), paddedValues.begin() + padding );
+
+    for( unsigned int k = 1; k <= padding; k++ ) {
+        unsigned int reflected = std::min( k, numValues - 1 );
+        paddedValues[padding - k] = 2.0 * firstValue - values[reflected];
+        paddedValues[padding + numValues - 1 + k] = 2.0 * lastValue - values[numValues - 1 - reflected];
+    }
+}
+
+
+//*********************************************************
+// Name: convolve
+// Desc: Replaces each value with the weighted sum of the
+//       window centred on it.  Two values are calculated
+//       at a time, sliding the window across the padded
+//       values.
+//*********************************************************
+void CurveSmoother::convolve( const std::vector<double> &weights, std::vector<double> &values )
+{
+    if( weights.empty() )
+        return;
+
+    unsigned int numValues = (unsigned int)values.size();
+    unsigned int numWeights = (unsigned int)weights.size();
+    std::vector<double> paddedValues;
+
+    getPaddedValues( values, numWeights / 2, paddedValues );
+
+    const double *window = &paddedValues[0];
+    const double *w = &weights[0];
+    double *result = &values[0];
+    unsigned int i = 0;
+
+#ifdef CURVE_SMOOTHER_SSE2
+    for( ; i + 2 <= numValues; i += 2 ) {
+        __m128d sum = _mm_setzero_pd();
+        for( unsigned int k = 0; k < numWeights; k++ )
+            sum = _mm_add_pd( sum, _mm_mul_pd( _mm_set1_pd( w[k] ), _mm_loadu_pd( window + i + k )));
+        _mm_storeu_pd( result + i, sum );
+    }
+#endif
+    for( ; i < numValues; i++ ) {
+        double sum = 0.0;
+        for( unsigned int k = 0; k < numWeights; k++ )
+            sum += w[k] * window[i + k];
+        result[i] = sum;
+    }
+}
+
+
+//*********************************************************
+// Name: butterworth
+// Desc: Runs a second order Butterworth low-pass forwards
+//       and then backwards over the values, which cancels
+//       the phase shift of a single pass.  Each value
+//       depends on the last, so this isn't vectorized.
+//       Periods of 2 samples or less are all kept.
+//*********************************************************
+void CurveSmoother::butterworth( double cutoffPeriod, std::vector<double> &values )
+{
+    if( cutoffPeriod <= minButterworthPeriod )
+        return;
+
+    unsigned int numValues = (unsigned int)values.size();
+    std::vector<double> paddedValues;
+
+    // The filter needs a few periods to settle
+    unsigned int padding = std::min( numValues - 1,
+                                     std::max( 9u, (unsigned int)ceil( 3.0 * cutoffPeriod )));
+    getPaddedValues( values, padding, paddedValues );
+
+    // Bilinear transform of the analog filter
+    double K = tan( pi / cutoffPeriod );
+    double norm = 1.0 / (1.0 + sqrt( 2.0 ) * K + K * K);
+    double b0 = K * K * norm;
+    double b1 = 2.0 * b0;
+    double b2 = b0;
+    double a1 = 2.0 * (K * K - 1.0) * norm;
+    double a2 = (1.0 - sqrt( 2.0 ) * K + K * K) * norm;
+
+    for( unsigned int pass = 0; pass < 2; pass++ ) {
+        // Start as if the first value had always been held
+        double x1 = paddedValues[0], x2 = paddedValues[0];
+        double y1 = paddedValues[0], y2 = paddedValues[0];
+
+        for( unsigned int i = 0; i < paddedValues.size(); i++ ) {
+            double x0 = paddedValues[i];
+            double y0 = b0 * x0 + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            paddedValues[i] = y0;
+        }
+
+        std::reverse( paddedValues.begin(), paddedValues.end() );
+    }
+
+    std::copy( paddedValues.begin() + padding, paddedValues.begin() + padding + numValues, values.begin() );
+}
+
+//*********************************************************
+// Name: pinEnds
+// Desc: Restores the first and last values.  The change at
+//       each end is faded out linearly towards the other
+//       end rather than only moving the end keys, which
+//       would leave a step next to them.
+//*********************************************************
+void CurveSmoother::pinEnds( double firstValue, double lastValue, std::vector<double> &values )
+{
+    unsigned int numValues = (unsigned int)values.size();
+    double firstOffset = firstValue - values[0];
+    double lastOffset = lastValue - values[numValues - 1];
+
+    if( firstOffset == 0.0 && lastOffset == 0.0 )
+        return;
+
+    for( unsigned int i = 0; i < numValues; i++ ) {
+        double t = (double)i / (numValues - 1);
+        values[i] += firstOffset * (1.0 - t) + lastOffset * t;
+    }
+
+    // Exact, whatever the rounding above
+    values[0] = firstValue;
+    values[numValues - 1] = lastValue;
+}
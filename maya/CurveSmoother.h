@@ -0,0 +1,86 @@
+//*********************************************************
+// CurveSmoother.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __CURVE_SMOOTHER_H_
+#define __CURVE_SMOOTHER_H_
+
+//*********************************************************
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: CurveSmoother
+//
+// Desc:  Low-pass filters for removing the noise from
+//        uniformly spaced key values (mocap, simulation
+//        bakes).  Widths are given in samples (keys).  The
+//        ends are extended by reflecting the values about
+//        the first and last keys so the curve keeps its
+//        direction at the edges.  The filters only come
+//        close to the end values (the Butterworth, and any
+//        filter wider than a short curve), so the change
+//        at the first and last keys is blended out across
+//        the curve, which keeps them and stops a step where
+//        a smoothed range meets the rest of the curve.
+//        Uses SSE2 for the sliding window filters when the
+//        compiler supports it.
+//*********************************************************
+class CurveSmoother
+{
+public:
+    enum FilterType {
+        kGaussian,
+        kSavitzkyGolay,
+        kButterworth
+    };
+
+private:
+    // Calculates the normalized gaussian weights for a
+    // window of 3 standard deviations either side
+    static void getGaussianWeights( double sigma, std::vector<double> &weights );
+
+    // Calculates the quadratic Savitzky-Golay smoothing
+    // weights for a window of halfWidth keys either side
+    static void getSavitzkyGolayWeights( unsigned int halfWidth, std::vector<double> &weights );
+
+    // Copies the values with padding keys reflected about
+    // the first and last values
+    static void getPaddedValues( const std::vector<double> &values,
+                                 unsigned int padding,
+                                 std::vector<double> &paddedValues );
+
+    // Replaces each value with the weighted sum of the
+    // window centred on it
+    static void convolve( const std::vector<double> &weights, std::vector<double> &values );
+
+    // Runs a second order Butterworth low-pass forwards and
+    // backwards over the values (zero phase)
+    static void butterworth( double cutoffPeriod, std::vector<double> &values );
+
+    // Restores the first and last values, spreading the
+    // correction linearly across the values between
+    static void pinEnds( double firstValue, double lastValue, std::vector<double> &values );
+
+public:
+    // Returns true if the keys from first to last are
+    // evenly spaced in time
+    static bool isUniform( const std::vector<double> &keyTimes,
+                           unsigned int first,
+                           unsigned int last );
+
+    // Returns true if the filter is wide enough to change
+    // values at the given width in samples
+    static bool isEffective( FilterType type, double width );
+
+    // Smooths the values.  width is the standard deviation
+    // (gaussian), the half window (Savitzky-Golay) or the
+    // shortest period kept (Butterworth) in samples.
+    static void smooth( FilterType type, double width, std::vector<double> &values );
+};
+
+#endif
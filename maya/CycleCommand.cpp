@@ -0,0 +1,327 @@
+//*********************************************************
+// CycleCommand.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "CycleCommand.h"
+#include "ErrorReporting.h"
+//*********************************************************
+
+//*********************************************************
+// Constants
+//*********************************************************
+const char *CycleCommand::offsetFlag = "-os";
+const char *CycleCommand::offsetLongFlag = "-offset";
+const char *CycleCommand::matchTangentsFlag = "-mt";
+const char *CycleCommand::matchTangentsLongFlag = "-matchTangents";
+const char *CycleCommand::lengthFlag = "-l";
+const char *CycleCommand::lengthLongFlag = "-length";
+
+
+//*********************************************************
+// Name: CycleCommand
+// Desc: Constructor
+//*********************************************************
+CycleCommand::CycleCommand()
+{
+    pluginTrace( "CycleCommand", "CycleCommand", "******* Cycle Command *******" );
+
+    initialized = false;
+
+    // Initialize the command flag defaults
+    offsetCycle = false;
+    matchTangents = true;
+    cycleLength = 0.0;
+}
+
+
+//*********************************************************
+// Name: ~CycleCommand
+// Desc: Destructor
+//*********************************************************
+CycleCommand::~CycleCommand()
+{
+    // Cleanup all memory allocated for this command
+    for( unsigned int i = 0; i < animCurveFnList.size(); i++ ) {
+        delete animCurveFnList[i].pAnimCurveFn;
+        delete animCurveFnList[i].pAnimCache;
+    }
+}
+
+
+//*********************************************************
+// Name: doIt
+// Desc: All of the one-time setup and initialization
+//       code for the cycle command.  doIt is called
+//       by Maya when any command is executed in MEL.
+//       Any code that changes the state of Maya is
+//       handled by the redoIt method.
+//*********************************************************
+MStatus CycleCommand::doIt( const MArgList &args )
+{
+    MStatus status = MS::kFailure;
+    AnimCurveCollector collector;
+    std::vector<AnimCurveInfo> animCurves;
+
+    if( !parseCommandFlags( args )) {
+        pluginError( "CycleCommand", "doIt", "Failed to parse command flags" );
+    }
+    else if( !AnimCurveCollector::getSelectedObjects( selectionList )) {
+        MGlobal::displayError( "No Objects Selected" );
+    }
+    else if( !collector.getAnimCurves( selectionList, animCurves )) {
+        pluginError( "CycleCommand", "doIt", "Failed to get the anim curves" );
+    }
+    else if( animCurves.empty() ) {
+        MGlobal::displayError( "No Keys Set" );
+    }
+    else if( !calcCycles( animCurves )) {
+        pluginError( "CycleCommand", "doIt", "Failed to read the anim curves" );
+    }
+    else if( !(status = redoIt() )) {
+        pluginError( "CycleCommand", "doIt", "Failed to redoIt" );
+    }
+    else {
+        MString result( "Result: " );
+        MGlobal::displayInfo( result + (unsigned int)animCurveFnList.size() );
+
+        setResult( (int)animCurveFnList.size() );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: redoIt
+// Desc: Contains the code that changes the internal state
+//       of Maya.  It is called by Maya to redo.
+//*********************************************************
+MStatus CycleCommand::redoIt()
+{
+    MStatus status = MS::kSuccess;
+
+    if( !initialized ) {
+        status = makeCycles();
+        initialized = true;
+    }
+    else {
+        // Just use the anim curve cache to redo
+        for( unsigned int i = 0; i < animCurveFnList.size(); i++ )
+            animCurveFnList[i].pAnimCache->redoIt();
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: undoIt
+// Desc: Contains the code to undo the internal state
+//       changes made by the cycle command (redoIt).
+//       It is called by Maya to undo.
+//*********************************************************
+MStatus CycleCommand::undoIt()
+{
+    MStatus status = MS::kSuccess;
+
+    for( unsigned int i = 0; i < animCurveFnList.size(); i++ )
+        animCurveFnList[i].pAnimCache->undoIt();
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: newSyntax
+// Desc: Method for registering the command flags
+//       with Maya
+//*********************************************************
+MSyntax CycleCommand::newSyntax()
+{
+    MSyntax syntax;
+    syntax.addFlag( offsetFlag, offsetLongFlag, MSyntax::kBoolean );
+    syntax.addFlag( matchTangentsFlag, matchTangentsLongFlag, MSyntax::kBoolean );
+    syntax.addFlag( lengthFlag, lengthLongFlag, MSyntax::kDouble );
+
+    return syntax;
+}
+
+
+//*********************************************************
+// Name: parseCommandFlags
+// Desc: Parse the command flags and stores the values
+//       in the appropriate variables
+//*********************************************************
+MStatus CycleCommand::parseCommandFlags( const MArgList &args )
+{
+    MStatus status = MS::kSuccess;
+
+    MArgDatabase argData( syntax(), args, &status );
+    if( !status ) {
+        pluginError( "CycleCommand", "parseCommandFlags",
+                     "Failed to create MArgDatabase for the cycle command" );
+    }
+    else {
+        if( argData.isFlagSet( offsetFlag ))
+            argData.getFlagArgument( offsetFlag, 0, offsetCycle );
+        if( argData.isFlagSet( matchTangentsFlag ))
+            argData.getFlagArgument( matchTangentsFlag, 0, matchTangents );
+        if( argData.isFlagSet( lengthFlag )) {
+            argData.getFlagArgument( lengthFlag, 0, cycleLength );
+
+            // 0 is only the default (keep the current length)
+            if( cycleLength <= 0.0 ) {
+                MGlobal::displayError( "The cycle length must be greater than 0" );
+                status = MS::kFailure;
+            }
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: calcCycles
+// Desc: Reads every curve into a snapshot and calculates
+//       the retimed key times (when a length is given)
+//       before any curve is changed
+//*********************************************************
+MStatus CycleCommand::calcCycles( const std::vector<AnimCurveInfo> &animCurves )
+{
+    MStatus status = MS::kSuccess;
+    AnimCurveSnapshot snapshot;
+    AnimCurveFnACC animCurveFnACC;
+
+    animCurveFnList.reserve( animCurves.size() );
+
+    for( unsigned int i = 0; i < animCurves.size(); i++ ) {
+        MFnAnimCurve *animCurveFn = new MFnAnimCurve( animCurves[i].animCurve, &status );
+        if( !status || !(status = snapshot.capture( *animCurveFn ))) {
+            pluginError( "CycleCommand", "calcCycles", "Can't read the anim curve" );
+            delete animCurveFn;
+            break;
+        }
+
+        // A cycle needs at least two keys
+        unsigned int numKeys = snapshot.numKeys();
+        if( numKeys < 2 ) {
+            delete animCurveFn;
+            continue;
+        }
+
+        animCurveFnACC.pAnimCurveFn = animCurveFn;
+        animCurveFnACC.pAnimCache = new MAnimCurveChange();
+        animCurveFnACC.firstValue = snapshot.keyValues[0];
+        animCurveFnACC.isOffsetCycle = offsetCycle &&
+            (animCurveFn->animCurveType() == MFnAnimCurve::kAnimCurveTL);
+        animCurveFnACC.origKeyTimes = snapshot.keyTimes;
+        animCurveFnACC.newKeyTimes.clear();
+
+        // Scale the key times about the first key
+        if( cycleLength > 0.0 ) {
+            double firstTime = snapshot.keyTimes[0];
+            double scale = cycleLength / (snapshot.keyTimes[numKeys - 1] - firstTime);
+
+            animCurveFnACC.newKeyTimes.resize( numKeys );
+            for( unsigned int index = 0; index < numKeys; index++ )
+                animCurveFnACC.newKeyTimes[index] = firstTime + (snapshot.keyTimes[index] - firstTime) * scale;
+        }
+
+        animCurveFnList.push_back( animCurveFnACC );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: makeCycles
+// Desc: Writes the cycle to every curve.  Offset cycles
+//       keep their end value so the curve continues on
+//       from the end of each cycle.
+//*********************************************************
+MStatus CycleCommand::makeCycles()
+{
+    MStatus status = MS::kSuccess;
+
+    for( unsigned int i = 0; i < animCurveFnList.size() && status; i++ ) {
+        AnimCurveFnACC &animCurveACC = animCurveFnList[i];
+        MFnAnimCurve *animCurve = animCurveACC.pAnimCurveFn;
+        unsigned int lastIndex = animCurve->numKeys() - 1;
+
+        if( !animCurveACC.newKeyTimes.empty() ) {
+            if( !(status = AnimCurveSnapshot::writeKeyTimes( *animCurve,
+                                                             animCurveACC.origKeyTimes,
+                                                             animCurveACC.newKeyTimes,
+                                                             animCurveACC.pAnimCache ))) {
+                pluginError( "CycleCommand", "makeCycles", "Failed to retime the cycle" );
+                break;
+            }
+        }
+
+        if( !animCurveACC.isOffsetCycle )
+            animCurve->setValue( lastIndex, animCurveACC.firstValue, animCurveACC.pAnimCache );
+
+        if( matchTangents )
+            matchEndTangents( animCurveACC );
+
+        MFnAnimCurve::InfinityType infinityType = animCurveACC.isOffsetCycle ?
+            MFnAnimCurve::kCycleRelative : MFnAnimCurve::kCycle;
+
+        animCurve->setPreInfinityType( infinityType, animCurveACC.pAnimCache );
+        animCurve->setPostInfinityType( infinityType, animCurveACC.pAnimCache );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: matchEndTangents
+// Desc: Gives the first and last keys the same tangent
+//       (the average of the first key's out tangent and
+//       the last key's in tangent) so the curve has no
+//       kink where the cycle repeats
+//*********************************************************
+MStatus CycleCommand::matchEndTangents( AnimCurveFnACC &animCurveACC )
+{
+    MStatus status = MS::kSuccess;
+    MFnAnimCurve *animCurve = animCurveACC.pAnimCurveFn;
+    MAnimCurveChange *pAnimCache = animCurveACC.pAnimCache;
+    unsigned int lastIndex = animCurve->numKeys() - 1;
+
+    MAngle firstAngle, lastAngle;
+    double firstWeight, lastWeight;
+
+    animCurve->getTangent( 0, firstAngle, firstWeight, false );
+    animCurve->getTangent( lastIndex, lastAngle, lastWeight, true );
+
+    MAngle angle( (firstAngle.asRadians() + lastAngle.asRadians()) * 0.5 );
+
+    unsigned int keyIndices[2] = { 0, lastIndex };
+
+    for( unsigned int i = 0; i < 2; i++ ) {
+        unsigned int index = keyIndices[i];
+        double weight = (index == 0) ? firstWeight : lastWeight;
+
+        bool isTangentLocked = animCurve->tangentsLocked( index );
+        if( isTangentLocked )
+            animCurve->setTangentsLocked( index, false, pAnimCache );
+
+        animCurve->setInTangentType( index, MFnAnimCurve::kTangentFixed, pAnimCache );
+        animCurve->setOutTangentType( index, MFnAnimCurve::kTangentFixed, pAnimCache );
+        animCurve->setTangent( index, angle, weight, true, pAnimCache );
+        animCurve->setTangent( index, angle, weight, false, pAnimCache );
+
+        if( isTangentLocked )
+            animCurve->setTangentsLocked( index, true, pAnimCache );
+    }
+
+    return status;
+}
@@ -0,0 +1,126 @@
+//*********************************************************
+// CycleCommand.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __CYCLE_COMMAND_H_
+#define __CYCLE_COMMAND_H_
+
+//*********************************************************
+#include <maya/MPxCommand.h>
+
+#include <maya/MGlobal.h>
+#include <maya/MTime.h>
+#include <maya/MAngle.h>
+#include <maya/MSyntax.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MSelectionList.h>
+#include <maya/MString.h>
+#include <maya/MAnimCurveChange.h>
+
+#include <maya/MFnAnimCurve.h>
+
+#include "AnimCurveCollector.h"
+#include "AnimCurveSnapshot.h"
+
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: CycleCommand
+//
+// Desc: Makes the anim curves of the selected objects loop
+//       seamlessly.  The last key is matched to the first
+//       key's value and both keys are given the same
+//       tangent before the curve is set to cycle.
+//
+// Command: cieCycle
+//
+// Flags: -offset (-os)          (boolean) translation curves
+//                                cycle with offset
+//
+//        -matchTangents (-mt)   (boolean)
+//
+//        -length (-l)           (double) frames
+//
+//*********************************************************
+class CycleCommand : public MPxCommand
+{
+private:
+    // Storage for the anim curve function set and its
+    // curve change cache (for undo/redo)
+    struct AnimCurveFnACC {
+        MFnAnimCurve* pAnimCurveFn;
+        MAnimCurveChange* pAnimCache;
+        bool isOffsetCycle;
+        std::vector<double> origKeyTimes;
+        std::vector<double> newKeyTimes;
+        double firstValue;
+    };
+
+    // Command flag constants
+    static const char *offsetFlag, *offsetLongFlag;
+    static const char *matchTangentsFlag, *matchTangentsLongFlag;
+    static const char *lengthFlag, *lengthLongFlag;
+
+    // Translation curves keep their end values and cycle
+    // with an offset
+    bool offsetCycle;
+
+    // Give the first and last keys the same tangent
+    bool matchTangents;
+
+    // The length of the cycle in frames (0 keeps the
+    // current length)
+    double cycleLength;
+
+    // The objects currently selected in the Maya scene
+    MSelectionList selectionList;
+
+    // Indicates that the anim curve caches have been
+    // calculated for undo/redo
+    bool initialized;
+
+    // The curves to cycle
+    std::vector<AnimCurveFnACC> animCurveFnList;
+
+    // Method to setup the command flags
+    MStatus parseCommandFlags( const MArgList &args );
+
+    // Reads the curves and calculates their new key times
+    MStatus calcCycles( const std::vector<AnimCurveInfo> &animCurves );
+
+    // Writes the cycle to every curve
+    MStatus makeCycles();
+
+    // Matches the tangents of the first and last keys
+    MStatus matchEndTangents( AnimCurveFnACC &animCurveACC );
+
+public:
+    // Constructor/Destructor
+    CycleCommand();
+    ~CycleCommand();
+
+    // Performs the command
+    virtual MStatus doIt( const MArgList &args );
+
+    // Performs the work that changes Maya's internal state
+    virtual MStatus redoIt();
+
+    // Undoes the changes to Maya's internal state
+    virtual MStatus undoIt();
+
+    // Indicates that Maya can undo/redo this command
+    virtual bool isUndoable() const { return true; }
+
+    // Allocates a command object to Maya (required)
+    static void *creator() { return new CycleCommand; }
+
+    // Defines the set of flags allowed by this command
+    static MSyntax newSyntax();
+};
+
+#endif
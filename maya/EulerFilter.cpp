@@ -0,0 +1,93 @@
+//*********************************************************
+// EulerFilter.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "EulerFilter.h"
+
+#include <math.h>
+//*********************************************************
+
+//*********************************************************
+// Name: closestAngle
+// Desc: Returns the angle plus the number of whole turns
+//       that brings it closest to the reference angle
+//*********************************************************
+double EulerFilter::closestAngle( double angle, double reference )
+{
+    return angle + 360.0 * floor( (reference - angle) / 360.0 + 0.5 );
+}
+
+
+//*********************************************************
+// Name: unwrap
+// Desc: Unwraps the values so each one is within 180
+//       degrees of the one before it
+//*********************************************************
+void EulerFilter::unwrap( std::vector<double> &values )
+{
+    for( unsigned int i = 1; i < values.size(); i++ )
+        values[i] = closestAngle( values[i], values[i - 1] );
+}
+
+
+//*********************************************************
+// Name: filter
+// Desc: Picks the closest equivalent rotation for every
+//       sample.  A rotation (a, b, c) with b as the middle
+//       axis is the same as (a + 180, 180 - b, c + 180),
+//       so both are unwrapped against the previous sample
+//       and the one that moves the least is kept.
+//*********************************************************
+void EulerFilter::filter( std::vector<double> &xValues,
+                          std::vector<double> &yValues,
+                          std::vector<double> &zValues,
+                          unsigned int middleAxis )
+{
+    unsigned int numSamples = (unsigned int)xValues.size();
+    if( numSamples < 2 )
+        return;
+
+    double *axes[3] = { &xValues[0], &yValues[0], &zValues[0] };
+
+    for( unsigned int i = 1; i < numSamples; i++ ) {
+        double original[3], alternate[3];
+        double originalDistance = 0.0, alternateDistance = 0.0;
+
+        for( unsigned int axis = 0; axis < 3; axis++ ) {
+            double previous = axes[axis][i - 1];
+            double value = axes[axis][i];
+            double flipped = (axis == middleAxis) ? 180.0 - value : value + 180.0;
+
+            original[axis] = closestAngle( value, previous );
+            alternate[axis] = closestAngle( flipped, previous );
+
+            originalDistance += fabs( original[axis] - previous );
+            alternateDistance += fabs( alternate[axis] - previous );
+        }
+
+        const double *closest = (alternateDistance < originalDistance) ? alternate : original;
+        for( unsigned int axis = 0; axis < 3; axis++ )
+            axes[axis][i] = closest[axis];
+    }
+}
+
+
+//*********************************************************
+// Name: getMiddleAxis
+// Desc: Returns the middle axis for a Maya rotate order
+//*********************************************************
+unsigned int EulerFilter::getMiddleAxis( int rotateOrder )
+{
+    // xyz, yzx, zxy, xzy, yxz, zyx
+    static const unsigned int middleAxes[6] = { 1, 2, 0, 2, 0, 1 };
+
+    if( rotateOrder < 0 || rotateOrder > 5 )
+        return 1;
+
+    return middleAxes[rotateOrder];
+}
@@ -0,0 +1,50 @@
+//*********************************************************
+// EulerFilter.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __EULER_FILTER_H_
+#define __EULER_FILTER_H_
+
+//*********************************************************
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: EulerFilter
+//
+// Desc:  Removes the flips from rotation values (in
+//        degrees).  A single channel can only be unwrapped
+//        by whole turns, while a full set of X/Y/Z values
+//        can also be switched to the equivalent rotation
+//        that is closest to the previous sample.
+//*********************************************************
+class EulerFilter
+{
+private:
+    // Returns the angle plus the number of whole turns
+    // that brings it closest to the reference angle
+    static double closestAngle( double angle, double reference );
+
+public:
+    // Unwraps the values so each one is within 180 degrees
+    // of the one before it
+    static void unwrap( std::vector<double> &values );
+
+    // Picks the closest equivalent rotation for every
+    // sample of the X/Y/Z values.  middleAxis is the axis
+    // (0-2) in the middle of the rotation order.
+    static void filter( std::vector<double> &xValues,
+                        std::vector<double> &yValues,
+                        std::vector<double> &zValues,
+                        unsigned int middleAxis );
+
+    // Returns the middle axis for a Maya rotate order
+    // (0 = xyz, 1 = yzx, 2 = zxy, 3 = xzy, 4 = yxz, 5 = zyx)
+    static unsigned int getMiddleAxis( int rotateOrder );
+};
+
+#endif
@@ -0,0 +1,276 @@
+//*********************************************************
+// FrameCounterFormat.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "FrameCounterFormat.h"
+
+#include <math.h>
+#include <stdlib.h>
+//*********************************************************
+
+//*********************************************************
+// Name: FrameCounterFormat
+// Desc: Constructor
+//*********************************************************
+FrameCounterFormat::FrameCounterFormat()
+{
+    format = kFrames;
+    numDigits = 4;
+    framesPerFoot = 16;
+    showSign = false;
+}
+
+
+//*********************************************************
+// Name: fitRange
+// Desc: Sets the number of digits and the sign so every
+//       frame in the range fits
+//*********************************************************
+void FrameCounterFormat::fitRange( const MTime &start, const MTime &end, unsigned int minDigits )
+{
+    long long startFrame = getFrame( start );
+    long long endFrame = getFrame( end );
+
+    long long largest = llabs( startFrame ) > llabs( endFrame ) ? llabs( startFrame ) : llabs( endFrame );
+
+    if( format == kFeetFrames && framesPerFoot > 0 )
+        largest /= framesPerFoot;
+
+    numDigits = countDigits( largest );
+    if( numDigits < minDigits )
+        numDigits = minDigits;
+
+    showSign = (startFrame < 0 || endFrame < 0);
+}
+
+
+//*********************************************************
+// Name: getSlots
+// Desc: The slots from left to right
+//*********************************************************
+std::string FrameCounterFormat::getSlots() const
+{
+    std::string slots;
+
+    if( showSign )
+        slots += '-';
+
+    if( format == kTimecode ) {
+        slots += "##:##:##:";
+        slots.append( getNumFrameDigits(), '#' );
+    }
+    else if( format == kFeetFrames ) {
+        slots.append( numDigits, '#' );
+        slots += '+';
+        slots.append( getNumFrameDigits(), '#' );
+    }
+    else
+        slots.append( numDigits, '#' );
+
+    return slots;
+}
+
+
+//*********************************************************
+// Name: getNumDigitSlots
+// Desc: The number of digit slots
+//*********************************************************
+unsigned int FrameCounterFormat::getNumDigitSlots() const
+{
+    unsigned int numSlots = numDigits;
+
+    if( format == kTimecode )
+        numSlots = 6 + getNumFrameDigits();
+    else if( format == kFeetFrames )
+        numSlots = numDigits + getNumFrameDigits();
+
+    return numSlots;
+}
+
+
+//*********************************************************
+// Name: getDigits
+// Desc: Gets the digit of every digit slot, starting with
+//       the rightmost slot
+//*********************************************************
+void FrameCounterFormat::getDigits( const MTime &time, std::vector<int> &digits, bool &negative ) const
+{
+    long long frame = getFrame( time );
+
+    negative = (frame < 0);
+    if( negative )
+        frame = -frame;
+
+    digits.clear();
+    digits.reserve( getNumDigitSlots() );
+
+    if( format == kTimecode ) {
+        bool dropFrame = false;
+        long long frameRate = getFrameRate( dropFrame );
+
+        // Drop frame skips frame numbers 0 and 1 at the start
+        // of every minute, except every 10th minute
+        if( dropFrame ) {
+            long long framesPer10Mins = frameRate * 600 - 18;
+            long long framesPerMin = frameRate * 60 - 2;
+            long long tenMins = frame / framesPer10Mins;
+            long long remainder = frame % framesPer10Mins;
+
+            frame += 18 * tenMins;
+            if( remainder > 1 )
+                frame += 2 * ((remainder - 2) / framesPerMin);
+        }
+
+        appendDigits( frame % frameRate, getNumFrameDigits(), digits );
+        appendDigits( (frame / frameRate) % 60, 2, digits );
+        appendDigits( (frame / (frameRate * 60)) % 60, 2, digits );
+        appendDigits( (frame / (frameRate * 3600)) % 24, 2, digits );
+    }
+    else if( format == kFeetFrames ) {
+        long long perFoot = framesPerFoot > 0 ? framesPerFoot : 16;
+
+        appendDigits( frame % perFoot, getNumFrameDigits(), digits );
+        appendDigits( frame / perFoot, numDigits, digits );
+    }
+    else
+        appendDigits( frame, numDigits, digits );
+}
+
+
+//*********************************************************
+// Name: getText
+// Desc: Fills the digit slots from the left, the digits
+//       are stored from the right
+//*********************************************************
+std::string FrameCounterFormat::getText( const MTime &time ) const
+{
+    std::vector<int> digits;
+    bool negative = false;
+    getDigits( time, digits, negative );
+
+    std::string slots = getSlots();
+    std::string text;
+    size_t digitSlot = digits.size();
+
+    if( negative )
+        text += '-';
+
+    for( size_t i = 0; i < slots.size(); i++ ) {
+        if( slots[i] == '#' ) {
+            if( digitSlot > 0 )
+                text += (char)('0' + digits[--digitSlot]);
+        }
+        else if( slots[i] != '-' )
+            text += slots[i];
+    }
+
+    return text;
+}
+
+
+//*********************************************************
+// Name: getFormat
+// Desc: Converts a format name
+//*********************************************************
+MStatus FrameCounterFormat::getFormat( const MString &name, Format &format )
+{
+    MStatus status = MS::kSuccess;
+
+    if( name == "frames" )
+        format = kFrames;
+    else if( name == "timecode" )
+        format = kTimecode;
+    else if( name == "feetFrames" )
+        format = kFeetFrames;
+    else
+        status = MS::kInvalidParameter;
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: getFrame
+// Desc: Sub-frames show the frame they're in
+//*********************************************************
+long long FrameCounterFormat::getFrame( const MTime &time )
+{
+    return (long long)floor( time.as( MTime::uiUnit() ) + 1.0e-6 );
+}
+
+
+//*********************************************************
+// Name: getFrameRate
+// Desc: The frames in a second of the UI unit, rounded to
+//       the nominal rate used by timecode
+//*********************************************************
+long long FrameCounterFormat::getFrameRate( bool &dropFrame )
+{
+    MTime::Unit unit = MTime::uiUnit();
+    MTime second( 1.0, MTime::kSeconds );
+
+    long long frameRate = (long long)floor( second.as( unit ) + 0.5 );
+    if( frameRate < 1 )
+        frameRate = 1;
+
+    dropFrame = (unit == MTime::k29_97DF);
+
+    return frameRate;
+}
+
+
+//*********************************************************
+// Name: getNumFrameDigits
+// Desc: Enough digits for the last frame of a second or a
+//       foot, at least 2
+//*********************************************************
+unsigned int FrameCounterFormat::getNumFrameDigits() const
+{
+    long long lastFrame = framesPerFoot > 0 ? framesPerFoot - 1 : 15;
+
+    if( format == kTimecode ) {
+        bool dropFrame = false;
+        lastFrame = getFrameRate( dropFrame ) - 1;
+    }
+
+    unsigned int numFrameDigits = countDigits( lastFrame );
+
+    return numFrameDigits < 2 ? 2 : numFrameDigits;
+}
+
+
+//*********************************************************
+// Name: countDigits
+// Desc: Number of decimal digits in a positive value, 0
+//       has 1 digit
+//*********************************************************
+unsigned int FrameCounterFormat::countDigits( long long value )
+{
+    unsigned int numDigits = 1;
+
+    while( value >= 10 ) {
+        value /= 10;
+        numDigits++;
+    }
+
+    return numDigits;
+}
+
+
+//*********************************************************
+// Name: appendDigits
+// Desc: Adds the lowest numSlots digits of the value,
+//       least significant first
+//*********************************************************
+void FrameCounterFormat::appendDigits( long long value, unsigned int numSlots, std::vector<int> &digits )
+{
+    for( unsigned int i = 0; i < numSlots; i++ ) {
+        digits.push_back( (int)(value % 10) );
+        value /= 10;
+    }
+}
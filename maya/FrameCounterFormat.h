@@ -0,0 +1,112 @@
+//*********************************************************
+// FrameCounterFormat.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __FRAME_COUNTER_FORMAT_H_
+#define __FRAME_COUNTER_FORMAT_H_
+
+//*********************************************************
+#include <maya/MStatus.h>
+#include <maya/MString.h>
+#include <maya/MTime.h>
+
+#include <string>
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: FrameCounterFormat
+//
+// Desc: Splits a time into the digits shown by the shot
+//       mask frame counter.  The time is converted to a
+//       whole frame once, everything after that is integer
+//       arithmetic.
+//
+//       The counter is a row of slots.  Digit slots show
+//       0-9, the other slots are a fixed separator or the
+//       sign.  Digit slots are numbered from the right, so
+//       slot 0 is always the least significant digit.
+//
+//       frames      -####        frame number
+//       timecode    -##:##:##:## SMPTE hours, minutes,
+//                                seconds and frames
+//       feetFrames  -####+##     35mm feet and frames
+//
+//       Timecode uses the rounded frame rate of the time
+//       unit (24 for 23.976) and drop frame counting for
+//       29.97 DF.
+//*********************************************************
+class FrameCounterFormat
+{
+public:
+    enum Format {
+        kFrames,
+        kTimecode,
+        kFeetFrames
+    };
+
+    // How the time is shown
+    Format format;
+
+    // Digits for the frame number (frames) or the number
+    // of feet (feetFrames).  Timecode always has 2 digits
+    // for the hours.
+    unsigned int numDigits;
+
+    // Frames in a foot of film (16 for 4-perf 35mm)
+    unsigned int framesPerFoot;
+
+    // Adds a sign slot in front of the counter
+    bool showSign;
+
+    // Constructor
+    FrameCounterFormat();
+
+    // Sets the number of digits and the sign so every frame
+    // in the range fits.  Never uses fewer digits than
+    // minDigits.
+    void fitRange( const MTime &start, const MTime &end, unsigned int minDigits );
+
+    // The slots from left to right, '#' is a digit, '-'
+    // the sign and anything else is a separator
+    std::string getSlots() const;
+
+    // The number of digit slots
+    unsigned int getNumDigitSlots() const;
+
+    // Gets the digit of every digit slot, index 0 is the
+    // rightmost slot.  Values too large for the slots
+    // only show their lowest digits.
+    void getDigits( const MTime &time, std::vector<int> &digits, bool &negative ) const;
+
+    // The counter as text, e.g. 01:02:03:04 for timecode.
+    // Negative times start with a '-' even without a sign
+    // slot.
+    std::string getText( const MTime &time ) const;
+
+    // Converts a format name (frames, timecode, feetFrames)
+    static MStatus getFormat( const MString &name, Format &format );
+
+    // The whole frame containing the time in the UI unit
+    static long long getFrame( const MTime &time );
+
+    // The nominal frame rate of the UI unit and whether
+    // it uses drop frame timecode
+    static long long getFrameRate( bool &dropFrame );
+
+private:
+    // Digits in the frames field of timecode/feetFrames
+    unsigned int getNumFrameDigits() const;
+
+    // Number of decimal digits in a positive value
+    static unsigned int countDigits( long long value );
+
+    // Adds numSlots digits of value to the digit array
+    static void appendDigits( long long value, unsigned int numSlots, std::vector<int> &digits );
+};
+
+#endif
@@ -0,0 +1,427 @@
+//*********************************************************
+// GlyphCache.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "GlyphCache.h"
+#include "ErrorReporting.h"
+
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+//*********************************************************
+
+//*********************************************************
+// Constants
+//*********************************************************
+std::map<std::string, GlyphCache::Glyph> GlyphCache::glyphs;
+bool GlyphCache::modified = false;
+
+// Identifies a glyph cache file and its layout
+static const char glyphFileTag[4] = { 'A', 'T', 'B', 'G' };
+static const uint32_t glyphFileVersion = 1;
+
+// Limits on the counts read from a glyph cache file, far
+// more than any tessellated character needs.  Anything
+// larger is a corrupt file.
+static const uint32_t maxGlyphKeyLength = 1024;
+static const uint32_t maxGlyphPoints = 1 << 16;
+static const uint32_t maxGlyphPolygons = 1 << 16;
+static const uint32_t maxGlyphConnects = 1 << 18;
+
+
+//*********************************************************
+// Name: createMeshData
+// Desc: Creates mesh data from the glyph that can be set
+//       on the inMesh of a mesh node
+//*********************************************************
+MObject GlyphCache::Glyph::createMeshData( MStatus *status ) const
+{
+    MFnMeshData meshDataFn;
+    MObject meshData = meshDataFn.create( status );
+
+    if( *status ) {
+        MFnMesh meshFn;
+        meshFn.create( points.length(), polygonCounts.length(), points,
+                       polygonCounts, polygonConnects, meshData, status );
+    }
+
+    return meshData;
+}
+
+
+//*********************************************************
+// Name: getGlyph
+// Desc: Returns the glyph for the character, tessellating
+//       it the first time.  Characters without geometry
+//       (spaces) are half as wide as an 'n'.
+//*********************************************************
+const GlyphCache::Glyph *GlyphCache::getGlyph( const MString &font, char character, MStatus *status )
+{
+    MStatus stat = MS::kSuccess;
+    const Glyph *pGlyph = NULL;
+    std::string key = getKey( font, character );
+
+    std::map<std::string, Glyph>::const_iterator cached = glyphs.find( key );
+    if( cached != glyphs.end() ) {
+        pGlyph = &cached->second;
+    }
+    else {
+        Glyph glyph;
+
+        if( !(stat = tessellate( font, character, glyph ))) {
+            pluginError( "GlyphCache", "getGlyph", "Failed to tessellate a glyph" );
+        }
+        else {
+            if( glyph.isEmpty() ) {
+                const Glyph *pSpacing = (character != 'n') ? getGlyph( font, 'n', &stat ) : NULL;
+                glyph.advance = (pSpacing != NULL) ? pSpacing->advance * 0.5 : 0.0;
+            }
+
+            pGlyph = &(glyphs[key] = glyph);
+            modified = true;
+        }
+    }
+
+    if( status != NULL )
+        *status = stat;
+
+    return pGlyph;
+}
+
+
+//*********************************************************
+// Name: load
+// Desc: Adds the glyphs in the file that aren't cached
+//       yet.  A missing file isn't an error, the cache is
+//       simply empty.  The file isn't trusted: counts over
+//       the limits stop the load and glyphs with bad
+//       polygons are skipped.  Either way the cache is
+//       flagged as modified, so the missing glyphs are
+//       tessellated again and the file is overwritten.
+//*********************************************************
+MStatus GlyphCache::load( const MString &fileName )
+{
+    MStatus status = MS::kSuccess;
+
+    std::ifstream file( fileName.asChar(), std::ios::in | std::ios::binary );
+    if( !file.is_open() )
+        return status;
+
+    char tag[4] = { 0, 0, 0, 0 };
+    uint32_t version = 0, numGlyphs = 0;
+
+    file.read( tag, sizeof( tag ));
+    file.read( (char *)&version, sizeof( version ));
+    file.read( (char *)&numGlyphs, sizeof( numGlyphs ));
+
+    if( !file || std::string( tag, 4 ) != std::string( glyphFileTag, 4 ) || version != glyphFileVersion ) {
+        pluginTrace( "GlyphCache", "load", "Ignoring an unknown glyph cache file" );
+        return status;
+    }
+
+    // Set when the rest of the file can't be read, the
+    // glyphs after a bad count are lost
+    bool corrupt = false;
+    unsigned int numBadGlyphs = 0;
+
+    for( uint32_t i = 0; i < numGlyphs && !corrupt; i++ ) {
+        Glyph glyph;
+        uint32_t keyLength = 0, numPoints = 0, numCounts = 0, numConnects = 0;
+
+        file.read( (char *)&keyLength, sizeof( keyLength ));
+        if( !file || keyLength > maxGlyphKeyLength ) {
+            corrupt = true;
+            break;
+        }
+
+        std::string key( keyLength, '\0' );
+        if( keyLength > 0 )
+            file.read( &key[0], keyLength );
+
+        file.read( (char *)&glyph.advance, sizeof( glyph.advance ));
+
+        file.read( (char *)&numPoints, sizeof( numPoints ));
+        if( !file || numPoints > maxGlyphPoints ) {
+            corrupt = true;
+            break;
+        }
+
+        std::vector<float> coords( (size_t)numPoints * 3 );
+        if( numPoints > 0 )
+            file.read( (char *)&coords[0], coords.size() * sizeof( float ));
+
+        file.read( (char *)&numCounts, sizeof( numCounts ));
+        if( !file || numCounts > maxGlyphPolygons ) {
+            corrupt = true;
+            break;
+        }
+
+        std::vector<int32_t> counts( numCounts );
+        if( numCounts > 0 )
+            file.read( (char *)&counts[0], counts.size() * sizeof( int32_t ));
+
+        file.read( (char *)&numConnects, sizeof( numConnects ));
+        if( !file || numConnects > maxGlyphConnects ) {
+            corrupt = true;
+            break;
+        }
+
+        std::vector<int32_t> connects( numConnects );
+        if( numConnects > 0 )
+            file.read( (char *)&connects[0], connects.size() * sizeof( int32_t ));
+
+        if( !file ) {
+            corrupt = true;
+            break;
+        }
+
+        // The mesh would be created from bad indices
+        if( !isValidMesh( numPoints, counts, connects )) {
+            numBadGlyphs++;
+            continue;
+        }
+
+        // Glyphs tessellated this session take priority
+        if( glyphs.find( key ) != glyphs.end() )
+            continue;
+
+        for( uint32_t p = 0; p < numPoints; p++ )
+            glyph.points.append( coords[p * 3], coords[p * 3 + 1], coords[p * 3 + 2] );
+        for( uint32_t c = 0; c < numCounts; c++ )
+            glyph.polygonCounts.append( counts[c] );
+        for( uint32_t c = 0; c < numConnects; c++ )
+            glyph.polygonConnects.append( connects[c] );
+
+        double advance = glyph.advance;
+        setMetrics( glyph );
+        glyph.advance = advance;
+
+        glyphs[key] = glyph;
+    }
+
+    // The missing glyphs are tessellated again and the
+    // file is overwritten on the next save
+    if( corrupt || numBadGlyphs > 0 ) {
+        pluginWarning( "GlyphCache", "load", "The glyph cache file is corrupt and will be rebuilt: " + fileName );
+        modified = true;
+    }
+
+    if( corrupt )
+        status = MS::kFailure;
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: isValidMesh
+// Desc: Every polygon needs at least 3 vertices, the
+//       counts have to add up to the number of connects
+//       and every connect has to be a point index
+//*********************************************************
+bool GlyphCache::isValidMesh( uint32_t numPoints, const std::vector<int32_t> &counts,
+                              const std::vector<int32_t> &connects )
+{
+    uint64_t numCountConnects = 0;
+
+    for( size_t c = 0; c < counts.size(); c++ ) {
+        if( counts[c] < 3 )
+            return false;
+        numCountConnects += (uint64_t)counts[c];
+    }
+
+    if( numCountConnects != connects.size() )
+        return false;
+
+    for( size_t c = 0; c < connects.size(); c++ ) {
+        if( connects[c] < 0 || (uint32_t)connects[c] >= numPoints )
+            return false;
+    }
+
+    return true;
+}
+
+
+//*********************************************************
+// Name: save
+// Desc: Writes every cached glyph to the file
+//*********************************************************
+MStatus GlyphCache::save( const MString &fileName )
+{
+    MStatus status = MS::kSuccess;
+
+    std::ofstream file( fileName.asChar(), std::ios::out | std::ios::binary | std::ios::trunc );
+    if( !file.is_open() ) {
+        pluginError( "GlyphCache", "save", "Can't open the glyph cache file " + fileName );
+        return MS::kFailure;
+    }
+
+    uint32_t numGlyphs = (uint32_t)glyphs.size();
+
+    file.write( glyphFileTag, sizeof( glyphFileTag ));
+    file.write( (const char *)&glyphFileVersion, sizeof( glyphFileVersion ));
+    file.write( (const char *)&numGlyphs, sizeof( numGlyphs ));
+
+    std::map<std::string, Glyph>::const_iterator cached;
+    for( cached = glyphs.begin(); cached != glyphs.end(); cached++ ) {
+        const Glyph &glyph = cached->second;
+
+        uint32_t keyLength = (uint32_t)cached->first.size();
+        file.write( (const char *)&keyLength, sizeof( keyLength ));
+        file.write( cached->first.data(), keyLength );
+
+        file.write( (const char *)&glyph.advance, sizeof( glyph.advance ));
+
+        uint32_t numPoints = glyph.points.length();
+        file.write( (const char *)&numPoints, sizeof( numPoints ));
+        for( uint32_t p = 0; p < numPoints; p++ ) {
+            float coords[3] = { glyph.points[p].x, glyph.points[p].y, glyph.points[p].z };
+            file.write( (const char *)coords, sizeof( coords ));
+        }
+
+        uint32_t numCounts = glyph.polygonCounts.length();
+        file.write( (const char *)&numCounts, sizeof( numCounts ));
+        for( uint32_t c = 0; c < numCounts; c++ ) {
+            int32_t count = glyph.polygonCounts[c];
+            file.write( (const char *)&count, sizeof( count ));
+        }
+
+        uint32_t numConnects = glyph.polygonConnects.length();
+        file.write( (const char *)&numConnects, sizeof( numConnects ));
+        for( uint32_t c = 0; c < numConnects; c++ ) {
+            int32_t connect = glyph.polygonConnects[c];
+            file.write( (const char *)&connect, sizeof( connect ));
+        }
+    }
+
+    if( !file ) {
+        pluginError( "GlyphCache", "save", "Failed to write the glyph cache file " + fileName );
+        status = MS::kFailure;
+    }
+    else
+        modified = false;
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: clear
+// Desc: Removes every glyph from the cache
+//*********************************************************
+void GlyphCache::clear()
+{
+    glyphs.clear();
+    modified = false;
+}
+
+
+//*********************************************************
+// Name: getKey
+// Desc: The font name and character separated by a
+//       character that can't be in a font name
+//*********************************************************
+std::string GlyphCache::getKey( const MString &font, char character )
+{
+    std::string key( font.asChar() );
+    key += '\n';
+    key += character;
+
+    return key;
+}
+
+
+//*********************************************************
+// Name: tessellate
+// Desc: Creates the character with textCurves, converts
+//       its curves to polygons with planarSrf and copies
+//       the mesh.  The temporary nodes are deleted and
+//       nothing goes on the undo queue.
+//*********************************************************
+MStatus GlyphCache::tessellate( const MString &font, char character, Glyph &glyph )
+{
+    MStatus status = MS::kSuccess;
+
+    MString nullStr( "" );
+    MString text;
+    MStringArray curves, letters, surface;
+
+    // Quotes and backslashes need to be escaped for MEL
+    if( character == '"' || character == '\\' )
+        text = "\\";
+    text += MString( &character, 1 );
+
+    if( !(status = MGlobal::executeCommand( nullStr + "textCurves -ch 0 -f \"" + font + "\" -t \"" + text + "\"",
+                                            curves, false, false )) || curves.length() == 0 ) {
+        pluginError( "GlyphCache", "tessellate", "textCurves failed" );
+        status = MS::kFailure;
+    }
+    else {
+        MGlobal::executeCommand( "listRelatives -c " + curves[0], letters, false, false );
+
+        // Spaces have no letters
+        if( letters.length() > 0 ) {
+            MSelectionList surfaceList;
+            MDagPath meshPath;
+
+            if( !(status = MGlobal::executeCommand( nullStr + "planarSrf -ch 0 -tol 0.01 -o on -po 1 " + letters[0],
+                                                    surface, false, false )) || surface.length() == 0 ) {
+                pluginError( "GlyphCache", "tessellate", "planarSrf failed" );
+                status = MS::kFailure;
+            }
+            else if( !(status = surfaceList.add( surface[0] )) ||
+                     !(status = surfaceList.getDagPath( 0, meshPath )) ||
+                     !(status = meshPath.extendToShape() )) {
+                pluginError( "GlyphCache", "tessellate", "Can't find the glyph mesh" );
+            }
+            else {
+                MFnMesh meshFn( meshPath, &status );
+                if( !status ) {
+                    pluginError( "GlyphCache", "tessellate", "Can't get Mesh function set" );
+                }
+                else if( !(status = meshFn.getPoints( glyph.points, MSpace::kWorld )) ||
+                         !(status = meshFn.getVertices( glyph.polygonCounts, glyph.polygonConnects ))) {
+                    pluginError( "GlyphCache", "tessellate", "Failed to copy the glyph mesh" );
+                }
+            }
+
+            if( surface.length() > 0 )
+                MGlobal::executeCommand( "delete " + surface[0], false, false );
+        }
+
+        MGlobal::executeCommand( "delete " + curves[0], false, false );
+    }
+
+    if( status )
+        setMetrics( glyph );
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: setMetrics
+// Desc: The first character of textCurves starts at the
+//       origin, so the left bearing is the minimum x.  The
+//       right bearing is assumed to be the same.
+//*********************************************************
+void GlyphCache::setMetrics( Glyph &glyph )
+{
+    glyph.bounds = MBoundingBox();
+    glyph.advance = 0.0;
+
+    if( glyph.points.length() > 0 ) {
+        MPoint first( glyph.points[0] );
+        glyph.bounds = MBoundingBox( first, first );
+
+        for( unsigned int i = 1; i < glyph.points.length(); i++ )
+            glyph.bounds.expand( MPoint( glyph.points[i] ));
+
+        glyph.advance = glyph.bounds.max().x + glyph.bounds.min().x;
+    }
+}
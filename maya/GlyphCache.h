@@ -0,0 +1,110 @@
+//*********************************************************
+// GlyphCache.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __GLYPH_CACHE_H_
+#define __GLYPH_CACHE_H_
+
+//*********************************************************
+#include <maya/MGlobal.h>
+#include <maya/MStatus.h>
+#include <maya/MString.h>
+#include <maya/MStringArray.h>
+#include <maya/MSelectionList.h>
+#include <maya/MDagPath.h>
+#include <maya/MPoint.h>
+#include <maya/MFloatPoint.h>
+#include <maya/MFloatPointArray.h>
+#include <maya/MIntArray.h>
+#include <maya/MBoundingBox.h>
+#include <maya/MObject.h>
+
+#include <maya/MFnMesh.h>
+#include <maya/MFnMeshData.h>
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+//*********************************************************
+
+//*********************************************************
+// Class: GlyphCache
+//
+// Desc: The polygon mesh of each (font, character) pair
+//       used by the shot mask.  A glyph is tessellated from
+//       textCurves/planarSrf the first time it's needed and
+//       kept for the rest of the session, so rebuilding a
+//       mask only creates meshes from the cached arrays.
+//       The cache can also be saved to and loaded from a
+//       file so the glyphs survive between sessions.
+//
+//       Glyph points are relative to the pen position.  The
+//       advance is estimated from the ink bounds with the
+//       same bearing on both sides.
+//*********************************************************
+class GlyphCache
+{
+public:
+    struct Glyph {
+        MFloatPointArray points;
+        MIntArray polygonCounts;
+        MIntArray polygonConnects;
+
+        // Bounds of the points, empty for a space
+        MBoundingBox bounds;
+
+        // Distance to move the pen to the next character
+        double advance;
+
+        // Indicates the glyph has no geometry (a space)
+        bool isEmpty() const { return polygonCounts.length() == 0; }
+
+        // Creates mesh data from the glyph for a mesh's inMesh
+        MObject createMeshData( MStatus *status ) const;
+    };
+
+private:
+    // Every cached glyph, keyed by font and character
+    static std::map<std::string, Glyph> glyphs;
+
+    // Set when a glyph is added after the last save/load
+    static bool modified;
+
+    // The key for a font and character
+    static std::string getKey( const MString &font, char character );
+
+    // Builds a glyph from textCurves/planarSrf
+    static MStatus tessellate( const MString &font, char character, Glyph &glyph );
+
+    // Calculates the bounds and advance from the points
+    static void setMetrics( Glyph &glyph );
+
+    // Checks the polygons read from a file against the
+    // number of points
+    static bool isValidMesh( uint32_t numPoints, const std::vector<int32_t> &counts,
+                             const std::vector<int32_t> &connects );
+
+public:
+    // Returns the glyph for the character, tessellating it
+    // the first time.  Returns NULL on failure.
+    static const Glyph *getGlyph( const MString &font, char character, MStatus *status = NULL );
+
+    // Adds the glyphs in the file that aren't cached yet
+    static MStatus load( const MString &fileName );
+
+    // Writes every cached glyph to the file
+    static MStatus save( const MString &fileName );
+
+    // Indicates there are glyphs that haven't been saved
+    static bool isModified() { return modified; }
+
+    // Removes every glyph from the cache
+    static void clear();
+};
+
+#endif
@@ -0,0 +1,464 @@
+//*********************************************************
+// KeyHeatmapCommand.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "KeyHeatmapCommand.h"
+#include "AnimCurveCollector.h"
+#include "ParallelFor.h"
+#include "ErrorReporting.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <utility>
+#include <fstream>
+//*********************************************************
+
+//*********************************************************
+// Constants
+//*********************************************************
+const char *KeyHeatmapCommand::fileFlag = "-f";
+const char *KeyHeatmapCommand::fileLongFlag = "-file";
+const char *KeyHeatmapCommand::binaryFlag = "-bin";
+const char *KeyHeatmapCommand::binaryLongFlag = "-binary";
+const char *KeyHeatmapCommand::startTimeFlag = "-st";
+const char *KeyHeatmapCommand::startTimeLongFlag = "-startTime";
+const char *KeyHeatmapCommand::endTimeFlag = "-et";
+const char *KeyHeatmapCommand::endTimeLongFlag = "-endTime";
+
+// Identifies a binary heatmap file and its layout
+static const char heatmapFileTag[4] = { 'A', 'T', 'B', 'H' };
+static const uint32_t heatmapFileVersion = 1;
+
+
+//*********************************************************
+// Name: KeyHeatmapCommand
+// Desc: Constructor
+//*********************************************************
+KeyHeatmapCommand::KeyHeatmapCommand()
+{
+    pluginTrace( "KeyHeatmapCommand", "KeyHeatmapCommand", "******* Key Heatmap Command *******" );
+
+    // Initialize the command flag defaults
+    binary = false;
+
+    startFrame = 0;
+    numFrames = 0;
+}
+
+
+//*********************************************************
+// Name: ~KeyHeatmapCommand
+// Desc: Destructor
+//*********************************************************
+KeyHeatmapCommand::~KeyHeatmapCommand()
+{
+}
+
+
+//*********************************************************
+// Name: doIt
+// Desc: Reads the keys of the controls, indexes every
+//       control in parallel and sums the indexes into the
+//       per frame counts in one pass
+//*********************************************************
+MStatus KeyHeatmapCommand::doIt( const MArgList &args )
+{
+    MStatus status = MS::kFailure;
+    std::vector<HeatmapControl> controls;
+    std::vector<HeatmapCurve> curves;
+
+    if( !parseCommandFlags( args )) {
+        pluginError( "KeyHeatmapCommand", "doIt", "Failed to parse command flags" );
+    }
+    else if( !(status = getCurves( controls, curves ))) {
+        pluginError( "KeyHeatmapCommand", "doIt", "Failed to read the anim curves" );
+    }
+    else {
+        // Every control is indexed independently
+        parallelFor( (unsigned int)controls.size(), [&]( unsigned int i ) {
+            indexControl( controls[i], curves, startFrame, numFrames );
+        });
+
+        std::vector<unsigned int> frameKeys( numFrames, 0 );
+        std::vector<unsigned int> frameBreakdowns( numFrames, 0 );
+        unsigned int numKeys = 0, numBreakdowns = 0;
+
+        for( unsigned int i = 0; i < controls.size(); i++ ) {
+            const std::vector<KeyedFrame> &keyedFrames = controls[i].keyedFrames;
+
+            for( unsigned int k = 0; k < keyedFrames.size(); k++ ) {
+                frameKeys[keyedFrames[k].frame] += keyedFrames[k].keys;
+                frameBreakdowns[keyedFrames[k].frame] += keyedFrames[k].breakdowns;
+            }
+
+            numKeys += controls[i].numKeys;
+            numBreakdowns += controls[i].numBreakdowns;
+        }
+
+        if( binary )
+            status = writeBinary( controls, frameKeys, frameBreakdowns );
+        else
+            status = writeCSV( controls, frameKeys, frameBreakdowns );
+
+        if( !status ) {
+            MGlobal::displayError( "Failed to write the key heatmap to " + fileName );
+        }
+        else {
+            MString result( "Result: " );
+            result += numKeys;
+            result += " keys and ";
+            result += numBreakdowns;
+            result += " breakdowns on ";
+            result += (unsigned int)controls.size();
+            result += " controls over ";
+            result += numFrames;
+            result += " frames written to ";
+            result += fileName;
+            MGlobal::displayInfo( result );
+
+            setResult( (int)(numKeys + numBreakdowns) );
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: newSyntax
+// Desc: Method for registering the command flags
+//       with Maya
+//*********************************************************
+MSyntax KeyHeatmapCommand::newSyntax()
+{
+    MSyntax syntax;
+    syntax.addFlag( fileFlag, fileLongFlag, MSyntax::kString );
+    syntax.addFlag( binaryFlag, binaryLongFlag, MSyntax::kNoArg );
+    syntax.addFlag( startTimeFlag, startTimeLongFlag, MSyntax::kDouble );
+    syntax.addFlag( endTimeFlag, endTimeLongFlag, MSyntax::kDouble );
+
+    syntax.setObjectType( MSyntax::kSelectionList, 0 );
+
+    return syntax;
+}
+
+
+//*********************************************************
+// Name: parseCommandFlags
+// Desc: Parse the command flags and stores the values
+//       in the appropriate variables
+//*********************************************************
+MStatus KeyHeatmapCommand::parseCommandFlags( const MArgList &args )
+{
+    MStatus status = MS::kSuccess;
+
+    MArgDatabase argData( syntax(), args, &status );
+    if( !status ) {
+        pluginError( "KeyHeatmapCommand", "parseCommandFlags",
+                     "Failed to create MArgDatabase for the key heatmap command" );
+        return status;
+    }
+
+    MTime::Unit unit = MTime::uiUnit();
+    double startTime = MAnimControl::minTime().as( unit );
+    double endTime = MAnimControl::maxTime().as( unit );
+
+    if( argData.isFlagSet( fileFlag ))
+        argData.getFlagArgument( fileFlag, 0, fileName );
+    if( argData.isFlagSet( binaryFlag ))
+        binary = true;
+    if( argData.isFlagSet( startTimeFlag ))
+        argData.getFlagArgument( startTimeFlag, 0, startTime );
+    if( argData.isFlagSet( endTimeFlag ))
+        argData.getFlagArgument( endTimeFlag, 0, endTime );
+
+    argData.getObjects( rootList );
+
+    startFrame = (long long)floor( startTime + 0.5 );
+    long long endFrame = (long long)floor( endTime + 0.5 );
+
+    if( fileName.length() == 0 ) {
+        MGlobal::displayError( "A file must be given with -file" );
+        status = MS::kFailure;
+    }
+    else if( endFrame < startFrame ) {
+        MGlobal::displayError( "The end time must be greater than or equal to the start time" );
+        status = MS::kFailure;
+    }
+    else if( rootList.length() == 0 && !(status = AnimCurveCollector::getSelectedObjects( rootList ))) {
+        MGlobal::displayError( "Select the root objects of the controls" );
+    }
+    else
+        numFrames = (unsigned int)(endFrame - startFrame + 1);
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: getCurves
+// Desc: Every DAG node under a root object is a control,
+//       other roots (character sets) are controls
+//       themselves.  The curves are found by the anim
+//       curve collector and driven keys are skipped.
+//       Controls without curves aren't written.
+//*********************************************************
+MStatus KeyHeatmapCommand::getCurves( std::vector<HeatmapControl> &controls, std::vector<HeatmapCurve> &curves )
+{
+    MStatus status = MS::kSuccess;
+    MSelectionList controlList;
+
+    MItSelectionList sIter( rootList, MFn::kInvalid, &status );
+    if( !status ) {
+        pluginError( "KeyHeatmapCommand", "getCurves", "Failed to create SL iterator" );
+        return status;
+    }
+
+    for( ; !sIter.isDone(); sIter.next() ) {
+        MObject root;
+        if( !sIter.getDependNode( root ))
+            continue;
+
+        if( !root.hasFn( MFn::kDagNode )) {
+            controlList.add( root, true );
+            continue;
+        }
+
+        MItDag dagIter;
+        if( !(status = dagIter.reset( root ))) {
+            pluginError( "KeyHeatmapCommand", "getCurves", "Failed to reset the DAG iterator" );
+            return status;
+        }
+
+        for( ; !dagIter.isDone(); dagIter.next() )
+            controlList.add( dagIter.currentItem(), true );
+    }
+
+    AnimCurveCollector collector;
+    std::vector<AnimCurveInfo> animCurves;
+
+    if( !(status = collector.getAnimCurves( controlList, animCurves ))) {
+        pluginError( "KeyHeatmapCommand", "getCurves", "Failed to get the anim curves" );
+        return status;
+    }
+
+    // The position of each control in the controls array,
+    // a control is added with its first curve
+    std::vector<int> controlIndices( controlList.length(), -1 );
+    MTime::Unit unit = MTime::uiUnit();
+
+    for( unsigned int i = 0; i < animCurves.size(); i++ ) {
+        MFnAnimCurve animCurveFn( animCurves[i].animCurve, &status );
+        if( !status ) {
+            pluginError( "KeyHeatmapCommand", "getCurves", "Can't get AnimCurve function set" );
+            break;
+        }
+
+        if( !animCurveFn.isTimeInput() )
+            continue;
+
+        unsigned int selectionIndex = animCurves[i].selectionIndex;
+        if( controlIndices[selectionIndex] < 0 ) {
+            HeatmapControl control;
+            MObject node = animCurves[i].node;
+
+            if( node.hasFn( MFn::kDagNode ))
+                control.name = MFnDagNode( node ).partialPathName();
+            else
+                control.name = MFnDependencyNode( node ).name();
+
+            control.numKeys = 0;
+            control.numBreakdowns = 0;
+
+            controlIndices[selectionIndex] = (int)controls.size();
+            controls.push_back( control );
+        }
+
+        HeatmapCurve curve;
+        unsigned int numKeys = animCurveFn.numKeys();
+
+        curve.control = (unsigned int)controlIndices[selectionIndex];
+        curve.keyFrames.resize( numKeys );
+        curve.breakdowns.resize( numKeys, 0 );
+
+        for( unsigned int index = 0; index < numKeys; index++ )
+            curve.keyFrames[index] = animCurveFn.time( index ).as( unit );
+
+        // keyTickDrawSpecial is sparse, the logical index
+        // of each element is the index of its key
+        MPlug tdsPlug = animCurveFn.findPlug( "keyTickDrawSpecial", &status );
+        if( !status ) {
+            pluginError( "KeyHeatmapCommand", "getCurves", "No MPlug with name keyTickDrawSpecial" );
+            break;
+        }
+
+        for( unsigned int element = 0; element < tdsPlug.numElements(); element++ ) {
+            bool tds = false;
+            MPlug elementPlug = tdsPlug.elementByPhysicalIndex( element );
+            unsigned int index = elementPlug.logicalIndex();
+
+            if( index < numKeys && elementPlug.getValue( tds ) && tds )
+                curve.breakdowns[index] = 1;
+        }
+
+        controls[curve.control].curves.push_back( (unsigned int)curves.size() );
+        curves.push_back( curve );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: indexControl
+// Desc: Rounds the keys of the control's curves to the
+//       frames of the range, sorts them and counts the keys
+//       and breakdowns on each keyed frame
+//*********************************************************
+void KeyHeatmapCommand::indexControl( HeatmapControl &control, const std::vector<HeatmapCurve> &curves,
+                                      long long startFrame, unsigned int numFrames )
+{
+    std::vector<std::pair<unsigned int, unsigned char> > keys;
+
+    control.keyedFrames.clear();
+    control.numKeys = 0;
+    control.numBreakdowns = 0;
+
+    for( unsigned int c = 0; c < control.curves.size(); c++ ) {
+        const HeatmapCurve &curve = curves[control.curves[c]];
+
+        for( unsigned int k = 0; k < curve.keyFrames.size(); k++ ) {
+            long long frame = (long long)floor( curve.keyFrames[k] + 0.5 ) - startFrame;
+            if( frame >= 0 && frame < (long long)numFrames )
+                keys.push_back( std::make_pair( (unsigned int)frame, curve.breakdowns[k] ));
+        }
+    }
+
+    std::sort( keys.begin(), keys.end() );
+
+    for( unsigned int k = 0; k < keys.size(); k++ ) {
+        if( control.keyedFrames.empty() || control.keyedFrames.back().frame != keys[k].first ) {
+            KeyedFrame keyedFrame = { keys[k].first, 0, 0 };
+            control.keyedFrames.push_back( keyedFrame );
+        }
+
+        KeyedFrame &keyedFrame = control.keyedFrames.back();
+        if( keys[k].second ) {
+            keyedFrame.breakdowns++;
+            control.numBreakdowns++;
+        }
+        else {
+            keyedFrame.keys++;
+            control.numKeys++;
+        }
+    }
+}
+
+
+//*********************************************************
+// Name: writeCSV
+// Desc: Writes the frame table, a blank line and the
+//       control table, each with a header row
+//*********************************************************
+MStatus KeyHeatmapCommand::writeCSV( const std::vector<HeatmapControl> &controls,
+                                     const std::vector<unsigned int> &frameKeys,
+                                     const std::vector<unsigned int> &frameBreakdowns )
+{
+    std::ofstream file( fileName.asChar(), std::ios::out | std::ios::trunc );
+    if( !file.is_open() ) {
+        pluginError( "KeyHeatmapCommand", "writeCSV", "Can't open the heatmap file " + fileName );
+        return MS::kFailure;
+    }
+
+    file << "frame,keys,breakdowns\n";
+    for( unsigned int frame = 0; frame < numFrames; frame++ )
+        file << (startFrame + frame) << ',' << frameKeys[frame] << ',' << frameBreakdowns[frame] << '\n';
+
+    file << "\ncontrol,curves,keys,breakdowns,keyedFrames,density\n";
+    for( unsigned int i = 0; i < controls.size(); i++ ) {
+        const HeatmapControl &control = controls[i];
+        unsigned int numKeyedFrames = (unsigned int)control.keyedFrames.size();
+
+        file << control.name.asChar() << ','
+             << control.curves.size() << ','
+             << control.numKeys << ','
+             << control.numBreakdowns << ','
+             << numKeyedFrames << ','
+             << (double)numKeyedFrames / numFrames << '\n';
+    }
+
+    if( !file ) {
+        pluginError( "KeyHeatmapCommand", "writeCSV", "Failed to write the heatmap file " + fileName );
+        return MS::kFailure;
+    }
+
+    return MS::kSuccess;
+}
+
+
+//*********************************************************
+// Name: writeBinary
+// Desc: In order, native byte order:
+//
+//       'ATBH', uint32 version, int32 start frame,
+//       uint32 frame count, uint32 control count
+//
+//       per frame: uint32 keys, uint32 breakdowns
+//
+//       per control: uint32 name length, the name (no
+//       terminator), uint32 curves, uint32 keys,
+//       uint32 breakdowns, uint32 keyed frames,
+//       float density
+//*********************************************************
+MStatus KeyHeatmapCommand::writeBinary( const std::vector<HeatmapControl> &controls,
+                                        const std::vector<unsigned int> &frameKeys,
+                                        const std::vector<unsigned int> &frameBreakdowns )
+{
+    std::ofstream file( fileName.asChar(), std::ios::out | std::ios::binary | std::ios::trunc );
+    if( !file.is_open() ) {
+        pluginError( "KeyHeatmapCommand", "writeBinary", "Can't open the heatmap file " + fileName );
+        return MS::kFailure;
+    }
+
+    int32_t first = (int32_t)startFrame;
+    uint32_t numControls = (uint32_t)controls.size();
+
+    file.write( heatmapFileTag, sizeof( heatmapFileTag ));
+    file.write( (const char *)&heatmapFileVersion, sizeof( heatmapFileVersion ));
+    file.write( (const char *)&first, sizeof( first ));
+    file.write( (const char *)&numFrames, sizeof( uint32_t ));
+    file.write( (const char *)&numControls, sizeof( numControls ));
+
+    for( unsigned int frame = 0; frame < numFrames; frame++ ) {
+        uint32_t counts[2] = { frameKeys[frame], frameBreakdowns[frame] };
+        file.write( (const char *)counts, sizeof( counts ));
+    }
+
+    for( unsigned int i = 0; i < controls.size(); i++ ) {
+        const HeatmapControl &control = controls[i];
+
+        uint32_t nameLength = control.name.length();
+        file.write( (const char *)&nameLength, sizeof( nameLength ));
+        file.write( control.name.asChar(), nameLength );
+
+        uint32_t counts[4] = { (uint32_t)control.curves.size(), control.numKeys, control.numBreakdowns,
+                               (uint32_t)control.keyedFrames.size() };
+        file.write( (const char *)counts, sizeof( counts ));
+
+        float density = (float)control.keyedFrames.size() / numFrames;
+        file.write( (const char *)&density, sizeof( density ));
+    }
+
+    if( !file ) {
+        pluginError( "KeyHeatmapCommand", "writeBinary", "Failed to write the heatmap file " + fileName );
+        return MS::kFailure;
+    }
+
+    return MS::kSuccess;
+}
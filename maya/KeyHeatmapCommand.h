@@ -0,0 +1,158 @@
+//*********************************************************
+// KeyHeatmapCommand.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __KEY_HEATMAP_COMMAND_H_
+#define __KEY_HEATMAP_COMMAND_H_
+
+//*********************************************************
+#include <maya/MPxCommand.h>
+
+#include <maya/MGlobal.h>
+#include <maya/MSyntax.h>
+#include <maya/MArgList.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MString.h>
+#include <maya/MTime.h>
+#include <maya/MPlug.h>
+#include <maya/MObject.h>
+#include <maya/MSelectionList.h>
+#include <maya/MAnimControl.h>
+
+#include <maya/MFnDependencyNode.h>
+#include <maya/MFnDagNode.h>
+#include <maya/MFnAnimCurve.h>
+
+#include <maya/MItDag.h>
+#include <maya/MItSelectionList.h>
+
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: KeyHeatmapCommand
+//
+// Desc: Writes where the keys and breakdowns fall across
+//       a character for review.  Every control in the
+//       hierarchy below the root objects (selection by
+//       default) is scanned and two tables are written:
+//
+//       - per frame, the number of keys and of breakdowns
+//         (keys with keyTickDrawSpecial set) on the frame
+//       - per control, the number of curves, keys,
+//         breakdowns and keyed frames, and the density
+//         (keyed frames / frames in the range)
+//
+//       Keys are counted on the nearest whole frame of the
+//       UI unit, keys outside the range are ignored.  The
+//       range defaults to the playback range.
+//
+//       The file is CSV, or a small binary file with the
+//       -binary flag (see writeBinary for the layout).
+//
+// Command: cieKeyHeatmap
+//
+// Flags: -file (-f)            (string)
+//
+//        -binary (-bin)
+//
+//        -startTime (-st)      (double)
+//
+//        -endTime (-et)        (double)
+//
+//*********************************************************
+class KeyHeatmapCommand : public MPxCommand
+{
+private:
+    // The key times read from a curve
+    struct HeatmapCurve {
+        // Index of the control the curve animates
+        unsigned int control;
+
+        // Key times in frames of the UI unit and whether
+        // each key is a breakdown
+        std::vector<double> keyFrames;
+        std::vector<unsigned char> breakdowns;
+    };
+
+    // The keys on one frame of a control
+    struct KeyedFrame {
+        unsigned int frame;
+        unsigned int keys, breakdowns;
+    };
+
+    // A control and its key-time index
+    struct HeatmapControl {
+        MString name;
+
+        // The curves of the control
+        std::vector<unsigned int> curves;
+
+        // Every keyed frame in the range, in frame order
+        std::vector<KeyedFrame> keyedFrames;
+
+        unsigned int numKeys, numBreakdowns;
+    };
+
+    // Command flag constants
+    static const char *fileFlag, *fileLongFlag;
+    static const char *binaryFlag, *binaryLongFlag;
+    static const char *startTimeFlag, *startTimeLongFlag;
+    static const char *endTimeFlag, *endTimeLongFlag;
+
+    // The file written and its format
+    MString fileName;
+    bool binary;
+
+    // The first frame and the number of frames in the range
+    long long startFrame;
+    unsigned int numFrames;
+
+    // The root objects of the controls
+    MSelectionList rootList;
+
+    // Method to setup the command flags
+    MStatus parseCommandFlags( const MArgList &args );
+
+    // Reads the keys of every curve of the controls under
+    // the root objects
+    MStatus getCurves( std::vector<HeatmapControl> &controls, std::vector<HeatmapCurve> &curves );
+
+    // Builds the key-time index of a control (safe to call
+    // from the thread pool)
+    static void indexControl( HeatmapControl &control, const std::vector<HeatmapCurve> &curves,
+                              long long startFrame, unsigned int numFrames );
+
+    // Writes the tables as CSV
+    MStatus writeCSV( const std::vector<HeatmapControl> &controls,
+                      const std::vector<unsigned int> &frameKeys,
+                      const std::vector<unsigned int> &frameBreakdowns );
+
+    // Writes the tables as binary
+    MStatus writeBinary( const std::vector<HeatmapControl> &controls,
+                         const std::vector<unsigned int> &frameKeys,
+                         const std::vector<unsigned int> &frameBreakdowns );
+
+public:
+    // Constructor/Destructor
+    KeyHeatmapCommand();
+    ~KeyHeatmapCommand();
+
+    // Performs the command
+    virtual MStatus doIt( const MArgList &args );
+
+    // The scene isn't changed
+    virtual bool isUndoable() const { return false; }
+
+    // Allocates a command object to Maya (required)
+    static void *creator() { return new KeyHeatmapCommand; }
+
+    // Defines the set of flags allowed by this command
+    static MSyntax newSyntax();
+};
+
+#endif
@@ -0,0 +1,266 @@
+//*********************************************************
+// KeyTypeTimeline.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "KeyTypeTimeline.h"
+#include "ErrorReporting.h"
+
+#include <algorithm>
+//*********************************************************
+
+//*********************************************************
+// Name: KeyTypeTimeline
+// Desc: Constructor
+//*********************************************************
+KeyTypeTimeline::KeyTypeTimeline()
+{
+    valid = false;
+}
+
+
+//*********************************************************
+// Name: ~KeyTypeTimeline
+// Desc: Destructor
+//*********************************************************
+KeyTypeTimeline::~KeyTypeTimeline()
+{
+    removeCallbacks();
+}
+
+
+//*********************************************************
+// Name: build
+// Desc: Collects the key times of every curve on the root
+//       objects, sorts them and merges the keys on the same
+//       time.  A time is a breakdown when any of its keys
+//       has keyTickDrawSpecial set, matching the colour of
+//       the timeline tick.
+//*********************************************************
+MStatus KeyTypeTimeline::build( const MObjectArray &rootNodes, bool watchChanges )
+{
+    MStatus status = MS::kSuccess;
+    MObjectArray animCurves;
+    std::vector<KeyTime> curveKeyTimes;
+
+    removeCallbacks();
+    keyTimes.clear();
+    valid = false;
+
+    if( !(status = getAnimCurves( rootNodes, animCurves ))) {
+        pluginError( "KeyTypeTimeline", "build", "Failed to get the anim curves" );
+    }
+    else {
+        for( unsigned int i = 0; i < animCurves.length() && status; i++ ) {
+            MFnAnimCurve animCurveFn( animCurves[i], &status );
+            if( !status ) {
+                pluginError( "KeyTypeTimeline", "build", "Can't get AnimCurve function set" );
+                break;
+            }
+
+            unsigned int numKeys = animCurveFn.numKeys();
+            size_t firstKey = curveKeyTimes.size();
+
+            for( unsigned int index = 0; index < numKeys; index++ ) {
+                KeyTime keyTime;
+                keyTime.time = animCurveFn.time( index );
+                keyTime.keyType = kKey;
+                curveKeyTimes.push_back( keyTime );
+            }
+
+            // keyTickDrawSpecial is sparse, the logical index
+            // of each element is the index of its key
+            MPlug tdsPlug = animCurveFn.findPlug( "keyTickDrawSpecial", &status );
+            if( !status ) {
+                pluginError( "KeyTypeTimeline", "build", "No MPlug with name keyTickDrawSpecial" );
+                break;
+            }
+
+            for( unsigned int element = 0; element < tdsPlug.numElements(); element++ ) {
+                bool tds = false;
+                MPlug elementPlug = tdsPlug.elementByPhysicalIndex( element );
+                unsigned int index = elementPlug.logicalIndex();
+
+                if( index < numKeys && elementPlug.getValue( tds ) && tds )
+                    curveKeyTimes[firstKey + index].keyType = kBreakdown;
+            }
+        }
+    }
+
+    if( status ) {
+        std::sort( curveKeyTimes.begin(), curveKeyTimes.end(),
+                   []( const KeyTime &a, const KeyTime &b ) { return a.time < b.time; } );
+
+        // One entry per time, a breakdown on any curve wins
+        for( size_t i = 0; i < curveKeyTimes.size(); i++ ) {
+            if( keyTimes.empty() || !(keyTimes.back().time == curveKeyTimes[i].time) )
+                keyTimes.push_back( curveKeyTimes[i] );
+            else if( curveKeyTimes[i].keyType == kBreakdown )
+                keyTimes.back().keyType = kBreakdown;
+        }
+
+        if( watchChanges && !(status = addCallbacks( rootNodes, animCurves ))) {
+            pluginError( "KeyTypeTimeline", "build", "Failed to add the callbacks" );
+        }
+        else
+            valid = true;
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: getKeyType
+// Desc: Binary search for the given time
+//*********************************************************
+KeyTypeTimeline::KeyType KeyTypeTimeline::getKeyType( const MTime &time ) const
+{
+    KeyType keyType = kNoKey;
+
+    std::vector<KeyTime>::const_iterator keyTime =
+        std::lower_bound( keyTimes.begin(), keyTimes.end(), time,
+                          []( const KeyTime &a, const MTime &b ) { return a.time < b; } );
+
+    if( keyTime != keyTimes.end() && keyTime->time == time )
+        keyType = keyTime->keyType;
+
+    return keyType;
+}
+
+
+//*********************************************************
+// Name: getKeyTypes
+// Desc: Walks the frames and the sorted key times together,
+//       so a range costs one search plus one step per frame
+//       or key
+//*********************************************************
+void KeyTypeTimeline::getKeyTypes( const MTime &start, unsigned int numFrames, std::vector<KeyType> &frameKeyTypes ) const
+{
+    frameKeyTypes.assign( numFrames, kNoKey );
+
+    std::vector<KeyTime>::const_iterator keyTime =
+        std::lower_bound( keyTimes.begin(), keyTimes.end(), start,
+                          []( const KeyTime &a, const MTime &b ) { return a.time < b; } );
+
+    for( unsigned int frame = 0; frame < numFrames && keyTime != keyTimes.end(); frame++ ) {
+        MTime time = start + (double)frame;
+
+        while( keyTime != keyTimes.end() && keyTime->time < time )
+            keyTime++;
+
+        if( keyTime != keyTimes.end() && keyTime->time == time )
+            frameKeyTypes[frame] = keyTime->keyType;
+    }
+}
+
+
+//*********************************************************
+// Name: removeCallbacks
+// Desc: Removes all of the callbacks
+//*********************************************************
+void KeyTypeTimeline::removeCallbacks()
+{
+    if( callbackIds.length() > 0 ) {
+        MMessage::removeCallbacks( callbackIds );
+        callbackIds.clear();
+    }
+}
+
+
+//*********************************************************
+// Name: getAnimCurves
+// Desc: Gets the anim curves directly connected to the
+//       keyable, unlocked attributes of the root objects
+//*********************************************************
+MStatus KeyTypeTimeline::getAnimCurves( const MObjectArray &rootNodes, MObjectArray &animCurves )
+{
+    MStatus status = MS::kSuccess;
+
+    for( unsigned int i = 0; i < rootNodes.length(); i++ ) {
+        MPlugArray plugArray;
+
+        // No connections means no anim curves
+        MFnDependencyNode dependFn( rootNodes[i] );
+        if( !dependFn.getConnections( plugArray ))
+            continue;
+
+        for( unsigned int index = 0; index < plugArray.length(); index++ ) {
+            MPlugArray srcPlugs;
+
+            if( !plugArray[index].isKeyable() || plugArray[index].isLocked() )
+                continue;
+
+            if( plugArray[index].connectedTo( srcPlugs, true, false ) && srcPlugs.length() > 0 &&
+                srcPlugs[0].node().hasFn( MFn::kAnimCurve ))
+                animCurves.append( srcPlugs[0].node() );
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: addCallbacks
+// Desc: Adds an attribute changed callback to every root
+//       object and curve
+//*********************************************************
+MStatus KeyTypeTimeline::addCallbacks( const MObjectArray &rootNodes, const MObjectArray &animCurves )
+{
+    MStatus status = MS::kSuccess;
+
+    for( unsigned int i = 0; i < rootNodes.length() && status; i++ ) {
+        MObject node = rootNodes[i];
+        MCallbackId id = MNodeMessage::addAttributeChangedCallback( node, rootChanged, this, &status );
+        if( status )
+            callbackIds.append( id );
+    }
+
+    for( unsigned int i = 0; i < animCurves.length() && status; i++ ) {
+        MObject node = animCurves[i];
+        MCallbackId id = MNodeMessage::addAttributeChangedCallback( node, curveChanged, this, &status );
+        if( status )
+            callbackIds.append( id );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: rootChanged
+// Desc: Changes to the values of a root object don't
+//       affect the keys, only which curves are used does.
+//       Evaluation messages are sent every frame and are
+//       ignored.
+//*********************************************************
+void KeyTypeTimeline::rootChanged( MNodeMessage::AttributeMessage msg, MPlug &plug, MPlug &otherPlug, void *clientData )
+{
+    const int changeMask = MNodeMessage::kConnectionMade | MNodeMessage::kConnectionBroken |
+                           MNodeMessage::kAttributeLocked | MNodeMessage::kAttributeUnlocked |
+                           MNodeMessage::kAttributeKeyable | MNodeMessage::kAttributeUnkeyable;
+
+    if( msg & changeMask )
+        ((KeyTypeTimeline *)clientData)->invalidate();
+}
+
+
+//*********************************************************
+// Name: curveChanged
+// Desc: Any key edit sets or adds/removes elements of the
+//       curve's key arrays.  Evaluation messages are sent
+//       every frame and are ignored.
+//*********************************************************
+void KeyTypeTimeline::curveChanged( MNodeMessage::AttributeMessage msg, MPlug &plug, MPlug &otherPlug, void *clientData )
+{
+    const int changeMask = MNodeMessage::kAttributeSet | MNodeMessage::kAttributeArrayAdded |
+                           MNodeMessage::kAttributeArrayRemoved | MNodeMessage::kConnectionBroken;
+
+    if( msg & changeMask )
+        ((KeyTypeTimeline *)clientData)->invalidate();
+}
@@ -0,0 +1,109 @@
+//*********************************************************
+// KeyTypeTimeline.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __KEY_TYPE_TIMELINE_H_
+#define __KEY_TYPE_TIMELINE_H_
+
+//*********************************************************
+#include <maya/MObject.h>
+#include <maya/MObjectArray.h>
+#include <maya/MPlug.h>
+#include <maya/MPlugArray.h>
+#include <maya/MTime.h>
+#include <maya/MCallbackIdArray.h>
+#include <maya/MNodeMessage.h>
+
+#include <maya/MFnAnimCurve.h>
+#include <maya/MFnDependencyNode.h>
+
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: KeyTypeTimeline
+//
+// Desc: Every key time on the anim curves of a set of
+//       root objects, merged into one sorted array with the
+//       type of key at each time.  Looking up a time is a
+//       binary search.  Once built, attribute changed
+//       callbacks on the curves and root objects mark the
+//       timeline as out of date when the keys or the
+//       connections change, so it's only rebuilt after an
+//       edit.
+//*********************************************************
+class KeyTypeTimeline
+{
+public:
+    enum KeyType {
+        kNoKey,
+        kKey,
+        kBreakdown
+    };
+
+private:
+    // A time with a key on at least one of the curves
+    struct KeyTime {
+        MTime time;
+        KeyType keyType;
+    };
+
+    // The merged key times in ascending order
+    std::vector<KeyTime> keyTimes;
+
+    // The callbacks on the root objects and curves
+    MCallbackIdArray callbackIds;
+
+    // False until built and after the keys or
+    // connections have changed
+    bool valid;
+
+    // Gets the anim curves directly connected to the
+    // keyable, unlocked attributes of the root objects
+    static MStatus getAnimCurves( const MObjectArray &rootNodes, MObjectArray &animCurves );
+
+    // Adds the callbacks that invalidate the timeline
+    MStatus addCallbacks( const MObjectArray &rootNodes, const MObjectArray &animCurves );
+
+    // Invalidates the timeline when a connection, lock or
+    // keyable state changes on a root object
+    static void rootChanged( MNodeMessage::AttributeMessage msg, MPlug &plug, MPlug &otherPlug, void *clientData );
+
+    // Invalidates the timeline when a key is added,
+    // removed or edited on a curve
+    static void curveChanged( MNodeMessage::AttributeMessage msg, MPlug &plug, MPlug &otherPlug, void *clientData );
+
+public:
+    // Constructor/Destructor
+    KeyTypeTimeline();
+    ~KeyTypeTimeline();
+
+    // Rebuilds the timeline from the curves of the root
+    // objects.  Callbacks are only added when watchChanges
+    // is set.
+    MStatus build( const MObjectArray &rootNodes, bool watchChanges );
+
+    // Finds the type of key at the given time.  A breakdown
+    // on any curve takes priority over a key.
+    KeyType getKeyType( const MTime &time ) const;
+
+    // Finds the type of key at each of numFrames frames
+    // from the start time in one pass.  The frames are one
+    // unit of the start time apart.
+    void getKeyTypes( const MTime &start, unsigned int numFrames, std::vector<KeyType> &frameKeyTypes ) const;
+
+    // Marks the timeline as out of date
+    void invalidate() { valid = false; }
+
+    // Indicates the timeline matches the curves
+    bool isValid() const { return valid; }
+
+    // Removes all of the callbacks
+    void removeCallbacks();
+};
+
+#endif
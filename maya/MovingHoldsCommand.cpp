@@ -0,0 +1,350 @@
+//*********************************************************
+// MovingHoldsCommand.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "MovingHoldsCommand.h"
+#include "ErrorReporting.h"
+//*********************************************************
+
+//*********************************************************
+// Constants
+//*********************************************************
+const char *MovingHoldsCommand::offsetFlag = "-o";
+const char *MovingHoldsCommand::offsetLongFlag = "-offset";
+const char *MovingHoldsCommand::driftFlag = "-dr";
+const char *MovingHoldsCommand::driftLongFlag = "-drift";
+const char *MovingHoldsCommand::startTimeFlag = "-st";
+const char *MovingHoldsCommand::startTimeLongFlag = "-startTime";
+const char *MovingHoldsCommand::endTimeFlag = "-et";
+const char *MovingHoldsCommand::endTimeLongFlag = "-endTime";
+const char *MovingHoldsCommand::tickDrawSpecialFlag = "-tds";
+const char *MovingHoldsCommand::tickDrawSpecialLongFlag = "-tickDrawSpecial";
+
+
+//*********************************************************
+// Name: MovingHoldsCommand
+// Desc: Constructor
+//*********************************************************
+MovingHoldsCommand::MovingHoldsCommand()
+{
+    pluginTrace( "MovingHoldsCommand", "MovingHoldsCommand", "******* Moving Holds Command *******" );
+
+    initialized = false;
+    numHoldsInserted = 0;
+
+    // Initialize the command flag defaults
+    holdOffset = 2.0;
+    holdDrift = 10.0;
+    useStartTime = false;
+    startTime = 0.0;
+    useEndTime = false;
+    endTime = 0.0;
+    tickDrawSpecial = false;
+}
+
+
+//*********************************************************
+// Name: ~MovingHoldsCommand
+// Desc: Destructor
+//*********************************************************
+MovingHoldsCommand::~MovingHoldsCommand()
+{
+    // Cleanup all memory allocated for this command
+    for( unsigned int i = 0; i < holdCurves.size(); i++ ) {
+        delete holdCurves[i].pAnimCurveFn;
+        delete holdCurves[i].pAnimCache;
+    }
+}
+
+
+//*********************************************************
+// Name: doIt
+// Desc: All of the one-time setup and initialization
+//       code for the moving holds command.  doIt is called
+//       by Maya when any command is executed in MEL.
+//       Any code that changes the state of Maya is
+//       handled by the redoIt method.
+//*********************************************************
+MStatus MovingHoldsCommand::doIt( const MArgList &args )
+{
+    MStatus status = MS::kFailure;
+    AnimCurveCollector collector;
+    std::vector<AnimCurveInfo> animCurves;
+
+    if( !parseCommandFlags( args )) {
+        pluginError( "MovingHoldsCommand", "doIt", "Failed to parse command flags" );
+    }
+    else if( !AnimCurveCollector::getSelectedObjects( selectionList )) {
+        MGlobal::displayError( "No Objects Selected" );
+    }
+    else if( !collector.getAnimCurves( selectionList, animCurves )) {
+        pluginError( "MovingHoldsCommand", "doIt", "Failed to get the anim curves" );
+    }
+    else if( animCurves.empty() ) {
+        MGlobal::displayError( "No Keys Set" );
+    }
+    else if( !calcHolds( animCurves )) {
+        pluginError( "MovingHoldsCommand", "doIt", "Failed to calculate the holds" );
+    }
+    else if( !(status = redoIt() )) {
+        pluginError( "MovingHoldsCommand", "doIt", "Failed to redoIt" );
+    }
+    else {
+        MString result( "Result: " );
+        MGlobal::displayInfo( result + numHoldsInserted );
+
+        setResult( (int)numHoldsInserted );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: redoIt
+// Desc: Contains the code that changes the internal state
+//       of Maya.  It is called by Maya to redo.
+//*********************************************************
+MStatus MovingHoldsCommand::redoIt()
+{
+    MStatus status = MS::kSuccess;
+
+    if( !initialized ) {
+        status = insertHolds();
+        initialized = true;
+    }
+    else {
+        // Just use the anim curve cache to redo
+        for( unsigned int i = 0; i < holdCurves.size(); i++ )
+            holdCurves[i].pAnimCache->redoIt();
+
+        tickDrawModifier.doIt();
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: undoIt
+// Desc: Contains the code to undo the internal state
+//       changes made by the moving holds command (redoIt).
+//       It is called by Maya to undo.
+//*********************************************************
+MStatus MovingHoldsCommand::undoIt()
+{
+    MStatus status = MS::kSuccess;
+
+    // The tick states were set after the keys were added,
+    // so they are restored first
+    tickDrawModifier.undoIt();
+
+    for( unsigned int i = 0; i < holdCurves.size(); i++ )
+        holdCurves[i].pAnimCache->undoIt();
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: newSyntax
+// Desc: Method for registering the command flags
+//       with Maya
+//*********************************************************
+MSyntax MovingHoldsCommand::newSyntax()
+{
+    MSyntax syntax;
+    syntax.addFlag( offsetFlag, offsetLongFlag, MSyntax::kDouble );
+    syntax.addFlag( driftFlag, driftLongFlag, MSyntax::kDouble );
+    syntax.addFlag( startTimeFlag, startTimeLongFlag, MSyntax::kDouble );
+    syntax.addFlag( endTimeFlag, endTimeLongFlag, MSyntax::kDouble );
+    syntax.addFlag( tickDrawSpecialFlag, tickDrawSpecialLongFlag, MSyntax::kBoolean );
+
+    return syntax;
+}
+
+
+//*********************************************************
+// Name: parseCommandFlags
+// Desc: Parse the command flags and stores the values
+//       in the appropriate variables
+//*********************************************************
+MStatus MovingHoldsCommand::parseCommandFlags( const MArgList &args )
+{
+    MStatus status = MS::kSuccess;
+
+    MArgDatabase argData( syntax(), args, &status );
+    if( !status ) {
+        pluginError( "MovingHoldsCommand", "parseCommandFlags",
+                     "Failed to create MArgDatabase for the moving holds command" );
+    }
+    else {
+        if( argData.isFlagSet( offsetFlag ))
+            argData.getFlagArgument( offsetFlag, 0, holdOffset );
+        if( argData.isFlagSet( driftFlag ))
+            argData.getFlagArgument( driftFlag, 0, holdDrift );
+        if( argData.isFlagSet( tickDrawSpecialFlag ))
+            argData.getFlagArgument( tickDrawSpecialFlag, 0, tickDrawSpecial );
+
+        if( argData.isFlagSet( startTimeFlag )) {
+            argData.getFlagArgument( startTimeFlag, 0, startTime );
+            useStartTime = true;
+        }
+        if( argData.isFlagSet( endTimeFlag )) {
+            argData.getFlagArgument( endTimeFlag, 0, endTime );
+            useEndTime = true;
+        }
+
+        if( holdOffset <= 0.0 ) {
+            MGlobal::displayError( "The hold offset must be greater than 0" );
+            status = MS::kFailure;
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: calcHolds
+// Desc: Reads every curve into a snapshot and calculates
+//       its holds before any curve is changed
+//*********************************************************
+MStatus MovingHoldsCommand::calcHolds( const std::vector<AnimCurveInfo> &animCurves )
+{
+    MStatus status = MS::kSuccess;
+    AnimCurveSnapshot snapshot;
+    HoldCurveACC holdCurve;
+
+    holdCurves.reserve( animCurves.size() );
+
+    for( unsigned int i = 0; i < animCurves.size(); i++ ) {
+        MFnAnimCurve *animCurveFn = new MFnAnimCurve( animCurves[i].animCurve, &status );
+        if( !status ) {
+            pluginError( "MovingHoldsCommand", "calcHolds", "Can't get AnimCurve function set" );
+            delete animCurveFn;
+            break;
+        }
+
+        if( !(status = snapshot.capture( *animCurveFn ))) {
+            delete animCurveFn;
+            break;
+        }
+
+        holdCurve.pAnimCurveFn = animCurveFn;
+        holdCurve.pAnimCache = NULL;
+        holdCurve.isStepped = AnimCurveCollector::isSteppedPlug( animCurves[i].plug );
+
+        calcCurveHolds( snapshot, holdCurve );
+
+        // Curves without holds don't need to be stored
+        if( holdCurve.holdTimes.empty() ) {
+            delete animCurveFn;
+            continue;
+        }
+
+        holdCurve.pAnimCache = new MAnimCurveChange();
+        holdCurves.push_back( holdCurve );
+
+        numHoldsInserted += (unsigned int)holdCurve.holdTimes.size();
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: calcCurveHolds
+// Desc: Calculates a hold for every pair of keys in the
+//       range.  Stepped (boolean/enum) curves hold the
+//       key's value without drifting.
+//*********************************************************
+void MovingHoldsCommand::calcCurveHolds( const AnimCurveSnapshot &snapshot,
+                                         HoldCurveACC &holdCurve )
+{
+    const std::vector<double> &keyTimes = snapshot.keyTimes;
+    const std::vector<double> &keyValues = snapshot.keyValues;
+
+    double driftFactor = holdCurve.isStepped ? 0.0 : holdDrift / 100.0;
+
+    holdCurve.holdTimes.clear();
+    holdCurve.holdValues.clear();
+
+    for( unsigned int index = 0; index + 1 < snapshot.numKeys(); index++ ) {
+        double holdTime = keyTimes[index] + holdOffset;
+
+        if( useStartTime && keyTimes[index] < startTime )
+            continue;
+        if( useEndTime && keyTimes[index + 1] > endTime )
+            break;
+
+        // The hold must fall between the keys and there is
+        // nothing to hold between keys of the same value
+        if( holdTime >= keyTimes[index + 1] || keyValues[index] == keyValues[index + 1] )
+            continue;
+
+        holdCurve.holdTimes.push_back( holdTime );
+        holdCurve.holdValues.push_back( keyValues[index] +
+                                        driftFactor * (keyValues[index + 1] - keyValues[index]) );
+    }
+}
+
+
+//*********************************************************
+// Name: insertHolds
+// Desc: Adds the holds to each curve in a single call
+//       and marks them as breakdowns if requested
+//*********************************************************
+MStatus MovingHoldsCommand::insertHolds()
+{
+    MStatus status = MS::kSuccess;
+    MTime::Unit uiUnit = MTime::uiUnit();
+
+    for( unsigned int i = 0; i < holdCurves.size() && status; i++ ) {
+        HoldCurveACC &holdCurve = holdCurves[i];
+        MTimeArray times;
+        MDoubleArray values;
+
+        for( unsigned int j = 0; j < holdCurve.holdTimes.size(); j++ ) {
+            times.append( MTime( holdCurve.holdTimes[j], uiUnit ));
+            values.append( holdCurve.holdValues[j] );
+        }
+
+        // Use stepped out tangents for holds on boolean attributes
+        MFnAnimCurve::TangentType outTangent = holdCurve.isStepped ?
+            MFnAnimCurve::kTangentStep : MFnAnimCurve::kTangentGlobal;
+
+        if( !(status = holdCurve.pAnimCurveFn->addKeys( &times, &values,
+                                                        MFnAnimCurve::kTangentGlobal,
+                                                        outTangent,
+                                                        true,
+                                                        holdCurve.pAnimCache ))) {
+            pluginError( "MovingHoldsCommand", "insertHolds", "Failed to add the hold keys" );
+            break;
+        }
+
+        if( tickDrawSpecial ) {
+            MPlug drawSpecPlugArray = holdCurve.pAnimCurveFn->findPlug( "keyTickDrawSpecial", &status );
+            if( !status ) {
+                pluginError( "MovingHoldsCommand", "insertHolds", "No MPlug with name keyTickDrawSpecial" );
+                break;
+            }
+
+            for( unsigned int j = 0; j < times.length(); j++ ) {
+                unsigned int keyIndex;
+                if( holdCurve.pAnimCurveFn->find( times[j], keyIndex ))
+                    tickDrawModifier.newPlugValueBool( drawSpecPlugArray.elementByLogicalIndex( keyIndex ), true );
+            }
+        }
+    }
+
+    if( status && tickDrawSpecial )
+        status = tickDrawModifier.doIt();
+
+    return status;
+}
@@ -0,0 +1,145 @@
+//*********************************************************
+// MovingHoldsCommand.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __MOVING_HOLDS_COMMAND_H_
+#define __MOVING_HOLDS_COMMAND_H_
+
+//*********************************************************
+#include <maya/MPxCommand.h>
+
+#include <maya/MGlobal.h>
+#include <maya/MTime.h>
+#include <maya/MTimeArray.h>
+#include <maya/MDoubleArray.h>
+#include <maya/MSyntax.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MSelectionList.h>
+#include <maya/MString.h>
+#include <maya/MPlug.h>
+#include <maya/MDGModifier.h>
+#include <maya/MAnimCurveChange.h>
+
+#include <maya/MFnAnimCurve.h>
+
+#include "AnimCurveCollector.h"
+#include "AnimCurveSnapshot.h"
+
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: MovingHoldsCommand
+//
+// Desc: Inserts a moving hold after every key on the
+//       selected objects' anim curves.  The hold is placed
+//       a number of frames after the key and drifts a
+//       percentage of the way toward the next key.
+//
+// Command: cieMovingHolds
+//
+// Flags: -offset (-o)           (double) frames after the key
+//
+//        -drift (-dr)           (double) percent toward the next key
+//
+//        -startTime (-st)       (double)
+//
+//        -endTime (-et)         (double)
+//
+//        -tickDrawSpecial (-tds)  (boolean)
+//
+//*********************************************************
+class MovingHoldsCommand : public MPxCommand
+{
+private:
+    // The holds calculated for a curve and its curve
+    // change cache (for undo/redo)
+    struct HoldCurveACC {
+        MFnAnimCurve* pAnimCurveFn;
+        MAnimCurveChange* pAnimCache;
+        bool isStepped;
+        std::vector<double> holdTimes;
+        std::vector<double> holdValues;
+    };
+
+    // Command flag constants
+    static const char *offsetFlag, *offsetLongFlag;
+    static const char *driftFlag, *driftLongFlag;
+    static const char *startTimeFlag, *startTimeLongFlag;
+    static const char *endTimeFlag, *endTimeLongFlag;
+    static const char *tickDrawSpecialFlag, *tickDrawSpecialLongFlag;
+
+    // The number of frames between a key and its hold
+    double holdOffset;
+
+    // The percentage of the way toward the next key's
+    // value the hold drifts
+    double holdDrift;
+
+    // Only key pairs inside the range get holds
+    bool useStartTime;
+    double startTime;
+    bool useEndTime;
+    double endTime;
+
+    // Use the special drawing state for the hold keys
+    bool tickDrawSpecial;
+
+    // The objects currently selected in the Maya scene
+    MSelectionList selectionList;
+
+    // Indicates that the anim curve caches have been
+    // calculated for undo/redo
+    bool initialized;
+
+    // The holds for each curve
+    std::vector<HoldCurveACC> holdCurves;
+
+    // Sets keyTickDrawSpecial on the hold keys (for undo/redo)
+    MDGModifier tickDrawModifier;
+
+    // The number of holds inserted
+    unsigned int numHoldsInserted;
+
+    // Method to setup the command flags
+    MStatus parseCommandFlags( const MArgList &args );
+
+    // Calculates the holds for every curve
+    MStatus calcHolds( const std::vector<AnimCurveInfo> &animCurves );
+
+    // Calculates the holds for a single curve
+    void calcCurveHolds( const AnimCurveSnapshot &snapshot,
+                         HoldCurveACC &holdCurve );
+
+    // Adds the holds to the curves
+    MStatus insertHolds();
+
+public:
+    // Constructor/Destructor
+    MovingHoldsCommand();
+    ~MovingHoldsCommand();
+
+    // Performs the command
+    virtual MStatus doIt( const MArgList &args );
+
+    // Performs the work that changes Maya's internal state
+    virtual MStatus redoIt();
+
+    // Undoes the changes to Maya's internal state
+    virtual MStatus undoIt();
+
+    // Indicates that Maya can undo/redo this command
+    virtual bool isUndoable() const { return true; }
+
+    // Allocates a command object to Maya (required)
+    static void *creator() { return new MovingHoldsCommand; }
+
+    // Defines the set of flags allowed by this command
+    static MSyntax newSyntax();
+};
+
+#endif
@@ -0,0 +1,41 @@
+//*********************************************************
+// NodeIds.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __NODE_IDS_H_
+#define __NODE_IDS_H_
+
+//*********************************************************
+// Node Ids
+//
+// Desc: The type ids of the plugin's nodes.  The ids are
+//       written into saved scenes, so every id is an
+//       offset into the block of ids registered with
+//       Autodesk for the plugin and must never change once
+//       a node has shipped.
+//
+//       The block is set by the build (ATB_NODE_ID_BLOCK
+//       in CMake, node_id_block in SCons).  Without it the
+//       ids fall back to Maya's local range (0x00000 -
+//       0x7ffff), which other in-house plugins use too.
+//       Those builds are for development only, scenes
+//       saved with them can't be opened once the block is
+//       set.
+//*********************************************************
+#ifndef ATB_NODE_ID_BLOCK
+    #define ATB_NODE_ID_BLOCK 0x0007F0A0
+
+    #ifndef _DEBUG
+        #pragma message( "ATB_NODE_ID_BLOCK isn't set, the node ids are in Maya's local range" )
+    #endif
+#endif
+
+// Offsets into the block, add new nodes at the end
+const unsigned int shotMaskNodeId = ATB_NODE_ID_BLOCK + 0x00;
+//*********************************************************
+
+#endif
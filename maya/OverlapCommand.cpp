@@ -0,0 +1,313 @@
+//*********************************************************
+// OverlapCommand.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "OverlapCommand.h"
+#include "ErrorReporting.h"
+
+#include <set>
+#include <iterator>
+//*********************************************************
+
+//*********************************************************
+// Constants
+//*********************************************************
+const char *OverlapCommand::modeFlag = "-m";
+const char *OverlapCommand::modeLongFlag = "-mode";
+const char *OverlapCommand::offsetFlag = "-o";
+const char *OverlapCommand::offsetLongFlag = "-offset";
+const char *OverlapCommand::tableFlag = "-tbl";
+const char *OverlapCommand::tableLongFlag = "-table";
+
+
+//*********************************************************
+// Name: OverlapCommand
+// Desc: Constructor
+//*********************************************************
+OverlapCommand::OverlapCommand()
+{
+    pluginTrace( "OverlapCommand", "OverlapCommand", "******* Overlap Command *******" );
+
+    numCurvesOffset = 0;
+
+    // Initialize the command flag defaults
+    overlapMode = kDepth;
+    offsetPerLevel = 1.0;
+}
+
+
+//*********************************************************
+// Name: ~OverlapCommand
+// Desc: Destructor
+//*********************************************************
+OverlapCommand::~OverlapCommand()
+{
+}
+
+
+//*********************************************************
+// Name: doIt
+// Desc: All of the one-time setup and initialization
+//       code for the overlap command.  doIt is called
+//       by Maya when any command is executed in MEL.
+//       Any code that changes the state of Maya is
+//       handled by the redoIt method.
+//*********************************************************
+MStatus OverlapCommand::doIt( const MArgList &args )
+{
+    MStatus status = MS::kFailure;
+    AnimCurveCollector collector;
+    std::vector<AnimCurveInfo> animCurves;
+
+    if( !parseCommandFlags( args )) {
+        pluginError( "OverlapCommand", "doIt", "Failed to parse command flags" );
+    }
+    else if( !AnimCurveCollector::getSelectedObjects( selectionList )) {
+        MGlobal::displayError( "No Objects Selected" );
+    }
+    else if( !collector.getAnimCurves( selectionList, animCurves )) {
+        pluginError( "OverlapCommand", "doIt", "Failed to get the anim curves" );
+    }
+    else if( animCurves.empty() ) {
+        MGlobal::displayError( "No Keys Set" );
+    }
+    else if( !calcCurveShifts( animCurves )) {
+        pluginError( "OverlapCommand", "doIt", "Failed to calculate the curve offsets" );
+    }
+    else if( !(status = redoIt() )) {
+        pluginError( "OverlapCommand", "doIt", "Failed to redoIt" );
+    }
+    else {
+        MString result( "Result: " );
+        MGlobal::displayInfo( result + numCurvesOffset );
+
+        setResult( (int)numCurvesOffset );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: redoIt
+// Desc: Contains the code that changes the internal state
+//       of Maya.  It is called by Maya to redo.
+//*********************************************************
+MStatus OverlapCommand::redoIt()
+{
+    return applyCurveShifts( 1.0 );
+}
+
+
+//*********************************************************
+// Name: undoIt
+// Desc: Contains the code to undo the internal state
+//       changes made by the overlap command (redoIt).
+//       Only the shift per curve is stored, so undo
+//       shifts each curve back.
+//*********************************************************
+MStatus OverlapCommand::undoIt()
+{
+    return applyCurveShifts( -1.0 );
+}
+
+
+//*********************************************************
+// Name: newSyntax
+// Desc: Method for registering the command flags
+//       with Maya
+//*********************************************************
+MSyntax OverlapCommand::newSyntax()
+{
+    MSyntax syntax;
+    syntax.addFlag( modeFlag, modeLongFlag, MSyntax::kString );
+    syntax.addFlag( offsetFlag, offsetLongFlag, MSyntax::kDouble );
+    syntax.addFlag( tableFlag, tableLongFlag, MSyntax::kString, MSyntax::kDouble );
+
+    syntax.makeFlagMultiUse( tableFlag );
+
+    return syntax;
+}
+
+
+//*********************************************************
+// Name: parseCommandFlags
+// Desc: Parse the command flags and stores the values
+//       in the appropriate variables
+//*********************************************************
+MStatus OverlapCommand::parseCommandFlags( const MArgList &args )
+{
+    MStatus status = MS::kSuccess;
+
+    MArgDatabase argData( syntax(), args, &status );
+    if( !status ) {
+        pluginError( "OverlapCommand", "parseCommandFlags",
+                     "Failed to create MArgDatabase for the overlap command" );
+    }
+    else {
+        if( argData.isFlagSet( offsetFlag ))
+            argData.getFlagArgument( offsetFlag, 0, offsetPerLevel );
+
+        // Giving a table implies table mode
+        unsigned int numTableEntries = argData.numberOfFlagUses( tableFlag );
+        if( numTableEntries > 0 )
+            overlapMode = kTable;
+
+        for( unsigned int i = 0; i < numTableEntries; i++ ) {
+            MArgList tableArgs;
+            argData.getFlagArgumentList( tableFlag, i, tableArgs );
+
+            tableNames.append( tableArgs.asString( 0 ));
+            tableOffsets.push_back( tableArgs.asDouble( 1 ));
+        }
+
+        if( argData.isFlagSet( modeFlag )) {
+            MString strMode;
+            argData.getFlagArgument( modeFlag, 0, strMode );
+
+            if( strMode == "depth" )
+                overlapMode = kDepth;
+            else if( strMode == "chain" )
+                overlapMode = kChain;
+            else if( strMode == "table" )
+                overlapMode = kTable;
+            else
+                MGlobal::displayWarning( "Invalid arguement for -mode.  Using default value." );
+        }
+
+        if( overlapMode == kTable && numTableEntries == 0 ) {
+            MGlobal::displayError( "Table mode requires at least one -table entry" );
+            status = MS::kFailure;
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: calcCurveShifts
+// Desc: Calculates the shift for every anim curve.  Depth
+//       and chain offsets are relative to the first
+//       object so it always stays in place.
+//*********************************************************
+MStatus OverlapCommand::calcCurveShifts( const std::vector<AnimCurveInfo> &animCurves )
+{
+    MStatus status = MS::kSuccess;
+    CurveShift curveShift;
+
+    std::vector<double> levels( animCurves.size(), 0.0 );
+    double minLevel = 0.0;
+
+    if( overlapMode == kDepth ) {
+        for( unsigned int i = 0; i < animCurves.size(); i++ ) {
+            levels[i] = (double)getDagDepth( animCurves[i].node );
+
+            if( i == 0 || levels[i] < minLevel )
+                minLevel = levels[i];
+        }
+    }
+    else if( overlapMode == kChain ) {
+        // Number the objects with curves in selection order
+        std::set<unsigned int> selectionIndices;
+        for( unsigned int i = 0; i < animCurves.size(); i++ )
+            selectionIndices.insert( animCurves[i].selectionIndex );
+
+        for( unsigned int i = 0; i < animCurves.size(); i++ )
+            levels[i] = (double)std::distance( selectionIndices.begin(),
+                                               selectionIndices.find( animCurves[i].selectionIndex ));
+    }
+
+    curveShifts.clear();
+    curveShifts.reserve( animCurves.size() );
+
+    for( unsigned int i = 0; i < animCurves.size(); i++ ) {
+        if( overlapMode == kTable )
+            curveShift.numFrames = getTableOffset( animCurves[i].node );
+        else
+            curveShift.numFrames = (levels[i] - minLevel) * offsetPerLevel;
+
+        // Curves that don't move don't need to be stored
+        if( curveShift.numFrames == 0.0 )
+            continue;
+
+        curveShift.animCurve = animCurves[i].animCurve;
+        curveShifts.push_back( curveShift );
+    }
+
+    numCurvesOffset = (unsigned int)curveShifts.size();
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: getDagDepth
+// Desc: Returns the depth of the node in the DAG.  DG
+//       nodes (ie character sets) have a depth of 0.
+//*********************************************************
+unsigned int OverlapCommand::getDagDepth( const MObject &node )
+{
+    MDagPath dagPath;
+
+    if( !node.hasFn( MFn::kDagNode ) || !MDagPath::getAPathTo( node, dagPath ))
+        return 0;
+
+    return dagPath.length();
+}
+
+
+//*********************************************************
+// Name: getTableOffset
+// Desc: Returns the offset in the table for the node.
+//       Nodes that aren't in the table are not moved.
+//*********************************************************
+double OverlapCommand::getTableOffset( const MObject &node )
+{
+    MFnDependencyNode dependFn( node );
+    MString nodeName = dependFn.name();
+
+    for( unsigned int i = 0; i < tableNames.length(); i++ ) {
+        if( tableNames[i] == nodeName )
+            return tableOffsets[i];
+    }
+
+    return 0.0;
+}
+
+
+//*********************************************************
+// Name: applyCurveShifts
+// Desc: Shifts all of the curves by their shift times the
+//       direction (1 to apply, -1 to revert)
+//*********************************************************
+MStatus OverlapCommand::applyCurveShifts( double direction )
+{
+    MStatus status = MS::kSuccess;
+
+    for( unsigned int i = 0; i < curveShifts.size(); i++ ) {
+        // Skip curves deleted since the command ran
+        if( !curveShifts[i].animCurve.isValid() )
+            continue;
+
+        MFnAnimCurve animCurveFn( curveShifts[i].animCurve.object(), &status );
+        if( !status ) {
+            pluginError( "OverlapCommand", "applyCurveShifts", "Can't get AnimCurve function set" );
+            break;
+        }
+
+        if( !(status = AnimCurveSnapshot::shiftKeyTimes( animCurveFn,
+                                                         curveShifts[i].numFrames * direction,
+                                                         NULL ))) {
+            pluginError( "OverlapCommand", "applyCurveShifts", "Failed to shift the keys" );
+            break;
+        }
+    }
+
+    return status;
+}
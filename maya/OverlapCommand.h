@@ -0,0 +1,131 @@
+//*********************************************************
+// OverlapCommand.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __OVERLAP_COMMAND_H_
+#define __OVERLAP_COMMAND_H_
+
+//*********************************************************
+#include <maya/MPxCommand.h>
+
+#include <maya/MGlobal.h>
+#include <maya/MSyntax.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MSelectionList.h>
+#include <maya/MString.h>
+#include <maya/MDagPath.h>
+#include <maya/MObjectHandle.h>
+
+#include <maya/MFnDependencyNode.h>
+#include <maya/MFnAnimCurve.h>
+
+#include "AnimCurveCollector.h"
+#include "AnimCurveSnapshot.h"
+
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: OverlapCommand
+//
+// Desc: Offsets the anim curves of the selected objects in
+//       time to create follow through and overlap.  The
+//       offset for each object depends on its depth in the
+//       DAG, its position in the selection or a table of
+//       values given to the command.
+//
+// Command: cieOverlap
+//
+// Flags: -mode (-m)         (string) depth, chain or table
+//
+//        -offset (-o)       (double) frames per level
+//
+//        -table (-tbl)      (string, double) multi-use
+//
+//*********************************************************
+class OverlapCommand : public MPxCommand
+{
+public:
+    // The ways an offset can be assigned to an object
+    enum OverlapMode {
+        kDepth,
+        kChain,
+        kTable
+    };
+
+private:
+    // The time shift applied to a curve (for undo/redo)
+    struct CurveShift {
+        MObjectHandle animCurve;
+        double numFrames;
+    };
+
+    // Command flag constants
+    static const char *modeFlag, *modeLongFlag;
+    static const char *offsetFlag, *offsetLongFlag;
+    static const char *tableFlag, *tableLongFlag;
+
+    // How offsets are assigned
+    OverlapMode overlapMode;
+
+    // The number of frames per depth level/chain index
+    double offsetPerLevel;
+
+    // The node names and offsets given with -table
+    MStringArray tableNames;
+    std::vector<double> tableOffsets;
+
+    // The objects currently selected in the Maya scene
+    MSelectionList selectionList;
+
+    // The shift applied to each curve
+    std::vector<CurveShift> curveShifts;
+
+    // The number of curves offset
+    unsigned int numCurvesOffset;
+
+    // Method to setup the command flags
+    MStatus parseCommandFlags( const MArgList &args );
+
+    // Calculates the shift for every anim curve
+    MStatus calcCurveShifts( const std::vector<AnimCurveInfo> &animCurves );
+
+    // Returns the depth of the node in the DAG (0 for DG nodes)
+    unsigned int getDagDepth( const MObject &node );
+
+    // Returns the offset in the table for the node
+    double getTableOffset( const MObject &node );
+
+    // Shifts all of the curves by their shift times the
+    // direction (1 to apply, -1 to revert)
+    MStatus applyCurveShifts( double direction );
+
+public:
+    // Constructor/Destructor
+    OverlapCommand();
+    ~OverlapCommand();
+
+    // Performs the command
+    virtual MStatus doIt( const MArgList &args );
+
+    // Performs the work that changes Maya's internal state
+    virtual MStatus redoIt();
+
+    // Undoes the changes to Maya's internal state
+    virtual MStatus undoIt();
+
+    // Indicates that Maya can undo/redo this command
+    virtual bool isUndoable() const { return true; }
+
+    // Allocates a command object to Maya (required)
+    static void *creator() { return new OverlapCommand; }
+
+    // Defines the set of flags allowed by this command
+    static MSyntax newSyntax();
+};
+
+#endif
@@ -0,0 +1,31 @@
+//*********************************************************
+// ParallelFor.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __PARALLEL_FOR_H_
+#define __PARALLEL_FOR_H_
+
+//*********************************************************
+#include "ThreadPool.h"
+
+#include <functional>
+//*********************************************************
+
+//*********************************************************
+// Name: parallelFor
+// Desc: Calls function( i ) for every i in [0, count) on
+//       the plugin's thread pool and returns once every
+//       call has finished.  The function must not use the
+//       Maya API, which is only safe on the main thread.
+//*********************************************************
+template <typename Function>
+void parallelFor( unsigned int count, const Function &function )
+{
+    g_threadPool.run( count, std::function<void( unsigned int )>( function ));
+}
+
+#endif
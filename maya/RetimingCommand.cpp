@@ -8,6 +8,7 @@
 
 //*********************************************************
 #include "RetimingCommand.h"
+#include "AnimCurveCollector.h"
 #include "ErrorReporting.h"
 //*********************************************************
 
@@ -20,6 +21,23 @@ const char *RetimingCommand::deltaFlag = "-d";
 const char *RetimingCommand::deltaLongFlag = "-delta";
 const char *RetimingCommand::nextKeyOnCompleteFlag = "-nkc";
 const char *RetimingCommand::nextKeyOnCompleteLongFlag = "-nextKeyOnComplete";
+const char *RetimingCommand::previewFlag = "-pv";
+const char *RetimingCommand::previewLongFlag = "-preview";
+const char *RetimingCommand::commitFlag = "-cm";
+const char *RetimingCommand::commitLongFlag = "-commit";
+const char *RetimingCommand::discardFlag = "-dis";
+const char *RetimingCommand::discardLongFlag = "-discard";
+
+std::list<RetimingCommand::RetimingPreview> RetimingCommand::previewList;
+MTime RetimingCommand::previewOrigPlayheadTime;
+MTime RetimingCommand::previewPlayheadTime;
+MCallbackIdArray RetimingCommand::sceneCallbackIds;
+RetimingCommand *RetimingCommand::lastRetimingCommand = NULL;
+
+// The dynamic attribute that marks a time remap as a
+// retiming preview
+static const char *previewTagLongName = "retimePreview";
+static const char *previewTagName = "rtpv";
 
 
 //*********************************************************
@@ -44,6 +62,11 @@ RetimingCommand::RetimingCommand()
     relativeMode = false;
     timingDelta = 1;
     nextKeyOnComplete = false;
+    previewMode = false;
+    commitMode = false;
+    discardMode = false;
+    mergeMode = false;
+    undone = false;
 
 }
 
@@ -61,10 +84,13 @@ RetimingCommand::~RetimingCommand()
         while( animCurveListIter != animCurveFnList.end() ) {
 
             delete (*animCurveListIter).pAnimCurveFn;
-            delete (*animCurveListIter).pAnimCache;
             animCurveListIter++;
         }
     }
+
+    // Maya has flushed this command from the undo queue
+    if( lastRetimingCommand == this )
+        lastRetimingCommand = NULL;
 }
 
 
@@ -84,6 +110,21 @@ MStatus RetimingCommand::doIt(const MArgList &args)
     if( !parseCommandFlags( args )) {
         pluginError( "RetimingCommand", "doIt", "Failed to parse command flags" );
     }
+    // Committing/discarding a preview doesn't depend on the
+    // current selection or range
+    else if( commitMode || discardMode ) {
+        if( !(status = redoIt() )) {
+            pluginError( "RetimingCommand", "doIt", "Failed to redoIt" );
+        }
+        else {
+            MString result( "Result: " );
+            MGlobal::displayInfo( result + numRetimed );
+            setResult( (int)numRetimed );
+        }
+
+        // A commit has no range to merge with
+        lastRetimingCommand = NULL;
+    }
     // Get a list of the currently selected objects
     else if( !getSelectedObjects() ) {
         // Query mode will still be a success if no objects are selected
@@ -116,6 +157,11 @@ MStatus RetimingCommand::doIt(const MArgList &args)
     }
 
     else {
+        // Repeated retimings of the same keys are merged
+        // into a single undo
+        if( !queryMode && !previewMode )
+            mergeMode = canMergeWithLast();
+
         // Execute all operations that change the state of Maya
         if( !(status = redoIt() )) {
             pluginError( "RetimingCommand", "doIt", "Failed to redoIt" );
@@ -125,6 +171,9 @@ MStatus RetimingCommand::doIt(const MArgList &args)
                 setResult( stripString );
             }
             else {
+                if( !previewMode && !mergeMode )
+                    lastRetimingCommand = this;
+
                 MString result( "Result: " );
                 MGlobal::displayInfo( result + numRetimed );
 
@@ -148,28 +197,38 @@ MStatus RetimingCommand::redoIt()
     MStatus status = MS::kSuccess;
 
     if( !initialized ) {
-        status = retime();
+        if( commitMode )
+            status = commitPreview();
+        else if( discardMode )
+            status = discardPreview();
+        else
+            status = retime();
         initialized = true;
     }
     else {
-        // Just use the anim curve cache to redo
+        // Just use the journal to redo
         if( !animCurveFnList.empty()) {
             animCurveListIter = animCurveFnList.begin();
 
             while( animCurveListIter != animCurveFnList.end() ) {
-                // Be sure to skip any NULL pointers
-                if( (*animCurveListIter).pAnimCache != NULL )
-                    ((*animCurveListIter).pAnimCache)->redoIt();
+                // Skip curves that weren't changed
+                if( !(*animCurveListIter).origKeyTimes.empty() )
+                    AnimCurveSnapshot::writeKeyTimes( *(*animCurveListIter).pAnimCurveFn,
+                                                      (*animCurveListIter).origKeyTimes,
+                                                      (*animCurveListIter).finalKeyTimes,
+                                                      NULL );
 
                 animCurveListIter++;
             }
         }
+
+        undone = false;
     }
     // if there have been no errors and at least one key 
     // has been retimed
     // ** Note: Don't change the current time when querying **
     // It will break middle mouse timeline dragging
-    if( status && !animCurveFnList.empty() && !queryMode )
+    if( status && (!animCurveFnList.empty() || discardMode) && !queryMode )
         MAnimControl::setCurrentTime( newPlayheadTime );
 
     return status;
@@ -186,14 +245,17 @@ MStatus RetimingCommand::undoIt()
 {
     MStatus status = MS::kSuccess;
 
-    // Use the anim curve cache to undo
+    // Use the journal to undo
     if( !animCurveFnList.empty()) {
         animCurveListIter = animCurveFnList.begin();
 
         while( animCurveListIter != animCurveFnList.end() ) {
-            // Be sure to skip any NULL pointers
-            if( (*animCurveListIter).pAnimCache != NULL )
-                    ((*animCurveListIter).pAnimCache)->undoIt();
+            // Skip curves that weren't changed
+            if( !(*animCurveListIter).origKeyTimes.empty() )
+                AnimCurveSnapshot::writeKeyTimes( *(*animCurveListIter).pAnimCurveFn,
+                                                  (*animCurveListIter).finalKeyTimes,
+                                                  (*animCurveListIter).origKeyTimes,
+                                                  NULL );
 
             animCurveListIter++;
         }
@@ -201,6 +263,8 @@ MStatus RetimingCommand::undoIt()
 
     MAnimControl::setCurrentTime( origPlayheadTime );
 
+    undone = true;
+
     return status;
 }
 
@@ -218,6 +282,9 @@ MSyntax RetimingCommand::newSyntax()
     syntax.addFlag( relativeFlag, relativeLongFlag, MSyntax::kBoolean );
     syntax.addFlag( deltaFlag, deltaLongFlag, MSyntax::kLong );
     syntax.addFlag( nextKeyOnCompleteFlag, nextKeyOnCompleteLongFlag, MSyntax::kBoolean );
+    syntax.addFlag( previewFlag, previewLongFlag, MSyntax::kNoArg );
+    syntax.addFlag( commitFlag, commitLongFlag, MSyntax::kNoArg );
+    syntax.addFlag( discardFlag, discardLongFlag, MSyntax::kNoArg );
 
     syntax.enableQuery();
 
@@ -252,11 +319,29 @@ MStatus RetimingCommand::parseCommandFlags(const MArgList &args)
 
         if( argData.isFlagSet( nextKeyOnCompleteFlag ) && !queryMode )
             argData.getFlagArgument( nextKeyOnCompleteFlag, 0, nextKeyOnComplete );
+
+        if( !queryMode ) {
+            previewMode = argData.isFlagSet( previewFlag );
+            commitMode = argData.isFlagSet( commitFlag );
+            discardMode = argData.isFlagSet( discardFlag );
+        }
+
+        if( (previewMode + commitMode + discardMode) > 1 ) {
+            MGlobal::displayError( "Only one of -preview, -commit and -discard can be used" );
+            status = MS::kFailure;
+        }
+        // Editing curves under a preview would be hidden by
+        // the time remap, so the preview must be resolved first
+        else if( !queryMode && !previewMode && !commitMode && !discardMode &&
+                 !previewList.empty() ) {
+            MGlobal::displayError( "Commit or discard the retiming preview first" );
+            status = MS::kFailure;
+        }
     }
 
     // Absolute value retimings cannot be < 1
     // Relative retimings can be positive or negative
-    if( (timingDelta < 1) && !relativeMode ) {
+    if( status && (timingDelta < 1) && !relativeMode ) {
         MGlobal::displayError( "Absolute retiming values must be greater than 0" );
         status = MS::kFailure;
     }
@@ -272,48 +357,13 @@ MStatus RetimingCommand::parseCommandFlags(const MArgList &args)
 //*********************************************************
 MStatus RetimingCommand::getSelectedObjects()
 {
-    MStatus status = MS::kFailure;
-    MSelectionList characterSetList;
-
-    selectionList.clear();
-
-    // Selected Objects Include:
-    //    1) The Active Character Set (if in use) and its subset
-    //    2) Character Sets selected by the user (and their subsets)
-    //    3) Objects selected by the user
-
-    // Get the character set if active (in Maya) and the associated character set subsets
-    MStringArray characterSets;
-    MGlobal::executeCommand( MString("cie_atbGetActiveCharacterSets"), characterSets, false, false );
-
-    // Create a selection list with all the character set/subsets
-    for( unsigned int i = 0; i < characterSets.length(); i++ ) {
-        MGlobal::getSelectionListByName( characterSets[i], characterSetList );
-    }
+    MStatus status = AnimCurveCollector::getSelectedObjects( selectionList );
 
-    // Get the character sets selected (by user) and the associated character set subsets 
-    MGlobal::executeCommand( MString("cie_atbGetSelectedCharacterSets"), characterSets, false, false);
-
-    // Append to the selection list with all the selected character set/subsets
-    for( unsigned int i = 0; i < characterSets.length(); i++ ) {
-        MGlobal::getSelectionListByName( characterSets[i], characterSetList );
-    }
-
-    // Retrive all of the currently selected objects
-    if( !MGlobal::getActiveSelectionList( selectionList )) {
-        pluginError( "RetimingCommand", "getSelectedObjects", "Failed to get active selection list" );
-    }
     // At least one object must be selected for this command
-    else if( characterSetList.length() == 0 && selectionList.length() == 0 ) {
-        if( !queryMode ) {
-            pluginError( "RetimingCommand", "getSelectedObjects", "No Objects Selected" );
-            MGlobal::displayError( "No Objects Selected" );
-        }
+    if( !status && !queryMode ) {
+        pluginError( "RetimingCommand", "getSelectedObjects", "No Objects Selected" );
+        MGlobal::displayError( "No Objects Selected" );
     }
-    else
-        status = MS::kSuccess;
-
-    selectionList.merge( characterSetList );
 
     return status;
 }
@@ -322,151 +372,31 @@ MStatus RetimingCommand::getSelectedObjects()
 //*********************************************************
 // Name: getAnimCurveFnList
 // Desc: Generates a list of anim curve function sets to
-//       be operated on
+//       be operated on, the curves are found by the anim
+//       curve collector
 //*********************************************************
 MStatus RetimingCommand::getAnimCurveFnList()
 {
-    //pluginTrace( "RetimingCommand", "getAnimCurveFnList", "***" );
-
     MStatus status = MS::kSuccess;
+    AnimCurveCollector collector;
+    std::vector<AnimCurveInfo> animCurves;
+    AnimCurveFnACC animCurveFnACC;
 
-    MObject dependNode;
-    MPlugArray plugArray;
-
-    // Create an iterator to traverse the selection list
-    MItSelectionList sIter( selectionList, MFn::kInvalid, &status );
-    if( !status ) {
-        pluginError( "RetimingCommand", "getAnimCurveFnList", "Failed to creation SL iterator" );
+    if( !(status = collector.getAnimCurves( selectionList, animCurves ))) {
+        pluginError( "RetimingCommand", "getAnimCurveFnList", "Failed to get the anim curves" );
+        return status;
     }
-    else {
 
-        // Traverse all of the dependency nodes for the selected objects
-        for( ; !sIter.isDone(); sIter.next() ) {
-            // Get the current dependency node
-            if( !sIter.getDependNode( dependNode )) {
-                pluginError( "RetimingCommand", "getAnimCurveFnList", "Couldn't get dependency node" );
-                status = MS::kFailure;
-                break;
-            }
-
-            // The call to get connections doesn't clear the array
-            // so me must do it manually
-            plugArray.clear();
-
-            // Get all of the connections to this dependency node
-            MFnDependencyNode dependFn( dependNode );
-            if( !dependFn.getConnections( plugArray )) {
-                // This object has no animation curves... no keys to worry about
-                pluginTrace( "RetimingCommand", "getAnimCurveFnList", "No keys on object" );
-                continue;
-            }
-
-            // Generate the list from the plugs
-            if( !getAnimCurveFnListFromPlugs( plugArray )) {
-                pluginError( "RetimingCommand", "getAnimCurveFnList", "Failed to create list from Plugs" );
-                status = MS::kFailure;
-                break;
-            } 
+    for( unsigned int i = 0; i < animCurves.size(); i++ ) {
+        MFnAnimCurve *animCurveFn = new MFnAnimCurve( animCurves[i].animCurve, &status );
+        if( !status ) {
+            pluginError( "RetimingCommand", "getAnimCurveFnList", "Can't get AnimCurve function set" );
+            delete animCurveFn;
+            break;
         }
-    }
-
-    return status;
-}
-
-
-//*********************************************************
-// Name: getAnimCurveFnListFromPlugs
-// Desc: Generates a list of anim curve function sets from
-//       an array of plugs
-//*********************************************************
-MStatus RetimingCommand::getAnimCurveFnListFromPlugs( MPlugArray plugArray )
-{
-    //pluginTrace( "RetimingCommand", "getAnimCurveFnListFromPlugs", "***" );
-    MStatus status = MS::kSuccess;
-    AnimCurveFnACC animCurveFnACC;
-
-    //for( unsigned int i = 0; i < plugArray.length(); i++ )
-    //    pluginTrace( "RetimingCommand", "getAnimCurveFnListFromPlugs", MString("Plug Name: ") + plugArray[i].name() );
 
-    // Check each connection for an upstream connections that is a kAnimCurve
-    for( unsigned int index = 0; index < plugArray.length(); index++ )
-    {
-        if( plugArray[index].isKeyable() && !plugArray[index].isLocked() )
-        {
-            // Create an iterator that will exclusively traverse AnimCurve nodes
-            MPlug currentPlug = plugArray[index];
-            MItDependencyGraph dgIter( currentPlug,
-                                       MFn::kAnimCurve,
-                                       MItDependencyGraph::kUpstream,
-                                       MItDependencyGraph::kBreadthFirst,
-                                       MItDependencyGraph::kNodeLevel,
-                                       &status );
-            if( !status ) {
-                pluginError( "RetimingCommand", "getAnimCurveFnListFromPlugs", "DG Iterator error" );
-            }
-            else {
-                // Retrieve the anim curve function sets
-                // and store them in the list
-                for( ; !dgIter.isDone(); dgIter.next() )
-                {
-                    MObjectArray nodePath;
-                    dgIter.getNodePath( nodePath );
-/*                  
-                    // *** Original solution that didn't support Blend/Charater nodes ***
-                    // Only use the anim curves directly connected to the attributes
-                    // >1 on a breadth first search is level 2.  Root will always be
-                    // last in path
-                    if( nodePath.length() > 2 )
-                        break;
-*/
-
-                    // At a depth of 1 in the DAG, the animation nodes are directly 
-                    // connected to animated object.  However, if the depth is greater
-                    // than one then we must accomodate both PairBlend nodes and 
-                    // Character Set nodes (which sit between the transform node and
-                    // the anim nodes.
-                    int nodeParentIndex = 1;
-                    if( nodePath.length() <= 2 || 
-                        (nodePath.length() == 3 && 
-                            (nodePath[nodeParentIndex].apiType() == MFn::kPairBlend ||
-                            nodePath[nodeParentIndex].apiType() == MFn::kCharacter ))
-                        )
-                    {
-                        MObject anim = dgIter.thisNode( &status );
-                        MFnAnimCurve *animCurveFn = new MFnAnimCurve( anim, &status );
-
-                        // Avoid adding duplicate anim curves to the list
-                        // Important when dealing with blend nodes
-                        MString curveName = animCurveFn->name();
-                        bool nameExists = false;
-
-                        animCurveListIter = animCurveFnList.begin();
-                        while( animCurveListIter != animCurveFnList.end() ) {
-                            if( ((AnimCurveFnACC)*animCurveListIter).pAnimCurveFn->name() == curveName ) {
-                                nameExists = true;
-                                break;
-                            }
-                            animCurveListIter++;
-                        }
-
-                        if( !nameExists ) {
-                            //pluginTrace( "RetimingCommand", "getAnimCurveFnListFromPlugs", MString("adding curve:") + animCurveFn->name() );
-
-                            if( !status ) {
-                                pluginError( "RetimingCommand", "getAnimCurveFnListFromPlugs", "Can't get AnimCurve function set" );
-                                delete animCurveFn;
-                            }
-                            // If there are no problems, add the function set to the list
-                            else {
-                                animCurveFnACC.pAnimCurveFn = animCurveFn;
-                                animCurveFnACC.pAnimCache = new MAnimCurveChange();
-                                animCurveFnList.push_back( animCurveFnACC );
-                            }
-                        }
-                    }
-                }
-            }
-        }
+        animCurveFnACC.pAnimCurveFn = animCurveFn;
+        animCurveFnList.push_back( animCurveFnACC );
     }
 
     return status;
@@ -529,15 +459,39 @@ MStatus RetimingCommand::retime()
 
     MStatus status = MS::kSuccess;
 
+    bool firstPreview = previewList.empty();
+
+    // When merging, the changes are recorded in the last
+    // command's journal (its curves are in the same order)
+    std::list<AnimCurveFnACC>::iterator journalIter;
+    if( mergeMode )
+        journalIter = lastRetimingCommand->animCurveFnList.begin();
+
     // Retime each individual anim curve in the list
     animCurveListIter = animCurveFnList.begin();
     while( (animCurveListIter != animCurveFnList.end()) && (status == MS::kSuccess) )
     {
-        status = retimeAnimCurve( *animCurveListIter );
+        if( mergeMode ) {
+            status = retimeAnimCurve( *animCurveListIter, *journalIter );
+            journalIter++;
+        }
+        else
+            status = retimeAnimCurve( *animCurveListIter, *animCurveListIter );
 
         animCurveListIter++;
     }
 
+    // The merged command now ends where this one does
+    if( mergeMode && status )
+        lastRetimingCommand->newPlayheadTime = newPlayheadTime;
+
+    // Remember the playhead so commit/discard can restore it
+    if( previewMode && status ) {
+        if( firstPreview )
+            previewOrigPlayheadTime = origPlayheadTime;
+        previewPlayheadTime = newPlayheadTime;
+    }
+
     //pluginTrace( "RetimingCommand", "retimeAbsolute", "completed" );
     return status;
 }
@@ -545,282 +499,611 @@ MStatus RetimingCommand::retime()
 
 //*********************************************************
 // Name: retimeAnimCurve
-// Desc: Traverses all keyframes in the given range and
-//       retimes them to the absolute delta value 
+// Desc: Retimes the anim curve in memory, then writes the
+//       new key times to the curve or, in preview mode,
+//       to the curve's time remap
 //*********************************************************
-MStatus RetimingCommand::retimeAnimCurve( AnimCurveFnACC &animCurveACC )
+MStatus RetimingCommand::retimeAnimCurve( AnimCurveFnACC &animCurveACC,
+                                          AnimCurveFnACC &journalACC )
 {
     //pluginTrace( "RetimingCommand", "retimeAnimCurve", "***" );
-    
+
     MStatus status = MS::kSuccess;
     MFnAnimCurve *animCurve = animCurveACC.pAnimCurveFn;
-    
-    unsigned int numKeys = animCurve->numKeys( &status );
+
+    AnimCurveSnapshot snapshot;
+    std::vector<double> newKeyTimes;
     unsigned int firstRetimingIndex = 0;
     unsigned int lastRetimingIndex = 0;
 
-    // Find the index of the last key NOT to be moved -- the anchor
-    unsigned int closestIndex = animCurve->findClosest( rangeStartTime, &status );
-    if( !status ) {
-        pluginError( "RetimingCommand", "retimeAnimCurve", "Couldn't find closest key" );
+    if( !(status = snapshot.capture( *animCurve ))) {
+        pluginError( "RetimingCommand", "retimeAnimCurve", "Couldn't read the anim curve" );
+        return status;
     }
-    MTime closestTime = animCurve->time( closestIndex, &status );
-    if( !status ) {
-        pluginError( "RetimingCommand", "retimeAnimCurve", "Couldn't find closest time" );
+
+    // Nothing to retime on an empty curve
+    if( snapshot.numKeys() == 0 )
+        return status;
+
+    // A curve being previewed is retimed from its
+    // previewed times so that previews build on each other
+    MObject animCurveObj = animCurve->object();
+    RetimingPreview *pPreview = findPreview( animCurveObj );
+    if( pPreview != NULL )
+        snapshot.keyTimes = pPreview->previewKeyTimes;
+
+    // The last key should never be less than the first key
+    if( !calcRetimedKeyTimes( snapshot, newKeyTimes, firstRetimingIndex, lastRetimingIndex )) {
+        pluginError( "RetimingCommand", "retimeAnimCurve", "RetimingStartIndex should always be less" );
+        status = MS::kFailure;
+    }
+
+    // We have all the required info to generate the query string
+    else if( queryMode ) {
+        generateStripString( snapshot.keyTimes, firstRetimingIndex, lastRetimingIndex );
+    }
+
+    // If the start and last indexes are the same, then there
+    // are no keys during/after the range.
+    else if( firstRetimingIndex == lastRetimingIndex ) {
+        // When skipping, don't move the playhead
+        newPlayheadTime = origPlayheadTime;
+    }
+
+    else {
+        // Move the play head to the last key in the retiming
+        // range when this flag is set, otherwise the first
+        if( nextKeyOnComplete )
+            newPlayheadTime = MTime( newKeyTimes[lastRetimingIndex], MTime::uiUnit() );
+        else
+            newPlayheadTime = MTime( newKeyTimes[firstRetimingIndex], MTime::uiUnit() );
+
+        // Keep track of the number of keys retimed
+        numRetimed += lastRetimingIndex - firstRetimingIndex;
+
+        if( previewMode ) {
+            bool newPreview = false;
+
+            if( pPreview == NULL ) {
+                previewList.push_back( RetimingPreview() );
+                pPreview = &previewList.back();
+                pPreview->animCurve = animCurveObj;
+                pPreview->origKeyTimes = snapshot.keyTimes;
+                newPreview = true;
+            }
+
+            pPreview->previewKeyTimes = newKeyTimes;
+
+            if( !(status = updatePreviewRemap( *pPreview ))) {
+                pluginError( "RetimingCommand", "retimeAnimCurve", "Failed to update the preview" );
+                if( newPreview )
+                    previewList.pop_back();
+            }
+        }
+        else if( (status = AnimCurveSnapshot::writeKeyTimes( *animCurve, snapshot.keyTimes,
+                                                             newKeyTimes, NULL ))) {
+            // Only the key times before the first retiming
+            // and after the latest one are kept
+            if( journalACC.origKeyTimes.empty() )
+                journalACC.origKeyTimes = snapshot.keyTimes;
+            journalACC.finalKeyTimes = newKeyTimes;
+        }
     }
 
+    return status;
+}
+
+
+//*********************************************************
+// Name: canMergeWithLast
+// Desc: Returns true if this retiming can be merged into
+//       the last retiming command.  It must be the next
+//       command to be undone, not have been undone, cover
+//       the same curves and range, and the curves must not
+//       have been changed since it ran.
+//*********************************************************
+bool RetimingCommand::canMergeWithLast()
+{
+    if( lastRetimingCommand == NULL || lastRetimingCommand == this ||
+        lastRetimingCommand->undone )
+        return false;
+
+    if( lastRetimingCommand->rangeStartTime != rangeStartTime ||
+        lastRetimingCommand->rangeEndTime != rangeEndTime ||
+        lastRetimingCommand->animCurveFnList.size() != animCurveFnList.size() )
+        return false;
+
+    // Something else may have been done since the last retiming
+    MString undoName;
+    MGlobal::executeCommand( "undoInfo -q -undoName", undoName );
+    if( undoName.length() < 11 || undoName.substring( 0, 10 ) != "cieRetiming" )
+        return false;
+
+    AnimCurveSnapshot snapshot;
+    std::list<AnimCurveFnACC>::iterator journalIter = lastRetimingCommand->animCurveFnList.begin();
+
+    for( animCurveListIter = animCurveFnList.begin();
+         animCurveListIter != animCurveFnList.end();
+         animCurveListIter++, journalIter++ ) {
+        MFnAnimCurve *animCurve = (*animCurveListIter).pAnimCurveFn;
+
+        if( animCurve->object() != (*journalIter).pAnimCurveFn->object() )
+            return false;
+
+        // Curves that were retimed must still have their
+        // retimed key times
+        if( !(*journalIter).finalKeyTimes.empty() ) {
+            if( !snapshot.capture( *animCurve ) ||
+                snapshot.keyTimes != (*journalIter).finalKeyTimes )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+//*********************************************************
+// Name: calcRetimedKeyTimes
+// Desc: Calculates the new time of every key on a curve
+//       from the retiming delta.  Keys in the range are
+//       retimed and all keys after it are shifted by the
+//       change to the last retimed key.
+//*********************************************************
+bool RetimingCommand::calcRetimedKeyTimes( const AnimCurveSnapshot &snapshot,
+                                           std::vector<double> &newKeyTimes,
+                                           unsigned int &firstRetimingIndex,
+                                           unsigned int &lastRetimingIndex )
+{
+    const std::vector<double> &keyTimes = snapshot.keyTimes;
+    unsigned int numKeys = snapshot.numKeys();
+
+    double rangeStart = rangeStartTime.as( MTime::uiUnit() );
+    double rangeEnd = rangeEndTime.as( MTime::uiUnit() );
+
+    // Find the index of the last key NOT to be moved -- the anchor
+    unsigned int closestIndex = snapshot.findClosest( rangeStart );
+
     firstRetimingIndex = closestIndex;
 
-    if( (closestTime > rangeStartTime) && (closestIndex > 0) )
+    if( (keyTimes[closestIndex] > rangeStart) && (closestIndex > 0) )
         firstRetimingIndex = closestIndex - 1;
 
     // Find the index of the last key TO BE RETIMED during this operation
     // All keys after this one will be shifted only
-    closestIndex = animCurve->findClosest( rangeEndTime, &status );
-    if( !status ) {
-        pluginError( "RetimingCommand", "retimeAnimCurve", "Couldn't find closest key" );
-    }
-    closestTime = animCurve->time( closestIndex, &status );
-    if( !status ) {
-        pluginError( "RetimingCommand", "retimeAnimCurve", "Couldn't find closest time" );
-    }
+    closestIndex = snapshot.findClosest( rangeEnd );
 
     lastRetimingIndex = closestIndex;
-    
+
     // When the closest frame is inside the time range, we need to move
     // to the next frame (after the end of the time range) if possible
-    if( (closestTime < rangeEndTime) && (closestIndex < (numKeys - 1)))
+    if( (keyTimes[closestIndex] < rangeEnd) && (closestIndex < (numKeys - 1)))
         lastRetimingIndex = closestIndex + 1;
 
-    //MString output( "startingIndex : lastIndex ---> " );
-    //pluginTrace( "RetimingCommand", "retimeAnimCurve",
-    //             output + firstRetimingIndex + " : " + lastRetimingIndex );
+    if( firstRetimingIndex > lastRetimingIndex )
+        return false;
 
-    // The last key should never be less than the first key
-    if( firstRetimingIndex > lastRetimingIndex ) {
-        pluginError( "RetimingCommand", "retimeAnimCurve", "RetimingStartIndex should always be less" );
-        status = MS::kFailure;
-    }
+    newKeyTimes = keyTimes;
 
-    // We have all the required info to generate the query string
-    else if( queryMode ) {
-        generateStripString( *(animCurveACC.pAnimCurveFn), firstRetimingIndex, lastRetimingIndex );
-    }
-    else { 
-        // If the start and last indexes are the same, then there
-        // are no keys during/after the range.  Additional processing
-        // can be skipped otherwise...
-        if( firstRetimingIndex < lastRetimingIndex ) {
-            MTime prevIndexMTime = animCurve->time( firstRetimingIndex );
-            double prevIndexTime = prevIndexMTime.value();
-
-            // Move the play head to the first key in the retiming
-            // range when this flag is not set
-            if( !nextKeyOnComplete )
-                newPlayheadTime = prevIndexMTime;
-
-            retimeAnimCurve( animCurveACC, firstRetimingIndex + 1, 
-                             lastRetimingIndex, prevIndexTime, prevIndexTime );
+    double prevIndexOrigTime = keyTimes[firstRetimingIndex];
+    double prevIndexNewTime = prevIndexOrigTime;
+
+    for( unsigned int index = firstRetimingIndex + 1; index <= lastRetimingIndex; index++ ) {
+        double currIndexNewTime;
+
+        // Caculate the new time for the current key differently based
+        // on absolute or relative values
+        if( relativeMode ) {
+            // Relative - shift the current key's time by the input delta *plus*
+            //            the time shift of the previous key
+            currIndexNewTime = keyTimes[index] + (double)timingDelta +
+                                    (prevIndexNewTime - prevIndexOrigTime);
+
+            // Make sure that when a relative retiming is negative,
+            // the retiming will result in no less than one frame between
+            // the current frame being shifted and its previous frame
+            if( (currIndexNewTime - prevIndexNewTime) < 1 ) {
+                currIndexNewTime = prevIndexNewTime + 1;
+            }
         }
-        else
-            // When skipping, don't move the playhead
-            newPlayheadTime = origPlayheadTime;
+        else {
+            // Absolute - The previous time plus the expected time between keys
+            currIndexNewTime = prevIndexNewTime + (double)timingDelta;
+        }
+
+        newKeyTimes[index] = currIndexNewTime;
+
+        prevIndexOrigTime = keyTimes[index];
+        prevIndexNewTime = currIndexNewTime;
     }
 
-    return status;
+    // All keys after the last retiming key are shifted by
+    // the same amount as the last retiming key
+    double lastRetimingKeyDelta = newKeyTimes[lastRetimingIndex] - keyTimes[lastRetimingIndex];
+
+    for( unsigned int index = lastRetimingIndex + 1; index < numKeys; index++ )
+        newKeyTimes[index] += lastRetimingKeyDelta;
+
+    return true;
 }
 
+
 //*********************************************************
-// Name: retimeAnimCurve
-// Desc: Traverses all keyframes in the given range and
-//       retimes them to the delta value 
+// Name: findPreview
+// Desc: Returns the preview for the curve (NULL if the
+//       curve is not being previewed)
 //*********************************************************
-MStatus RetimingCommand::retimeAnimCurve( AnimCurveFnACC &animCurveACC,
-                                          unsigned int currentIndex,
-                                          unsigned int lastRetimingIndex,
-                                          double prevIndexOrigTime,
-                                          double prevIndexNewTime )
+RetimingCommand::RetimingPreview *RetimingCommand::findPreview( const MObject &animCurve )
+{
+    std::list<RetimingPreview>::iterator previewIter = previewList.begin();
+
+    while( previewIter != previewList.end() ) {
+        if( (*previewIter).animCurve.isValid() &&
+            (*previewIter).animCurve.object() == animCurve )
+            return &(*previewIter);
+
+        previewIter++;
+    }
+
+    return NULL;
+}
+
+
+//*********************************************************
+// Name: updatePreviewRemap
+// Desc: Updates (or creates) the animCurveTT connected to
+//       the curve's input.  Each key maps a previewed key
+//       time back to the original key time, so the curve
+//       plays back with the new timing while its keys
+//       stay where they are.
+//*********************************************************
+MStatus RetimingCommand::updatePreviewRemap( RetimingPreview &preview )
 {
     MStatus status = MS::kSuccess;
-    MString outStr( "" );
+    MFnAnimCurve remapFn;
+    MTime::Unit uiUnit = MTime::uiUnit();
 
-    MFnAnimCurve *animCurve = animCurveACC.pAnimCurveFn;
+    if( !preview.timeRemap.isValid() ) {
+        MObject animCurve = preview.animCurve.object();
+        MFnDependencyNode animCurveFn( animCurve );
+
+        MPlug inputPlug = animCurveFn.findPlug( "input", true, &status );
+        if( !status ) {
+            pluginError( "RetimingCommand", "updatePreviewRemap", "Couldn't find the input plug" );
+        }
+        else if( inputPlug.isConnected() ) {
+            MGlobal::displayError( animCurveFn.name() + " has a connected input and can't be previewed" );
+            status = MS::kFailure;
+        }
+        else {
+            // The preview is not undoable, so the remap is
+            // created directly rather than through a modifier
+            MObject remap = remapFn.create( MFnAnimCurve::kAnimCurveTT, NULL, &status );
+            if( !status ) {
+                pluginError( "RetimingCommand", "updatePreviewRemap", "Couldn't create the time remap" );
+            }
+            else {
+                remapFn.setName( animCurveFn.name() + "_retimePreview" );
+
+                // Tagged so a remap left in a scene can be found
+                MFnNumericAttribute tagAttrFn;
+                MObject tagAttr = tagAttrFn.create( previewTagLongName, previewTagName,
+                                                    MFnNumericData::kBoolean, 1 );
+                remapFn.addAttribute( tagAttr );
+
+                MDGModifier dgModifier;
+                dgModifier.connect( remapFn.findPlug( "output", true ), inputPlug );
+                if( !(status = dgModifier.doIt() )) {
+                    pluginError( "RetimingCommand", "updatePreviewRemap", "Couldn't connect the time remap" );
+                }
 
-    // Store the time in frames
-    double currIndexOrigTime = 0.0;
-    double currIndexNewTime = 0.0;
-    double nextIndexOrigTime = 0.0;
-
-    MTime currIndexMTime;
-    MTime nextIndexMTime;
-
-    currIndexMTime = animCurve->time( currentIndex );
-    currIndexOrigTime = currIndexMTime.value();
-
-    // Caculate the new time for the current key differently based
-    // on absolute or relative values
-    if( relativeMode ) {
-        // Relative - shift the current key's time by the input delta *plus*
-        //            the time shift of the previous key
-        currIndexNewTime = currIndexOrigTime + (double)timingDelta +
-                                (prevIndexNewTime - prevIndexOrigTime);
-
-        // Make sure that when a relative retiming is negative,
-        // the retiming will result in no less than one frame between
-        // the current frame being shifted and its previous frame
-        if( (currIndexNewTime - prevIndexNewTime) < 1 ) {
-            currIndexNewTime = prevIndexNewTime + 1;
+                preview.timeRemap = remap;
+            }
         }
     }
     else {
-        // Absolute - The previous time plus the expected time between keys
-        currIndexNewTime = prevIndexNewTime + (double)timingDelta;
+        remapFn.setObject( preview.timeRemap.object() );
     }
 
-    MTime currIndexNewMTime( currIndexNewTime, MTime::uiUnit() );
-
-    // All retiming keys, except for the last one are handled the
-    // same.
-    if( currentIndex != lastRetimingIndex ) {
-        nextIndexMTime = animCurve->time( currentIndex + 1 );
-        nextIndexOrigTime = nextIndexMTime.value();
+    if( status ) {
+        // Replace the keys with the new preview times
+        while( remapFn.numKeys() > 0 )
+            remapFn.remove( remapFn.numKeys() - 1 );
+
+        MTimeArray times;
+        MDoubleArray values;
+        unsigned int numKeys = (unsigned int)preview.origKeyTimes.size();
+
+        // Time curves hold their values in seconds.  The
+        // extra keys a frame before and after give the
+        // linear infinity a slope of 1, so time outside
+        // the keys plays back at normal speed
+        times.append( MTime( preview.previewKeyTimes[0] - 1.0, uiUnit ));
+        values.append( MTime( preview.origKeyTimes[0] - 1.0, uiUnit ).as( MTime::kSeconds ));
+
+        for( unsigned int index = 0; index < numKeys; index++ ) {
+            times.append( MTime( preview.previewKeyTimes[index], uiUnit ));
+            values.append( MTime( preview.origKeyTimes[index], uiUnit ).as( MTime::kSeconds ));
+        }
 
-        //pluginTrace( "RetimingCommand", "retimeAnimCurve",
-        //             outStr + "[" + currentIndex + "]" + " Original Time: " + currIndexOrigTime + " New Time: " + currIndexNewTime );
+        times.append( MTime( preview.previewKeyTimes[numKeys - 1] + 1.0, uiUnit ));
+        values.append( MTime( preview.origKeyTimes[numKeys - 1] + 1.0, uiUnit ).as( MTime::kSeconds ));
 
-        // If the new time for the current key is going to be
-        // larger than the original time for the next frame,
-        // we must move the next frame first to prevent problems
-        if( currIndexNewTime >= nextIndexOrigTime ) {
-            retimeAnimCurve( animCurveACC, currentIndex + 1, 
-                             lastRetimingIndex, currIndexOrigTime, currIndexNewTime );
-            animCurve->setTime( currentIndex, currIndexNewMTime, animCurveACC.pAnimCache );
+        if( !(status = remapFn.addKeys( &times, &values,
+                                        MFnAnimCurve::kTangentLinear,
+                                        MFnAnimCurve::kTangentLinear ))) {
+            pluginError( "RetimingCommand", "updatePreviewRemap", "Couldn't key the time remap" );
         }
-        // If the new time for the current key is smaller,
-        // we will move it first to avoid problems with
-        // the next key possibly having a smaller value once
-        // it is retimed (if it were retimed first
         else {
-            animCurve->setTime( currentIndex, currIndexNewMTime, animCurveACC.pAnimCache );
-            retimeAnimCurve( animCurveACC, currentIndex + 1, 
-                             lastRetimingIndex, currIndexOrigTime, currIndexNewTime );
+            remapFn.setPreInfinityType( MFnAnimCurve::kLinear );
+            remapFn.setPostInfinityType( MFnAnimCurve::kLinear );
         }
+    }
 
-        // Keep track of the number of keys retimed
-        numRetimed++;
+    return status;
+}
+
+
+//*********************************************************
+// Name: commitPreview
+// Desc: Removes the time remaps and writes all previewed
+//       key times to their curves.  Only the key times
+//       are part of the undo.
+//*********************************************************
+MStatus RetimingCommand::commitPreview()
+{
+    MStatus status = MS::kSuccess;
+    MDGModifier dgModifier;
+    AnimCurveSnapshot snapshot;
+    AnimCurveFnACC animCurveFnACC;
+
+    std::list<RetimingPreview>::iterator previewIter;
+
+    if( previewList.empty() ) {
+        MGlobal::displayWarning( "No retiming preview to commit" );
+        return status;
     }
 
-    // Once the last retiming key is reached, all keys after it
-    // will need to be shifted as well
-    else {
-        // If there are no keys after the last key to be retimed,
-        // adjust its time and we're done
-        if( lastRetimingIndex == (animCurve->numKeys() - 1) ) {
-            animCurve->setTime( currentIndex, currIndexNewMTime, animCurveACC.pAnimCache );
+    // Remove the remaps first so the curves play back normally
+    for( previewIter = previewList.begin(); previewIter != previewList.end(); previewIter++ ) {
+        if( (*previewIter).timeRemap.isValid() )
+            dgModifier.deleteNode( (*previewIter).timeRemap.object() );
+    }
+    dgModifier.doIt();
+
+    for( previewIter = previewList.begin(); previewIter != previewList.end(); previewIter++ ) {
+        RetimingPreview &preview = *previewIter;
+
+        if( !preview.animCurve.isValid() )
+            continue;
+
+        MFnAnimCurve *animCurveFn = new MFnAnimCurve( preview.animCurve.object(), &status );
+
+        // Skip any curve whose keys were changed by hand
+        // while it was being previewed
+        if( !status || !snapshot.capture( *animCurveFn ) ||
+            snapshot.keyTimes != preview.origKeyTimes ) {
+            MGlobal::displayWarning( animCurveFn->name() + " was edited during the preview and will not be retimed" );
+            delete animCurveFn;
+            status = MS::kSuccess;
+            continue;
         }
-        // Otherwise we need to shift all keys after the last retiming keys
-        else {
 
-            double lastRetimingKeyDelta = currIndexNewTime - currIndexOrigTime;
+        animCurveFnACC.pAnimCurveFn = animCurveFn;
+        animCurveFnACC.origKeyTimes = preview.origKeyTimes;
+        animCurveFnACC.finalKeyTimes = preview.previewKeyTimes;
+        animCurveFnList.push_back( animCurveFnACC );
 
-            //pluginTrace( "RetimingCommand", "retimeAnimCurveAbs",
-            //             outStr + "Final Retiming Key Delta: " + lastRetimingKeyDelta );
+        if( !(status = AnimCurveSnapshot::writeKeyTimes( *animCurveFn, preview.origKeyTimes,
+                                                         preview.previewKeyTimes, NULL ))) {
+            pluginError( "RetimingCommand", "commitPreview", "Failed to write the key times" );
+            break;
+        }
 
-            if( lastRetimingKeyDelta > 0 ) {
-                // shift before updating the last retiming key
-                shiftRemainingKeys( animCurveACC, currentIndex + 1, lastRetimingKeyDelta );
-                animCurve->setTime( currentIndex, currIndexNewMTime, animCurveACC.pAnimCache );
-            }
-            else if( lastRetimingKeyDelta < 0 ) {
-                // update the last retiming key, then shift
-                animCurve->setTime( currentIndex, currIndexNewMTime, animCurveACC.pAnimCache );
-                shiftRemainingKeys( animCurveACC, currentIndex + 1, lastRetimingKeyDelta );
-            }
-            // if the lastRetimingDelta == 0, there is no need to shift the remaining keys   
+        for( unsigned int index = 0; index < preview.origKeyTimes.size(); index++ ) {
+            if( preview.origKeyTimes[index] != preview.previewKeyTimes[index] )
+                numRetimed++;
         }
+    }
 
-        // Move the play head to the last key in the retiming
-        // range when this flag is set
-        if( nextKeyOnComplete )
-            newPlayheadTime = currIndexNewMTime;
+    // Undo returns to where the playhead was before previewing
+    origPlayheadTime = previewOrigPlayheadTime;
+    newPlayheadTime = previewPlayheadTime;
+
+    previewList.clear();
 
-        // Keep track of the number of keys retimed (including the last one)
-        numRetimed++;
+    return status;
+}
+
+
+//*********************************************************
+// Name: discardPreview
+// Desc: Removes all of the preview time remap nodes,
+//       leaving the curves as they were
+//*********************************************************
+MStatus RetimingCommand::discardPreview()
+{
+    MStatus status = MS::kSuccess;
+    bool hasPreview = !previewList.empty();
+
+    if( !(status = clearPreview() )) {
+        pluginError( "RetimingCommand", "discardPreview", "Failed to delete the time remaps" );
     }
 
+    if( hasPreview )
+        newPlayheadTime = previewOrigPlayheadTime;
+
     return status;
 }
 
+
 //*********************************************************
-// Name: shiftRemainingKeys
-// Desc: Shift the keys that fall after the retiming range by
-//       the specified number of frames
+// Name: clearPreview
+// Desc: Deletes every tagged time remap in the scene.  The
+//       remaps of the current preview are tagged, so this
+//       also removes any left in a scene saved while
+//       previewing.  Referenced remaps can't be deleted.
 //*********************************************************
-MStatus RetimingCommand::shiftRemainingKeys( AnimCurveFnACC &animCurveACC,
-                                             unsigned int firstKeyIndex,
-                                             double numFrames)
+MStatus RetimingCommand::clearPreview( unsigned int *numRemoved )
 {
     MStatus status = MS::kSuccess;
+    MDGModifier dgModifier;
+    unsigned int numRemaps = 0;
 
-    MFnAnimCurve *animCurve = animCurveACC.pAnimCurveFn;
- 
-    MTime currentKeyTime;
-
-    // Shift the lowest index (smallest time value) first when shifting keys
-    // to the left (smaller time values)
-    if( numFrames < 0 ) {
-        for( unsigned int index = firstKeyIndex; index < animCurve->numKeys(); index++ )
-        {   
-            currentKeyTime = animCurve->time( index, &status );
-            currentKeyTime += numFrames;
-            animCurve->setTime( index, currentKeyTime, animCurveACC.pAnimCache );
-        }
+    MItDependencyNodes nodeIter( MFn::kAnimCurveTimeToTime, &status );
+    if( !status ) {
+        pluginError( "RetimingCommand", "clearPreview", "Failed to create the node iterator" );
     }
-    // Shift the highest index (largest time value) first when shifting keys
-    // to the right (larger time values)
-    else if( numFrames > 0 ) {
-        for( unsigned int index = (animCurve->numKeys() - 1); index >= firstKeyIndex; index-- )
-        {   
-            currentKeyTime = animCurve->time( index, &status );
-            currentKeyTime += numFrames;
-            animCurve->setTime( index, currentKeyTime, animCurveACC.pAnimCache );
+
+    for( ; status && !nodeIter.isDone(); nodeIter.next() ) {
+        MObject remap = nodeIter.thisNode();
+        MFnDependencyNode remapFn( remap );
+
+        if( remapFn.hasAttribute( previewTagLongName ) && !remapFn.isFromReferencedFile() ) {
+            dgModifier.deleteNode( remap );
+            numRemaps++;
         }
     }
+
+    if( status && numRemaps > 0 && !(status = dgModifier.doIt() )) {
+        pluginError( "RetimingCommand", "clearPreview", "Failed to delete the time remaps" );
+    }
+
+    if( numRemoved != NULL )
+        *numRemoved = numRemaps;
+
+    previewList.clear();
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: addCallbacks
+// Desc: Adds the scene callbacks.  A preview is never
+//       saved, it's discarded before the save.
+//*********************************************************
+MStatus RetimingCommand::addCallbacks()
+{
+    MStatus status = MS::kSuccess;
+
+    if( sceneCallbackIds.length() > 0 )
+        return status;
+
+    MCallbackId id = MSceneMessage::addCallback( MSceneMessage::kBeforeSave, sceneSaving, NULL, &status );
+    if( status ) {
+        sceneCallbackIds.append( id );
+        id = MSceneMessage::addCallback( MSceneMessage::kBeforeNew, sceneChanging, NULL, &status );
+    }
+    if( status ) {
+        sceneCallbackIds.append( id );
+        id = MSceneMessage::addCallback( MSceneMessage::kBeforeOpen, sceneChanging, NULL, &status );
+    }
+    if( status ) {
+        sceneCallbackIds.append( id );
+        id = MSceneMessage::addCallback( MSceneMessage::kAfterOpen, sceneOpened, NULL, &status );
+    }
+    if( status ) {
+        sceneCallbackIds.append( id );
+    }
+    else {
+        pluginError( "RetimingCommand", "addCallbacks", "Failed to add the scene callbacks" );
+        removeCallbacks();
+    }
+
     return status;
 }
 
+
+//*********************************************************
+// Name: removeCallbacks
+// Desc: Removes the scene callbacks
+//*********************************************************
+void RetimingCommand::removeCallbacks()
+{
+    if( sceneCallbackIds.length() > 0 ) {
+        MMessage::removeCallbacks( sceneCallbackIds );
+        sceneCallbackIds.clear();
+    }
+}
+
+
+//*********************************************************
+// Name: sceneSaving
+// Desc: The time remaps would be saved still connected to
+//       the curves, so the preview is discarded first
+//*********************************************************
+void RetimingCommand::sceneSaving( void *clientData )
+{
+    if( previewList.empty() )
+        return;
+
+    MGlobal::displayWarning( "The retiming preview was discarded before saving" );
+    clearPreview();
+}
+
+
+//*********************************************************
+// Name: sceneChanging
+// Desc: The time remaps are deleted with the scene, only
+//       the handles to them are left
+//*********************************************************
+void RetimingCommand::sceneChanging( void *clientData )
+{
+    previewList.clear();
+}
+
+
+//*********************************************************
+// Name: sceneOpened
+// Desc: Removes any preview time remaps saved in the
+//       scene, they would remap the curves without a
+//       preview to commit or discard
+//*********************************************************
+void RetimingCommand::sceneOpened( void *clientData )
+{
+    unsigned int numRemoved = 0;
+
+    if( clearPreview( &numRemoved ) && numRemoved > 0 ) {
+        MString msg( "Removed " );
+        msg += numRemoved;
+        msg += " retiming preview time remaps saved in the scene";
+        MGlobal::displayWarning( msg );
+    }
+}
+
+
 //*********************************************************
 // Name: generateStripString
 // Desc: Creates the strip string. The info related to the
 //       current timing at the current playhead position
 //*********************************************************
-MStatus RetimingCommand::generateStripString( MFnAnimCurve &animCurve,
+MStatus RetimingCommand::generateStripString( const std::vector<double> &keyTimes,
                                               unsigned int firstRetimingIndex,
                                               unsigned int lastRetimingIndex)
 {
     MStatus status = MS::kSuccess;
 
-    MTime time = animCurve.time( firstRetimingIndex );
-    double firstFrame = time.value();
+    double playheadFrame = origPlayheadTime.as( MTime::uiUnit() );
+    double firstFrame = keyTimes[firstRetimingIndex];
 
     // Create the first half of the string
-    if( (firstRetimingIndex == lastRetimingIndex) && (origPlayheadTime < time))
+    if( (firstRetimingIndex == lastRetimingIndex) && (playheadFrame < firstFrame))
         stripString = "None";
     else
         stripString = firstFrame;
 
-    time = animCurve.time( lastRetimingIndex );
-    double lastFrame = time.value();
+    double lastFrame = keyTimes[lastRetimingIndex];
 
-    if( (firstRetimingIndex == lastRetimingIndex) && (origPlayheadTime >= time)) {
+    if( (firstRetimingIndex == lastRetimingIndex) && (playheadFrame >= lastFrame)) {
         // We are on or after the last key
         stripString += " on End";
     }
     else if( firstRetimingIndex == lastRetimingIndex ) {
         // We are before the first key (None on first frame in the timeline)
         // Determine what the animation start time is
-        time = MAnimControl::animationStartTime();
-        double animStartFrame = time.value();
+        MTime time = MAnimControl::animationStartTime();
+        double animStartFrame = time.as( MTime::uiUnit() );
 
         stripString += " on ";
         stripString += (firstFrame - animStartFrame);
@@ -832,4 +1115,4 @@ MStatus RetimingCommand::generateStripString( MFnAnimCurve &animCurve,
     }
 
     return status;
-}
\ No newline at end of file
+}
@@ -21,16 +21,27 @@
 #include <maya/MStringArray.h>
 #include <maya/MPlug.h>
 #include <maya/MPlugArray.h>
+#include <maya/MTimeArray.h>
+#include <maya/MDoubleArray.h>
 #include <maya/MAnimControl.h>
-#include <maya/MAnimCurveChange.h>
+
+#include <maya/MDGModifier.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MCallbackIdArray.h>
+#include <maya/MSceneMessage.h>
 
 #include <maya/MFnDependencyNode.h>
 #include <maya/MFnAnimCurve.h>
+#include <maya/MFnNumericAttribute.h>
+#include <maya/MFnNumericData.h>
 
 #include <maya/MItSelectionList.h>
-#include <maya/MItDependencyGraph.h>
+#include <maya/MItDependencyNodes.h>
+
+#include "AnimCurveSnapshot.h"
 
 #include <list>
+#include <vector>
 //*********************************************************
 
 //*********************************************************
@@ -49,21 +60,64 @@
 //
 //        -nextKeyOnComplete (-nkc)  (boolean)
 //
+//        -preview (-pv)
+//
+//        -commit (-cm)
+//
+//        -discard (-dis)
+//
 //*********************************************************
 class RetimingCommand : public MPxCommand
 {
 private:
     // Storage for the anim curve function set and its
-    // curve change cache (for undo/redo)
+    // journal (for undo/redo).  The journal holds the key
+    // times before and after retiming and is empty if the
+    // curve was not changed.
     struct AnimCurveFnACC {
         MFnAnimCurve* pAnimCurveFn;
-        MAnimCurveChange* pAnimCache;
+        std::vector<double> origKeyTimes;
+        std::vector<double> finalKeyTimes;
+    };
+
+    // A curve being previewed.  The curve's keys are left
+    // untouched and an animCurveTT connected to its input
+    // remaps time so the curve plays back with the
+    // previewed timing.
+    struct RetimingPreview {
+        MObjectHandle animCurve;
+        MObjectHandle timeRemap;
+        std::vector<double> origKeyTimes;
+        std::vector<double> previewKeyTimes;
     };
 
     // Constants for setting up the command's flags
     static const char *relativeFlag, *relativeLongFlag;
     static const char *deltaFlag, *deltaLongFlag;
     static const char *nextKeyOnCompleteFlag, *nextKeyOnCompleteLongFlag;
+    static const char *previewFlag, *previewLongFlag;
+    static const char *commitFlag, *commitLongFlag;
+    static const char *discardFlag, *discardLongFlag;
+
+    // The curves currently being previewed.  Previews
+    // live between command calls until they are committed
+    // or discarded.
+    static std::list<RetimingPreview> previewList;
+
+    // The playhead time before the first preview
+    static MTime previewOrigPlayheadTime;
+
+    // The playhead time after the latest preview
+    static MTime previewPlayheadTime;
+
+    // Discard the preview before a save and forget it
+    // when the scene is replaced
+    static MCallbackIdArray sceneCallbackIds;
+
+    // The most recent retiming on the undo queue.  Further
+    // retimings of the same curves and range are merged
+    // into its journal instead of adding to the queue.
+    static RetimingCommand *lastRetimingCommand;
 
     // Indicates if the command is in query mode
     bool queryMode;
@@ -82,6 +136,23 @@ private:
     // move to the first key
     bool nextKeyOnComplete;
 
+    // Indicates the retiming is only previewed
+    bool previewMode;
+
+    // Indicates the current preview should be written
+    // to the curves
+    bool commitMode;
+
+    // Indicates the current preview should be thrown away
+    bool discardMode;
+
+    // Indicates this retiming is merged into the journal
+    // of the last retiming command
+    bool mergeMode;
+
+    // Indicates the command has been undone
+    bool undone;
+
     // The objects currently selected in the Maya scene
     MSelectionList selectionList;
 
@@ -124,8 +195,6 @@ private:
     // selected objects
     MStatus getAnimCurveFnList();
 
-    // Generates a list of anim curves from an array of plugs
-    MStatus getAnimCurveFnListFromPlugs( MPlugArray plugArray );
 
     // Determines the range (from the time slider) over which
     // retiming will occur
@@ -135,27 +204,49 @@ private:
     // range and retimes them
     MStatus retime();
 
-    // Traverses all keyframes in the given range and retimes
-    // them
-    MStatus retimeAnimCurve( AnimCurveFnACC &animCurveACC );
+    // Retimes the anim curve in memory, then writes the
+    // new key times to the curve (or its preview) and
+    // records them in the journal
+    MStatus retimeAnimCurve( AnimCurveFnACC &animCurveACC,
+                             AnimCurveFnACC &journalACC );
+
+    // Returns true if this retiming can be merged into
+    // the last retiming command
+    bool canMergeWithLast();
+
+    // Calculates the new time of every key on a curve.
+    // Returns false if there are no keys to retime.
+    bool calcRetimedKeyTimes( const AnimCurveSnapshot &snapshot,
+                              std::vector<double> &newKeyTimes,
+                              unsigned int &firstRetimingIndex,
+                              unsigned int &lastRetimingIndex );
+
+    // Returns the preview for the curve (NULL if the
+    // curve is not being previewed)
+    RetimingPreview *findPreview( const MObject &animCurve );
 
-    // Traverses all keyframes in the given range and retimes
-    // them
-    MStatus retimeAnimCurve( AnimCurveFnACC &animCurveACC, 
-                             unsigned int currentIndex,
-                             unsigned int lastRetimingIndex,
-                             double prevIndexOrigTime,
-                             double prevIndexNewTime );
+    // Updates (or creates) the time remap node that
+    // displays the previewed key times
+    MStatus updatePreviewRemap( RetimingPreview &preview );
 
-    // Shift the keys that fall after the retiming range by
-    // the specified number of frames
-    MStatus shiftRemainingKeys( AnimCurveFnACC &animCurveACC,
-                                unsigned int firstKeyIndex,
-                                double numFrames );
+    // Writes all previewed key times to their curves
+    MStatus commitPreview();
+
+    // Removes all of the preview time remap nodes
+    MStatus discardPreview();
+
+    // Discards the preview so the time remaps aren't saved
+    static void sceneSaving( void *clientData );
+
+    // Forgets the preview, its nodes go with the scene
+    static void sceneChanging( void *clientData );
+
+    // Removes time remaps left in an opened scene
+    static void sceneOpened( void *clientData );
 
     // Creates the strip string. The info related to the
     // current timing
-    MStatus generateStripString( MFnAnimCurve &animCurve,
+    MStatus generateStripString( const std::vector<double> &keyTimes,
                                  unsigned int firstRetimingIndex,
                                  unsigned int lastRetimingIndex );
 
@@ -174,7 +265,10 @@ public:
     virtual MStatus undoIt();
 
     // Indicates that Maya can undo/redo this command
-    virtual bool isUndoable() const { return (queryMode ? false : true); }
+    // (previews are not undoable until committed and
+    // merged retimings are undone with the command they
+    // were merged into)
+    virtual bool isUndoable() const { return !(queryMode || previewMode || discardMode || mergeMode); }
 
     // Allocates a command object to Maya (required)
     static void *creator() { return new RetimingCommand; }
@@ -182,6 +276,16 @@ public:
     // Defines the set of flags allowed by this command
     static MSyntax newSyntax();
 
+    // Adds the scene callbacks that keep previews out of
+    // saved scenes
+    static MStatus addCallbacks();
+
+    // Removes the scene callbacks
+    static void removeCallbacks();
+
+    // Deletes every preview time remap in the scene and
+    // forgets the preview
+    static MStatus clearPreview( unsigned int *numRemoved = NULL );
 };
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
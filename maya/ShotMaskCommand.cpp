@@ -35,10 +35,25 @@ const char *ShotMaskCommand::text1Flag = "-t1";
 const char *ShotMaskCommand::text1LongFlag = "-text1";
 const char *ShotMaskCommand::text2Flag = "-t2";
 const char *ShotMaskCommand::text2LongFlag = "-text2"; 
+const char *ShotMaskCommand::glyphCacheFlag = "-gc";
+const char *ShotMaskCommand::glyphCacheLongFlag = "-glyphCache";
+const char *ShotMaskCommand::counterFormatFlag = "-cf";
+const char *ShotMaskCommand::counterFormatLongFlag = "-counterFormat";
+const char *ShotMaskCommand::framesPerFootFlag = "-fpf";
+const char *ShotMaskCommand::framesPerFootLongFlag = "-framesPerFoot";
+const char *ShotMaskCommand::elementFlag = "-el";
+const char *ShotMaskCommand::elementLongFlag = "-element";
+const char *ShotMaskCommand::colorFlag = "-clr";
+const char *ShotMaskCommand::colorLongFlag = "-color";
+const char *ShotMaskCommand::transparencyFlag = "-tr";
+const char *ShotMaskCommand::transparencyLongFlag = "-transparency";
+const char *ShotMaskCommand::detailsFlag = "-dt";
+const char *ShotMaskCommand::detailsLongFlag = "-details";
 
 // Shot Mask Nodes/Elements
 const char *ShotMaskCommand::mainGrpName = "atbShotMask_grp";
 const char *ShotMaskCommand::frameCounterGrpName = "atbFrameCounter_grp";
+const char *ShotMaskCommand::counterDigitsGrpName = "atbCounterDigits_grp";
 
 const char *ShotMaskCommand::titleTextGrpName = "atbShotMaskTitleText_grp";
 const char *ShotMaskCommand::bottomLeftTextGrpName = "atbShotMaskBLText_grp";
@@ -56,8 +71,14 @@ const char *ShotMaskCommand::bdIconShaderGroupName = "atbShotMaskBDIcon_shdrSG";
 const char *ShotMaskCommand::ltbxShaderNodeName = "atbShotMaskLtbx_shdr";
 const char *ShotMaskCommand::ltbxShaderGroupName = "atbxShotMaskLtbx_shdrSG";
 
+const char *ShotMaskCommand::shotMaskNodeName = "atbShotMask_node";
 const char *ShotMaskCommand::shotMaskExprName = "atbShotMaskFC_expr";
 
+// The -element names, in the order the shaders are
+// connected to the shot mask node
+static const char *shaderElements[] = { "border", "text", "key", "breakdown", "letterbox" };
+static const unsigned int numShaderElements = sizeof( shaderElements ) / sizeof( const char * );
+
 
 //*********************************************************
 // Name: ShotMaskCommand
@@ -71,10 +92,20 @@ ShotMaskCommand::ShotMaskCommand()
     queryMode = false;
     queryKeyType = false;
     queryDigits = false;
+    queryDetails = false;
+
+    editMode = false;
+    editThickness = editTitle = editText1 = editText2 = false;
+    editColor = editTransparency = false;
+    shaderIndex = 0;
+
+    for( unsigned int i = 0; i < 3; i++ )
+        shaderColor[i] = shaderTransparency[i] = 0.0;
 
     cleanScene = false;
 
     pCameraFn = NULL;
+    maskAspectRatio = 0.0;
     aspectRatio = 0.0;
     renderAspectRatio = 0.0;
     filmAspectRatio = 0.0;
@@ -149,27 +180,46 @@ MStatus ShotMaskCommand::doIt(const MArgList &args)
             // of ints corresponding to the current frame
             generateFrameDigitArray();
         }
+        else if( queryDetails ) {
+            // Everything the UI shows in one call
+            status = getDetails();
+        }
         else
             MGlobal::displayError( "No queriable flags provided" );
     }
     else {
         // Do we just want to delete the old mask
         if( cleanScene )
-            cleanUpShotMask();
+            status = cleanUpShotMask();
 
-        // Otherwise, create the shot mask and expression
-        else if( !(status = createShotMask())) {
-            pluginError( "ShotMaskCommand", "doIt", "Failed to create the shot mask" );
-        }
-        else if( !(status = createShotMaskExpr())) {
-            pluginError( "ShotMaskCommand", "doIt", "Failed to create the expression editor" );
+        else {
+            // Glyphs from previous sessions, a shader edit
+            // doesn't need any
+            bool useGlyphs = !editMode || editThickness || editTitle || editText1 || editText2;
+
+            if( useGlyphs && glyphCacheFile.length() > 0 && !GlyphCache::load( glyphCacheFile ))
+                pluginWarning( "ShotMaskCommand", "doIt", "Failed to load the glyph cache" );
+
+            // Only change what the edit flags ask for
+            if( editMode ) {
+                if( !(status = editShotMask()))
+                    pluginError( "ShotMaskCommand", "doIt", "Failed to edit the shot mask" );
+            }
+            // Create the shot mask and the node that updates it
+            else if( !(status = createShotMask())) {
+                pluginError( "ShotMaskCommand", "doIt", "Failed to create the shot mask" );
+            }
+
+            if( status && glyphCacheFile.length() > 0 && GlyphCache::isModified() && !GlyphCache::save( glyphCacheFile ))
+                pluginWarning( "ShotMaskCommand", "doIt", "Failed to save the glyph cache" );
         }
         // Deselect the shot mask
         MGlobal::executeCommand( "select -cl", false, true );
     }
 
-    // If something fails, remove the whole shot mask
-    if( !status )
+    // If creating it fails, remove the whole shot mask.  A
+    // failed edit leaves the existing mask alone.
+    if( !status && !queryMode && !editMode )
         cleanUpShotMask();
 
     return status;
@@ -184,8 +234,16 @@ MStatus ShotMaskCommand::redoIt()
 {
     MStatus status = MS::kSuccess;
 
-    // All of the undo/redo relates to MEL commands
-    // which are handled by Maya
+    // Delete the previous mask, then rebuild this one
+    if( !(status = cleanUpModifier.doIt() )) {
+        pluginError( "ShotMaskCommand", "redoIt", "Failed to redo the shot mask clean up" );
+    }
+    else if( !(status = dagModifier.doIt() )) {
+        pluginError( "ShotMaskCommand", "redoIt", "Failed to redo the shot mask nodes" );
+    }
+    else if( !(status = layoutModifier.doIt() )) {
+        pluginError( "ShotMaskCommand", "redoIt", "Failed to redo the shot mask layout" );
+    }
 
     return status;
 }
@@ -200,8 +258,17 @@ MStatus ShotMaskCommand::undoIt()
 {
     MStatus status = MS::kSuccess;
 
-    // All of the undo/redo relates to MEL commands
-    // which are handled by Maya
+    // Removes the whole mask in one step and restores
+    // the previous one
+    if( !(status = layoutModifier.undoIt() )) {
+        pluginError( "ShotMaskCommand", "undoIt", "Failed to undo the shot mask layout" );
+    }
+    else if( !(status = dagModifier.undoIt() )) {
+        pluginError( "ShotMaskCommand", "undoIt", "Failed to undo the shot mask nodes" );
+    }
+    else if( !(status = cleanUpModifier.undoIt() )) {
+        pluginError( "ShotMaskCommand", "undoIt", "Failed to undo the shot mask clean up" );
+    }
 
     return status;
 }
@@ -227,8 +294,16 @@ MSyntax ShotMaskCommand::newSyntax()
     syntax.addFlag( titleFlag, titleLongFlag, MSyntax::kString );
     syntax.addFlag( text1Flag, text1LongFlag, MSyntax::kString );
     syntax.addFlag( text2Flag, text2LongFlag, MSyntax::kString );
+    syntax.addFlag( glyphCacheFlag, glyphCacheLongFlag, MSyntax::kString );
+    syntax.addFlag( counterFormatFlag, counterFormatLongFlag, MSyntax::kString );
+    syntax.addFlag( framesPerFootFlag, framesPerFootLongFlag, MSyntax::kLong );
+    syntax.addFlag( elementFlag, elementLongFlag, MSyntax::kString );
+    syntax.addFlag( colorFlag, colorLongFlag, MSyntax::kDouble, MSyntax::kDouble, MSyntax::kDouble );
+    syntax.addFlag( transparencyFlag, transparencyLongFlag, MSyntax::kDouble, MSyntax::kDouble, MSyntax::kDouble );
+    syntax.addFlag( detailsFlag, detailsLongFlag, MSyntax::kNoArg );
 
     syntax.enableQuery();
+    syntax.enableEdit();
     syntax.setObjectType( MSyntax::kSelectionList, 0 );
 
     return syntax;
@@ -257,8 +332,13 @@ MStatus ShotMaskCommand::parseCommandFlags( const MArgList &args )
             queryKeyType = true;
             argData.getObjects( objList );
         }
-        else if( argData.isFlagSet( frameDigitsFlag ))
+        else if( argData.isFlagSet( frameDigitsFlag )) {
             queryDigits = true;
+            status = parseCounterFlags( argData );
+        }
+        else if( argData.isFlagSet( detailsFlag )) {
+            queryDetails = true;
+        }
     }
     // If the cleanScene flag is set, ignore the rest.
     // When set, all nodes related to the Shot Mask
@@ -268,13 +348,17 @@ MStatus ShotMaskCommand::parseCommandFlags( const MArgList &args )
     }
     else {
         // Continue parsing the remaing flags
+        editMode = argData.isEdit();
+
         if( argData.isFlagSet( cameraFlag ))
             argData.getFlagArgument( cameraFlag, 0, camTransNodeName );
         if( argData.isFlagSet( aspectRatioFlag )) {
-            argData.getFlagArgument( aspectRatioFlag, 0, aspectRatio );
+            argData.getFlagArgument( aspectRatioFlag, 0, maskAspectRatio );
             
-            if( aspectRatio <= 0 )
+            if( maskAspectRatio <= 0 ) {
                 MGlobal::displayWarning( "Aspect Ratio must be greater than 0, Default film gate used" );
+                maskAspectRatio = 0.0;
+            }
         }
         if( argData.isFlagSet( maskThicknessFlag )) {
             argData.getFlagArgument( maskThicknessFlag, 0, maskThickness );
@@ -283,36 +367,80 @@ MStatus ShotMaskCommand::parseCommandFlags( const MArgList &args )
                 maskThickness = minThickness;
             else if( maskThickness > maxThickness )
                 maskThickness = maxThickness;
+
+            editThickness = true;
         }
-        if( argData.isFlagSet( titleFlag ))
+        if( (editTitle = argData.isFlagSet( titleFlag ))) {
             argData.getFlagArgument( titleFlag, 0, shotMaskTitle );
-        if( argData.isFlagSet( text1Flag ))
+            shotMaskTitle = unescapeText( shotMaskTitle );
+        }
+        if( (editText1 = argData.isFlagSet( text1Flag ))) {
             argData.getFlagArgument( text1Flag, 0, shotMaskText1 );
-        if( argData.isFlagSet( text2Flag ))
+            shotMaskText1 = unescapeText( shotMaskText1 );
+        }
+        if( (editText2 = argData.isFlagSet( text2Flag ))) {
             argData.getFlagArgument( text2Flag, 0, shotMaskText2 );
-
+            shotMaskText2 = unescapeText( shotMaskText2 );
+        }
+        if( argData.isFlagSet( glyphCacheFlag ))
+            argData.getFlagArgument( glyphCacheFlag, 0, glyphCacheFile );
+
+        // The camera and counter of an edited mask are
+        // read from the mask itself
+        if( editMode ) {
+            if( !(status = parseShaderFlags( argData )))
+                pluginError( "ShotMaskCommand", "parseCommandFlags", "Invalid shader flags" );
+        }
         // We need a camera to perform this command on
-        if( camTransNodeName.length() == 0 ) {
+        else if( !(status = parseCounterFlags( argData ))) {
+            pluginError( "ShotMaskCommand", "parseCommandFlags", "Invalid counter format" );
+        }
+        else if( camTransNodeName.length() == 0 ) {
             MGlobal::displayError( "No camera selected" );
             pluginError( "ShotMaskCommand", "parseCommandFlags", "No Objects provided" );
             status = MS::kFailure;
         }
-        else {
-            // Get the name of the camera's shape node
-            status = getCameraShapeNode();
+        else
+            status = initCamera();
+    }
 
-            if( status ) {
-                filmAspectRatio = pCameraFn->aspectRatio();
+    return status;
+}
+
+//*********************************************************
+// Name: parseShaderFlags
+// Desc: Gets the shader and the color/transparency to set
+//       on it from the edit flags
+//*********************************************************
+MStatus ShotMaskCommand::parseShaderFlags( MArgDatabase &argData )
+{
+    MStatus status = MS::kSuccess;
 
-                if( aspectRatio <= 0 ) {
-                aspectRatio = filmAspectRatio;
+    editColor = argData.isFlagSet( colorFlag );
+    editTransparency = argData.isFlagSet( transparencyFlag );
 
-                // Get the render globals aspect ratio
-                MGlobal::executeCommand( "getAttr defaultResolution.deviceAspectRatio", renderAspectRatio, false, false );
-                }
-                else
-                    renderAspectRatio = aspectRatio;
-            }
+    if( !editColor && !editTransparency )
+        return status;
+
+    MString element;
+    if( argData.isFlagSet( elementFlag ))
+        argData.getFlagArgument( elementFlag, 0, element );
+
+    for( shaderIndex = 0; shaderIndex < numShaderElements; shaderIndex++ ) {
+        if( element == shaderElements[shaderIndex] )
+            break;
+    }
+
+    if( shaderIndex == numShaderElements ) {
+        MGlobal::displayError( "Element must be border, text, key, breakdown or letterbox" );
+        status = MS::kInvalidParameter;
+    }
+    else {
+        for( unsigned int i = 0; i < 3; i++ ) {
+            if( editColor )
+                argData.getFlagArgument( colorFlag, i, shaderColor[i] );
+            if( editTransparency )
+                argData.getFlagArgument( transparencyFlag, i, shaderTransparency[i] );
         }
     }
 
@@ -371,46 +499,265 @@ MStatus ShotMaskCommand::getCameraShapeNode()
     return status;
 }
 
+//*********************************************************
+// Name: initCamera
+// Desc: Gets the camera shape node and the aspect ratios
+//       the mask is laid out with.  Without an aspect
+//       ratio the film gate is used.
+//*********************************************************
+MStatus ShotMaskCommand::initCamera()
+{
+    MStatus status = MS::kSuccess;
+
+    // Get the name of the camera's shape node
+    if( (status = getCameraShapeNode() )) {
+        filmAspectRatio = pCameraFn->aspectRatio();
+
+        if( maskAspectRatio <= 0 ) {
+            aspectRatio = filmAspectRatio;
+
+            // Get the render globals aspect ratio
+            if( !(status = ShotMaskDetails::getRenderAspectRatio( renderAspectRatio )))
+                pluginError( "ShotMaskCommand", "initCamera", "Failed to get the render aspect ratio" );
+        }
+        else
+            aspectRatio = renderAspectRatio = maskAspectRatio;
+    }
+
+    return status;
+}
+
 //*********************************************************
 // Name: cleanUpShotMask
-// Desc: Deletes all shot mask elements from the
-//       current scene
+// Desc: Deletes all shot mask elements from the current
+//       scene with one modifier.  The nodes are found
+//       through the shot mask node, masks made by older
+//       versions are found by name.  The poly creators are
+//       deleted before the meshes they feed.
 //*********************************************************
 MStatus ShotMaskCommand::cleanUpShotMask()
 {
     MStatus status = MS::kSuccess;
+    MObjectArray nodes, history;
+
+    // Everything connected to a shot mask node
+    MItDependencyNodes nodeIter( MFn::kPluginDependNode );
+    for( ; !nodeIter.isDone(); nodeIter.next() ) {
+        MObject node = nodeIter.thisNode();
+        if( MFnDependencyNode( node ).typeId() != ShotMaskNode::id )
+            continue;
 
-    MString cmdStr( "if( `objExists " );
+        addNodeToDelete( getSourceNode( MPlug( node, ShotMaskNode::maskRootAttr )), nodes );
 
-    // Remove the geometry
-    MGlobal::executeCommand( cmdStr + frameCounterGrpName + "` ) delete " + frameCounterGrpName, false, true );
-    MGlobal::executeCommand( cmdStr + mainGrpName + "` ) delete " + mainGrpName, false, true );
+        MPlug shadersPlug( node, ShotMaskNode::shadersAttr );
+        for( unsigned int i = 0; i < shadersPlug.numElements(); i++ ) {
+            MObject shader = getSourceNode( shadersPlug.elementByPhysicalIndex( i ));
 
-    // Remove the shaders
-    MGlobal::executeCommand( cmdStr + borderShaderGroupName + "` ) delete " + borderShaderGroupName, false, true );
-    MGlobal::executeCommand( cmdStr + borderShaderNodeName + "` ) delete " + borderShaderNodeName, false, true );
+            addNodeToDelete( getShadingGroup( shader ), nodes );
+            addNodeToDelete( shader, nodes );
+        }
+
+        addNodeToDelete( node, nodes );
+    }
+
+    // The nodes of older masks
+    const char *nodeNames[] = { mainGrpName, frameCounterGrpName,
+                                borderShaderGroupName, borderShaderNodeName,
+                                textShaderGroupName, textShaderNodeName,
+                                keyIconShaderGroupName, keyIconShaderNodeName,
+                                bdIconShaderGroupName, bdIconShaderNodeName,
+                                ltbxShaderGroupName, ltbxShaderNodeName,
+                                shotMaskNodeName, shotMaskExprName };
+
+    for( unsigned int i = 0; i < sizeof( nodeNames ) / sizeof( const char * ); i++ ) {
+        MSelectionList nodeList;
+        MObject node;
+
+        if( nodeList.add( nodeNames[i] ) && nodeList.getDependNode( 0, node ))
+            addNodeToDelete( node, nodes );
+    }
+
+    // The polyPlane/polyCylinder of each border and icon
+    MItDag dagIter;
+    for( unsigned int i = 0; i < nodes.length(); i++ ) {
+        if( !nodes[i].hasFn( MFn::kDagNode ))
+            continue;
+
+        dagIter.reset( nodes[i], MItDag::kDepthFirst, MFn::kMesh );
+        for( ; !dagIter.isDone(); dagIter.next() ) {
+            MObject creator = getSourceNode( MFnDependencyNode( dagIter.currentItem() ).findPlug( "inMesh" ));
+            if( !creator.isNull() && !creator.hasFn( MFn::kDagNode ))
+                addNodeToDelete( creator, history );
+        }
+    }
+
+    for( unsigned int i = 0; i < history.length() && status; i++ )
+        status = cleanUpModifier.deleteNode( history[i] );
+    for( unsigned int i = 0; i < nodes.length() && status; i++ )
+        status = cleanUpModifier.deleteNode( nodes[i] );
+
+    if( !status ) {
+        pluginError( "ShotMaskCommand", "cleanUpShotMask", "Failed to add a node to delete" );
+    }
+    else if( !(status = cleanUpModifier.doIt() )) {
+        pluginError( "ShotMaskCommand", "cleanUpShotMask", "Failed to delete the shot mask" );
+    }
+
+    return status;
+}
+
+//*********************************************************
+// Name: addNodeToDelete
+// Desc: Adds a node to the list of nodes to delete.  Null
+//       nodes, nodes already in the list and DAG nodes
+//       below one in the list are skipped, deleting the
+//       parent deletes them.
+//*********************************************************
+void ShotMaskCommand::addNodeToDelete( const MObject &node, MObjectArray &nodes )
+{
+    if( node.isNull() )
+        return;
+
+    bool isDagNode = node.hasFn( MFn::kDagNode );
+    MString path = isDagNode ? MFnDagNode( node ).fullPathName() : MString( "" );
+
+    for( unsigned int i = 0; i < nodes.length(); i++ ) {
+        if( nodes[i] == node )
+            return;
+
+        if( isDagNode && nodes[i].hasFn( MFn::kDagNode )) {
+            MString parentPath = MFnDagNode( nodes[i] ).fullPathName() + "|";
+
+            if( path.length() > parentPath.length() && path.substring( 0, parentPath.length() - 1 ) == parentPath )
+                return;
+        }
+    }
+
+    nodes.append( node );
+}
+
+//*********************************************************
+// Name: findShotMaskNode
+// Desc: Finds the shot mask node in the scene by its type,
+//       so it doesn't matter what it's called
+//*********************************************************
+MObject ShotMaskCommand::findShotMaskNode()
+{
+    MObject maskNode;
+
+    MItDependencyNodes nodeIter( MFn::kPluginDependNode );
+    for( ; !nodeIter.isDone() && maskNode.isNull(); nodeIter.next() ) {
+        if( MFnDependencyNode( nodeIter.thisNode() ).typeId() == ShotMaskNode::id )
+            maskNode = nodeIter.thisNode();
+    }
+
+    return maskNode;
+}
+
+//*********************************************************
+// Name: getSourceNode
+// Desc: The node connected to a plug, a null object if
+//       it isn't connected
+//*********************************************************
+MObject ShotMaskCommand::getSourceNode( const MPlug &plug )
+{
+    MObject node;
+    MPlugArray srcPlugs;
+
+    if( !plug.isNull() && plug.connectedTo( srcPlugs, true, false ) && srcPlugs.length() > 0 )
+        node = srcPlugs[0].node();
+
+    return node;
+}
+
+//*********************************************************
+// Name: getShadingGroup
+// Desc: The shading group the outColor of a shader is
+//       connected to
+//*********************************************************
+MObject ShotMaskCommand::getShadingGroup( const MObject &shader )
+{
+    MObject shadingGroup;
+    MPlugArray dstPlugs;
+
+    if( !shader.isNull() &&
+        MFnDependencyNode( shader ).findPlug( "outColor" ).connectedTo( dstPlugs, false, true )) {
+        for( unsigned int i = 0; i < dstPlugs.length() && shadingGroup.isNull(); i++ ) {
+            if( dstPlugs[i].node().hasFn( MFn::kShadingEngine ))
+                shadingGroup = dstPlugs[i].node();
+        }
+    }
+
+    return shadingGroup;
+}
+
+//*********************************************************
+// Name: unescapeText
+// Desc: The UI escapes quotes and backslashes for MEL,
+//       the text is stored and shown without them
+//*********************************************************
+MString ShotMaskCommand::unescapeText( const MString &text )
+{
+    const char *chars = text.asChar();
+    unsigned int numChars = text.length();
+    std::string unescaped;
+
+    for( unsigned int i = 0; i < numChars; i++ ) {
+        if( chars[i] == '\\' && i + 1 < numChars )
+            i++;
+
+        unescaped += chars[i];
+    }
+
+    return MString( unescaped.c_str() );
+}
+
+//*********************************************************
+// Name: parseCounterFlags
+// Desc: Sets the counter format from the flags and sizes
+//       it to fit the animation range.  The frame number
+//       and feet never use fewer digits than the original
+//       counter did.
+//*********************************************************
+MStatus ShotMaskCommand::parseCounterFlags( MArgDatabase &argData )
+{
+    MStatus status = MS::kSuccess;
 
-    MGlobal::executeCommand( cmdStr + textShaderGroupName + "` ) delete " + textShaderGroupName, false, true );
-    MGlobal::executeCommand( cmdStr + textShaderNodeName + "` ) delete " + textShaderNodeName, false, true );
+    if( argData.isFlagSet( counterFormatFlag )) {
+        MString formatName;
+        argData.getFlagArgument( counterFormatFlag, 0, formatName );
 
-    MGlobal::executeCommand( cmdStr + keyIconShaderGroupName + "` ) delete " + keyIconShaderGroupName, false, true );
-    MGlobal::executeCommand( cmdStr + keyIconShaderNodeName + "` ) delete " + keyIconShaderNodeName, false, true );
+        if( !(status = FrameCounterFormat::getFormat( formatName, counterFormat.format ))) {
+            MGlobal::displayError( "Counter format must be frames, timecode or feetFrames" );
+        }
+    }
 
-    MGlobal::executeCommand( cmdStr + bdIconShaderGroupName + "` ) delete " + bdIconShaderGroupName, false, true );
-    MGlobal::executeCommand( cmdStr + bdIconShaderNodeName + "` ) delete " + bdIconShaderNodeName, false, true );
+    if( status && argData.isFlagSet( framesPerFootFlag )) {
+        int framesPerFoot = 16;
+        argData.getFlagArgument( framesPerFootFlag, 0, framesPerFoot );
 
-    MGlobal::executeCommand( cmdStr + ltbxShaderGroupName + "` ) delete " + ltbxShaderGroupName, false, true );
-    MGlobal::executeCommand( cmdStr + ltbxShaderNodeName + "` ) delete " + ltbxShaderNodeName, false, true );
+        if( framesPerFoot < 1 ) {
+            MGlobal::displayError( "Frames per foot must be greater than 0" );
+            status = MS::kInvalidParameter;
+        }
+        else
+            counterFormat.framesPerFoot = (unsigned int)framesPerFoot;
+    }
 
-    // Remove the expressions
-    MGlobal::executeCommand( cmdStr + shotMaskExprName + "` ) delete " + shotMaskExprName, false, true );
+    if( status ) {
+        unsigned int minDigits = (counterFormat.format == FrameCounterFormat::kFeetFrames) ? 3 : 4;
+        counterFormat.fitRange( MAnimControl::animationStartTime(), MAnimControl::animationEndTime(), minDigits );
+    }
 
     return status;
 }
 
 //*********************************************************
 // Name: createShotMask
-// Desc: Creates a shot mask for a specified camera
+// Desc: Creates a shot mask for a specified camera.  The
+//       nodes and text are built by one modifier, then a
+//       second modifier lays them out.  Both are undone
+//       together.
 //*********************************************************
 MStatus ShotMaskCommand::createShotMask()
 {
@@ -422,390 +769,476 @@ MStatus ShotMaskCommand::createShotMask()
     if( !(status = cleanUpShotMask() )) {
         pluginTrace( "ShotMaskCommand", "createShotMask", "Failed to clean up the previous shot mask" );
     }
-    else {
-        // Generate the shaders first
-        createShotMaskShaders();
+    else if( !(status = buildShotMask() )) {
+        pluginError( "ShotMaskCommand", "createShotMask", "Failed to build the shot mask" );
+    }
+    else if( !(status = dagModifier.doIt() )) {
+        pluginError( "ShotMaskCommand", "createShotMask", "Failed to create the shot mask nodes" );
+    }
+    else if( !(status = layoutShotMask() )) {
+        pluginError( "ShotMaskCommand", "createShotMask", "Failed to lay out the shot mask" );
+    }
+    else if( !(status = layoutModifier.doIt() )) {
+        pluginError( "ShotMaskCommand", "createShotMask", "Failed to position the shot mask" );
+    }
 
-        // The width and height of the shot mask
-        double width, height;
+    return status;
+}
 
-        double nearClip = pCameraFn->nearClippingPlane();
-        if( nearClip < 0.1 )
-            nearClip = 0.1;
 
-        // The location of the shot mask is slightly offset
-        // to minimize clipping problems with the
-        // labels, frame counter, etc...
-        double shotMaskZPos = nearClip + (nearClip * 0.1);
+//*********************************************************
+// Name: buildShotMask
+// Desc: Adds the nodes of the shot mask to the modifier.
+//       Everything is created at the origin, the layout is
+//       set afterwards.  Shaders are assigned once per
+//       group and the display override is set once on the
+//       main group.
+//*********************************************************
+MStatus ShotMaskCommand::buildShotMask()
+{
+    MStatus status = MS::kSuccess;
+    MObject creator;
 
-        // The z-position for the 
-        double textZPos = shotMaskZPos - (nearClip * 0.006);
+    glyphShapes.clear();
+    glyphInstanceCmd.clear();
 
-        // The z-position for icons
-        double iconZPos = shotMaskZPos - (nearClip * 0.003);
+    createShotMaskShaders();
 
-        // The z-position for the frame counter numbers
-        double frameNumZPos = textZPos;
+    maskNodes.mainGrp = createTransform( mainGrpName, MObject::kNullObj, &status );
 
-        // Determine how the film back is mapped to 
-        // the render globals aspect ratio
-        MFnCamera::FilmFit filmFit = pCameraFn->filmFit();
+    // Top border with the title and frame counter
+    maskNodes.topFrameGrp = createTransform( "atbFrameTop_grp", maskNodes.mainGrp, &status );
+    maskNodes.topPlane = createMesh( "atbFrameTop_geo", maskNodes.topFrameGrp, "polyPlane", creator, &status );
 
-        // Handle Overscan & Fill fit options
-        if( filmFit == MFnCamera::kFillFilmFit && 
-            (filmAspectRatio <= renderAspectRatio || filmAspectRatio == aspectRatio) )
-            filmFit = MFnCamera::kHorizontalFilmFit;
+    if( shotMaskTitle != "" )
+        createText( "atbTitleText", titleTextGrpName, shotMaskTitle, maskNodes.topFrameGrp, maskNodes.title, &status );
 
-        else if( filmFit == MFnCamera::kOverscanFilmFit &&
-            (filmAspectRatio >= renderAspectRatio || filmAspectRatio == aspectRatio) )
-            filmFit = MFnCamera::kHorizontalFilmFit;
+    createFrameCounter( maskNodes.topFrameGrp, &status );
 
+    // Bottom border with the bottom left/right text
+    maskNodes.bottomFrameGrp = createTransform( "atbFrameBottom_grp", maskNodes.mainGrp, &status );
+    maskNodes.bottomPlane = createMesh( "atbFrameBottom_geo", maskNodes.bottomFrameGrp, "polyPlane", creator, &status );
 
-        // Is this an ortho camera
-        if( pCameraFn->isOrtho() ) {
-            width = pCameraFn->orthoWidth();
-            height = width / aspectRatio;
-        }
-        else {
-            // Get the necessary camera attributes
-            double vertFOV = pCameraFn->verticalFieldOfView();
-            double horizontalFOV = pCameraFn->horizontalFieldOfView();
-            
-            // Calculate the width & height of the gate at the
-            // Z position of shot mask based on the camera's
-            // film fit option (for perspective cameras)    
-            if( filmFit == MFnCamera::kVerticalFilmFit ) {
-                // The vertFOV will remain fixed
-                height = 2 * (tan(vertFOV / 2.0) * shotMaskZPos);
-                width = height * aspectRatio;
-            }
-            else if( filmFit == MFnCamera::kHorizontalFilmFit ) {
-                // The horizontal FOV will remain fixed
-                width = 2 * (tan(horizontalFOV / 2.0) * shotMaskZPos);
-                height = width / aspectRatio;
-            }
-            else if( filmFit == MFnCamera::kFillFilmFit ) {
-                // When the film aspect ratio > render aspect ratio 
-                // we need to adjust the size of the mask
-                double scaling = renderAspectRatio / filmAspectRatio;
-                width = 2 * (tan(horizontalFOV / 2.0) * scaling * shotMaskZPos);
-                height = width / aspectRatio;
-            }
-            else if( filmFit == MFnCamera::kOverscanFilmFit ) {
-                // When the render aspect ratio > film aspect ratio 
-                // we need to adjust the size of the mask
-                double scaling = renderAspectRatio / filmAspectRatio;
-                width = 2 * (tan(horizontalFOV / 2.0) * scaling * shotMaskZPos);
-                height = width / aspectRatio;
-            }
-        }
+    if( shotMaskText1 != "" )
+        createText( "atbBottomLeftText", bottomLeftTextGrpName, shotMaskText1, maskNodes.bottomFrameGrp,
+                    maskNodes.bottomLeft, &status );
+    if( shotMaskText2 != "" )
+        createText( "atbBottomRightText", bottomRightTextGrpName, shotMaskText2, maskNodes.bottomFrameGrp,
+                    maskNodes.bottomRight, &status );
 
-        // The corners (size) of the shot mask, based
-        // when it is positioned at the near clipping
-        // plan of the camera
-        double left, right, top, bottom;
-        right = width / 2.0;
-        left = -right;
-        top = height / 2.0;
-        bottom = -top;
-
-        // The thickness of horizontal edges
-        double hThickness = maskThickness * height;
-        // The thickness of vertical edges
-        double vThickness = maskThickness * width;
-
-        double iconScale = hThickness * 0.6;
-#ifdef NT_PLUGIN
-        double counterScale = hThickness * 0.17;
-        double titleScale = hThickness * 0.25;
-        double subtitleScale = hThickness * 0.22;
-#endif
+    // Side borders
+    MObject sideFrameGrp = createTransform( "atbFrameSides_grp", maskNodes.mainGrp, &status );
+    maskNodes.leftPlane = createMesh( "atbFrameLeft_geo", sideFrameGrp, "polyPlane", creator, &status );
+    maskNodes.rightPlane = createMesh( "atbFrameRight_geo", sideFrameGrp, "polyPlane", creator, &status );
 
+    // Letterbox
+    MObject letterboxGrp = createTransform( "atbLetterbox_grp", maskNodes.mainGrp, &status );
+    maskNodes.letterboxTop = createMesh( "atbLetterboxTop_geo", letterboxGrp, "polyPlane", creator, &status );
+    maskNodes.letterboxBottom = createMesh( "atbLetterboxBottom_geo", letterboxGrp, "polyPlane", creator, &status );
+    maskNodes.letterboxLeft = createMesh( "atbLetterboxLeft_geo", letterboxGrp, "polyPlane", creator, &status );
+    maskNodes.letterboxRight = createMesh( "atbLetterboxRight_geo", letterboxGrp, "polyPlane", creator, &status );
 
-#ifdef LINUX_PLUGIN
-        // with Utopia, it seems to be the same as PPC-mac
-        double counterScale = hThickness * 0.50;
-        double titleScale = hThickness * 0.53;
-        double subtitleScale = hThickness * 0.50;
-#endif
+    if( status ) {
+        MFnDependencyNode mainGrpFn( maskNodes.mainGrp );
 
-// Apple stuff
-// #FIXME! This is a spot that'll need to be added to when
-//		   64-bit Maya hits the Mac, maybe
-#ifdef __APPLE__
-	//##NEW
-//	#if defined(TDT_MAYA_2011)
-	#if defined(__i386__)
-       	double counterScale = hThickness * 0.11;
-       	double titleScale = hThickness * 0.15;
-       	double subtitleScale = hThickness * 0.15;
-	#else
-       	double counterScale = hThickness * 0.50;
-       	double titleScale = hThickness * 0.53;
-      	double subtitleScale = hThickness * 0.50;
-	#endif
-	/*
-	#elif defined(TDT_MAYA_2009)
-		// I know these are the same as Maya 2008, but I have reason
-		// for keeping them separate
-       	double counterScale = hThickness * 0.11;
-       	double titleScale = hThickness * 0.15;
-       	double subtitleScale = hThickness * 0.15;
-	#elif defined(TDT_MAYA_2008)
-       	double counterScale = hThickness * 0.11;
-       	double titleScale = hThickness * 0.15;
-       	double subtitleScale = hThickness * 0.15;
-	#elif defined(TDT_MAYA_85)
-       	double counterScale = hThickness * 0.11;
-       	double titleScale = hThickness * 0.15;
-       	double subtitleScale = hThickness * 0.15;
-	#else
-		// other ones are ppc only, 8.0 and 7.0.
-       	double counterScale = hThickness * 0.034;
-       	double titleScale = hThickness * 0.046;
-       	double subtitleScale = hThickness * 0.042;
-	#endif
-	 */
-#endif
+        // The whole mask is drawn as a reference so it
+        // can't be selected in the viewport
+        dagModifier.newPlugValueBool( mainGrpFn.findPlug( "overrideEnabled" ), true );
+        dagModifier.newPlugValueInt( mainGrpFn.findPlug( "overrideDisplayType" ), 2 );
 
-        MString topPlaneName( "atbFrameTop_geo" );
-        MString bottomPlaneName( "atbFrameBottom_geo" );
-        MString leftPlaneName( "atbFrameRight_geo" );
-        MString rightPlaneName( "atbFrameLeft_geo" );
+        // Every other use of a glyph instances its shape
+        if( glyphInstanceCmd.length() > 0 )
+            dagModifier.commandToExecute( glyphInstanceCmd );
 
-        MString mainGroupName( mainGrpName );
-        MString topFrameGroupName( "atbFrameTop_grp" );
-        MString bottomFrameGroupName( "atbFrameBottom_grp" );
-        MString sideFrameGroupName( "atbFrameSides_grp" );
+        // One assignment per shader, the text shader covers
+        // every instance of the glyphs
+        MString nullStr( "" );
+        MString textMembers;
+
+        textMembers = textMembers + " " + counterDigitsGrpName;
+        if( !maskNodes.title.layout.isNull() )
+            textMembers += " atbTitleText_layout";
+        if( !maskNodes.bottomLeft.layout.isNull() )
+            textMembers += " atbBottomLeftText_layout";
+        if( !maskNodes.bottomRight.layout.isNull() )
+            textMembers += " atbBottomRightText_layout";
+
+        dagModifier.commandToExecute( nullStr +
+                                      "sets -e -forceElement " + borderShaderGroupName +
+                                      " atbFrameTop_geo atbFrameBottom_geo atbFrameLeft_geo atbFrameRight_geo; " +
+                                      "sets -e -forceElement " + ltbxShaderGroupName + " atbLetterbox_grp; " +
+                                      "sets -e -forceElement " + keyIconShaderGroupName + " atbKeyIcon_geo; " +
+                                      "sets -e -forceElement " + bdIconShaderGroupName + " atbBreakdownIcon_geo; " +
+                                      "sets -e -forceElement " + textShaderGroupName + textMembers + "; " );
 
-        // How far to move the mask edges to fit the gate
-        double edgeVertTrans = top - (hThickness/2.0);
-        double edgeHoriTrans = right - (vThickness/2.0);
+        // Constrain the mask to the camera
+        dagModifier.commandToExecute( "parentConstraint -weight 1 " + camTransNodeName + " " + mainGrpName );
 
-        MString nullStr( "" );
-        MDoubleArray boundingBox;
-
-        // Create the Top Border (and labels/icons)
-        MGlobal::executeCommand( nullStr + "polyPlane -w " + width + " -h " + hThickness + "-sx 1 -sy 1 -ch 0 -n " + topPlaneName + "; " +
-                                 "setAttr " + topPlaneName + "Shape.overrideEnabled 1; setAttr " + topPlaneName + "Shape.overrideDisplayType 2; " +
-                                 "rotate -a 90 0 0 " + topPlaneName + "; " +
-                                 "move -a 0 " + edgeVertTrans + " " + -shotMaskZPos + " " + topPlaneName + "; " +
-                                 "select -r " + topPlaneName + "; sets -e -forceElement " + borderShaderGroupName + "; " +
-                                 "group -n " + topFrameGroupName + "; ", false, true );
-
-        if( shotMaskTitle != "" ) {
-            MString titleGeoName( "atbTitleText" );
-            createText( titleGeoName, titleTextGrpName, shotMaskTitle, font );
-            MGlobal::executeCommand( nullStr + "xform -cp " + titleGeoName + "; " +
-                                     "move -rpr 0 " + edgeVertTrans + " " + -textZPos + " " + titleGeoName + "; " + 
-                                     "scale -a " + titleScale + " " + titleScale + " " + titleScale + " " + titleGeoName + "; " +
-                                     "makeIdentity -apply true -t 1 -r 1 -s 1 -n 0 " + titleGeoName + "; " +
-                                     "xform -cp " + titleTextGrpName + "; " +                                      
-                                     "parent -a " + titleTextGrpName + " " + topFrameGroupName + "; ", false, true                               
-                                      );
-            // Move the scale pivot to the top edge
-            //MGlobal::executeCommand( nullStr + "exactWorldBoundingBox " + titleGeoName, boundingBox, false, true );
-            //MGlobal::executeCommand( nullStr + "move -a " + 0.0 + " " + boundingBox[4] + " " + boundingBox[5] + " " + 
-            //                                   titleGeoName + ".scalePivot " + titleGeoName + ".rotatePivot; ", false, true ); 
-        }
+        status = createShotMaskNode();
+    }
 
-        // Add the Key Icon (oval)
-        MGlobal::executeCommand( nullStr + "circle -n atbTempCircle_geo; scale -a 1 0.6 1 atbTempCircle_geo; " +
-                                 "planarSrf -n atbKeyIcon_geo -ch 0 -d 3 -ko 0 -tol 0.01 -rn 0 -po 1 atbTempCircle_geo;" +
-                                 "setAttr " + "atbKeyIcon_geoShape.overrideEnabled 1; setAttr " + "atbKeyIcon_geoShape.overrideDisplayType 2; " +
-                                 "scale -a " + iconScale + " " + iconScale + " " + iconScale + " atbKeyIcon_geo; " +
-                                 "move -rpr " + edgeHoriTrans + " " + edgeVertTrans + " " + -iconZPos + " atbKeyIcon_geo;" +
-                                 "delete atbTempCircle_geo;" + 
-                                 "select -r atbKeyIcon_geo; sets -e -forceElement " + keyIconShaderGroupName + "; ", false, true );
-
-        // Add the Breakdown Icon (underline)
-        MGlobal::executeCommand( nullStr + "nurbsPlane -w 2.0 -lr 0.1 -ch 0 -n atbBreakdownIcon_geo; " +
-                                 "setAttr " + "atbBreakdownIcon_geoShape.overrideEnabled 1; setAttr " + "atbBreakdownIcon_geoShape.overrideDisplayType 2; " +
-                                 "rotate -a 0 90 0 atbBreakdownIcon_geo; " +
-                                 "scale -a " + iconScale + " " + iconScale + " " + iconScale + " atbBreakdownIcon_geo; " +
-                                 "move -rpr " + edgeHoriTrans + " " + (edgeVertTrans - (0.3 *hThickness)) + " " + -iconZPos + " atbBreakdownIcon_geo; " + 
-                                 "select -r atbBreakdownIcon_geo; sets -e -forceElement " + bdIconShaderGroupName + "; ", false, true );
-
-        // Create the Frame Counter Group and move to the right edge
-        MGlobal::executeCommand( nullStr + "select -r atbKeyIcon_geo atbBreakdownIcon_geo; " +
-                                 "group -n " + frameCounterGrpName + "; xform -os -piv 0 0 0; "
-                                 
-                                 //"scale -a 1.2 1.2 1.2 atbFrameCounter_grp;" +
-                                 "xform -cp " + frameCounterGrpName + "; " +  
-                                 "scale -a 1.2 1.2 1.0 atbFrameCounter_grp;" +
-                                 // Parent the Frame Counter Group to the Top Border
-                                 "parent -a " + frameCounterGrpName + " " + topFrameGroupName + "; ", false, true );                
-
-        // Create the digits of the frame counter
-        createFrameCounter( counterScale, frameNumZPos, hThickness, edgeHoriTrans, edgeVertTrans );
-        // Slight the counter slightly left and down from the edges
-        MGlobal::executeCommand( nullStr +
-                                 "move -r " + (-0.13 * vThickness) + " " + (-0.04 * hThickness) + " 0 " + frameCounterGrpName + "; " + 
-                                 "makeIdentity -apply true -t 1 -r 1 -s 1 -n 0 " + frameCounterGrpName + "; ", false, true );
-
-        // Move pivot to top right corner for the frame counter
-        MGlobal::executeCommand( nullStr + "exactWorldBoundingBox " + frameCounterGrpName, boundingBox, false, true );
-        MGlobal::executeCommand( nullStr + "move -a " + boundingBox[3] + " " + boundingBox[4] + " " + boundingBox[5] + " " + 
-                                               frameCounterGrpName + ".scalePivot " + frameCounterGrpName + ".rotatePivot; ", false, true ); 
-
-        // Create the Bottom Border (and labels/icons)
-        MGlobal::executeCommand( nullStr + "polyPlane -w " + width + " -h " + hThickness + "-sx 1 -sy 1 -ch 0 -n " + bottomPlaneName + "; " +
-                                 "setAttr " + bottomPlaneName + "Shape.overrideEnabled 1; setAttr " + bottomPlaneName + "Shape.overrideDisplayType 2; " +
-                                 "rotate -a 90 0 0 " + bottomPlaneName + "; " +
-                                 "move -a 0 " + -edgeVertTrans + " " + -shotMaskZPos + " " + bottomPlaneName + "; " + 
-                                 "select -r " + bottomPlaneName + "; sets -e -forceElement " + borderShaderGroupName + "; " + 
-                                 "group -n " + bottomFrameGroupName + "; ", false, true );
-
-        double subtitleVertPos, subtitleHoriPos, textHeight, textWidth;
-
-        double padding = 0.03 * width;
-
-        // Create the text if necessary
-        if( shotMaskText1 != "" ) {
-            MString textGeoName( "atbBottomLeftText" );
-            createText( textGeoName, bottomLeftTextGrpName, shotMaskText1, font );
-
-            // We want to vertically align the text in the middle of the mask edge
-            MGlobal::executeCommand( nullStr + "exactWorldBoundingBox " + bottomLeftTextGrpName, boundingBox, false, true );
-
-            textHeight = boundingBox[4] - boundingBox[1]; 
-            subtitleVertPos = (-edgeVertTrans - (0.25 * textHeight * subtitleScale ));
-
-            // Caculate the horizontal position with a fixed padding          
-            subtitleHoriPos = left + padding;
-
-            // Create the bottom-left aligned text
-            MGlobal::executeCommand( nullStr + 
-                                     "move -r " + subtitleHoriPos + " " + subtitleVertPos + " " + -textZPos + " " + textGeoName + "; " + 
-                                     "scale -a " + subtitleScale + " " + subtitleScale + " " + subtitleScale + " " + textGeoName + "; " +
-                                     "makeIdentity -apply true -t 1 -r 1 -s 1 -n 0 " + textGeoName + "; " +
-                                     "xform -cp " + bottomLeftTextGrpName + "; " +
-                                     "parent -a " + bottomLeftTextGrpName + " " + bottomFrameGroupName + "; ", false, true                                  
-                                     );
-
-            // Move the scale pivot to the top edge
-            MGlobal::executeCommand( nullStr + "exactWorldBoundingBox " + textGeoName, boundingBox, false, true );
-            MGlobal::executeCommand( nullStr + "move -a " + boundingBox[0] + " " + (boundingBox[4] - (textHeight * subtitleScale * 0.5))+ " " + boundingBox[5] + " " + 
-                                               textGeoName + ".scalePivot " + textGeoName + ".rotatePivot; ", false, true ); 
-        }
+    return status;
+}
+
+
+//*********************************************************
+// Name: layoutShotMask
+// Desc: Gets the camera settings and the bounds of the
+//       text for the layout and applies the transforms it
+//       calculates to the mask nodes
+//*********************************************************
+MStatus ShotMaskCommand::layoutShotMask()
+{
+    MStatus status = MS::kSuccess;
+
+    ShotMaskLayout::Camera camera;
+    camera.orthographic = pCameraFn->isOrtho();
+    camera.orthoWidth = pCameraFn->orthoWidth();
+    camera.horizontalFOV = pCameraFn->horizontalFieldOfView();
+    camera.verticalFOV = pCameraFn->verticalFieldOfView();
+    camera.nearClip = pCameraFn->nearClippingPlane();
+    camera.filmFit = (ShotMaskLayout::FilmFit)pCameraFn->filmFit();
+    camera.filmAspectRatio = filmAspectRatio;
+
+    ShotMaskLayout::Input input;
+    input.aspectRatio = aspectRatio;
+    input.renderAspectRatio = renderAspectRatio;
+    input.maskThickness = maskThickness;
+    input.textScales = ShotMaskLayout::getPlatformTextScales();
+    input.titleBox = getLayoutBox( maskNodes.title.box );
+    input.bottomLeftBox = getLayoutBox( maskNodes.bottomLeft.box );
+    input.bottomRightBox = getLayoutBox( maskNodes.bottomRight.box );
+    input.digitBox = getLayoutBox( maskNodes.digitBox );
+    input.slotOffsets = maskNodes.slotOffsets;
+
+    ShotMaskLayout::Result result;
+    ShotMaskLayout::layout( camera, input, result );
+
+    setTransform( maskNodes.topPlane, result.topPlane );
+    setTransform( maskNodes.bottomPlane, result.bottomPlane );
+    setTransform( maskNodes.leftPlane, result.leftPlane );
+    setTransform( maskNodes.rightPlane, result.rightPlane );
+
+    setTransform( maskNodes.letterboxTop, result.letterboxTop );
+    setTransform( maskNodes.letterboxBottom, result.letterboxBottom );
+    setTransform( maskNodes.letterboxLeft, result.letterboxLeft );
+    setTransform( maskNodes.letterboxRight, result.letterboxRight );
+
+    // The scale set by the UI is applied around the pivot
+    // of the text node
+    if( !maskNodes.title.layout.isNull() ) {
+        setTransform( maskNodes.title.layout, result.title );
+        setPivot( maskNodes.title.text, result.titlePivot );
+    }
+    if( !maskNodes.bottomLeft.layout.isNull() ) {
+        setTransform( maskNodes.bottomLeft.layout, result.bottomLeft );
+        setPivot( maskNodes.bottomLeft.text, result.bottomLeftPivot );
+    }
+    if( !maskNodes.bottomRight.layout.isNull() ) {
+        setTransform( maskNodes.bottomRight.layout, result.bottomRight );
+        setPivot( maskNodes.bottomRight.text, result.bottomRightPivot );
+    }
+
+    setTransform( maskNodes.keyIcon, result.keyIcon );
+    setTransform( maskNodes.breakdownIcon, result.breakdownIcon );
+
+    for( unsigned int i = 0; i < maskNodes.counterSlots.size(); i++ )
+        setTransform( maskNodes.counterSlots[i], result.counterSlots[i] );
+
+    setPivot( maskNodes.frameCounterGrp, result.counterPivot );
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: editShotMask
+// Desc: Changes only what the edit flags ask for.  New
+//       text replaces just its own line, a new thickness
+//       only moves and scales the existing nodes and a
+//       shader edit only sets the shader.  The layout is
+//       redone after a thickness or text change.
+//*********************************************************
+MStatus ShotMaskCommand::editShotMask()
+{
+    pluginTrace( "ShotMaskCommand", "editShotMask", "***" );
+
+    MStatus status = MS::kSuccess;
+    bool relayout = editThickness || editTitle || editText1 || editText2;
+
+    if( !(status = loadShotMask() )) {
+        pluginError( "ShotMaskCommand", "editShotMask", "Failed to find the shot mask" );
+        return status;
+    }
+    else if( relayout && !(status = loadShotMaskLayout() )) {
+        pluginError( "ShotMaskCommand", "editShotMask", "Failed to find the shot mask nodes" );
+        return status;
+    }
+
+    MObject maskNode = maskNodes.maskNode;
+
+    if( editThickness )
+        dagModifier.newPlugValueDouble( MPlug( maskNode, ShotMaskNode::maskThicknessAttr ), maskThickness );
+
+    if( status && editTitle )
+        status = editText( "atbTitleText", titleTextGrpName, shotMaskTitle, maskNodes.topFrameGrp,
+                           ShotMaskNode::titleAttr, maskNodes.title );
+    if( status && editText1 )
+        status = editText( "atbBottomLeftText", bottomLeftTextGrpName, shotMaskText1, maskNodes.bottomFrameGrp,
+                           ShotMaskNode::text1Attr, maskNodes.bottomLeft );
+    if( status && editText2 )
+        status = editText( "atbBottomRightText", bottomRightTextGrpName, shotMaskText2, maskNodes.bottomFrameGrp,
+                           ShotMaskNode::text2Attr, maskNodes.bottomRight );
+
+    if( status && (editColor || editTransparency) )
+        status = editShader();
+
+    if( !status ) {
+        pluginError( "ShotMaskCommand", "editShotMask", "Failed to edit the shot mask" );
+    }
+    else if( !(status = dagModifier.doIt() )) {
+        pluginError( "ShotMaskCommand", "editShotMask", "Failed to change the shot mask nodes" );
+    }
+    else if( relayout && !(status = layoutShotMask() )) {
+        pluginError( "ShotMaskCommand", "editShotMask", "Failed to lay out the shot mask" );
+    }
+    else if( relayout && !(status = layoutModifier.doIt() )) {
+        pluginError( "ShotMaskCommand", "editShotMask", "Failed to position the shot mask" );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: loadShotMask
+// Desc: Gets the existing mask from its shot mask node.
+//       Settings that aren't being edited are read from
+//       the node.
+//*********************************************************
+MStatus ShotMaskCommand::loadShotMask()
+{
+    MStatus status = MS::kSuccess;
+
+    MObject maskNode = findShotMaskNode();
+    MObject cameraNode;
+
+    if( maskNode.isNull() ) {
+        MGlobal::displayError( "A shot mask has not been created" );
+        return MS::kFailure;
+    }
+    else if( (maskNodes.mainGrp = getSourceNode( MPlug( maskNode, ShotMaskNode::maskRootAttr ))).isNull() ||
+             (cameraNode = getSourceNode( MPlug( maskNode, ShotMaskNode::cameraAttr ))).isNull() ) {
+        MGlobal::displayError( "The shot mask needs to be rebuilt" );
+        pluginError( "ShotMaskCommand", "loadShotMask", "The shot mask node isn't connected to the mask" );
+        return MS::kFailure;
+    }
+
+    maskNodes.maskNode = maskNode;
+
+    // The settings the mask was built with
+    maskAspectRatio = MPlug( maskNode, ShotMaskNode::aspectRatioAttr ).asDouble();
+
+    if( !editThickness )
+        maskThickness = MPlug( maskNode, ShotMaskNode::maskThicknessAttr ).asDouble();
+    if( !editTitle )
+        shotMaskTitle = MPlug( maskNode, ShotMaskNode::titleAttr ).asString();
+    if( !editText1 )
+        shotMaskText1 = MPlug( maskNode, ShotMaskNode::text1Attr ).asString();
+    if( !editText2 )
+        shotMaskText2 = MPlug( maskNode, ShotMaskNode::text2Attr ).asString();
+
+    counterFormat.format = (FrameCounterFormat::Format)MPlug( maskNode, ShotMaskNode::counterFormatAttr ).asShort();
+    counterFormat.numDigits = MPlug( maskNode, ShotMaskNode::counterDigitsAttr ).asInt();
+    counterFormat.framesPerFoot = MPlug( maskNode, ShotMaskNode::framesPerFootAttr ).asInt();
+    counterFormat.showSign = MPlug( maskNode, ShotMaskNode::signVisibilityAttr ).isConnected();
+
+    MPlug shadersPlug( maskNode, ShotMaskNode::shadersAttr );
+    for( unsigned int i = 0; i < numShaderElements; i++ )
+        maskNodes.shaders.append( getSourceNode( shadersPlug.elementByLogicalIndex( i )));
+
+    camTransNodeName = MFnDagNode( cameraNode ).partialPathName();
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: loadShotMaskLayout
+// Desc: Gets the nodes of the existing mask the layout
+//       positions.  They're looked up by name below the
+//       mask's main group, so other nodes in the scene
+//       with the same names don't matter.
+//*********************************************************
+MStatus ShotMaskCommand::loadShotMaskLayout()
+{
+    MStatus status = MS::kSuccess;
+
+    if( !(status = initCamera() )) {
+        pluginError( "ShotMaskCommand", "loadShotMaskLayout", "Failed to get the shot mask camera" );
+        return status;
+    }
+
+    // Every transform of the mask by name
+    std::map<std::string, MObject> maskTransforms;
+    MItDag dagIter;
+
+    dagIter.reset( maskNodes.mainGrp, MItDag::kDepthFirst, MFn::kTransform );
+    for( ; !dagIter.isDone(); dagIter.next() ) {
+        MObject node = dagIter.currentItem();
+        maskTransforms[MFnDependencyNode( node ).name().asChar()] = node;
+    }
+
+    maskNodes.topFrameGrp = maskTransforms["atbFrameTop_grp"];
+    maskNodes.bottomFrameGrp = maskTransforms["atbFrameBottom_grp"];
+
+    maskNodes.topPlane = maskTransforms["atbFrameTop_geo"];
+    maskNodes.bottomPlane = maskTransforms["atbFrameBottom_geo"];
+    maskNodes.leftPlane = maskTransforms["atbFrameLeft_geo"];
+    maskNodes.rightPlane = maskTransforms["atbFrameRight_geo"];
+
+    maskNodes.letterboxTop = maskTransforms["atbLetterboxTop_geo"];
+    maskNodes.letterboxBottom = maskTransforms["atbLetterboxBottom_geo"];
+    maskNodes.letterboxLeft = maskTransforms["atbLetterboxLeft_geo"];
+    maskNodes.letterboxRight = maskTransforms["atbLetterboxRight_geo"];
+
+    TextNodes *textNodes[] = { &maskNodes.title, &maskNodes.bottomLeft, &maskNodes.bottomRight };
+    const char *textNames[] = { "atbTitleText", "atbBottomLeftText", "atbBottomRightText" };
+    const char *textGrpNames[] = { titleTextGrpName, bottomLeftTextGrpName, bottomRightTextGrpName };
+    const MString *texts[] = { &shotMaskTitle, &shotMaskText1, &shotMaskText2 };
+
+    for( unsigned int i = 0; i < 3 && status; i++ ) {
+        std::string textName( textNames[i] );
+
+        textNodes[i]->grp = maskTransforms[textGrpNames[i]];
+        textNodes[i]->text = maskTransforms[textName];
+        textNodes[i]->layout = maskTransforms[textName + "_layout"];
+
+        if( !textNodes[i]->layout.isNull() )
+            textNodes[i]->box = measureText( *texts[i], &status );
+    }
+
+    maskNodes.frameCounterGrp = maskTransforms[frameCounterGrpName];
+    maskNodes.keyIcon = maskTransforms["atbKeyIcon_geo"];
+    maskNodes.breakdownIcon = maskTransforms["atbBreakdownIcon_geo"];
+
+    // The counter slots from the right, named the way
+    // createFrameCounter names them
+    if( status )
+        maskNodes.digitBox = measureDigits( &status );
+
+    std::string slots = counterFormat.getSlots();
+    unsigned int digitSlot = 0, separatorSlot = 0;
+    double offset = 0.0;
 
-        if( shotMaskText2 != "" ) {
-            MString textGeoName( "atbBottomRightText" );
-            createText( textGeoName, bottomRightTextGrpName, shotMaskText2, font );
-
-            // We want to calculate the right alignment
-            MGlobal::executeCommand( nullStr + "exactWorldBoundingBox " + bottomRightTextGrpName, boundingBox, false, true );
-
-            // Caculate the vertical alignment (it may not have been done before)
-            textHeight = boundingBox[4] - boundingBox[1]; 
-            subtitleVertPos = (-edgeVertTrans - (0.25 * textHeight * subtitleScale ));
-
-            textWidth = boundingBox[3] - boundingBox[0];
-            subtitleHoriPos = right - (textWidth * subtitleScale) - padding;
-
-            // Create the bottom-right aligned text
-            MGlobal::executeCommand( nullStr + 
-                                     "move -r " + subtitleHoriPos + " " + subtitleVertPos + " " + -textZPos + " " + textGeoName + "; " + 
-                                     "scale -a " + subtitleScale + " " + subtitleScale + " " + subtitleScale + " " + textGeoName + "; " +
-                                     "makeIdentity -apply true -t 1 -r 1 -s 1 -n 0 " + textGeoName + "; " +
-                                     "xform -cp " + bottomRightTextGrpName + "; " +
-                                     "parent -a " + bottomRightTextGrpName + " " + bottomFrameGroupName + "; ", false, true                                  
-                                     );
-
-            // Move the scale pivot to the top edge
-            MGlobal::executeCommand( nullStr + "exactWorldBoundingBox " + textGeoName, boundingBox, false, true );
-            MGlobal::executeCommand( nullStr + "move -a " + boundingBox[3] + " " + (boundingBox[4] - (textHeight * subtitleScale * 0.5))+ " " + boundingBox[5] + " " + 
-                                               textGeoName + ".scalePivot " + textGeoName + ".rotatePivot; ", false, true ); 
+    for( int i = (int)slots.size() - 1; i >= 0 && status; i-- ) {
+        MString slotName = getCounterSlotName( slots[i], digitSlot, separatorSlot );
+        double slotWidth = getCounterSlotWidth( slots[i], &status );
+
+        if( i < (int)slots.size() - 1 )
+            offset -= slotWidth;
+
+        maskNodes.counterSlots.push_back( maskTransforms[slotName.asChar()] );
+        maskNodes.slotOffsets.push_back( offset );
+    }
+
+    // Every node the layout moves needs to be there
+    MObject requiredNodes[] = { maskNodes.topFrameGrp, maskNodes.bottomFrameGrp,
+                                maskNodes.topPlane, maskNodes.bottomPlane, maskNodes.leftPlane, maskNodes.rightPlane,
+                                maskNodes.letterboxTop, maskNodes.letterboxBottom,
+                                maskNodes.letterboxLeft, maskNodes.letterboxRight,
+                                maskNodes.frameCounterGrp, maskNodes.keyIcon, maskNodes.breakdownIcon };
+
+    for( unsigned int i = 0; i < sizeof( requiredNodes ) / sizeof( MObject ) && status; i++ ) {
+        if( requiredNodes[i].isNull() )
+            status = MS::kFailure;
+    }
+    for( unsigned int i = 0; i < maskNodes.counterSlots.size() && status; i++ ) {
+        if( maskNodes.counterSlots[i].isNull() )
+            status = MS::kFailure;
+    }
+
+    if( !status ) {
+        MGlobal::displayError( "The shot mask needs to be rebuilt" );
+        pluginError( "ShotMaskCommand", "loadShotMaskLayout", "The shot mask is missing nodes" );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: editText
+// Desc: Replaces one line of text.  The old line is
+//       deleted and the new one built in the same modifier,
+//       the rest of the mask is left as it is.
+//*********************************************************
+MStatus ShotMaskCommand::editText( const MString &name, const MString &grpNodeName, const MString &text,
+                                   const MObject &parent, const MObject &textAttr, TextNodes &textNodes )
+{
+    MStatus status = MS::kSuccess;
+
+    if( !textNodes.grp.isNull() )
+        status = dagModifier.deleteNode( textNodes.grp );
+
+    textNodes = TextNodes();
+
+    if( status && text != "" ) {
+        glyphInstanceCmd.clear();
+
+        createText( name, grpNodeName, text, parent, textNodes, &status );
+
+        if( status && glyphInstanceCmd.length() > 0 )
+            dagModifier.commandToExecute( glyphInstanceCmd );
+
+        // The shading group is found through the text shader
+        MObject shadingGroup = getShadingGroup( maskNodes.shaders[1] );
+        if( status && !shadingGroup.isNull() ) {
+            dagModifier.commandToExecute( "sets -e -forceElement " + MFnDependencyNode( shadingGroup ).name() +
+                                          " " + name + "_layout" );
         }
+    }
 
-        // Create the side border edges
-        double sideBorderHeight = height - (2 * hThickness);
-
-        // left edge
-        MGlobal::executeCommand( nullStr + "polyPlane -w " + vThickness + " -h " + sideBorderHeight + "-sx 1 -sy 1 -ch 0 -n " + leftPlaneName + "; " +
-                                 "setAttr " + leftPlaneName + "Shape.overrideEnabled 1; setAttr " + leftPlaneName + "Shape.overrideDisplayType 2; " +
-                                 "rotate -a 90 0 0 " + leftPlaneName + "; " +
-                                 "move -a " + -edgeHoriTrans + " 0 " + -shotMaskZPos + " " + leftPlaneName + "; " +
-                                 "select -r " + leftPlaneName + "; sets -e -forceElement " + borderShaderGroupName + "; " +
-                                 "group -n " + sideFrameGroupName + "; ", false, true );
-
-        // right edge
-        MGlobal::executeCommand( nullStr + "polyPlane -w " + vThickness + " -h " + sideBorderHeight + "-sx 1 -sy 1 -ch 0 -n " + rightPlaneName + "; " +
-                                 "setAttr " + rightPlaneName + "Shape.overrideEnabled 1; setAttr " + rightPlaneName + "Shape.overrideDisplayType 2; " +
-                                 "rotate -a 90 0 0 " + rightPlaneName + "; " +
-                                 "move -a " + edgeHoriTrans + " 0 " + -shotMaskZPos + " " + rightPlaneName + "; " +
-                                 "select -r " + rightPlaneName + "; sets -e -forceElement " + borderShaderGroupName + "; " + 
-                                 "parent -a " + rightPlaneName + " " + sideFrameGroupName + "; ", false, true );
-
-
-        // Create the letterbox geo
-        MString letterboxGrpName( "atbLetterbox_grp" );
-        MString letterboxTopName( "atbLetterboxTop_geo" );
-        MString letterboxBottomName( "atbLetterboxBottom_geo" );
-        MString letterboxLeftName( "atbLetterboxLeft_geo" );
-        MString letterboxRightName( "atbLetterboxRight_geo" );
-
-        double lbWidth = 3 * width;
-        double lbHeight = height;
-
-        // Letterboxing should be located on the outer edge
-        // of the gate
-        edgeVertTrans = top + (lbHeight/2.0);
-        
-        // top letterbox edge
-        MGlobal::executeCommand( nullStr + "polyPlane -w " + lbWidth + " -h " + lbHeight + "-sx 1 -sy 1 -ch 0 -n " + letterboxTopName + "; " +
-                                 "setAttr " + letterboxTopName + "Shape.overrideEnabled 1; setAttr " + letterboxTopName + "Shape.overrideDisplayType 2; " +
-                                 "rotate -a 90 0 0 " + letterboxTopName + "; " +
-                                 "move -a 0 " + edgeVertTrans + " " + -shotMaskZPos + " " + letterboxTopName + "; " +
-                                 "select -r " + letterboxTopName + "; sets -e -forceElement " + ltbxShaderGroupName + "; ", false, true );
-        // bottom leterbox edge
-        MGlobal::executeCommand( nullStr + "polyPlane -w " + lbWidth + " -h " + lbHeight + "-sx 1 -sy 1 -ch 0 -n " + letterboxBottomName + "; " +
-                                 "setAttr " + letterboxBottomName + "Shape.overrideEnabled 1; setAttr " + letterboxBottomName + "Shape.overrideDisplayType 2; " +
-                                 "rotate -a 90 0 0 " + letterboxBottomName + "; " +
-                                 "move -a 0 " + -edgeVertTrans + " " + -shotMaskZPos + " " + letterboxBottomName + "; " +
-                                 "select -r " + letterboxBottomName + "; sets -e -forceElement " + ltbxShaderGroupName + "; ", false, true );
-
-        lbWidth = width;
-        lbHeight = height;
-
-        edgeHoriTrans = right + (0.5 * lbWidth);
-
-        // left letterbox edge
-        MGlobal::executeCommand( nullStr + "polyPlane -w " + lbWidth + " -h " + lbHeight + "-sx 1 -sy 1 -ch 0 -n " + letterboxLeftName + "; " +
-                                 "setAttr " + letterboxLeftName + "Shape.overrideEnabled 1; setAttr " + letterboxLeftName + "Shape.overrideDisplayType 2; " +
-                                 "rotate -a 90 0 0 " + letterboxLeftName + "; " +
-                                 "move -a " + -edgeHoriTrans + " 0 " + -shotMaskZPos + " " + letterboxLeftName + "; " +
-                                 "select -r " + letterboxLeftName + "; sets -e -forceElement " + ltbxShaderGroupName + "; ", false, true );
-
-        // right letterbox edge
-        MGlobal::executeCommand( nullStr + "polyPlane -w " + lbWidth + " -h " + lbHeight + "-sx 1 -sy 1 -ch 0 -n " + letterboxRightName + "; " +
-                                 "setAttr " + letterboxRightName + "Shape.overrideEnabled 1; setAttr " + letterboxRightName + "Shape.overrideDisplayType 2; " +
-                                 "rotate -a 90 0 0 " + letterboxRightName + "; " +
-                                 "move -a " + edgeHoriTrans + " 0 " + -shotMaskZPos + " " + letterboxRightName + "; " +
-                                 "select -r " + letterboxRightName + "; sets -e -forceElement " + ltbxShaderGroupName + "; ", false, true );
-
-        // Group the letterbox geo together
-        MGlobal::executeCommand( "select -r " + letterboxTopName + " " + 
-                                                letterboxBottomName + " " + 
-                                                letterboxLeftName + " " + 
-                                                letterboxRightName + "; " +
-                                 "group -n " + letterboxGrpName + "; xform -os -piv 0 0 0; ", false, true );
-
-        // Group the mask border together
-        MGlobal::executeCommand( "select -r " + topFrameGroupName + " " + 
-                                                bottomFrameGroupName + " " + 
-                                                sideFrameGroupName +  " " + 
-                                                letterboxGrpName + "; " +
-                                 "group -n " + mainGrpName + "; xform -os -piv 0 0 0; ", false, true);
+    if( !status ) {
+        pluginError( "ShotMaskCommand", "editText", "Failed to replace " + name );
+    }
+    else
+        dagModifier.newPlugValueString( MPlug( maskNodes.maskNode, textAttr ), text );
 
-        // Constrain the mask to the camera
-        MGlobal::executeCommand( "select -r " + camTransNodeName + "; select -add " + mainGrpName + "; " +  
-                                 "parentConstraint -weight 1", false, true );
+    return status;
+}
+
+
+//*********************************************************
+// Name: editShader
+// Desc: Sets the color and/or transparency of the shader
+//       picked by the -element flag
+//*********************************************************
+MStatus ShotMaskCommand::editShader()
+{
+    MStatus status = MS::kSuccess;
+    MObject shader = maskNodes.shaders[shaderIndex];
+
+    if( shader.isNull() ) {
+        MGlobal::displayError( MString( "The shot mask has no " ) + shaderElements[shaderIndex] + " shader" );
+        return MS::kFailure;
+    }
+
+    MFnDependencyNode shaderFn( shader );
+    const char *channels[] = { "R", "G", "B" };
+
+    for( unsigned int i = 0; i < 3; i++ ) {
+        if( editColor )
+            dagModifier.newPlugValueFloat( shaderFn.findPlug( MString( "color" ) + channels[i] ), (float)shaderColor[i] );
+        if( editTransparency )
+            dagModifier.newPlugValueFloat( shaderFn.findPlug( MString( "transparency" ) + channels[i] ),
+                                           (float)shaderTransparency[i] );
     }
 
     return status;
 }
 
+
 //*********************************************************
 // Name: createShotMaskShaders
 // Desc: Create the shot mask shaders
@@ -817,448 +1250,625 @@ MStatus ShotMaskCommand::createShotMaskShaders()
     MString newShadingNodeStr( "shadingNode -asShader lambert -name " );
 
     // The border shader
-    MGlobal::executeCommand( newShadingNodeStr + borderShaderNodeName + "; " +
-                             "sets -r true -nss true -em -n " + borderShaderGroupName + "; " +
-                             "connectAttr -f " + borderShaderNodeName + ".outColor " + borderShaderGroupName + ".surfaceShader; " +
-                             "setAttr \"" + borderShaderNodeName + ".color\" -type double3 0.0 0.0 0.0; " +
-                             "setAttr \"" + borderShaderNodeName + ".transparency\" -type double3 0.85 0.85 0.85; ", false, true );
+    dagModifier.commandToExecute( newShadingNodeStr + borderShaderNodeName + "; " +
+                                  "sets -r true -nss true -em -n " + borderShaderGroupName + "; " +
+                                  "connectAttr -f " + borderShaderNodeName + ".outColor " + borderShaderGroupName + ".surfaceShader; " +
+                                  "setAttr \"" + borderShaderNodeName + ".color\" -type double3 0.0 0.0 0.0; " +
+                                  "setAttr \"" + borderShaderNodeName + ".transparency\" -type double3 0.85 0.85 0.85; " );
     // The text shader
-    MGlobal::executeCommand( newShadingNodeStr + textShaderNodeName + "; " +
-                             "sets -r true -nss true -em -n " + textShaderGroupName + "; " +
-                             "connectAttr -f " + textShaderNodeName + ".outColor " + textShaderGroupName + ".surfaceShader; " +
-                             "setAttr \"" + textShaderNodeName + ".color\" -type double3 1.0 1.0 1.0; " +
-                             "setAttr \"" + textShaderNodeName + ".transparency\" -type double3 0.0 0.0 0.0; ", false, true );
+    dagModifier.commandToExecute( newShadingNodeStr + textShaderNodeName + "; " +
+                                  "sets -r true -nss true -em -n " + textShaderGroupName + "; " +
+                                  "connectAttr -f " + textShaderNodeName + ".outColor " + textShaderGroupName + ".surfaceShader; " +
+                                  "setAttr \"" + textShaderNodeName + ".color\" -type double3 1.0 1.0 1.0; " +
+                                  "setAttr \"" + textShaderNodeName + ".transparency\" -type double3 0.0 0.0 0.0; " );
     // The key shader
-    MGlobal::executeCommand( newShadingNodeStr + keyIconShaderNodeName + "; " +
-                             "sets -r true -nss true -em -n " + keyIconShaderGroupName + "; " +
-                             "connectAttr -f " + keyIconShaderNodeName + ".outColor " + keyIconShaderGroupName + ".surfaceShader; " +
-                             "setAttr \"" + keyIconShaderNodeName + ".color\" -type double3 0.8 0.0 0.0; " +
-                             "setAttr \"" + keyIconShaderNodeName + ".transparency\" -type double3 0.0 0.0 0.0; ", false, true );
+    dagModifier.commandToExecute( newShadingNodeStr + keyIconShaderNodeName + "; " +
+                                  "sets -r true -nss true -em -n " + keyIconShaderGroupName + "; " +
+                                  "connectAttr -f " + keyIconShaderNodeName + ".outColor " + keyIconShaderGroupName + ".surfaceShader; " +
+                                  "setAttr \"" + keyIconShaderNodeName + ".color\" -type double3 0.8 0.0 0.0; " +
+                                  "setAttr \"" + keyIconShaderNodeName + ".transparency\" -type double3 0.0 0.0 0.0; " );
     // The breakdown shader
-    MGlobal::executeCommand( newShadingNodeStr + bdIconShaderNodeName + "; " +
-                             "sets -r true -nss true -em -n " + bdIconShaderGroupName + "; " +
-                             "connectAttr -f " + bdIconShaderNodeName + ".outColor " + bdIconShaderGroupName + ".surfaceShader; " +
-                             "setAttr \"" + bdIconShaderNodeName + ".color\" -type double3 0.0 0.8 0.0; " +
-                             "setAttr \"" + bdIconShaderNodeName + ".transparency\" -type double3 0.0 0.0 0.0; ", false, true );
+    dagModifier.commandToExecute( newShadingNodeStr + bdIconShaderNodeName + "; " +
+                                  "sets -r true -nss true -em -n " + bdIconShaderGroupName + "; " +
+                                  "connectAttr -f " + bdIconShaderNodeName + ".outColor " + bdIconShaderGroupName + ".surfaceShader; " +
+                                  "setAttr \"" + bdIconShaderNodeName + ".color\" -type double3 0.0 0.8 0.0; " +
+                                  "setAttr \"" + bdIconShaderNodeName + ".transparency\" -type double3 0.0 0.0 0.0; " );
     // The letterbox shader
-    MGlobal::executeCommand( newShadingNodeStr + ltbxShaderNodeName + "; " +
-                             "sets -r true -nss true -em -n " + ltbxShaderGroupName + "; " +
-                             "connectAttr -f " + ltbxShaderNodeName + ".outColor " + ltbxShaderGroupName + ".surfaceShader; " +
-                             "setAttr \"" + ltbxShaderNodeName + ".color\" -type double3 0.0 0.0 0.0; " +
-                             "setAttr \"" + ltbxShaderNodeName + ".transparency\" -type double3 0.0 0.0 0.0; ", false, true );
+    dagModifier.commandToExecute( newShadingNodeStr + ltbxShaderNodeName + "; " +
+                                  "sets -r true -nss true -em -n " + ltbxShaderGroupName + "; " +
+                                  "connectAttr -f " + ltbxShaderNodeName + ".outColor " + ltbxShaderGroupName + ".surfaceShader; " +
+                                  "setAttr \"" + ltbxShaderNodeName + ".color\" -type double3 0.0 0.0 0.0; " +
+                                  "setAttr \"" + ltbxShaderNodeName + ".transparency\" -type double3 0.0 0.0 0.0; " );
 
 
     return status;
 }
 
+
 //*********************************************************
-// Name: createText 
-// Desc: Create text for the shot mask
+// Name: createTransform
+// Desc: Adds a named transform node to the build modifier.
+//       Does nothing once an earlier node has failed.
 //*********************************************************
-MStatus ShotMaskCommand::createText( MString name, MString grpNodeName, MString text, MString font )
+MObject ShotMaskCommand::createTransform( const MString &name, const MObject &parent, MStatus *status )
 {
-    MString nullStr( "" );
-    MStringArray nurbsCurveArray;
-
-    MGlobal::executeCommand( nullStr + "textCurves -ch 0 -f \"" + font + "\" -t \"" + text + "\"; ", nurbsCurveArray, false, true );
-
-    MStringArray letters;
-    MGlobal::executeCommand( "listRelatives -c ", letters );
+    MObject transform;
 
-    // Create a group for the text
-    MGlobal::executeCommand( "group -em -n " + grpNodeName + "; " +
-                             "group -em -n " + name + "; " +
-                             "parent -a " + name + " " + grpNodeName + "; ", false, true );
-
-    MString letterName;
-    for( unsigned int i = 0; i < letters.length(); i++ ) {
-        letterName = name;
-        letterName = letterName + "_" + i + "_" + letters[i] + "_geo";
-        MGlobal::executeCommand( nullStr + "select -r " + letters[i] + "; " + 
-                                 "planarSrf -name \"" + letterName + "\" -ch 0 -tol 0.01 -o on -po 1; " +  
-                                 "setAttr " + letterName + "Shape.overrideEnabled 1; setAttr " + letterName + "Shape.overrideDisplayType 2; " +
-                                 "sets -e -forceElement " + textShaderGroupName + "; " +
-                                 "parent -a " + letterName + " " + name + "; ", false, true );
+    if( *status ) {
+        transform = dagModifier.createNode( "transform", parent, status );
+        if( !(*status)) {
+            pluginError( "ShotMaskCommand", "createTransform", "Failed to create " + name );
+        }
+        else
+            dagModifier.renameNode( transform, name );
     }
 
-    MGlobal::executeCommand( nullStr + "delete " + nurbsCurveArray[0] + "; ", false, true );
-
-    return MStatus::kSuccess;
+    return transform;
 }
 
 
 //*********************************************************
-// Name: createFrameCounter
-// Desc: Create the shot mask shaders
+// Name: createMesh
+// Desc: Adds a transform with a unit sized poly primitive
+//       (polyPlane or polyCylinder) facing the camera.  The
+//       layout scales the transform, so the size of a
+//       border can be changed without rebuilding it.
 //*********************************************************
-MStatus ShotMaskCommand::createFrameCounter( double scaleVal,
-                                             double digitZPos, 
-                                             double borderThickness,
-                                             double hEdgeTrans,
-                                             double vEdgeTrans )
+MObject ShotMaskCommand::createMesh( const MString &name, const MObject &parent, const MString &creatorType,
+                                     MObject &creator, MStatus *status )
 {
-    MStatus status = MS::kSuccess;
-
-    double textHeight = 0, textWidth = 0;
-    double vPos = 0, hPos = 0, hOffset = 0;
-    MDoubleArray boundingBox;
+    MObject transform = createTransform( name, parent, status );
 
-    MString numberStr;
-    MString nullStr( "" );
+    if( *status ) {
+        MObject shape = dagModifier.createNode( "mesh", transform, status );
+        if( *status )
+            creator = dagModifier.MDGModifier::createNode( creatorType, status );
 
-    for( unsigned int i = 0; i < 4; i++ ) {
-        MString groupName( "atbDigitColumn_" );
-        groupName = groupName + i + "_grp";
-        MGlobal::executeCommand( "group -em -n " + groupName + "; ", false, true );
+        if( !(*status)) {
+            pluginError( "ShotMaskCommand", "createMesh", "Failed to create " + name );
+        }
+        else {
+            MFnDependencyNode creatorFn( creator );
 
-        hPos += hOffset;
-        for( unsigned int j = 0; j <= 9; j++ ) {
-            MStringArray nurbsCurveArray;
-            MStringArray surfaceArray;
+            dagModifier.renameNode( shape, name + "Shape" );
 
-            MString digitSurfaceName( "atbShotMaskDigit_" );
-            digitSurfaceName = digitSurfaceName + i + "_" + j + "_geo";
+            // Built along z, facing the camera
+            dagModifier.newPlugValueDouble( creatorFn.findPlug( "axisY" ), 0.0 );
+            dagModifier.newPlugValueDouble( creatorFn.findPlug( "axisZ" ), 1.0 );
 
-            numberStr.set( j, 1 );
-            MGlobal::executeCommand( nullStr + "textCurves -ch 0 -f \"" + font + "\" -t " + numberStr.asInt() + "; ", nurbsCurveArray, false, true );
+            if( creatorType == "polyPlane" ) {
+                dagModifier.newPlugValueInt( creatorFn.findPlug( "subdivisionsWidth" ), 1 );
+                dagModifier.newPlugValueInt( creatorFn.findPlug( "subdivisionsHeight" ), 1 );
+            }
+            else {
+                dagModifier.newPlugValueDouble( creatorFn.findPlug( "height" ), 0.001 );
+                dagModifier.newPlugValueInt( creatorFn.findPlug( "subdivisionsAxis" ), 24 );
+            }
 
-            MGlobal::executeCommand( nullStr + "planarSrf -n " + digitSurfaceName + " -ch 0 -tol 0.01 -o on -po 1 " + nurbsCurveArray[0] + "; ",
-                                     surfaceArray, false, true);
-            
-            MGlobal::executeCommand( nullStr + "select -r " + surfaceArray[0] + "; sets -e -forceElement " + textShaderGroupName + "; ", false, true );
+            dagModifier.connect( creatorFn.findPlug( "output" ), MFnDependencyNode( shape ).findPlug( "inMesh" ));
+        }
+    }
 
-            MGlobal::executeCommand( nullStr + "delete " + nurbsCurveArray[0] + "; ", false, true );
+    return transform;
+}
 
-            MGlobal::executeCommand( nullStr +
-                                     "setAttr " + surfaceArray[0] + "Shape.overrideEnabled 1; setAttr " + surfaceArray[0] + "Shape.overrideDisplayType 2; " );
 
-            MGlobal::executeCommand( "parent -a " + surfaceArray[0] + " " + groupName + "; ", false, true );
+//*********************************************************
+// Name: createText
+// Desc: Adds the groups for a line of text and a letter
+//       for every character inside the layout node.  The
+//       letters are placed from the advance of their cached
+//       glyphs and the bounds of the line are kept for the
+//       layout.  The UI scales the text node.  Each line
+//       has its own glyph shapes, so it can be replaced
+//       without touching the others.
+//*********************************************************
+void ShotMaskCommand::createText( const MString &name, const MString &grpNodeName, const MString &text,
+                                  const MObject &parent, TextNodes &textNodes, MStatus *status )
+{
+    glyphShapes.clear();
+
+    textNodes.grp = createTransform( grpNodeName, parent, status );
+    textNodes.text = createTransform( name, textNodes.grp, status );
+    textNodes.layout = createTransform( name + "_layout", textNodes.text, status );
+
+    const char *chars = text.asChar();
+    unsigned int numChars = text.length();
+    unsigned int numLetters = 0;
+    double penPos = 0.0;
+
+    for( unsigned int i = 0; i < numChars && *status; i++ ) {
+        const GlyphCache::Glyph *pGlyph = GlyphCache::getGlyph( font, chars[i], status );
+        if( pGlyph == NULL ) {
+            pluginError( "ShotMaskCommand", "createText", "Failed to get a glyph" );
+            break;
         }
 
-        MGlobal::executeCommand( nullStr + 
-                                 "scale -a " + scaleVal + " " + scaleVal + " " + scaleVal + " " + groupName + "; " +
-                                 "move -r " + hEdgeTrans + " " + vEdgeTrans + " " + -digitZPos + " " + groupName + "; "  +
-                                 "parent -a " + groupName + " " + frameCounterGrpName + "; ", false, true
-                                  );
-        if( textWidth == 0 ) {
-                MGlobal::executeCommand( nullStr + "exactWorldBoundingBox " + groupName, boundingBox, false, true );
-                textHeight = boundingBox[4] - boundingBox[1];
-                vPos = -textHeight * 0.5;
-
-                textWidth = boundingBox[3] - boundingBox[0];
-                double spacing = textWidth * 0.1;
-                hPos = (textWidth) + (spacing);
-                hOffset = -(textWidth + (textWidth * 0.1));
+        if( !pGlyph->isEmpty() ) {
+            MString letterName( name + "_" );
+            letterName = letterName + numLetters++ + "_geo";
+
+            MObject letter = createGlyph( chars[i], letterName, textNodes.layout, status );
+            if( *status )
+                dagModifier.newPlugValueDouble( MFnDependencyNode( letter ).findPlug( "translateX" ), penPos );
         }
-        MGlobal::executeCommand( nullStr + 
-                                 "move -r " + hPos + " " + vPos + " 0 " + groupName + "; ", false, true );
 
+        penPos += pGlyph->advance;
     }
 
-    return status;
+    if( *status )
+        textNodes.box = measureText( text, status );
 }
 
+
 //*********************************************************
-// Name: createShotMaskExpr
-// Desc: Creates the expression to update the shot mask
+// Name: measureText
+// Desc: The bounds of a line of text from the glyphs,
+//       the same way createText places them
 //*********************************************************
-MStatus ShotMaskCommand::createShotMaskExpr()
+MBoundingBox ShotMaskCommand::measureText( const MString &text, MStatus *status )
 {
-    pluginTrace( "ShotMaskCommand", "createShotMaskExpr", "***" );
-
-    MString expression;
-
-    expression = 
-
-"int $visibleDigits[] = `cieShotMask -q -fd`;\
-\
-atbShotMaskDigit_0_0_geo.visibility = ($visibleDigits[0] == 0 ? 1 : 0); \
-atbShotMaskDigit_0_1_geo.visibility = ($visibleDigits[0] == 1 ? 1 : 0); \
-atbShotMaskDigit_0_2_geo.visibility = ($visibleDigits[0] == 2 ? 1 : 0); \
-atbShotMaskDigit_0_3_geo.visibility = ($visibleDigits[0] == 3 ? 1 : 0); \
-atbShotMaskDigit_0_4_geo.visibility = ($visibleDigits[0] == 4 ? 1 : 0); \
-atbShotMaskDigit_0_5_geo.visibility = ($visibleDigits[0] == 5 ? 1 : 0); \
-atbShotMaskDigit_0_6_geo.visibility = ($visibleDigits[0] == 6 ? 1 : 0); \
-atbShotMaskDigit_0_7_geo.visibility = ($visibleDigits[0] == 7 ? 1 : 0); \
-atbShotMaskDigit_0_8_geo.visibility = ($visibleDigits[0] == 8 ? 1 : 0); \
-atbShotMaskDigit_0_9_geo.visibility = ($visibleDigits[0] == 9 ? 1 : 0); \
-\
-atbShotMaskDigit_1_0_geo.visibility = ($visibleDigits[1] == 0 ? 1 : 0); \
-atbShotMaskDigit_1_1_geo.visibility = ($visibleDigits[1] == 1 ? 1 : 0); \
-atbShotMaskDigit_1_2_geo.visibility = ($visibleDigits[1] == 2 ? 1 : 0); \
-atbShotMaskDigit_1_3_geo.visibility = ($visibleDigits[1] == 3 ? 1 : 0); \
-atbShotMaskDigit_1_4_geo.visibility = ($visibleDigits[1] == 4 ? 1 : 0); \
-atbShotMaskDigit_1_5_geo.visibility = ($visibleDigits[1] == 5 ? 1 : 0); \
-atbShotMaskDigit_1_6_geo.visibility = ($visibleDigits[1] == 6 ? 1 : 0); \
-atbShotMaskDigit_1_7_geo.visibility = ($visibleDigits[1] == 7 ? 1 : 0); \
-atbShotMaskDigit_1_8_geo.visibility = ($visibleDigits[1] == 8 ? 1 : 0); \
-atbShotMaskDigit_1_9_geo.visibility = ($visibleDigits[1] == 9 ? 1 : 0); \
-\
-atbShotMaskDigit_2_0_geo.visibility = ($visibleDigits[2] == 0 ? 1 : 0); \
-atbShotMaskDigit_2_1_geo.visibility = ($visibleDigits[2] == 1 ? 1 : 0); \
-atbShotMaskDigit_2_2_geo.visibility = ($visibleDigits[2] == 2 ? 1 : 0); \
-atbShotMaskDigit_2_3_geo.visibility = ($visibleDigits[2] == 3 ? 1 : 0); \
-atbShotMaskDigit_2_4_geo.visibility = ($visibleDigits[2] == 4 ? 1 : 0); \
-atbShotMaskDigit_2_5_geo.visibility = ($visibleDigits[2] == 5 ? 1 : 0); \
-atbShotMaskDigit_2_6_geo.visibility = ($visibleDigits[2] == 6 ? 1 : 0); \
-atbShotMaskDigit_2_7_geo.visibility = ($visibleDigits[2] == 7 ? 1 : 0); \
-atbShotMaskDigit_2_8_geo.visibility = ($visibleDigits[2] == 8 ? 1 : 0); \
-atbShotMaskDigit_2_9_geo.visibility = ($visibleDigits[2] == 9 ? 1 : 0); \
-\
-atbShotMaskDigit_3_0_geo.visibility = ($visibleDigits[3] == 0 ? 1 : 0); \
-atbShotMaskDigit_3_1_geo.visibility = ($visibleDigits[3] == 1 ? 1 : 0); \
-atbShotMaskDigit_3_2_geo.visibility = ($visibleDigits[3] == 2 ? 1 : 0); \
-atbShotMaskDigit_3_3_geo.visibility = ($visibleDigits[3] == 3 ? 1 : 0); \
-atbShotMaskDigit_3_4_geo.visibility = ($visibleDigits[3] == 4 ? 1 : 0); \
-atbShotMaskDigit_3_5_geo.visibility = ($visibleDigits[3] == 5 ? 1 : 0); \
-atbShotMaskDigit_3_6_geo.visibility = ($visibleDigits[3] == 6 ? 1 : 0); \
-atbShotMaskDigit_3_7_geo.visibility = ($visibleDigits[3] == 7 ? 1 : 0); \
-atbShotMaskDigit_3_8_geo.visibility = ($visibleDigits[3] == 8 ? 1 : 0); \
-atbShotMaskDigit_3_9_geo.visibility = ($visibleDigits[3] == 9 ? 1 : 0); \
-\
-atbKeyIcon_geo.visibility = 0;\
-atbBreakdownIcon_geo.visibility = 0;\
-\
-string $keyType;\
-\
-if( $g_cieATBShotMaskRootObj != \\\"\\\" ) { \
-    string $objArray[] = stringToStringArray( $g_cieATBShotMaskRootObj, \\\" \\\"  ); \
-    $keyType = `cieShotMask -q -kt $objArray`; \
-} \
-else \
-       $keyType = \\\"none\\\"; \
-\
-if( $keyType == \\\"key\\\" ) \
-	atbKeyIcon_geo.visibility = 1; \
-else if( $keyType == \\\"breakdown\\\" ) \
-	atbBreakdownIcon_geo.visibility = 1; \
-";
-    
-    return MGlobal::executeCommand( "expression -s \"" + expression + "\"" +
-                                    " -o \"\" -ae 1 -uc all -n " + shotMaskExprName + "; ", false, true );
+    MBoundingBox textBox;
+    bool hasBounds = false;
+
+    const char *chars = text.asChar();
+    unsigned int numChars = text.length();
+    double penPos = 0.0;
+
+    for( unsigned int i = 0; i < numChars && *status; i++ ) {
+        const GlyphCache::Glyph *pGlyph = GlyphCache::getGlyph( font, chars[i], status );
+        if( pGlyph == NULL ) {
+            pluginError( "ShotMaskCommand", "measureText", "Failed to get a glyph" );
+            break;
+        }
+
+        if( !pGlyph->isEmpty() ) {
+            MPoint minPoint( pGlyph->bounds.min().x + penPos, pGlyph->bounds.min().y, 0.0 );
+            MPoint maxPoint( pGlyph->bounds.max().x + penPos, pGlyph->bounds.max().y, 0.0 );
+
+            if( !hasBounds )
+                textBox = MBoundingBox( minPoint, maxPoint );
+            else {
+                textBox.expand( minPoint );
+                textBox.expand( maxPoint );
+            }
+
+            hasBounds = true;
+        }
+
+        penPos += pGlyph->advance;
+    }
+
+    return textBox;
 }
 
 
 //*********************************************************
-// Name: generateFrameDigitArray
-// Desc: Converts the current frame into an int array where
-//       index 0 represents the 1s column, index 2 represents
-//       the 10s column, etc...
+// Name: measureDigits
+// Desc: The size of a digit slot is the bounds of all of
+//       the digits
 //*********************************************************
-MStatus ShotMaskCommand::generateFrameDigitArray()
+MBoundingBox ShotMaskCommand::measureDigits( MStatus *status )
 {
-    MTime currentTime = MAnimControl::currentTime();
-    double currentFrame = currentTime.value();
+    MBoundingBox digitBox;
+    bool hasBounds = false;
 
-    MString frameStr;
-    frameStr.set( currentFrame );
-    
-    unsigned int frameNumLength = frameStr.length();
+    for( unsigned int j = 0; j <= 9 && *status; j++ ) {
+        const GlyphCache::Glyph *pGlyph = GlyphCache::getGlyph( font, (char)('0' + j), status );
 
-    // If the string has no length there was an error getting
-    // the current time
-    if( frameNumLength == 0 ) {
-        pluginError( "ShotMaskCommand", "getCurrentDigit", "Couldn't get current frame" );
+        if( pGlyph == NULL || pGlyph->isEmpty() )
+            continue;
+        else if( !hasBounds )
+            digitBox = pGlyph->bounds;
+        else
+            digitBox.expand( pGlyph->bounds );
+
+        hasBounds = true;
     }
 
-    MIntArray resultArray( 4, 0 );
-    MString singleDigitStr;
+    return digitBox;
+}
+
+
+//*********************************************************
+// Name: getCounterSlotName
+// Desc: The node of a digit slot is a column of digits,
+//       other slots are a single glyph
+//*********************************************************
+MString ShotMaskCommand::getCounterSlotName( char slot, unsigned int &digitSlot, unsigned int &separatorSlot )
+{
+    MString slotName;
 
-    for( unsigned int i = 0; i < frameNumLength; i++ ) {
-        singleDigitStr = frameStr.substring(i, i);
-        resultArray[frameNumLength - 1 - i] = singleDigitStr.asInt();
+    if( slot == '#' ) {
+        slotName = "atbDigitColumn_";
+        slotName = slotName + digitSlot++ + "_grp";
+    }
+    else if( slot == '-' )
+        slotName = "atbCounterSign_geo";
+    else {
+        slotName = "atbCounterSeparator_";
+        slotName = slotName + separatorSlot++ + "_geo";
     }
 
-    setResult( resultArray );
+    return slotName;
+}
 
-    return MS::kSuccess;
+
+//*********************************************************
+// Name: getCounterSlotWidth
+// Desc: Digit slots are as wide as the widest digit, the
+//       other slots as wide as their glyph's advance.  Both
+//       are padded by 10%.
+//*********************************************************
+double ShotMaskCommand::getCounterSlotWidth( char slot, MStatus *status )
+{
+    double slotWidth = 0.0;
+
+    if( slot == '#' )
+        slotWidth = 1.1 * maskNodes.digitBox.width();
+    else {
+        const GlyphCache::Glyph *pGlyph = GlyphCache::getGlyph( font, slot, status );
+        if( pGlyph != NULL )
+            slotWidth = 1.1 * pGlyph->advance;
+    }
+
+    return slotWidth;
 }
 
+
 //*********************************************************
-// Name: getKeyType
-// Desc: Finds the key type at the current frame and sets
-//       the result to the type "none", "key", "breakdown"
+// Name: createFrameCounter
+// Desc: Adds the key icons and only the counter slots the
+//       format needs.  Digit slots hold the digits 0-9,
+//       which share one shape each between all of the
+//       slots.  The offset of each slot from the rightmost
+//       one is kept for the layout.
 //*********************************************************
-MStatus ShotMaskCommand::getKeyType()
+MStatus ShotMaskCommand::createFrameCounter( const MObject &parent, MStatus *status )
 {
-    MStatus status = MS::kSuccess;
+    MObject creator;
 
-    MObject dependNode;
-    MPlugArray plugArray;
+    // The counter doesn't share shapes with the text
+    glyphShapes.clear();
 
-    // Create an iterator to traverse the selection list
-    MItSelectionList sIter( objList, MFn::kInvalid, &status );
-    if( !status ) {
-        pluginError( "ShotMaskCommand", "getKeyType", "Failed to creation SL iterator" );
-    }
-    else {
-        // Traverse all of the dependency nodes for the selected objects
-        for( ; !sIter.isDone(); sIter.next() ) {          
+    maskNodes.frameCounterGrp = createTransform( frameCounterGrpName, parent, status );
 
-            // Get the current dependency node
-            if( !sIter.getDependNode( dependNode )) {
-                pluginError( "ShotMaskCommand", "getKeyType", "Couldn't get dependency node" );
-                status = MS::kFailure;
-                break;
-            }
-            
-            // The call to get connections doesn't clear the array
-            // so me must do it manually
-            plugArray.clear();
-
-            // Get all of the connections to this dependency node
-            MFnDependencyNode dependFn( dependNode );
-            if( !dependFn.getConnections( plugArray )) {
-                // No connections means no animCurves
-                // therefore, no keys
-                break;
-            }
+    maskNodes.keyIcon = createMesh( "atbKeyIcon_geo", maskNodes.frameCounterGrp, "polyCylinder", creator, status );
+    maskNodes.breakdownIcon = createMesh( "atbBreakdownIcon_geo", maskNodes.frameCounterGrp, "polyPlane", creator, status );
 
-            // Generate the list from the plugs
-            if( !getKeyTypeFromPlugArray( plugArray )) {
-                pluginError( "ShotMaskCommand", "getKeyType", "Failed to create list from Plugs" );
-                status = MS::kFailure;
-                break;
+    MObject digitsGrp = createTransform( counterDigitsGrpName, maskNodes.frameCounterGrp, status );
+
+    if( *status )
+        maskNodes.digitBox = measureDigits( status );
+
+    // Build the slots from the right
+    std::string slots = counterFormat.getSlots();
+    unsigned int digitSlot = 0, separatorSlot = 0;
+    double offset = 0.0;
+
+    for( int i = (int)slots.size() - 1; i >= 0 && *status; i-- ) {
+        MObject slot;
+        unsigned int column = digitSlot;
+        MString slotName = getCounterSlotName( slots[i], digitSlot, separatorSlot );
+        double slotWidth = getCounterSlotWidth( slots[i], status );
+
+        if( slots[i] == '#' ) {
+            slot = createTransform( slotName, digitsGrp, status );
+
+            for( unsigned int j = 0; j <= 9; j++ ) {
+                MString digitName( "atbShotMaskDigit_" );
+                digitName = digitName + column + "_" + j + "_geo";
+
+                maskNodes.digits.push_back( createGlyph( (char)('0' + j), digitName, slot, status ));
             }
+        }
+        else {
+            slot = createGlyph( slots[i], slotName, digitsGrp, status );
 
-            // If one attribute is a breakdown (tickDrawSpecial == true)
-            // we are done.  When tds is true for one attribute, the
-            // tick color will aways be green.
-            if( resultStr == "breakdown" )
-                break;
+            if( slots[i] == '-' )
+                maskNodes.counterSign = slot;
         }
-    }
 
-    // Set the result
-    setResult( resultStr );
+        // The rightmost slot is at the origin of the counter
+        if( i < (int)slots.size() - 1 )
+            offset -= slotWidth;
 
-    return status;
+        maskNodes.counterSlots.push_back( slot );
+        maskNodes.slotOffsets.push_back( offset );
+    }
+
+    return *status;
 }
 
+
 //*********************************************************
-// Name: getKeyTypeFromPlugArray
-// Desc: Finds the key type at the current frame and sets
-//       the result to the type "none", "key", "breakdown"
+// Name: createGlyph
+// Desc: Adds a transform showing a character.  The first
+//       use of each character gets a mesh created from the
+//       glyph cache, every later use instances that shape.
 //*********************************************************
-MStatus ShotMaskCommand::getKeyTypeFromPlugArray( MPlugArray plugArray )
+MObject ShotMaskCommand::createGlyph( char character, const MString &name, const MObject &parent, MStatus *status )
 {
-    MStatus status = MS::kSuccess;
+    MObject transform = createTransform( name, parent, status );
 
-    // Check each connection for an upstream connection that is a kAnimCurve
-    for( unsigned int index = 0; index < plugArray.length(); index++ )
-    {
-        if( plugArray[index].isKeyable() && !plugArray[index].isLocked() )
-        {
-            // Create an iterator that will exclusively traverse AnimCurve nodes
-            MPlug currentPlug = plugArray[index];
-            MItDependencyGraph dgIter( currentPlug,
-                                       MFn::kAnimCurve,
-                                       MItDependencyGraph::kUpstream,
-                                       MItDependencyGraph::kBreadthFirst,
-                                       MItDependencyGraph::kNodeLevel,
-                                       &status );
-            if( !status ) {
-                pluginError( "ShotMaskCommand", "getKeyTypeFromPlugArray", "DG Iterator error" );
+    if( *status ) {
+        std::map<char, MString>::const_iterator shape = glyphShapes.find( character );
+
+        if( shape != glyphShapes.end() ) {
+            glyphInstanceCmd += "parent -add -s " + shape->second + " " + name + "; ";
+        }
+        else {
+            MObject meshData, mesh;
+            const GlyphCache::Glyph *pGlyph = GlyphCache::getGlyph( font, character, status );
+
+            if( pGlyph != NULL )
+                meshData = pGlyph->createMeshData( status );
+            if( pGlyph != NULL && *status )
+                mesh = dagModifier.createNode( "mesh", transform, status );
+
+            if( pGlyph == NULL || !(*status)) {
+                pluginError( "ShotMaskCommand", "createGlyph", "Failed to create " + name );
+                *status = MS::kFailure;
             }
             else {
-                // Retrieve the anim curve function sets
-                // and store them in the list
-                for( ; !dgIter.isDone(); dgIter.next() )
-                {
-                    MObjectArray nodePath;
-                    dgIter.getNodePath( nodePath );
-                    
-                    // Only use the anim curves directly connected to the attributes
-                    // >1 on a breath first search is level 2.  Root will always be
-                    // first in the path
-                    if( nodePath.length() > 2 )
-                        break;
-
-                    MObject anim = dgIter.thisNode( &status );
-                    MFnAnimCurve animCurveFn( anim, &status );
-
-                    if( !status ) {
-                        pluginError( "ShotMaskCommand", "getKeyTypeFromPlugArray", "Can't get AnimCurve function set" );
-                    }
-                    else {
-                        // Get the value of the key from the anim curve
-                        if( !(status = getKeyTypeFromCurve( animCurveFn ))) {
-                            pluginError( "ShotMaskCommand", "getKeyTypeFromPlugArray", "Failed to get key type" );
-                        }
-                    }
-                }
+                dagModifier.renameNode( mesh, name + "Shape" );
+                dagModifier.newPlugValue( MFnDependencyNode( mesh ).findPlug( "inMesh" ), meshData );
+
+                // The transform isn't instanced, so this path
+                // stays unique once the shape is
+                glyphShapes[character] = name + "|" + name + "Shape";
             }
         }
     }
 
-    return status;
+    return transform;
 }
 
 
 //*********************************************************
-// Name: getKeyTypeFromCurve
-// Desc: Finds the key type on a given anim curve
+// Name: createShotMaskNode
+// Desc: Adds the node that drives the frame counter digits
+//       and key icons from the scene time.  The root objects
+//       are connected to it by the UI.
 //*********************************************************
-MStatus ShotMaskCommand::getKeyTypeFromCurve(MFnAnimCurve &animCurveFn )
+MStatus ShotMaskCommand::createShotMaskNode()
 {
+    pluginTrace( "ShotMaskCommand", "createShotMaskNode", "***" );
+
     MStatus status = MS::kSuccess;
+    MSelectionList timeList;
+    MObject timeNode;
 
-    MPlug tdsPlugArray;
-    MPlug tdsPlug;
+    MObject maskNode = dagModifier.MDGModifier::createNode( ShotMaskNode::id, &status );
+    if( !status ) {
+        pluginError( "ShotMaskCommand", "createShotMaskNode", "Failed to create the shot mask node" );
+    }
+    else if( !timeList.add( "time1" ) || !(status = timeList.getDependNode( 0, timeNode ))) {
+        pluginError( "ShotMaskCommand", "createShotMaskNode", "Failed to get time1" );
+        status = MS::kFailure;
+    }
+    else {
+        dagModifier.renameNode( maskNode, shotMaskNodeName );
 
-    bool tds;
-    
-    int logicalIndex = getKeyLogicalIndex( animCurveFn, &status );
-
-    if( logicalIndex >= 0 && (status == MS::kSuccess) ) 
-    {
-        // Get the Plug array for keyTickDrawSpecial
-         tdsPlugArray = animCurveFn.findPlug( "keyTickDrawSpecial", &status );
-        if( !status ) {
-            pluginError( "ShotMaskCommand", "getKeyTypeFromCurve", "No MPlug with name keyTickDrawSpecial" );
+        dagModifier.connect( MFnDependencyNode( timeNode ).findPlug( "outTime" ),
+                             MPlug( maskNode, ShotMaskNode::timeAttr ));
+
+        // The format the slots were built for
+        dagModifier.newPlugValueInt( MPlug( maskNode, ShotMaskNode::counterFormatAttr ), counterFormat.format );
+        dagModifier.newPlugValueInt( MPlug( maskNode, ShotMaskNode::counterDigitsAttr ), counterFormat.numDigits );
+        dagModifier.newPlugValueInt( MPlug( maskNode, ShotMaskNode::framesPerFootAttr ), counterFormat.framesPerFoot );
+
+        // One visibility output per digit
+        MPlug digitVisibilityPlug( maskNode, ShotMaskNode::digitVisibilityAttr );
+        for( unsigned int i = 0; i < maskNodes.digits.size(); i++ ) {
+            dagModifier.connect( digitVisibilityPlug.elementByLogicalIndex( i ),
+                                 MFnDependencyNode( maskNodes.digits[i] ).findPlug( "visibility" ));
         }
-        else {
-            // Get the specific plug for keyTickDrawSpecial at the current time
-            tdsPlug = tdsPlugArray.elementByLogicalIndex( logicalIndex, &status );
-            if( !status ) {
-                pluginError( "ShotMaskCommand", "getKeyTypeFromCurve", "Failed to get element by logical index" );
-            }
-            else {
-                tdsPlug.getValue( tds );
-                if( tds )
-                    resultStr = "breakdown";
-                else
-                    resultStr = "key";
-            }
+
+        if( !maskNodes.counterSign.isNull() ) {
+            dagModifier.connect( MPlug( maskNode, ShotMaskNode::signVisibilityAttr ),
+                                 MFnDependencyNode( maskNodes.counterSign ).findPlug( "visibility" ));
         }
+
+        dagModifier.connect( MPlug( maskNode, ShotMaskNode::keyIconVisibilityAttr ),
+                             MFnDependencyNode( maskNodes.keyIcon ).findPlug( "visibility" ));
+        dagModifier.connect( MPlug( maskNode, ShotMaskNode::breakdownIconVisibilityAttr ),
+                             MFnDependencyNode( maskNodes.breakdownIcon ).findPlug( "visibility" ));
+
+        // The node is the handle of the mask, the camera and
+        // the nodes it owns are connected to it
+        MObject cameraNode = MFnDagNode( pCameraFn->object() ).parent( 0 );
+        dagModifier.connect( MFnDependencyNode( cameraNode ).findPlug( "message" ),
+                             MPlug( maskNode, ShotMaskNode::cameraAttr ));
+        dagModifier.connect( MFnDependencyNode( maskNodes.mainGrp ).findPlug( "message" ),
+                             MPlug( maskNode, ShotMaskNode::maskRootAttr ));
+
+        // The shaders are made by MEL, in the order of
+        // the shader elements
+        const char *shaderNames[] = { borderShaderNodeName, textShaderNodeName, keyIconShaderNodeName,
+                                      bdIconShaderNodeName, ltbxShaderNodeName };
+        MString shaderCmd;
+
+        for( unsigned int i = 0; i < numShaderElements; i++ )
+            shaderCmd = shaderCmd + "connectAttr " + shaderNames[i] + ".message " + shotMaskNodeName + ".shaders[" + i + "]; ";
+
+        dagModifier.commandToExecute( shaderCmd );
+
+        // The settings an edit starts from
+        dagModifier.newPlugValueDouble( MPlug( maskNode, ShotMaskNode::aspectRatioAttr ), maskAspectRatio );
+        dagModifier.newPlugValueDouble( MPlug( maskNode, ShotMaskNode::maskThicknessAttr ), maskThickness );
+        dagModifier.newPlugValueString( MPlug( maskNode, ShotMaskNode::titleAttr ), shotMaskTitle );
+        dagModifier.newPlugValueString( MPlug( maskNode, ShotMaskNode::text1Attr ), shotMaskText1 );
+        dagModifier.newPlugValueString( MPlug( maskNode, ShotMaskNode::text2Attr ), shotMaskText2 );
     }
-    
 
     return status;
 }
 
+
+//*********************************************************
+// Name: setTransform
+// Desc: Sets the translation and x/y scale of a node with
+//       the layout modifier
+//*********************************************************
+void ShotMaskCommand::setTransform( const MObject &node, const ShotMaskLayout::Transform &transform )
+{
+    MFnDependencyNode nodeFn( node );
+
+    layoutModifier.newPlugValueDouble( nodeFn.findPlug( "translateX" ), transform.tx );
+    layoutModifier.newPlugValueDouble( nodeFn.findPlug( "translateY" ), transform.ty );
+    layoutModifier.newPlugValueDouble( nodeFn.findPlug( "translateZ" ), transform.tz );
+    layoutModifier.newPlugValueDouble( nodeFn.findPlug( "scaleX" ), transform.sx );
+    layoutModifier.newPlugValueDouble( nodeFn.findPlug( "scaleY" ), transform.sy );
+}
+
+
+//*********************************************************
+// Name: setPivot
+// Desc: Sets the rotate and scale pivots of a node with
+//       the layout modifier
+//*********************************************************
+void ShotMaskCommand::setPivot( const MObject &node, const ShotMaskLayout::Pivot &pivot )
+{
+    MFnDependencyNode nodeFn( node );
+
+    layoutModifier.newPlugValueDouble( nodeFn.findPlug( "rotatePivotX" ), pivot.x );
+    layoutModifier.newPlugValueDouble( nodeFn.findPlug( "rotatePivotY" ), pivot.y );
+    layoutModifier.newPlugValueDouble( nodeFn.findPlug( "rotatePivotZ" ), pivot.z );
+    layoutModifier.newPlugValueDouble( nodeFn.findPlug( "scalePivotX" ), pivot.x );
+    layoutModifier.newPlugValueDouble( nodeFn.findPlug( "scalePivotY" ), pivot.y );
+    layoutModifier.newPlugValueDouble( nodeFn.findPlug( "scalePivotZ" ), pivot.z );
+}
+
+
+//*********************************************************
+// Name: getLayoutBox
+// Desc: Copies the x/y bounds of a bounding box
+//*********************************************************
+ShotMaskLayout::Box ShotMaskCommand::getLayoutBox( const MBoundingBox &box )
+{
+    ShotMaskLayout::Box layoutBox;
+
+    layoutBox.minX = box.min().x;
+    layoutBox.minY = box.min().y;
+    layoutBox.maxX = box.max().x;
+    layoutBox.maxY = box.max().y;
+
+    return layoutBox;
+}
+
+
 //*********************************************************
-// Name: getKeyLogicalIndex
-// Desc: Returns the logical index of the key 
-//       at the time when the command was called
+// Name: generateFrameDigitArray
+// Desc: Converts the current time into an int array with
+//       the digit of each digit slot of the counter format.
+//       Index 0 is the rightmost slot.
 //*********************************************************
-int ShotMaskCommand::getKeyLogicalIndex( MFnAnimCurve &animCurveFn, MStatus *status )
+MStatus ShotMaskCommand::generateFrameDigitArray()
 {
     MTime currentTime = MAnimControl::currentTime();
 
-    // Returns -1 if there isn't a key set at the playhead time
-    int logicalIndex = -1;
+    std::vector<int> digits;
+    bool negative = false;
+    counterFormat.getDigits( currentTime, digits, negative );
+
+    MIntArray digitArray;
+    for( unsigned int i = 0; i < digits.size(); i++ )
+        digitArray.append( digits[i] );
+
+    setResult( digitArray );
+
+    return MS::kSuccess;
+}
 
-    unsigned int closestIndex = animCurveFn.findClosest( currentTime, status );
-    if( !(*status)) {
-        pluginError( "ShotMaskCommand", "getKeyLogicalIndex", "Couldn't find closest key" );
+//*********************************************************
+// Name: getKeyType
+// Desc: Finds the key type at the current frame and sets
+//       the result to the type "none", "key", "breakdown"
+//*********************************************************
+MStatus ShotMaskCommand::getKeyType()
+{
+    MStatus status = MS::kSuccess;
+
+    MObject dependNode;
+    MObjectArray rootNodes;
+
+    // Create an iterator to traverse the selection list
+    MItSelectionList sIter( objList, MFn::kInvalid, &status );
+    if( !status ) {
+        pluginError( "ShotMaskCommand", "getKeyType", "Failed to creation SL iterator" );
     }
     else {
-        // if the times match, the indexes are the same
-        if( currentTime == animCurveFn.time( closestIndex, status ) )
-            logicalIndex = (int)closestIndex;           
+        // Get all of the dependency nodes for the selected objects
+        for( ; !sIter.isDone(); sIter.next() ) {
+            if( !sIter.getDependNode( dependNode )) {
+                pluginError( "ShotMaskCommand", "getKeyType", "Couldn't get dependency node" );
+                status = MS::kFailure;
+                break;
+            }
+            rootNodes.append( dependNode );
+        }
+    }
+
+    // Uses the same lookup as the shot mask node, the
+    // timeline is only needed for this query
+    KeyTypeTimeline timeline;
+
+    if( status && !(status = timeline.build( rootNodes, false ))) {
+        pluginError( "ShotMaskCommand", "getKeyType", "Failed to build the key type timeline" );
+    }
+    else if( status ) {
+        switch( timeline.getKeyType( MAnimControl::currentTime() )) {
+            case KeyTypeTimeline::kKey:
+                resultStr = "key";
+                break;
+            case KeyTypeTimeline::kBreakdown:
+                resultStr = "breakdown";
+                break;
+            default:
+                resultStr = "none";
+                break;
+        }
     }
 
-    return logicalIndex;
+    // Set the result
+    setResult( resultStr );
 
-}
\ No newline at end of file
+    return status;
+}
+
+
+//*********************************************************
+// Name: getDetails
+// Desc: Sets the result to the viewport camera and scene
+//       details, in the order listed in the header.  Most
+//       of them come from the cache, so syncing the UI
+//       doesn't query the scene.
+//*********************************************************
+MStatus ShotMaskCommand::getDetails()
+{
+    MStatus status = MS::kSuccess;
+    ShotMaskDetails::Details details;
+
+    if( !(status = ShotMaskDetails::getDetails( details ))) {
+        pluginError( "ShotMaskCommand", "getDetails", "Failed to get the shot mask details" );
+    }
+    else {
+        MStringArray resultArray;
+
+        resultArray.append( details.camera );
+        resultArray.append( details.cameraShape );
+        resultArray.append( details.sceneName );
+        resultArray.append( MString() + details.renderAspectRatio );
+        resultArray.append( MString() + details.resolutionWidth );
+        resultArray.append( MString() + details.resolutionHeight );
+        resultArray.append( MString() + details.filmAspectRatio );
+        resultArray.append( ShotMaskDetails::getFilmFitName( details.filmFit ));
+        resultArray.append( MString() + details.overscan );
+        resultArray.append( details.orthographic ? "1" : "0" );
+
+        setResult( resultArray );
+    }
+
+    return status;
+}
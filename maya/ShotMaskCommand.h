@@ -27,14 +27,27 @@
 #include <maya/MDoubleArray.h>
 #include <maya/MPlug.h>
 #include <maya/MPlugArray.h>
+#include <maya/MDagModifier.h>
+#include <maya/MBoundingBox.h>
 
 #include <maya/MFnCamera.h>
 #include <maya/MFnDependencyNode.h>
+#include <maya/MFnDagNode.h>
 
 #include <maya/MItSelectionList.h>
 #include <maya/MItDependencyGraph.h>
+#include <maya/MItDependencyNodes.h>
+#include <maya/MItDag.h>
+
+#include "ShotMaskNode.h"
+#include "GlyphCache.h"
+#include "FrameCounterFormat.h"
+#include "ShotMaskDetails.h"
+#include "ShotMaskLayout.h"
 
 #include <math.h>
+#include <vector>
+#include <map>
 //*********************************************************
 
 //*********************************************************
@@ -47,6 +60,10 @@
 //
 // Flags: -query (-q)
 //
+//        -edit (-e)    edits the existing mask, only
+//                      -maskThickness, the text and the
+//                      shader flags can be edited
+//
 //        -camera (-c)    (string)
 //
 //        -aspectRatio (-ar)    (double)
@@ -63,7 +80,33 @@
 //
 //        -keyType (-kt) (query only)
 //
-//        -frameDigits (-fd) (query only)
+//        -frameDigits (-fd) (query only) digit of each
+//                           counter digit slot
+//
+//        -glyphCache (-gc)   (string) file the glyphs
+//                            are loaded from and saved to
+//
+//        -counterFormat (-cf) (string) frames, timecode
+//                             or feetFrames
+//
+//        -framesPerFoot (-fpf) (int)
+//
+//        -element (-el)  (string) edit only, the shader
+//                        of border, text, key, breakdown
+//                        or letterbox
+//
+//        -color (-clr)   (double3) edit only
+//
+//        -transparency (-tr) (double3) edit only
+//
+//        -details (-dt) (query only) the viewport camera
+//                       and scene details as strings:
+//                       camera, camera shape, scene name,
+//                       render aspect ratio, resolution
+//                       width, resolution height, film
+//                       aspect ratio, filmFit, overscan
+//                       and orthographic (0/1).  The
+//                       camera is empty without a viewport.
 //
 //*********************************************************
 class ShotMaskCommand : public MPxCommand
@@ -80,11 +123,19 @@ private:
     static const char *titleFlag, *titleLongFlag;
     static const char *text1Flag, *text1LongFlag;
     static const char *text2Flag, *text2LongFlag;
+    static const char *glyphCacheFlag, *glyphCacheLongFlag;
+    static const char *counterFormatFlag, *counterFormatLongFlag;
+    static const char *framesPerFootFlag, *framesPerFootLongFlag;
+    static const char *elementFlag, *elementLongFlag;
+    static const char *colorFlag, *colorLongFlag;
+    static const char *transparencyFlag, *transparencyLongFlag;
+    static const char *detailsFlag, *detailsLongFlag;
 
     // Constants for the shot mask nodes and elements
     // Group Nodes
     static const char *mainGrpName;
     static const char *frameCounterGrpName;
+    static const char *counterDigitsGrpName;
 
     static const char *titleTextGrpName;
     static const char *bottomLeftTextGrpName;
@@ -102,11 +153,32 @@ private:
     static const char *ltbxShaderNodeName;
     static const char *ltbxShaderGroupName;
 
-    // Expressions
+    // Node driving the frame counter and key icons
+    static const char *shotMaskNodeName;
+
+    // Expression used by older versions of the shot mask
     static const char *shotMaskExprName;
 
     // Determines if this is only querying information
     bool queryMode;
+
+    // Determines if the existing mask is being edited
+    bool editMode;
+
+    // The settings changed by an edit
+    bool editThickness, editTitle, editText1, editText2;
+    bool editColor, editTransparency;
+
+    // The shader being edited, index into the shaders
+    // of the mask node
+    unsigned int shaderIndex;
+
+    // The new color/transparency of the shader
+    double shaderColor[3], shaderTransparency[3];
+
+    // Aspect ratio given to the command, 0 for the
+    // film gate
+    double maskAspectRatio;
     
     // Aspect ratio for the overlay
     double aspectRatio;
@@ -126,6 +198,9 @@ private:
     // Query for the visible digits in each column
     bool queryDigits;
 
+    // Query for the viewport camera and scene details
+    bool queryDetails;
+
     // The resultant string to be returned
     MString resultStr;
 
@@ -146,6 +221,21 @@ private:
     // The font used on the shot mask
     MString font;
 
+    // How the frame counter shows the time
+    FrameCounterFormat counterFormat;
+
+    // The file the glyph cache is kept in, empty to only
+    // cache the glyphs in memory
+    MString glyphCacheFile;
+
+    // The first shape created for each character in the
+    // current line of text or the counter, every other
+    // use of the character in it instances that shape
+    std::map<char, MString> glyphShapes;
+
+    // Instances the glyph shapes once they're created
+    MString glyphInstanceCmd;
+
     // List of objects to perform command on
     MSelectionList objList;
 
@@ -158,53 +248,170 @@ private:
     // The camera shape node name
     MString camShapeNodeName;
 
+    // A line of text, the UI scales the text node and
+    // the layout positions the layout node inside it
+    struct TextNodes {
+        MObject grp, text, layout;
+
+        // Bounds of the text before it's scaled
+        MBoundingBox box;
+    };
+
+    // The nodes of the shot mask that are positioned
+    // by the layout
+    struct ShotMaskNodes {
+        MObject maskNode;
+        MObject mainGrp, topFrameGrp, bottomFrameGrp;
+        MObject topPlane, bottomPlane, leftPlane, rightPlane;
+        MObject letterboxTop, letterboxBottom, letterboxLeft, letterboxRight;
+        TextNodes title, bottomLeft, bottomRight;
+        MObject frameCounterGrp, keyIcon, breakdownIcon;
+
+        // Bounds of a counter column before it's scaled
+        MBoundingBox digitBox;
+
+        // One node per counter slot from the right, with
+        // its offset from the rightmost slot before scaling
+        std::vector<MObject> counterSlots;
+        std::vector<double> slotOffsets;
+        MObject counterSign;
+
+        // One transform per digit, index = slot * 10 + digit
+        std::vector<MObject> digits;
+
+        // The shaders in the order of the shaders attribute
+        MObjectArray shaders;
+    } maskNodes;
+
+    // Deletes the previous shot mask
+    MDagModifier cleanUpModifier;
+
+    // Creates the nodes of the shot mask
+    MDagModifier dagModifier;
+
+    // Positions the nodes once they exist
+    MDagModifier layoutModifier;
+
     // Method to setup the command flags
     MStatus parseCommandFlags( const MArgList &args );
 
+    // Sets the counter format from the command flags
+    MStatus parseCounterFlags( MArgDatabase &argData );
+
+    // Sets the shader being edited from the command flags
+    MStatus parseShaderFlags( MArgDatabase &argData );
+
     // Retrieves the camera shape node from the given transform node
     MStatus getCameraShapeNode();
 
+    // Gets the camera and the aspect ratios of the overlay
+    MStatus initCamera();
+
     // Creates the shot mask for a specified camere
     MStatus createShotMask();
 
+    // Adds the nodes of the shot mask to the build modifier
+    MStatus buildShotMask();
+
+    // Sizes and positions the shot mask for the camera
+    MStatus layoutShotMask();
+
+    // Changes the parts of the existing mask set by the
+    // edit flags
+    MStatus editShotMask();
+
+    // Gets the settings of the existing mask from its
+    // shot mask node
+    MStatus loadShotMask();
+
+    // Gets the nodes of the existing mask the layout
+    // positions
+    MStatus loadShotMaskLayout();
+
+    // Replaces a line of text of the existing mask
+    MStatus editText( const MString &name, const MString &grpNodeName, const MString &text,
+                      const MObject &parent, const MObject &textAttr, TextNodes &textNodes );
+
+    // Sets the color/transparency of the edited shader
+    MStatus editShader();
+
     // Create the shot mask shaders
     MStatus createShotMaskShaders();
 
-    // Creates the digits 0-9 for a counter
-    MStatus createFrameCounter( double scaleVal, 
-                                double digitZPos,
-                                double borderThickness,
-                                double hEdgeTrans,
-                                double vEdgeTrans );
+    // Adds a named transform to the build modifier
+    MObject createTransform( const MString &name, const MObject &parent, MStatus *status );
+
+    // Adds a transform with a unit sized poly primitive
+    MObject createMesh( const MString &name, const MObject &parent, const MString &creatorType,
+                        MObject &creator, MStatus *status );
+
+    // Creates the key icons and the digits 0-9 for a counter
+    MStatus createFrameCounter( const MObject &parent, MStatus *status );
 
     // Creates text for the shot mask
-    MStatus createText( MString name, MString grpNodeName, MString text, MString font );
+    void createText( const MString &name, const MString &grpNodeName, const MString &text,
+                     const MObject &parent, TextNodes &textNodes, MStatus *status );
+
+    // Gets the bounds of a line of text
+    MBoundingBox measureText( const MString &text, MStatus *status );
+
+    // Gets the bounds of the digits 0-9
+    MBoundingBox measureDigits( MStatus *status );
+
+    // The name of the node of a counter slot, the slot
+    // counts are incremented
+    MString getCounterSlotName( char slot, unsigned int &digitSlot, unsigned int &separatorSlot );
 
-    // Creates the expression to update the shot mask
-    MStatus createShotMaskExpr();
+    // The width of a counter slot before it's scaled
+    double getCounterSlotWidth( char slot, MStatus *status );
+
+    // Adds a transform showing a cached glyph
+    MObject createGlyph( char character, const MString &name, const MObject &parent, MStatus *status );
+
+    // Creates the node that updates the frame counter
+    // and key icons
+    MStatus createShotMaskNode();
+
+    // Sets the translation and x/y scale of a node
+    void setTransform( const MObject &node, const ShotMaskLayout::Transform &transform );
+
+    // Sets the rotate and scale pivots of a node
+    void setPivot( const MObject &node, const ShotMaskLayout::Pivot &pivot );
+
+    // The bounds of text or a digit for the layout
+    static ShotMaskLayout::Box getLayoutBox( const MBoundingBox &box );
 
     // Deletes all shot mask elements from the current scene
     MStatus cleanUpShotMask();
 
-    // Converts the current frame into an int array where
-    // index 0 represents the 1s column, index 2 represents
-    // the 10s column, etc...
+    // Adds a node to the list of nodes to delete, unless
+    // it or one of its parents is already in the list
+    void addNodeToDelete( const MObject &node, MObjectArray &nodes );
+
+    // Finds the shot mask node in the scene
+    static MObject findShotMaskNode();
+
+    // The node connected to a plug
+    static MObject getSourceNode( const MPlug &plug );
+
+    // The shading group a shader is assigned to
+    static MObject getShadingGroup( const MObject &shader );
+
+    // Removes the escapes the UI adds for MEL
+    static MString unescapeText( const MString &text );
+
+    // Converts the current time into an int array with the
+    // digit of each counter digit slot, index 0 is the
+    // rightmost slot
     MStatus generateFrameDigitArray();
 
     // Finds the key type at the current frame and sets
     // the result to the type "none", "key", "breakdown"
     MStatus getKeyType();
 
-    // Finds the key type at the current frame and sets
-    // the result to the type "none", "key", "breakdown"
-    MStatus getKeyTypeFromPlugArray( MPlugArray plugArray );
-
-    // Finds the key type on a given anim curve
-    MStatus getKeyTypeFromCurve( MFnAnimCurve &animCurveFn );
-
-    // Returns the logical index of a key at the 
-    // current time
-    int getKeyLogicalIndex( MFnAnimCurve &animCurveFn, MStatus *status );
+    // Sets the result to the viewport camera and scene
+    // details shown by the UI
+    MStatus getDetails();
 
 public:
     // Constructor/Destructor
@@ -232,4 +439,4 @@ public:
 };
 
 
-#endif //__SHOT_MASK_COMMAND_
\ No newline at end of file
+#endif //__SHOT_MASK_COMMAND_
\ No newline at end of file
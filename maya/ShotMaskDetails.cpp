@@ -0,0 +1,374 @@
+//*********************************************************
+// ShotMaskDetails.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "ShotMaskDetails.h"
+#include "ErrorReporting.h"
+//*********************************************************
+
+//*********************************************************
+// Constants
+//*********************************************************
+ShotMaskDetails::Details ShotMaskDetails::cached;
+bool ShotMaskDetails::cameraValid = false;
+bool ShotMaskDetails::renderValid = false;
+bool ShotMaskDetails::sceneValid = false;
+
+MObjectHandle ShotMaskDetails::cachedCamera;
+
+MCallbackIdArray ShotMaskDetails::cameraCallbackIds;
+MCallbackIdArray ShotMaskDetails::renderCallbackIds;
+MCallbackIdArray ShotMaskDetails::sceneCallbackIds;
+
+// Camera attributes the cached settings are read from.
+// When one is animated the settings change every frame
+// without a callback, so they aren't cached.
+static const char *cameraAttrs[] = { "horizontalFilmAperture", "verticalFilmAperture",
+                                     "filmFit", "overscan", "orthographic" };
+static const unsigned int numCameraAttrs = sizeof( cameraAttrs ) / sizeof( const char * );
+
+
+//*********************************************************
+// Name: getDetails
+// Desc: Gets the details for the camera of the active
+//       viewport, only reading the parts that changed
+//       since the last call.  Without a viewport (batch
+//       mode) the camera details are left empty.
+//*********************************************************
+MStatus ShotMaskDetails::getDetails( Details &details )
+{
+    MStatus status = MS::kSuccess;
+    MDagPath cameraPath;
+
+    // A new or opened scene replaces the watched nodes
+    if( sceneCallbackIds.length() == 0 ) {
+        MCallbackId id = MSceneMessage::addCallback( MSceneMessage::kBeforeNew, sceneChanged, NULL, &status );
+        if( status ) {
+            sceneCallbackIds.append( id );
+            id = MSceneMessage::addCallback( MSceneMessage::kBeforeOpen, sceneChanged, NULL, &status );
+        }
+        if( status ) {
+            sceneCallbackIds.append( id );
+            id = MSceneMessage::addCallback( MSceneMessage::kAfterSave, sceneSaved, NULL, &status );
+        }
+        if( status )
+            sceneCallbackIds.append( id );
+        else {
+            pluginError( "ShotMaskDetails", "getDetails", "Failed to add the scene callbacks" );
+            removeCallbacks( sceneCallbackIds );
+            return status;
+        }
+    }
+
+    if( !sceneValid && !(status = updateScene() )) {
+        pluginError( "ShotMaskDetails", "getDetails", "Failed to get the scene name" );
+    }
+    else if( !renderValid && !(status = updateRender() )) {
+        pluginError( "ShotMaskDetails", "getDetails", "Failed to get the render settings" );
+    }
+    else if( getViewportCamera( cameraPath )) {
+        MObject cameraShape = cameraPath.node();
+
+        // The names aren't cached, renaming doesn't change
+        // the camera
+        cached.cameraShape = cameraPath.partialPathName();
+        cameraPath.pop();
+        cached.camera = cameraPath.partialPathName();
+
+        if( !cameraValid || !(cachedCamera.isValid() && cachedCamera == cameraShape) ) {
+            if( !(status = updateCamera( cameraShape )))
+                pluginError( "ShotMaskDetails", "getDetails", "Failed to get the camera settings" );
+        }
+    }
+    else {
+        cached.camera = cached.cameraShape = "";
+    }
+
+    if( status )
+        details = cached;
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: getRenderAspectRatio
+// Desc: Gets the render aspect ratio in defaultResolution
+//*********************************************************
+MStatus ShotMaskDetails::getRenderAspectRatio( double &aspectRatio )
+{
+    MStatus status = MS::kSuccess;
+
+    if( !renderValid && !(status = updateRender() )) {
+        pluginError( "ShotMaskDetails", "getRenderAspectRatio", "Failed to get the render settings" );
+    }
+    else
+        aspectRatio = cached.renderAspectRatio;
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: getViewportCamera
+// Desc: The camera shape of the active viewport
+//*********************************************************
+MStatus ShotMaskDetails::getViewportCamera( MDagPath &cameraPath )
+{
+    MStatus status = MS::kSuccess;
+
+    // There are no views in batch mode
+    if( MGlobal::mayaState() != MGlobal::kInteractive )
+        return MS::kFailure;
+
+    M3dView view = M3dView::active3dView( &status );
+    if( status )
+        status = view.getCamera( cameraPath );
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: getFilmFitName
+// Desc: The filmFit name used by the camera command
+//*********************************************************
+MString ShotMaskDetails::getFilmFitName( MFnCamera::FilmFit filmFit )
+{
+    MString name;
+
+    switch( filmFit ) {
+        case MFnCamera::kFillFilmFit:
+            name = "fill";
+            break;
+        case MFnCamera::kHorizontalFilmFit:
+            name = "horizontal";
+            break;
+        case MFnCamera::kVerticalFilmFit:
+            name = "vertical";
+            break;
+        case MFnCamera::kOverscanFilmFit:
+            name = "overscan";
+            break;
+        default:
+            name = "invalid";
+            break;
+    }
+
+    return name;
+}
+
+
+//*********************************************************
+// Name: invalidate
+// Desc: Marks all of the details as out of date
+//*********************************************************
+void ShotMaskDetails::invalidate()
+{
+    cameraValid = renderValid = sceneValid = false;
+}
+
+
+//*********************************************************
+// Name: removeCallbacks
+// Desc: Removes all of the callbacks, they're added again
+//       the next time the details are needed
+//*********************************************************
+void ShotMaskDetails::removeCallbacks()
+{
+    removeCallbacks( cameraCallbackIds );
+    removeCallbacks( renderCallbackIds );
+    removeCallbacks( sceneCallbackIds );
+
+    invalidate();
+}
+
+
+//*********************************************************
+// Name: updateCamera
+// Desc: Reads the camera settings and watches the camera
+//       shape for edits
+//*********************************************************
+MStatus ShotMaskDetails::updateCamera( const MObject &cameraShape )
+{
+    MStatus status = MS::kSuccess;
+
+    removeCallbacks( cameraCallbackIds );
+    cameraValid = false;
+
+    MFnCamera cameraFn( cameraShape, &status );
+    if( !status ) {
+        pluginError( "ShotMaskDetails", "updateCamera", "Can't get Camera function set" );
+    }
+    else {
+        cached.filmAspectRatio = cameraFn.aspectRatio();
+        cached.overscan = cameraFn.overscan();
+        cached.filmFit = cameraFn.filmFit();
+        cached.orthographic = cameraFn.isOrtho();
+
+        bool animated = false;
+        for( unsigned int i = 0; i < numCameraAttrs && !animated; i++ )
+            animated = cameraFn.findPlug( cameraAttrs[i] ).isConnected();
+
+        if( !animated ) {
+            MObject node = cameraShape;
+            MCallbackId id = MNodeMessage::addAttributeChangedCallback( node, cameraChanged, NULL, &status );
+
+            if( !status ) {
+                pluginError( "ShotMaskDetails", "updateCamera", "Failed to add the camera callback" );
+            }
+            else {
+                cameraCallbackIds.append( id );
+                cachedCamera = MObjectHandle( cameraShape );
+                cameraValid = true;
+            }
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: updateRender
+// Desc: Reads defaultResolution and watches it for edits
+//*********************************************************
+MStatus ShotMaskDetails::updateRender()
+{
+    MStatus status = MS::kSuccess;
+
+    MSelectionList resolutionList;
+    MObject resolutionNode;
+
+    removeCallbacks( renderCallbackIds );
+    renderValid = false;
+
+    if( !(status = resolutionList.add( "defaultResolution" )) ||
+        !(status = resolutionList.getDependNode( 0, resolutionNode ))) {
+        pluginError( "ShotMaskDetails", "updateRender", "Can't find defaultResolution" );
+    }
+    else {
+        MFnDependencyNode resolutionFn( resolutionNode );
+
+        resolutionFn.findPlug( "deviceAspectRatio" ).getValue( cached.renderAspectRatio );
+        resolutionFn.findPlug( "width" ).getValue( cached.resolutionWidth );
+        resolutionFn.findPlug( "height" ).getValue( cached.resolutionHeight );
+
+        MCallbackId id = MNodeMessage::addAttributeChangedCallback( resolutionNode, renderChanged, NULL, &status );
+        if( !status ) {
+            pluginError( "ShotMaskDetails", "updateRender", "Failed to add the render callback" );
+        }
+        else {
+            renderCallbackIds.append( id );
+            renderValid = true;
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: updateScene
+// Desc: Reads the short scene name and removes the .ma/.mb
+//       extension
+//*********************************************************
+MStatus ShotMaskDetails::updateScene()
+{
+    MStatus status = MS::kSuccess;
+
+    MString sceneName;
+    if( !(status = MGlobal::executeCommand( "file -q -sn -shn", sceneName, false, false ))) {
+        pluginError( "ShotMaskDetails", "updateScene", "Failed to query the scene name" );
+    }
+    else {
+        int length = sceneName.length();
+
+        if( length == 0 )
+            sceneName = "Untitled";
+        else if( length > 3 ) {
+            MString suffix = sceneName.substring( length - 3, length - 1 );
+            if( suffix == ".ma" || suffix == ".mb" )
+                sceneName = sceneName.substring( 0, length - 4 );
+        }
+
+        cached.sceneName = sceneName;
+        sceneValid = true;
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: removeCallbacks
+// Desc: Removes the callbacks in the array
+//*********************************************************
+void ShotMaskDetails::removeCallbacks( MCallbackIdArray &callbackIds )
+{
+    if( callbackIds.length() > 0 ) {
+        MMessage::removeCallbacks( callbackIds );
+        callbackIds.clear();
+    }
+}
+
+
+//*********************************************************
+// Name: cameraChanged
+// Desc: Any edit to the camera shape might change the
+//       settings.  Evaluation messages are sent every frame
+//       and are ignored.
+//*********************************************************
+void ShotMaskDetails::cameraChanged( MNodeMessage::AttributeMessage msg, MPlug &plug, MPlug &otherPlug, void *clientData )
+{
+    const int changeMask = MNodeMessage::kAttributeSet | MNodeMessage::kConnectionMade |
+                           MNodeMessage::kConnectionBroken;
+
+    if( msg & changeMask )
+        cameraValid = false;
+}
+
+
+//*********************************************************
+// Name: renderChanged
+// Desc: Invalidates the render settings when
+//       defaultResolution is edited
+//*********************************************************
+void ShotMaskDetails::renderChanged( MNodeMessage::AttributeMessage msg, MPlug &plug, MPlug &otherPlug, void *clientData )
+{
+    const int changeMask = MNodeMessage::kAttributeSet | MNodeMessage::kConnectionMade |
+                           MNodeMessage::kConnectionBroken;
+
+    if( msg & changeMask )
+        renderValid = false;
+}
+
+
+//*********************************************************
+// Name: sceneSaved
+// Desc: Saving as another file changes the scene name
+//*********************************************************
+void ShotMaskDetails::sceneSaved( void *clientData )
+{
+    sceneValid = false;
+}
+
+
+//*********************************************************
+// Name: sceneChanged
+// Desc: The camera and defaultResolution of the current
+//       scene are about to be deleted, so the callbacks on
+//       them are removed
+//*********************************************************
+void ShotMaskDetails::sceneChanged( void *clientData )
+{
+    removeCallbacks( cameraCallbackIds );
+    removeCallbacks( renderCallbackIds );
+
+    invalidate();
+}
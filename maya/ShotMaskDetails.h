@@ -0,0 +1,132 @@
+//*********************************************************
+// ShotMaskDetails.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __SHOT_MASK_DETAILS_H_
+#define __SHOT_MASK_DETAILS_H_
+
+//*********************************************************
+#include <maya/MGlobal.h>
+#include <maya/MStatus.h>
+#include <maya/MString.h>
+#include <maya/MObject.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MDagPath.h>
+#include <maya/MPlug.h>
+#include <maya/MSelectionList.h>
+#include <maya/MCallbackIdArray.h>
+#include <maya/MNodeMessage.h>
+#include <maya/MSceneMessage.h>
+#include <maya/M3dView.h>
+
+#include <maya/MFnCamera.h>
+#include <maya/MFnDependencyNode.h>
+//*********************************************************
+
+//*********************************************************
+// Class: ShotMaskDetails
+//
+// Desc: The scene details shown by the shot mask UI, the
+//       viewport camera, the scene name and the render
+//       resolution.  Everything except the viewport camera
+//       is cached for the rest of the session:
+//
+//       - the camera settings until an attribute of the
+//         camera shape changes or another camera is used
+//       - the render settings until an attribute of
+//         defaultResolution changes
+//       - the scene name until a scene is saved, opened or
+//         created
+//
+//       The callbacks are added the first time the details
+//       are needed and removed when the plugin is unloaded.
+//*********************************************************
+class ShotMaskDetails
+{
+public:
+    struct Details {
+        // The viewport camera, empty without a viewport
+        MString camera, cameraShape;
+
+        // The short scene name without the extension,
+        // "Untitled" for a new scene
+        MString sceneName;
+
+        // defaultResolution
+        double renderAspectRatio;
+        int resolutionWidth, resolutionHeight;
+
+        // Camera settings that change the mask layout
+        double filmAspectRatio, overscan;
+        MFnCamera::FilmFit filmFit;
+        bool orthographic;
+    };
+
+private:
+    // The last details found, only the parts flagged as
+    // valid match the scene
+    static Details cached;
+    static bool cameraValid, renderValid, sceneValid;
+
+    // The camera shape the camera settings belong to
+    static MObjectHandle cachedCamera;
+
+    // The callbacks on the camera shape, on
+    // defaultResolution and on the scene
+    static MCallbackIdArray cameraCallbackIds;
+    static MCallbackIdArray renderCallbackIds;
+    static MCallbackIdArray sceneCallbackIds;
+
+    // Reads the camera settings and watches the camera
+    static MStatus updateCamera( const MObject &cameraShape );
+
+    // Reads defaultResolution and watches it
+    static MStatus updateRender();
+
+    // Reads the scene name
+    static MStatus updateScene();
+
+    // Removes the callbacks in the array
+    static void removeCallbacks( MCallbackIdArray &callbackIds );
+
+    // Invalidates the camera settings when the camera
+    // shape is edited
+    static void cameraChanged( MNodeMessage::AttributeMessage msg, MPlug &plug, MPlug &otherPlug, void *clientData );
+
+    // Invalidates the render settings when
+    // defaultResolution is edited
+    static void renderChanged( MNodeMessage::AttributeMessage msg, MPlug &plug, MPlug &otherPlug, void *clientData );
+
+    // Invalidates the scene name after a save
+    static void sceneSaved( void *clientData );
+
+    // Invalidates everything when a scene replaces the
+    // current one, the watched nodes no longer exist
+    static void sceneChanged( void *clientData );
+
+public:
+    // Gets the details for the camera of the active
+    // viewport
+    static MStatus getDetails( Details &details );
+
+    // Gets the render aspect ratio in defaultResolution
+    static MStatus getRenderAspectRatio( double &aspectRatio );
+
+    // The camera of the active viewport
+    static MStatus getViewportCamera( MDagPath &cameraPath );
+
+    // The filmFit name used by the camera command
+    static MString getFilmFitName( MFnCamera::FilmFit filmFit );
+
+    // Marks all of the details as out of date
+    static void invalidate();
+
+    // Removes all of the callbacks
+    static void removeCallbacks();
+};
+
+#endif
@@ -0,0 +1,277 @@
+//*********************************************************
+// ShotMaskLayout.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "ShotMaskLayout.h"
+
+#include <math.h>
+//*********************************************************
+
+//*********************************************************
+// Name: layout
+// Desc: Sizes the borders to the gate, centres the title
+//       on the top border, puts the bottom text in the
+//       bottom corners and the frame counter in the top
+//       right corner
+//*********************************************************
+void ShotMaskLayout::layout( const Camera &camera, const Input &input, Result &result )
+{
+    double nearClip = camera.nearClip;
+    if( nearClip < 0.1 )
+        nearClip = 0.1;
+
+    // The location of the shot mask is slightly offset
+    // to minimize clipping problems with the
+    // labels, frame counter, etc...
+    double shotMaskZPos = nearClip + (nearClip * 0.1);
+
+    // The z-position for the text
+    double textZPos = shotMaskZPos - (nearClip * 0.006);
+
+    // The z-position for icons
+    double iconZPos = shotMaskZPos - (nearClip * 0.003);
+
+    // The z-position for the frame counter numbers
+    double frameNumZPos = textZPos;
+
+    double width = 0.0, height = 0.0;
+    getGateSize( camera, input.aspectRatio, input.renderAspectRatio, shotMaskZPos, width, height );
+
+    result.width = width;
+    result.height = height;
+
+    // The corners (size) of the shot mask
+    double right = width / 2.0;
+    double left = -right;
+    double top = height / 2.0;
+
+    // The thickness of horizontal edges
+    double hThickness = input.maskThickness * height;
+    // The thickness of vertical edges
+    double vThickness = input.maskThickness * width;
+
+    double iconScale = hThickness * 0.6;
+    double counterScale = hThickness * input.textScales.counter;
+    double titleScale = hThickness * input.textScales.title;
+    double subtitleScale = hThickness * input.textScales.subtitle;
+
+    // How far to move the mask edges to fit the gate
+    double edgeVertTrans = top - (hThickness/2.0);
+    double edgeHoriTrans = right - (vThickness/2.0);
+
+    // Borders
+    double sideBorderHeight = height - (2 * hThickness);
+
+    result.topPlane = makeTransform( 0.0, edgeVertTrans, -shotMaskZPos, width, hThickness );
+    result.bottomPlane = makeTransform( 0.0, -edgeVertTrans, -shotMaskZPos, width, hThickness );
+    result.leftPlane = makeTransform( -edgeHoriTrans, 0.0, -shotMaskZPos, vThickness, sideBorderHeight );
+    result.rightPlane = makeTransform( edgeHoriTrans, 0.0, -shotMaskZPos, vThickness, sideBorderHeight );
+
+    // Letterboxing should be located on the outer edge
+    // of the gate
+    double lbVertTrans = top + (height / 2.0);
+    double lbHoriTrans = right + (width / 2.0);
+
+    result.letterboxTop = makeTransform( 0.0, lbVertTrans, -shotMaskZPos, 3.0 * width, height );
+    result.letterboxBottom = makeTransform( 0.0, -lbVertTrans, -shotMaskZPos, 3.0 * width, height );
+    result.letterboxLeft = makeTransform( -lbHoriTrans, 0.0, -shotMaskZPos, width, height );
+    result.letterboxRight = makeTransform( lbHoriTrans, 0.0, -shotMaskZPos, width, height );
+
+    // Title, centred on the top border
+    const Box &titleBox = input.titleBox;
+    double centerX = (titleBox.minX + titleBox.maxX) * 0.5;
+    double centerY = (titleBox.minY + titleBox.maxY) * 0.5;
+
+    result.title = makeTransform( -centerX * titleScale, edgeVertTrans - (centerY * titleScale), -textZPos,
+                                  titleScale, titleScale );
+    result.titlePivot = makePivot( 0.0, edgeVertTrans, -textZPos );
+
+    // Bottom left/right text, vertically aligned in the
+    // middle of the bottom border with a fixed padding
+    double padding = 0.03 * width;
+
+    const Box &leftBox = input.bottomLeftBox;
+    double leftHeight = leftBox.height();
+    double leftVertPos = -edgeVertTrans - (0.25 * leftHeight * subtitleScale);
+    double leftHoriPos = left + padding;
+
+    result.bottomLeft = makeTransform( leftHoriPos, leftVertPos, -textZPos, subtitleScale, subtitleScale );
+    result.bottomLeftPivot = makePivot( leftHoriPos + (leftBox.minX * subtitleScale),
+                                        leftVertPos + (leftBox.maxY * subtitleScale) - (leftHeight * subtitleScale * 0.5),
+                                        -textZPos );
+
+    const Box &rightBox = input.bottomRightBox;
+    double rightHeight = rightBox.height();
+    double rightVertPos = -edgeVertTrans - (0.25 * rightHeight * subtitleScale);
+    double rightHoriPos = right - (rightBox.width() * subtitleScale) - padding;
+
+    result.bottomRight = makeTransform( rightHoriPos, rightVertPos, -textZPos, subtitleScale, subtitleScale );
+    result.bottomRightPivot = makePivot( rightHoriPos + (rightBox.maxX * subtitleScale),
+                                         rightVertPos + (rightBox.maxY * subtitleScale) - (rightHeight * subtitleScale * 0.5),
+                                         -textZPos );
+
+    // Frame counter, the icons sit behind the 10s column and
+    // the counter is pulled slightly in from the corner
+    double counterHoriTrans = edgeHoriTrans - (0.13 * vThickness);
+    double counterVertTrans = edgeVertTrans - (0.04 * hThickness);
+    double keyIconScale = iconScale * 1.2;
+
+    result.keyIcon = makeTransform( counterHoriTrans, counterVertTrans, -iconZPos, keyIconScale, keyIconScale * 0.6 );
+    result.breakdownIcon = makeTransform( counterHoriTrans, counterVertTrans - (0.36 * hThickness), -iconZPos,
+                                          keyIconScale * 2.0, keyIconScale * 0.2 );
+
+    const Box &digitBox = input.digitBox;
+    double digitWidth = digitBox.width() * counterScale;
+    double digitHeight = digitBox.height() * counterScale;
+    double columnVertTrans = counterVertTrans - (digitHeight * 0.5);
+
+    // The icons sit behind the second slot from the right
+    result.counterSlots.resize( input.slotOffsets.size() );
+    for( unsigned int i = 0; i < input.slotOffsets.size(); i++ ) {
+        double slotHoriTrans = counterHoriTrans + (1.1 * digitWidth) + (input.slotOffsets[i] * counterScale);
+        result.counterSlots[i] = makeTransform( slotHoriTrans, columnVertTrans, -frameNumZPos, counterScale, counterScale );
+    }
+
+    // The UI scales the counter from its top right corner
+    double counterRight = counterHoriTrans + (1.1 * digitWidth) + (digitBox.maxX * counterScale);
+    double counterTop = columnVertTrans + (digitBox.maxY * counterScale);
+
+    if( counterRight < counterHoriTrans + keyIconScale )
+        counterRight = counterHoriTrans + keyIconScale;
+    if( counterTop < counterVertTrans + (keyIconScale * 0.6) )
+        counterTop = counterVertTrans + (keyIconScale * 0.6);
+
+    result.counterPivot = makePivot( counterRight, counterTop, -frameNumZPos );
+}
+
+
+//*********************************************************
+// Name: getGateSize
+// Desc: An ortho camera shows its ortho width.  A
+//       perspective camera keeps the field of view of its
+//       film fit, fill and overscan scale the horizontal
+//       field of view by the difference in aspect ratios.
+//*********************************************************
+void ShotMaskLayout::getGateSize( const Camera &camera, double aspectRatio, double renderAspectRatio,
+                                  double distance, double &width, double &height )
+{
+    width = height = 0.0;
+
+    if( camera.orthographic ) {
+        width = camera.orthoWidth;
+        height = width / aspectRatio;
+    }
+    else {
+        switch( getGateFilmFit( camera, aspectRatio, renderAspectRatio )) {
+            case kVerticalFilmFit:
+                // The vertical FOV will remain fixed
+                height = 2 * (tan(camera.verticalFOV / 2.0) * distance);
+                width = height * aspectRatio;
+                break;
+
+            case kHorizontalFilmFit:
+                // The horizontal FOV will remain fixed
+                width = 2 * (tan(camera.horizontalFOV / 2.0) * distance);
+                height = width / aspectRatio;
+                break;
+
+            case kFillFilmFit:
+            case kOverscanFilmFit:
+                // Fill with a film aspect ratio > render aspect
+                // ratio and overscan with a render aspect
+                // ratio > film aspect ratio change the size
+                width = 2 * (tan(camera.horizontalFOV / 2.0) * (renderAspectRatio / camera.filmAspectRatio) * distance);
+                height = width / aspectRatio;
+                break;
+        }
+    }
+}
+
+
+//*********************************************************
+// Name: getGateFilmFit
+// Desc: Fill and overscan are the same as horizontal when
+//       the mask uses the film gate, or when the aspect
+//       ratios don't need them
+//*********************************************************
+ShotMaskLayout::FilmFit ShotMaskLayout::getGateFilmFit( const Camera &camera, double aspectRatio, double renderAspectRatio )
+{
+    FilmFit filmFit = camera.filmFit;
+    double filmAspectRatio = camera.filmAspectRatio;
+
+    if( filmFit == kFillFilmFit &&
+        (filmAspectRatio <= renderAspectRatio || filmAspectRatio == aspectRatio) )
+        filmFit = kHorizontalFilmFit;
+
+    else if( filmFit == kOverscanFilmFit &&
+        (filmAspectRatio >= renderAspectRatio || filmAspectRatio == aspectRatio) )
+        filmFit = kHorizontalFilmFit;
+
+    return filmFit;
+}
+
+
+//*********************************************************
+// Name: getPlatformTextScales
+// Desc: The fonts of each platform have different sized
+//       glyphs, the scales keep the text the same size
+//*********************************************************
+ShotMaskLayout::TextScales ShotMaskLayout::getPlatformTextScales()
+{
+    TextScales scales = { 0.0, 0.0, 0.0 };
+
+#ifdef NT_PLUGIN
+    scales.counter = 0.17;
+    scales.title = 0.25;
+    scales.subtitle = 0.22;
+#endif
+
+#ifdef LINUX_PLUGIN
+    // with Utopia, it seems to be the same as PPC-mac
+    scales.counter = 0.50;
+    scales.title = 0.53;
+    scales.subtitle = 0.50;
+#endif
+
+// Apple stuff
+#ifdef __APPLE__
+	#if defined(__i386__)
+    scales.counter = 0.11;
+    scales.title = 0.15;
+    scales.subtitle = 0.15;
+	#else
+    scales.counter = 0.50;
+    scales.title = 0.53;
+    scales.subtitle = 0.50;
+	#endif
+#endif
+
+    return scales;
+}
+
+
+//*********************************************************
+// Name: makeTransform
+// Desc: Fills in a transform
+//*********************************************************
+ShotMaskLayout::Transform ShotMaskLayout::makeTransform( double tx, double ty, double tz, double sx, double sy )
+{
+    Transform transform = { tx, ty, tz, sx, sy };
+    return transform;
+}
+
+
+//*********************************************************
+// Name: makePivot
+// Desc: Fills in a pivot
+//*********************************************************
+ShotMaskLayout::Pivot ShotMaskLayout::makePivot( double x, double y, double z )
+{
+    Pivot pivot = { x, y, z };
+    return pivot;
+}
@@ -0,0 +1,140 @@
+//*********************************************************
+// ShotMaskLayout.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __SHOT_MASK_LAYOUT_H_
+#define __SHOT_MASK_LAYOUT_H_
+
+//*********************************************************
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: ShotMaskLayout
+//
+// Desc:  The size and position of every element of the
+//        shot mask, calculated from the camera, the render
+//        settings and the bounds of the text.  Nothing here
+//        uses Maya, so the layout can be checked for any
+//        camera without creating one.
+//
+//        The mask is drawn in the camera's space just past
+//        the near clipping plane, facing down -z.  The text
+//        and icons are pulled slightly towards the camera so
+//        they're drawn over the borders.
+//*********************************************************
+class ShotMaskLayout
+{
+public:
+    // In the order of MFnCamera::FilmFit
+    enum FilmFit {
+        kFillFilmFit,
+        kHorizontalFilmFit,
+        kVerticalFilmFit,
+        kOverscanFilmFit
+    };
+
+    // Bounds of text or a digit before it's scaled
+    struct Box {
+        double minX, minY, maxX, maxY;
+
+        Box() : minX( 0.0 ), minY( 0.0 ), maxX( 0.0 ), maxY( 0.0 ) {}
+        double width() const { return maxX - minX; }
+        double height() const { return maxY - minY; }
+    };
+
+    // Text size as a fraction of the border thickness.
+    // The default depends on the font of the platform.
+    struct TextScales {
+        double counter, title, subtitle;
+    };
+
+    // The camera settings the gate is calculated from.
+    // Angles are in radians.
+    struct Camera {
+        bool orthographic;
+        double orthoWidth;
+        double horizontalFOV, verticalFOV;
+        double nearClip;
+        FilmFit filmFit;
+        double filmAspectRatio;
+    };
+
+    struct Input {
+        // Aspect ratio of the mask and of the render
+        // settings, both are the film aspect ratio when the
+        // mask uses the film gate
+        double aspectRatio, renderAspectRatio;
+
+        // Border thickness as a fraction of the width and
+        // height of the gate
+        double maskThickness;
+
+        TextScales textScales;
+
+        // Bounds of the lines of text and of the digits
+        Box titleBox, bottomLeftBox, bottomRightBox, digitBox;
+
+        // Offset of each counter slot from the rightmost
+        // slot, before it's scaled
+        std::vector<double> slotOffsets;
+    };
+
+    // Translation and x/y scale of a node
+    struct Transform {
+        double tx, ty, tz, sx, sy;
+    };
+
+    // Rotate/scale pivot of a node
+    struct Pivot {
+        double x, y, z;
+    };
+
+    struct Result {
+        // Size of the gate at the distance of the mask
+        double width, height;
+
+        Transform topPlane, bottomPlane, leftPlane, rightPlane;
+        Transform letterboxTop, letterboxBottom, letterboxLeft, letterboxRight;
+
+        // The layout node of each line of text and the pivot
+        // of its text node, the UI scales the text around it
+        Transform title, bottomLeft, bottomRight;
+        Pivot titlePivot, bottomLeftPivot, bottomRightPivot;
+
+        Transform keyIcon, breakdownIcon;
+
+        // One transform per counter slot, in the order of
+        // the slot offsets
+        std::vector<Transform> counterSlots;
+
+        // The UI scales the counter from its top right
+        Pivot counterPivot;
+    };
+
+    // Calculates every element of the mask
+    static void layout( const Camera &camera, const Input &input, Result &result );
+
+    // The size of the gate at a distance in front of the
+    // camera
+    static void getGateSize( const Camera &camera, double aspectRatio, double renderAspectRatio,
+                             double distance, double &width, double &height );
+
+    // The film fit used for the gate.  Fill and overscan
+    // only differ from horizontal when the film and render
+    // aspect ratios make them.
+    static FilmFit getGateFilmFit( const Camera &camera, double aspectRatio, double renderAspectRatio );
+
+    // The text scales for the font of the platform
+    static TextScales getPlatformTextScales();
+
+private:
+    static Transform makeTransform( double tx, double ty, double tz, double sx, double sy );
+    static Pivot makePivot( double x, double y, double z );
+};
+
+#endif
@@ -0,0 +1,349 @@
+//*********************************************************
+// ShotMaskNode.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "ShotMaskNode.h"
+#include "NodeIds.h"
+#include "ErrorReporting.h"
+//*********************************************************
+
+//*********************************************************
+// Constants
+//*********************************************************
+const char *ShotMaskNode::typeName = "cieShotMaskNode";
+
+MTypeId ShotMaskNode::id( shotMaskNodeId );
+
+MObject ShotMaskNode::timeAttr;
+MObject ShotMaskNode::rootObjectsAttr;
+MObject ShotMaskNode::counterFormatAttr;
+MObject ShotMaskNode::counterDigitsAttr;
+MObject ShotMaskNode::framesPerFootAttr;
+
+MObject ShotMaskNode::cameraAttr;
+MObject ShotMaskNode::maskRootAttr;
+MObject ShotMaskNode::shadersAttr;
+MObject ShotMaskNode::aspectRatioAttr;
+MObject ShotMaskNode::maskThicknessAttr;
+MObject ShotMaskNode::titleAttr;
+MObject ShotMaskNode::text1Attr;
+MObject ShotMaskNode::text2Attr;
+
+MObject ShotMaskNode::burnInAttr;
+MObject ShotMaskNode::burnInStartAttr;
+MObject ShotMaskNode::burnInEndAttr;
+
+MObject ShotMaskNode::digitVisibilityAttr;
+MObject ShotMaskNode::signVisibilityAttr;
+MObject ShotMaskNode::keyTypeAttr;
+MObject ShotMaskNode::keyIconVisibilityAttr;
+MObject ShotMaskNode::breakdownIconVisibilityAttr;
+MObject ShotMaskNode::timecodeAttr;
+
+
+//*********************************************************
+// Name: ShotMaskNode
+// Desc: Constructor
+//*********************************************************
+ShotMaskNode::ShotMaskNode()
+{
+}
+
+
+//*********************************************************
+// Name: ~ShotMaskNode
+// Desc: Destructor
+//*********************************************************
+ShotMaskNode::~ShotMaskNode()
+{
+}
+
+
+//*********************************************************
+// Name: initialize
+// Desc: Creates the attributes of the node and sets up
+//       which outputs each input affects
+//*********************************************************
+MStatus ShotMaskNode::initialize()
+{
+    MStatus status = MS::kSuccess;
+
+    MFnUnitAttribute unitAttrFn;
+    MFnMessageAttribute messageAttrFn;
+    MFnNumericAttribute numericAttrFn;
+    MFnEnumAttribute enumAttrFn;
+    MFnTypedAttribute typedAttrFn;
+    MFnStringData stringDataFn;
+
+    // Inputs
+    timeAttr = unitAttrFn.create( "time", "tm", MFnUnitAttribute::kTime, 0.0 );
+    unitAttrFn.setStorable( false );
+
+    rootObjectsAttr = messageAttrFn.create( "rootObjects", "ro" );
+    messageAttrFn.setArray( true );
+
+    counterFormatAttr = enumAttrFn.create( "counterFormat", "cf", FrameCounterFormat::kFrames );
+    enumAttrFn.addField( "frames", FrameCounterFormat::kFrames );
+    enumAttrFn.addField( "timecode", FrameCounterFormat::kTimecode );
+    enumAttrFn.addField( "feetFrames", FrameCounterFormat::kFeetFrames );
+
+    counterDigitsAttr = numericAttrFn.create( "counterDigits", "cd", MFnNumericData::kInt, 4 );
+    numericAttrFn.setMin( 1 );
+
+    framesPerFootAttr = numericAttrFn.create( "framesPerFoot", "fpf", MFnNumericData::kInt, 16 );
+    numericAttrFn.setMin( 1 );
+
+    // The mask, these don't affect any outputs
+    cameraAttr = messageAttrFn.create( "camera", "cam" );
+    maskRootAttr = messageAttrFn.create( "maskRoot", "mr" );
+
+    shadersAttr = messageAttrFn.create( "shaders", "shd" );
+    messageAttrFn.setArray( true );
+
+    aspectRatioAttr = numericAttrFn.create( "aspectRatio", "ar", MFnNumericData::kDouble, 0.0 );
+    numericAttrFn.setMin( 0.0 );
+
+    maskThicknessAttr = numericAttrFn.create( "maskThickness", "mt", MFnNumericData::kDouble, 0.05 );
+    numericAttrFn.setMin( 0.0 );
+
+    titleAttr = typedAttrFn.create( "title", "tt", MFnData::kString, stringDataFn.create( "" ));
+    text1Attr = typedAttrFn.create( "text1", "tx1", MFnData::kString, stringDataFn.create( "" ));
+    text2Attr = typedAttrFn.create( "text2", "tx2", MFnData::kString, stringDataFn.create( "" ));
+
+    // The burn-in range only changes how the outputs are
+    // found, not their values
+    burnInAttr = numericAttrFn.create( "burnIn", "bi", MFnNumericData::kBoolean, 0 );
+    numericAttrFn.setStorable( false );
+
+    burnInStartAttr = unitAttrFn.create( "burnInStart", "bis", MFnUnitAttribute::kTime, 0.0 );
+    unitAttrFn.setStorable( false );
+
+    burnInEndAttr = unitAttrFn.create( "burnInEnd", "bie", MFnUnitAttribute::kTime, 0.0 );
+    unitAttrFn.setStorable( false );
+
+    // Outputs
+    digitVisibilityAttr = numericAttrFn.create( "digitVisibility", "dv", MFnNumericData::kBoolean, 0 );
+    numericAttrFn.setArray( true );
+    numericAttrFn.setUsesArrayDataBuilder( true );
+    numericAttrFn.setWritable( false );
+    numericAttrFn.setStorable( false );
+
+    signVisibilityAttr = numericAttrFn.create( "signVisibility", "sv", MFnNumericData::kBoolean, 0 );
+    numericAttrFn.setWritable( false );
+    numericAttrFn.setStorable( false );
+
+    keyTypeAttr = enumAttrFn.create( "keyType", "kt", KeyTypeTimeline::kNoKey );
+    enumAttrFn.addField( "none", KeyTypeTimeline::kNoKey );
+    enumAttrFn.addField( "key", KeyTypeTimeline::kKey );
+    enumAttrFn.addField( "breakdown", KeyTypeTimeline::kBreakdown );
+    enumAttrFn.setWritable( false );
+    enumAttrFn.setStorable( false );
+
+    keyIconVisibilityAttr = numericAttrFn.create( "keyIconVisibility", "kiv", MFnNumericData::kBoolean, 0 );
+    numericAttrFn.setWritable( false );
+    numericAttrFn.setStorable( false );
+
+    breakdownIconVisibilityAttr = numericAttrFn.create( "breakdownIconVisibility", "biv", MFnNumericData::kBoolean, 0 );
+    numericAttrFn.setWritable( false );
+    numericAttrFn.setStorable( false );
+
+    timecodeAttr = typedAttrFn.create( "timecode", "tc", MFnData::kString, stringDataFn.create( "" ));
+    typedAttrFn.setWritable( false );
+    typedAttrFn.setStorable( false );
+
+    MObject attributes[] = { timeAttr, rootObjectsAttr, counterFormatAttr, counterDigitsAttr, framesPerFootAttr,
+                             cameraAttr, maskRootAttr, shadersAttr, aspectRatioAttr, maskThicknessAttr,
+                             titleAttr, text1Attr, text2Attr,
+                             burnInAttr, burnInStartAttr, burnInEndAttr,
+                             digitVisibilityAttr, signVisibilityAttr,
+                             keyTypeAttr, keyIconVisibilityAttr, breakdownIconVisibilityAttr, timecodeAttr };
+
+    for( unsigned int i = 0; i < sizeof( attributes ) / sizeof( MObject ) && status; i++ ) {
+        if( !(status = addAttribute( attributes[i] ))) {
+            pluginError( "ShotMaskNode", "initialize", "Failed to add attribute" );
+        }
+    }
+
+    if( status ) {
+        // The digits depend on the time and the format, the
+        // key type also depends on which objects are connected
+        MObject counterInputs[] = { timeAttr, counterFormatAttr, counterDigitsAttr, framesPerFootAttr };
+
+        for( unsigned int i = 0; i < sizeof( counterInputs ) / sizeof( MObject ); i++ ) {
+            attributeAffects( counterInputs[i], digitVisibilityAttr );
+            attributeAffects( counterInputs[i], signVisibilityAttr );
+        }
+
+        attributeAffects( timeAttr, keyTypeAttr );
+        attributeAffects( timeAttr, keyIconVisibilityAttr );
+        attributeAffects( timeAttr, breakdownIconVisibilityAttr );
+        attributeAffects( timeAttr, timecodeAttr );
+
+        attributeAffects( rootObjectsAttr, keyTypeAttr );
+        attributeAffects( rootObjectsAttr, keyIconVisibilityAttr );
+        attributeAffects( rootObjectsAttr, breakdownIconVisibilityAttr );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: compute
+// Desc: Sets the visibility of every digit for the time
+//       in the counter's format, the timecode and the key
+//       type of the root objects at that time.  All of the
+//       outputs are calculated together.  During a burn-in
+//       they're looked up from the precalculated frames.
+//*********************************************************
+MStatus ShotMaskNode::compute( const MPlug &plug, MDataBlock &data )
+{
+    MStatus status = MS::kSuccess;
+    MObject attr = plug.attribute();
+
+    if( attr != digitVisibilityAttr && attr != signVisibilityAttr && attr != keyTypeAttr &&
+        attr != keyIconVisibilityAttr && attr != breakdownIconVisibilityAttr && attr != timecodeAttr ) {
+        status = MS::kUnknownParameter;
+    }
+    else {
+        MTime time = data.inputValue( timeAttr ).asTime();
+
+        FrameCounterFormat counterFormat;
+        counterFormat.format = (FrameCounterFormat::Format)data.inputValue( counterFormatAttr ).asShort();
+        counterFormat.numDigits = (unsigned int)data.inputValue( counterDigitsAttr ).asInt();
+        counterFormat.framesPerFoot = (unsigned int)data.inputValue( framesPerFootAttr ).asInt();
+
+        // The timeline is only rebuilt after an edit.  A
+        // failure to read the curves leaves it empty, which
+        // only hides the icons.
+        if( !timeline.isValid() ) {
+            MObjectArray rootNodes;
+
+            burnInData.invalidate();
+
+            if( !getRootNodes( rootNodes )) {
+                pluginError( "ShotMaskNode", "compute", "Failed to get the root objects" );
+            }
+            else if( !timeline.build( rootNodes, true )) {
+                pluginError( "ShotMaskNode", "compute", "Failed to build the key type timeline" );
+            }
+        }
+
+        // The burn-in frames are kept until the keys, the
+        // range or the format change
+        bool burnIn = data.inputValue( burnInAttr ).asBool();
+
+        if( burnIn ) {
+            MTime start = data.inputValue( burnInStartAttr ).asTime();
+            MTime end = data.inputValue( burnInEndAttr ).asTime();
+
+            if( (!burnInData.isValid() || !burnInData.matches( start, end, counterFormat )) &&
+                !burnInData.build( start, end, counterFormat, timeline )) {
+                pluginError( "ShotMaskNode", "compute", "Failed to calculate the burn-in frames" );
+            }
+        }
+        else if( burnInData.isValid() )
+            burnInData.clear();
+
+        BurnInData::Frame frame;
+        std::vector<int> digits;
+
+        // Sub-frames and times outside the burn-in range are
+        // calculated the same way as without a burn-in
+        if( !burnIn || !burnInData.getFrame( time, frame )) {
+            FrameCounterFormat timecodeFormat;
+            timecodeFormat.format = FrameCounterFormat::kTimecode;
+
+            counterFormat.getDigits( time, digits, frame.negative );
+            frame.digits = digits.empty() ? NULL : &digits[0];
+            frame.numDigits = (unsigned int)digits.size();
+            frame.timecode = timecodeFormat.getText( time ).c_str();
+            frame.keyType = timeline.getKeyType( time );
+        }
+
+        // One element per digit of each digit slot
+        MArrayDataHandle digitArrayHandle = data.outputArrayValue( digitVisibilityAttr );
+        MArrayDataBuilder digitBuilder( &data, digitVisibilityAttr, frame.numDigits * 10 );
+
+        for( unsigned int slot = 0; slot < frame.numDigits; slot++ ) {
+            for( int digit = 0; digit <= 9; digit++ )
+                digitBuilder.addElement( slot * 10 + digit ).setBool( frame.digits[slot] == digit );
+        }
+
+        digitArrayHandle.set( digitBuilder );
+        digitArrayHandle.setAllClean();
+
+        data.outputValue( signVisibilityAttr ).setBool( frame.negative );
+        data.setClean( signVisibilityAttr );
+
+        data.outputValue( timecodeAttr ).setString( frame.timecode );
+        data.setClean( timecodeAttr );
+
+        data.outputValue( keyTypeAttr ).setShort( (short)frame.keyType );
+        data.outputValue( keyIconVisibilityAttr ).setBool( frame.keyType == KeyTypeTimeline::kKey );
+        data.outputValue( breakdownIconVisibilityAttr ).setBool( frame.keyType == KeyTypeTimeline::kBreakdown );
+
+        data.setClean( keyTypeAttr );
+        data.setClean( keyIconVisibilityAttr );
+        data.setClean( breakdownIconVisibilityAttr );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: connectionMade
+// Desc: Rebuilds the timeline on the next compute when a
+//       root object is connected
+//*********************************************************
+MStatus ShotMaskNode::connectionMade( const MPlug &plug, const MPlug &otherPlug, bool asSrc )
+{
+    if( plug.attribute() == rootObjectsAttr )
+        timeline.invalidate();
+
+    return MPxNode::connectionMade( plug, otherPlug, asSrc );
+}
+
+
+//*********************************************************
+// Name: connectionBroken
+// Desc: Rebuilds the timeline on the next compute when a
+//       root object is disconnected
+//*********************************************************
+MStatus ShotMaskNode::connectionBroken( const MPlug &plug, const MPlug &otherPlug, bool asSrc )
+{
+    if( plug.attribute() == rootObjectsAttr )
+        timeline.invalidate();
+
+    return MPxNode::connectionBroken( plug, otherPlug, asSrc );
+}
+
+
+//*********************************************************
+// Name: getRootNodes
+// Desc: Gets the nodes connected to the rootObjects
+//       attribute
+//*********************************************************
+MStatus ShotMaskNode::getRootNodes( MObjectArray &rootNodes ) const
+{
+    MStatus status = MS::kSuccess;
+
+    MPlug rootObjectsPlug( thisMObject(), rootObjectsAttr );
+    unsigned int numElements = rootObjectsPlug.numElements( &status );
+
+    for( unsigned int i = 0; i < numElements && status; i++ ) {
+        MPlugArray srcPlugs;
+        MPlug elementPlug = rootObjectsPlug.elementByPhysicalIndex( i, &status );
+
+        if( status && elementPlug.connectedTo( srcPlugs, true, false ) && srcPlugs.length() > 0 )
+            rootNodes.append( srcPlugs[0].node() );
+    }
+
+    return status;
+}
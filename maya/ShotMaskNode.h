@@ -0,0 +1,184 @@
+//*********************************************************
+// ShotMaskNode.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __SHOT_MASK_NODE_H_
+#define __SHOT_MASK_NODE_H_
+
+//*********************************************************
+#include <maya/MPxNode.h>
+
+#include <maya/MTypeId.h>
+#include <maya/MObject.h>
+#include <maya/MObjectArray.h>
+#include <maya/MPlug.h>
+#include <maya/MPlugArray.h>
+#include <maya/MDataBlock.h>
+#include <maya/MDataHandle.h>
+#include <maya/MArrayDataHandle.h>
+#include <maya/MArrayDataBuilder.h>
+#include <maya/MTime.h>
+#include <maya/MString.h>
+
+#include <maya/MFnDependencyNode.h>
+#include <maya/MFnUnitAttribute.h>
+#include <maya/MFnNumericAttribute.h>
+#include <maya/MFnMessageAttribute.h>
+#include <maya/MFnEnumAttribute.h>
+#include <maya/MFnTypedAttribute.h>
+#include <maya/MFnStringData.h>
+
+#include "KeyTypeTimeline.h"
+#include "FrameCounterFormat.h"
+#include "BurnInData.h"
+
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: ShotMaskNode
+//
+// Desc: Drives the shot mask frame counter and key icons
+//       from the time and the root objects connected to
+//       it.  The counter shows the time in any of the
+//       FrameCounterFormat formats.  Replaces the per-frame expression, so nothing
+//       runs through MEL during playback and the node can
+//       be evaluated at any time with getAttr -t.  The key
+//       times of the root objects are cached in a timeline
+//       that is only rebuilt after the keys or connections
+//       change.
+//
+//       During a playblast burnIn is turned on and every
+//       frame of the burn-in range is calculated in one
+//       pass the first time the node is evaluated.  Each
+//       frame after that is looked up by its index.
+//
+//       The node is also the handle of the shot mask.  The
+//       camera, main group and shaders are connected to it
+//       and the settings the mask was built with are stored
+//       on it, so cieShotMask can find, edit and delete the
+//       whole mask without looking up nodes by name.
+//
+// Node: cieShotMaskNode
+//
+// Inputs: time (tm)                       (time)
+//
+//         rootObjects (ro)                (message array)
+//
+//         counterFormat (cf)              (enum) frames, timecode, feetFrames
+//
+//         counterDigits (cd)              (int) digits for the frames
+//                                         or feet
+//
+//         framesPerFoot (fpf)             (int)
+//
+//         camera (cam)                    (message) camera transform
+//
+//         maskRoot (mr)                   (message) main group
+//
+//         shaders (shd)                   (message array) border,
+//                                         text, key, breakdown and
+//                                         letterbox shaders
+//
+//         aspectRatio (ar)                (double) 0 for the film gate
+//
+//         maskThickness (mt)              (double)
+//
+//         title (tt), text1 (tx1), text2 (tx2)  (string)
+//
+//         burnIn (bi)                     (bool) precalculates
+//                                         the burn-in range
+//
+//         burnInStart (bis), burnInEnd (bie)  (time)
+//
+// Outputs: digitVisibility (dv)           (bool array)
+//              index = slot * 10 + digit, digit slots are
+//              numbered from the right
+//
+//          signVisibility (sv)            (bool)
+//
+//          keyType (kt)                   (enum) none, key, breakdown
+//
+//          keyIconVisibility (kiv)        (bool)
+//
+//          breakdownIconVisibility (biv)  (bool)
+//
+//          timecode (tc)                  (string) SMPTE
+//                                         timecode of the time
+//
+//*********************************************************
+class ShotMaskNode : public MPxNode
+{
+public:
+    // Node type name and id
+    static const char *typeName;
+    static MTypeId id;
+
+    // Input attributes
+    static MObject timeAttr;
+    static MObject rootObjectsAttr;
+    static MObject counterFormatAttr;
+    static MObject counterDigitsAttr;
+    static MObject framesPerFootAttr;
+
+    // Mask attributes, only used by cieShotMask
+    static MObject cameraAttr;
+    static MObject maskRootAttr;
+    static MObject shadersAttr;
+    static MObject aspectRatioAttr;
+    static MObject maskThicknessAttr;
+    static MObject titleAttr;
+    static MObject text1Attr;
+    static MObject text2Attr;
+
+    // Burn-in attributes, set for a playblast
+    static MObject burnInAttr;
+    static MObject burnInStartAttr;
+    static MObject burnInEndAttr;
+
+    // Output attributes
+    static MObject digitVisibilityAttr;
+    static MObject signVisibilityAttr;
+    static MObject keyTypeAttr;
+    static MObject keyIconVisibilityAttr;
+    static MObject breakdownIconVisibilityAttr;
+    static MObject timecodeAttr;
+
+private:
+    // The key times of the root objects
+    KeyTypeTimeline timeline;
+
+    // Every frame of the burn-in range
+    BurnInData burnInData;
+
+    // Gets the nodes connected to the rootObjects attribute
+    MStatus getRootNodes( MObjectArray &rootNodes ) const;
+
+public:
+    // Constructor/Destructor
+    ShotMaskNode();
+    virtual ~ShotMaskNode();
+
+    // Calculates the digit and key icon outputs
+    virtual MStatus compute( const MPlug &plug, MDataBlock &data );
+
+    // Rebuild the timeline when the root objects change
+    virtual MStatus connectionMade( const MPlug &plug, const MPlug &otherPlug, bool asSrc );
+    virtual MStatus connectionBroken( const MPlug &plug, const MPlug &otherPlug, bool asSrc );
+
+    // The key type is read from the anim curves directly,
+    // outside of the data block
+    virtual SchedulingType schedulingType() const { return kUntrusted; }
+
+    // Allocates a node object to Maya (required)
+    static void *creator() { return new ShotMaskNode; }
+
+    // Creates the attributes of the node
+    static MStatus initialize();
+};
+
+#endif
@@ -0,0 +1,434 @@
+//*********************************************************
+// StaticChannelsCommand.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "StaticChannelsCommand.h"
+#include "ParallelFor.h"
+#include "ErrorReporting.h"
+
+#include <algorithm>
+#include <math.h>
+//*********************************************************
+
+//*********************************************************
+// Constants
+//*********************************************************
+const char *StaticChannelsCommand::toleranceFlag = "-tol";
+const char *StaticChannelsCommand::toleranceLongFlag = "-tolerance";
+const char *StaticChannelsCommand::deleteFlag = "-d";
+const char *StaticChannelsCommand::deleteLongFlag = "-delete";
+
+// Tangent angles (radians) closer to 0 than this are flat,
+// for the tangents a linear infinity extends
+static const double flatTangentAngle = 1.0e-6;
+
+
+//*********************************************************
+// Name: StaticChannelsCommand
+// Desc: Constructor
+//*********************************************************
+StaticChannelsCommand::StaticChannelsCommand()
+{
+    pluginTrace( "StaticChannelsCommand", "StaticChannelsCommand", "******* Static Channels Command *******" );
+
+    numCurvesChecked = 0;
+    numStaticCurves = 0;
+    numCurvesDeleted = 0;
+
+    // Initialize the command flag defaults
+    tolerance = 0.0001;
+    deleteCurves = false;
+}
+
+
+//*********************************************************
+// Name: ~StaticChannelsCommand
+// Desc: Destructor
+//*********************************************************
+StaticChannelsCommand::~StaticChannelsCommand()
+{
+}
+
+
+//*********************************************************
+// Name: doIt
+// Desc: All of the one-time setup and initialization
+//       code for the static channels command.  doIt is
+//       called by Maya when any command is executed in MEL.
+//       Any code that changes the state of Maya is
+//       handled by the redoIt method.
+//*********************************************************
+MStatus StaticChannelsCommand::doIt( const MArgList &args )
+{
+    MStatus status = MS::kFailure;
+    std::vector<StaticCurveInfo> curves;
+
+    if( !parseCommandFlags( args )) {
+        pluginError( "StaticChannelsCommand", "doIt", "Failed to parse command flags" );
+    }
+    else if( !(status = getSceneCurves( curves ))) {
+        pluginError( "StaticChannelsCommand", "doIt", "Failed to read the scene's anim curves" );
+    }
+    else {
+        numCurvesChecked = (unsigned int)curves.size();
+
+        // Every curve is checked independently
+        parallelFor( numCurvesChecked, [&]( unsigned int i ) {
+            checkStaticCurve( curves[i] );
+        });
+
+        for( unsigned int i = 0; i < curves.size() && status; i++ ) {
+            if( !curves[i].isStatic )
+                continue;
+
+            numStaticCurves++;
+
+            if( deleteCurves ) {
+                bool isDeleted = false;
+                status = deleteStaticCurve( curves[i], isDeleted );
+                if( isDeleted )
+                    numCurvesDeleted++;
+            }
+        }
+
+        if( !status ) {
+            pluginError( "StaticChannelsCommand", "doIt", "Failed to delete the static curves" );
+        }
+        else if( deleteCurves && !(status = redoIt() )) {
+            pluginError( "StaticChannelsCommand", "doIt", "Failed to redoIt" );
+        }
+        else {
+            MString result( "Result: " );
+            result += numStaticCurves;
+            result += " of ";
+            result += numCurvesChecked;
+            result += " curves static";
+            if( deleteCurves ) {
+                result += ", ";
+                result += numCurvesDeleted;
+                result += " deleted";
+            }
+            MGlobal::displayInfo( result );
+
+            setResult( (int)(deleteCurves ? numCurvesDeleted : numStaticCurves) );
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: redoIt
+// Desc: Contains the code that changes the internal state
+//       of Maya.  It is called by Maya to redo.
+//*********************************************************
+MStatus StaticChannelsCommand::redoIt()
+{
+    return dgModifier.doIt();
+}
+
+
+//*********************************************************
+// Name: undoIt
+// Desc: Contains the code to undo the internal state
+//       changes made by the static channels command
+//       (redoIt).  It is called by Maya to undo.
+//*********************************************************
+MStatus StaticChannelsCommand::undoIt()
+{
+    return dgModifier.undoIt();
+}
+
+
+//*********************************************************
+// Name: newSyntax
+// Desc: Method for registering the command flags
+//       with Maya
+//*********************************************************
+MSyntax StaticChannelsCommand::newSyntax()
+{
+    MSyntax syntax;
+    syntax.addFlag( toleranceFlag, toleranceLongFlag, MSyntax::kDouble );
+    syntax.addFlag( deleteFlag, deleteLongFlag, MSyntax::kNoArg );
+
+    return syntax;
+}
+
+
+//*********************************************************
+// Name: parseCommandFlags
+// Desc: Parse the command flags and stores the values
+//       in the appropriate variables
+//*********************************************************
+MStatus StaticChannelsCommand::parseCommandFlags( const MArgList &args )
+{
+    MStatus status = MS::kSuccess;
+
+    MArgDatabase argData( syntax(), args, &status );
+    if( !status ) {
+        pluginError( "StaticChannelsCommand", "parseCommandFlags",
+                     "Failed to create MArgDatabase for the static channels command" );
+    }
+    else {
+        if( argData.isFlagSet( toleranceFlag ))
+            argData.getFlagArgument( toleranceFlag, 0, tolerance );
+        if( argData.isFlagSet( deleteFlag ))
+            deleteCurves = true;
+
+        if( tolerance < 0.0 ) {
+            MGlobal::displayError( "The tolerance must be greater than or equal to 0" );
+            status = MS::kFailure;
+        }
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: getSceneCurves
+// Desc: Reads the key values and tangent angles of every
+//       time based anim curve in the scene that drives an
+//       attribute and isn't from a referenced file
+//*********************************************************
+MStatus StaticChannelsCommand::getSceneCurves( std::vector<StaticCurveInfo> &curves )
+{
+    MStatus status = MS::kSuccess;
+
+    MItDependencyNodes nodeIter( MFn::kAnimCurve, &status );
+    if( !status ) {
+        pluginError( "StaticChannelsCommand", "getSceneCurves", "Failed to create the node iterator" );
+    }
+
+    for( ; status && !nodeIter.isDone(); nodeIter.next() ) {
+        MObject animCurve = nodeIter.thisNode();
+        MFnAnimCurve animCurveFn( animCurve, &status );
+        if( !status ) {
+            pluginError( "StaticChannelsCommand", "getSceneCurves", "Can't get AnimCurve function set" );
+            break;
+        }
+
+        // Referenced curves can't be deleted and driven
+        // keys are static by design
+        MFnAnimCurve::AnimCurveType curveType = animCurveFn.animCurveType();
+        if( animCurveFn.isFromReferencedFile() ||
+            curveType == MFnAnimCurve::kAnimCurveUA ||
+            curveType == MFnAnimCurve::kAnimCurveUL ||
+            curveType == MFnAnimCurve::kAnimCurveUT ||
+            curveType == MFnAnimCurve::kAnimCurveUU ||
+            curveType == MFnAnimCurve::kAnimCurveUnknown )
+            continue;
+
+        // Curves that don't drive anything aren't evaluated
+        MPlugArray destinations;
+        MPlug outputPlug = animCurveFn.findPlug( "output", &status );
+        if( !status || !outputPlug.connectedTo( destinations, false, true ) || destinations.length() == 0 ) {
+            status = MS::kSuccess;
+            continue;
+        }
+
+        StaticCurveInfo curve;
+        unsigned int numKeys = animCurveFn.numKeys();
+
+        curve.animCurve = animCurve;
+        curve.isStatic = false;
+        curve.keyTimes.resize( numKeys );
+        curve.keyValues.resize( numKeys );
+        curve.tangentAngles.resize( numKeys * 2 );
+        curve.isStepped.resize( numKeys );
+        curve.preInfinity = animCurveFn.preInfinityType();
+        curve.postInfinity = animCurveFn.postInfinityType();
+
+        // Values are compared in internal units
+        curve.tolerance = tolerance;
+        if( curveType == MFnAnimCurve::kAnimCurveTA )
+            curve.tolerance = MAngle( tolerance, MAngle::kDegrees ).asRadians();
+
+        for( unsigned int index = 0; index < numKeys; index++ ) {
+            MAngle angleIn, angleOut;
+            double weight;
+
+            // Tangent slopes are per second
+            curve.keyTimes[index] = animCurveFn.time( index ).as( MTime::kSeconds );
+            curve.keyValues[index] = animCurveFn.value( index );
+
+            animCurveFn.getTangent( index, angleIn, weight, true );
+            animCurveFn.getTangent( index, angleOut, weight, false );
+            curve.tangentAngles[index * 2] = angleIn.asRadians();
+            curve.tangentAngles[index * 2 + 1] = angleOut.asRadians();
+
+            MFnAnimCurve::TangentType outType = animCurveFn.outTangentType( index );
+            curve.isStepped[index] = (outType == MFnAnimCurve::kTangentStep ||
+                                      outType == MFnAnimCurve::kTangentStepNext);
+        }
+
+        curves.push_back( curve );
+    }
+
+    return status;
+}
+
+
+//*********************************************************
+// Name: checkStaticCurve
+// Desc: A curve is static when everything it evaluates to,
+//       between the keys as well as on them, is within the
+//       tolerance.  Beyond the keys, a linear infinity
+//       must have a flat tangent and a relative cycle must
+//       end on the value it starts on.  The other
+//       infinities repeat the keyed range.
+//*********************************************************
+void StaticChannelsCommand::checkStaticCurve( StaticCurveInfo &curve )
+{
+    unsigned int numKeys = (unsigned int)curve.keyValues.size();
+
+    curve.isStatic = (numKeys > 0);
+    if( !curve.isStatic )
+        return;
+
+    double minValue = curve.keyValues[0];
+    double maxValue = curve.keyValues[0];
+
+    for( unsigned int i = 0; i + 1 < numKeys; i++ ) {
+        double duration = curve.keyTimes[i + 1] - curve.keyTimes[i];
+
+        // A stepped segment holds a key value
+        if( curve.isStepped[i] || duration <= 0.0 ) {
+            minValue = std::min( minValue, curve.keyValues[i + 1] );
+            maxValue = std::max( maxValue, curve.keyValues[i + 1] );
+            continue;
+        }
+
+        getSegmentRange( curve.keyValues[i], curve.keyValues[i + 1],
+                         tan( curve.tangentAngles[i * 2 + 1] ), tan( curve.tangentAngles[(i + 1) * 2] ),
+                         duration, minValue, maxValue );
+    }
+
+    if( maxValue - minValue > curve.tolerance ) {
+        curve.isStatic = false;
+        return;
+    }
+
+    if( (curve.preInfinity == MFnAnimCurve::kLinear &&
+         fabs( curve.tangentAngles[0] ) > flatTangentAngle) ||
+        (curve.postInfinity == MFnAnimCurve::kLinear &&
+         fabs( curve.tangentAngles[numKeys * 2 - 1] ) > flatTangentAngle) )
+        curve.isStatic = false;
+
+    if( (curve.preInfinity == MFnAnimCurve::kCycleRelative ||
+         curve.postInfinity == MFnAnimCurve::kCycleRelative) &&
+        curve.keyValues[0] != curve.keyValues[numKeys - 1] )
+        curve.isStatic = false;
+}
+
+
+//*********************************************************
+// Name: getSegmentRange
+// Desc: Widens the value range by the lowest and highest
+//       values of the hermite segment between two keys.
+//       The segment's extremes are where its derivative,
+//       a quadratic in the segment parameter, is 0.
+//       Weighted tangents are treated as unweighted, which
+//       is close for the short weights of a near flat
+//       curve.
+//*********************************************************
+void StaticChannelsCommand::getSegmentRange( double value0, double value1,
+                                             double slope0, double slope1,
+                                             double duration,
+                                             double &minValue, double &maxValue )
+{
+    double m0 = slope0 * duration;
+    double m1 = slope1 * duration;
+
+    // p'(s) = a s^2 + b s + c
+    double a = 6.0 * (value0 - value1) + 3.0 * (m0 + m1);
+    double b = 6.0 * (value1 - value0) - 4.0 * m0 - 2.0 * m1;
+    double c = m0;
+
+    double roots[2];
+    unsigned int numRoots = 0;
+
+    if( fabs( a ) < 1.0e-12 ) {
+        if( fabs( b ) > 1.0e-12 )
+            roots[numRoots++] = -c / b;
+    }
+    else {
+        double discriminant = b * b - 4.0 * a * c;
+        if( discriminant >= 0.0 ) {
+            double root = sqrt( discriminant );
+            roots[numRoots++] = (-b + root) / (2.0 * a);
+            roots[numRoots++] = (-b - root) / (2.0 * a);
+        }
+    }
+
+    minValue = std::min( minValue, std::min( value0, value1 ));
+    maxValue = std::max( maxValue, std::max( value0, value1 ));
+
+    for( unsigned int i = 0; i < numRoots; i++ ) {
+        double s = roots[i];
+        if( s <= 0.0 || s >= 1.0 )
+            continue;
+
+        double s2 = s * s, s3 = s2 * s;
+        double value = (2.0 * s3 - 3.0 * s2 + 1.0) * value0 +
+                       (s3 - 2.0 * s2 + s) * m0 +
+                       (-2.0 * s3 + 3.0 * s2) * value1 +
+                       (s3 - s2) * m1;
+
+        minValue = std::min( minValue, value );
+        maxValue = std::max( maxValue, value );
+    }
+}
+
+
+//*********************************************************
+// Name: deleteStaticCurve
+// Desc: Adds the deletion of a static curve to the
+//       modifier and sets the attributes it drove to the
+//       curve's value.  Curves on locked attributes are
+//       left alone since their value couldn't be set once
+//       the curve was gone.
+//*********************************************************
+MStatus StaticChannelsCommand::deleteStaticCurve( const StaticCurveInfo &curve, bool &isDeleted )
+{
+    MStatus status = MS::kSuccess;
+    bool isLocked = false;
+
+    isDeleted = false;
+
+    MFnDependencyNode animCurveFn( curve.animCurve );
+    MPlug outputPlug = animCurveFn.findPlug( "output", &status );
+    MPlugArray destinations;
+
+    if( !status ) {
+        pluginError( "StaticChannelsCommand", "deleteStaticCurve", "No MPlug with name output" );
+    }
+    else {
+        outputPlug.connectedTo( destinations, false, true );
+
+        for( unsigned int i = 0; i < destinations.length(); i++ )
+            isLocked = isLocked || destinations[i].isLocked();
+
+        if( isLocked ) {
+            pluginTrace( "StaticChannelsCommand", "deleteStaticCurve",
+                         "Skipping curve on locked attribute: " + animCurveFn.name() );
+        }
+        else if( !(status = dgModifier.deleteNode( curve.animCurve ))) {
+            pluginError( "StaticChannelsCommand", "deleteStaticCurve", "Failed to delete the anim curve" );
+        }
+        else {
+            for( unsigned int i = 0; i < destinations.length() && status; i++ )
+                status = dgModifier.newPlugValueDouble( destinations[i], curve.keyValues[0] );
+
+            isDeleted = status;
+        }
+    }
+
+    return status;
+}
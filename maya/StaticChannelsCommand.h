@@ -0,0 +1,133 @@
+//*********************************************************
+// StaticChannelsCommand.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __STATIC_CHANNELS_COMMAND_H_
+#define __STATIC_CHANNELS_COMMAND_H_
+
+//*********************************************************
+#include <maya/MPxCommand.h>
+
+#include <maya/MGlobal.h>
+#include <maya/MSyntax.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MString.h>
+#include <maya/MAngle.h>
+#include <maya/MTime.h>
+#include <maya/MPlug.h>
+#include <maya/MPlugArray.h>
+#include <maya/MDGModifier.h>
+
+#include <maya/MFnDependencyNode.h>
+#include <maya/MFnAnimCurve.h>
+
+#include <maya/MItDependencyNodes.h>
+
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: StaticChannelsCommand
+//
+// Desc: Finds the anim curves in the scene that don't
+//       change value (the curve stays within the tolerance
+//       between and beyond its keys).  The curves can
+//       be deleted, leaving their value on the attribute.
+//       Referenced curves and driven keys are skipped.
+//
+// Command: cieStaticChannels
+//
+// Flags: -tolerance (-tol)     (double)
+//
+//        -delete (-d)
+//
+//*********************************************************
+class StaticChannelsCommand : public MPxCommand
+{
+private:
+    // The keys read from a curve and the result of the
+    // constancy check
+    struct StaticCurveInfo {
+        MObject animCurve;
+        double tolerance;
+        std::vector<double> keyTimes;
+        std::vector<double> keyValues;
+        std::vector<double> tangentAngles;
+        std::vector<bool> isStepped;
+        MFnAnimCurve::InfinityType preInfinity, postInfinity;
+        bool isStatic;
+    };
+
+    // Command flag constants
+    static const char *toleranceFlag, *toleranceLongFlag;
+    static const char *deleteFlag, *deleteLongFlag;
+
+    // The largest change in value allowed for a static
+    // curve (degrees for rotations)
+    double tolerance;
+
+    // Indicates that the static curves should be deleted
+    bool deleteCurves;
+
+    // The number of curves checked
+    unsigned int numCurvesChecked;
+
+    // The number of static curves found
+    unsigned int numStaticCurves;
+
+    // The number of static curves deleted
+    unsigned int numCurvesDeleted;
+
+    // Deletes the curves and sets the attribute values
+    // (for undo/redo)
+    MDGModifier dgModifier;
+
+    // Method to setup the command flags
+    MStatus parseCommandFlags( const MArgList &args );
+
+    // Reads the keys of every time based anim curve in the scene
+    MStatus getSceneCurves( std::vector<StaticCurveInfo> &curves );
+
+    // Checks whether a curve is static (safe to call from
+    // the thread pool)
+    static void checkStaticCurve( StaticCurveInfo &curve );
+
+    // Widens the value range by the extremes of a hermite
+    // segment between two keys
+    static void getSegmentRange( double value0, double value1,
+                                 double slope0, double slope1,
+                                 double duration,
+                                 double &minValue, double &maxValue );
+
+    // Adds the deletion of a static curve to the modifier
+    MStatus deleteStaticCurve( const StaticCurveInfo &curve, bool &isDeleted );
+
+public:
+    // Constructor/Destructor
+    StaticChannelsCommand();
+    ~StaticChannelsCommand();
+
+    // Performs the command
+    virtual MStatus doIt( const MArgList &args );
+
+    // Performs the work that changes Maya's internal state
+    virtual MStatus redoIt();
+
+    // Undoes the changes to Maya's internal state
+    virtual MStatus undoIt();
+
+    // Only deleting the curves changes the scene
+    virtual bool isUndoable() const { return deleteCurves; }
+
+    // Allocates a command object to Maya (required)
+    static void *creator() { return new StaticChannelsCommand; }
+
+    // Defines the set of flags allowed by this command
+    static MSyntax newSyntax();
+};
+
+#endif
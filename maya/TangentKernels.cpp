@@ -0,0 +1,177 @@
+//*********************************************************
+// TangentKernels.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "TangentKernels.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TANGENT_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+//*********************************************************
+
+//*********************************************************
+// Name: getSegmentAngles
+// Desc: Calculates the angle of the segment between each
+//       pair of keys.  The slopes are calculated two at a
+//       time, the arc tangents are not vectorized.
+//*********************************************************
+void TangentKernels::getSegmentAngles( const std::vector<double> &keyTimes,
+                                       const std::vector<double> &keyValues,
+                                       std::vector<double> &segmentAngles )
+{
+    unsigned int numSegments = (keyTimes.size() > 1) ? (unsigned int)keyTimes.size() - 1 : 0;
+    unsigned int i = 0;
+
+    segmentAngles.resize( numSegments );
+    if( numSegments == 0 )
+        return;
+
+    const double *times = &keyTimes[0];
+    const double *values = &keyValues[0];
+    double *slopes = &segmentAngles[0];
+
+#ifdef TANGENT_KERNELS_SSE2
+    for( ; i + 2 <= numSegments; i += 2 ) {
+        __m128d valueDelta = _mm_sub_pd( _mm_loadu_pd( values + i + 1 ), _mm_loadu_pd( values + i ));
+        __m128d timeDelta = _mm_sub_pd( _mm_loadu_pd( times + i + 1 ), _mm_loadu_pd( times + i ));
+        _mm_storeu_pd( slopes + i, _mm_div_pd( valueDelta, timeDelta ));
+    }
+#endif
+    for( ; i < numSegments; i++ )
+        slopes[i] = (values[i + 1] - values[i]) / (times[i + 1] - times[i]);
+
+    for( i = 0; i < numSegments; i++ )
+        slopes[i] = atan( slopes[i] );
+}
+
+
+//*********************************************************
+// Name: getPeaksAndValleys
+// Desc: Flags the keys that are a peak or a valley.  The
+//       nearest unequal values on either side of each key
+//       are found first (each depends on the last), then
+//       the keys are compared two at a time.
+//*********************************************************
+void TangentKernels::getPeaksAndValleys( const std::vector<double> &keyValues,
+                                         std::vector<unsigned char> &peakOrValley )
+{
+    unsigned int numKeys = (unsigned int)keyValues.size();
+
+    peakOrValley.assign( numKeys, 0 );
+    if( numKeys < 3 )
+        return;
+
+    std::vector<double> prevInequalValues( numKeys ), nextInequalValues( numKeys );
+
+    prevInequalValues[0] = keyValues[0];
+    for( unsigned int i = 1; i < numKeys; i++ ) {
+        if( keyValues[i] != keyValues[i - 1] )
+            prevInequalValues[i] = keyValues[i - 1];
+        else
+            prevInequalValues[i] = prevInequalValues[i - 1];
+    }
+
+    nextInequalValues[numKeys - 1] = keyValues[numKeys - 1];
+    for( unsigned int i = numKeys - 1; i > 0; i-- ) {
+        if( keyValues[i] != keyValues[i - 1] )
+            nextInequalValues[i - 1] = keyValues[i];
+        else
+            nextInequalValues[i - 1] = nextInequalValues[i];
+    }
+
+    const double *values = &keyValues[0];
+    const double *prevValues = &prevInequalValues[0];
+    const double *nextValues = &nextInequalValues[0];
+    unsigned int i = 1;
+
+#ifdef TANGENT_KERNELS_SSE2
+    for( ; i + 2 <= numKeys - 1; i += 2 ) {
+        __m128d value = _mm_loadu_pd( values + i );
+        __m128d prevValue = _mm_loadu_pd( prevValues + i );
+        __m128d nextValue = _mm_loadu_pd( nextValues + i );
+
+        __m128d isValley = _mm_and_pd( _mm_cmple_pd( value, prevValue ), _mm_cmple_pd( value, nextValue ));
+        __m128d isPeak = _mm_and_pd( _mm_cmpge_pd( value, prevValue ), _mm_cmpge_pd( value, nextValue ));
+        int mask = _mm_movemask_pd( _mm_or_pd( isValley, isPeak ));
+
+        peakOrValley[i] = (unsigned char)(mask & 1);
+        peakOrValley[i + 1] = (unsigned char)((mask >> 1) & 1);
+    }
+#endif
+    for( ; i < numKeys - 1; i++ ) {
+        double value = values[i];
+        if( (value <= prevValues[i] && value <= nextValues[i]) ||
+            (value >= prevValues[i] && value >= nextValues[i]) )
+        {
+            peakOrValley[i] = 1;
+        }
+    }
+}
+
+
+//*********************************************************
+// Name: getSoftenedAngles
+// Desc: Calculates the softened tangent angle for each
+//       key.  The smaller of the in and out angles is used
+//       to avoid overshoots, then the smoothing value
+//       moves it in the direction of the slope.
+//*********************************************************
+void TangentKernels::getSoftenedAngles( const std::vector<double> &segmentAngles,
+                                        double smoothing,
+                                        std::vector<double> &tangentAngles )
+{
+    unsigned int numKeys = (unsigned int)segmentAngles.size() + 1;
+
+    tangentAngles.assign( numKeys, 0.0 );
+    if( numKeys < 3 )
+        return;
+
+    const double *angles = &segmentAngles[0];
+    double *results = &tangentAngles[0];
+    unsigned int i = 1;
+
+#ifdef TANGENT_KERNELS_SSE2
+    const __m128d signMask = _mm_set1_pd( -0.0 );
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d smoothingValue = _mm_set1_pd( smoothing );
+
+    for( ; i + 2 <= numKeys - 1; i += 2 ) {
+        __m128d angleIn = _mm_loadu_pd( angles + i - 1 );
+        __m128d angleOut = _mm_loadu_pd( angles + i );
+
+        // The smallest angle is used to avoid overshoots
+        __m128d useIn = _mm_cmpgt_pd( _mm_andnot_pd( signMask, angleOut ), _mm_andnot_pd( signMask, angleIn ));
+        __m128d angle = _mm_or_pd( _mm_and_pd( useIn, angleIn ), _mm_andnot_pd( useIn, angleOut ));
+
+        __m128d softness = _mm_mul_pd( _mm_andnot_pd( signMask, _mm_sub_pd( angleOut, angleIn )), smoothingValue );
+
+        // Add or subtract the softness depending on positive or negative slope
+        __m128d isPositive = _mm_or_pd( _mm_cmpgt_pd( angleIn, zero ),
+                                        _mm_and_pd( _mm_cmpeq_pd( angleIn, zero ), _mm_cmpgt_pd( angleOut, zero )));
+        softness = _mm_or_pd( _mm_and_pd( isPositive, softness ),
+                              _mm_andnot_pd( isPositive, _mm_xor_pd( softness, signMask )));
+
+        _mm_storeu_pd( results + i, _mm_add_pd( angle, softness ));
+    }
+#endif
+    for( ; i < numKeys - 1; i++ ) {
+        double angleIn = angles[i - 1];
+        double angleOut = angles[i];
+
+        double angle = (fabs( angleOut ) > fabs( angleIn )) ? angleIn : angleOut;
+        double softness = fabs( angleOut - angleIn ) * smoothing;
+
+        if( angleIn > 0 || (angleIn == 0 && angleOut > 0) )
+            results[i] = angle + softness;
+        else
+            results[i] = angle - softness;
+    }
+}
@@ -0,0 +1,47 @@
+//*********************************************************
+// TangentKernels.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __TANGENT_KERNELS_H_
+#define __TANGENT_KERNELS_H_
+
+//*********************************************************
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: TangentKernels
+//
+// Desc:  The per-key math of the curve cleaner, run over
+//        whole curves at once.  Times are in frames and
+//        angles in radians.  Uses SSE2 when the compiler
+//        supports it.
+//*********************************************************
+class TangentKernels
+{
+public:
+    // Calculates the angle of the segment between each
+    // pair of keys (numKeys - 1 angles)
+    static void getSegmentAngles( const std::vector<double> &keyTimes,
+                                  const std::vector<double> &keyValues,
+                                  std::vector<double> &segmentAngles );
+
+    // Flags the keys that are a peak or a valley compared
+    // to the nearest unequal values on either side.  The
+    // first and last keys are never flagged.
+    static void getPeaksAndValleys( const std::vector<double> &keyValues,
+                                    std::vector<unsigned char> &peakOrValley );
+
+    // Calculates the softened tangent angle for each key
+    // from the angles of the segments on either side.  The
+    // first and last keys are given an angle of 0.
+    static void getSoftenedAngles( const std::vector<double> &segmentAngles,
+                                   double smoothing,
+                                   std::vector<double> &tangentAngles );
+};
+
+#endif
@@ -0,0 +1,183 @@
+//*********************************************************
+// TangentSolvers.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "TangentSolvers.h"
+
+#include <math.h>
+//*********************************************************
+
+//*********************************************************
+// Name: solve
+// Desc: Calculates the tangent angle of every key with
+//       the given solver, then the in/out weights from the
+//       length of the segments either side
+//*********************************************************
+void TangentSolvers::solve( SolverType type,
+                            const std::vector<double> &keyTimes,
+                            const std::vector<double> &keyValues,
+                            double weightFactor,
+                            std::vector<double> &tangentAngles,
+                            std::vector<double> &inWeights,
+                            std::vector<double> &outWeights )
+{
+    unsigned int numKeys = (unsigned int)keyTimes.size();
+    std::vector<double> secants, slopes;
+
+    tangentAngles.assign( numKeys, 0.0 );
+    inWeights.assign( numKeys, 0.0 );
+    outWeights.assign( numKeys, 0.0 );
+    if( numKeys < 2 )
+        return;
+
+    getSecants( keyTimes, keyValues, secants );
+    slopes.assign( numKeys, 0.0 );
+
+    switch( type ) {
+        case kClamped:
+            solveClamped( keyTimes, secants, slopes );
+            break;
+        case kMonotone:
+            solveMonotone( keyTimes, secants, slopes );
+            break;
+        case kCatmullRom:
+            solveCatmullRom( keyTimes, secants, slopes );
+            break;
+    }
+
+    for( unsigned int i = 0; i < numKeys; i++ ) {
+        tangentAngles[i] = atan( slopes[i] );
+
+        // The end keys use their one segment for both sides
+        double inDelta = (i > 0) ? keyTimes[i] - keyTimes[i - 1] : keyTimes[1] - keyTimes[0];
+        double outDelta = (i + 1 < numKeys) ? keyTimes[i + 1] - keyTimes[i] : inDelta;
+        double length = 1.0 / cos( tangentAngles[i] );
+
+        inWeights[i] = inDelta * length * weightFactor;
+        outWeights[i] = outDelta * length * weightFactor;
+    }
+}
+
+
+//*********************************************************
+// Name: getSecants
+// Desc: Calculates the slope of each segment between keys
+//*********************************************************
+void TangentSolvers::getSecants( const std::vector<double> &keyTimes,
+                                 const std::vector<double> &keyValues,
+                                 std::vector<double> &secants )
+{
+    unsigned int numSegments = (unsigned int)keyTimes.size() - 1;
+
+    secants.resize( numSegments );
+    for( unsigned int i = 0; i < numSegments; i++ )
+        secants[i] = (keyValues[i + 1] - keyValues[i]) / (keyTimes[i + 1] - keyTimes[i]);
+}
+
+
+//*********************************************************
+// Name: solveClamped
+// Desc: Uses the Catmull-Rom slope, except on peaks,
+//       valleys and keys that hold the value of a
+//       neighbour, which are flat.  The end keys are flat.
+//*********************************************************
+void TangentSolvers::solveClamped( const std::vector<double> &keyTimes,
+                                   const std::vector<double> &secants,
+                                   std::vector<double> &slopes )
+{
+    solveCatmullRom( keyTimes, secants, slopes );
+
+    unsigned int numKeys = (unsigned int)slopes.size();
+
+    slopes[0] = 0.0;
+    slopes[numKeys - 1] = 0.0;
+
+    for( unsigned int i = 1; i + 1 < numKeys; i++ ) {
+        if( secants[i - 1] * secants[i] <= 0.0 )
+            slopes[i] = 0.0;
+    }
+}
+
+
+//*********************************************************
+// Name: solveMonotone
+// Desc: The slope of each inner key is the weighted
+//       harmonic mean of the segments either side, or flat
+//       if they change direction.  The end slopes are
+//       extrapolated from the first/last two segments and
+//       limited so they can't overshoot.
+//*********************************************************
+void TangentSolvers::solveMonotone( const std::vector<double> &keyTimes,
+                                    const std::vector<double> &secants,
+                                    std::vector<double> &slopes )
+{
+    unsigned int numKeys = (unsigned int)slopes.size();
+
+    for( unsigned int i = 1; i + 1 < numKeys; i++ ) {
+        double prevSecant = secants[i - 1];
+        double nextSecant = secants[i];
+
+        if( prevSecant * nextSecant <= 0.0 ) {
+            slopes[i] = 0.0;
+        }
+        else {
+            double prevDelta = keyTimes[i] - keyTimes[i - 1];
+            double nextDelta = keyTimes[i + 1] - keyTimes[i];
+            double prevWeight = 2.0 * nextDelta + prevDelta;
+            double nextWeight = nextDelta + 2.0 * prevDelta;
+
+            slopes[i] = (prevWeight + nextWeight) / (prevWeight / prevSecant + nextWeight / nextSecant);
+        }
+    }
+
+    // A single segment is a straight line
+    if( numKeys == 2 )
+        slopes[0] = slopes[1] = secants[0];
+
+    // Three point end slopes, done for both ends
+    for( unsigned int end = 0; end < 2 && numKeys > 2; end++ ) {
+        unsigned int key = (end == 0) ? 0 : numKeys - 1;
+        unsigned int near = (end == 0) ? 0 : numKeys - 2;
+        unsigned int far = (end == 0) ? 1 : numKeys - 3;
+
+        double nearDelta = keyTimes[near + 1] - keyTimes[near];
+        double farDelta = keyTimes[far + 1] - keyTimes[far];
+        double slope = ((2.0 * nearDelta + farDelta) * secants[near] - nearDelta * secants[far]) /
+                       (nearDelta + farDelta);
+
+        if( slope * secants[near] <= 0.0 )
+            slope = 0.0;
+        else if( secants[near] * secants[far] < 0.0 && fabs( slope ) > fabs( 3.0 * secants[near] ))
+            slope = 3.0 * secants[near];
+
+        slopes[key] = slope;
+    }
+}
+
+
+//*********************************************************
+// Name: solveCatmullRom
+// Desc: The slope of each inner key is the slope between
+//       its neighbours.  The end keys use their segment.
+//*********************************************************
+void TangentSolvers::solveCatmullRom( const std::vector<double> &keyTimes,
+                                      const std::vector<double> &secants,
+                                      std::vector<double> &slopes )
+{
+    unsigned int numKeys = (unsigned int)slopes.size();
+
+    slopes[0] = secants[0];
+    slopes[numKeys - 1] = secants[numKeys - 2];
+
+    for( unsigned int i = 1; i + 1 < numKeys; i++ ) {
+        double prevDelta = keyTimes[i] - keyTimes[i - 1];
+        double nextDelta = keyTimes[i + 1] - keyTimes[i];
+
+        slopes[i] = (secants[i - 1] * prevDelta + secants[i] * nextDelta) / (prevDelta + nextDelta);
+    }
+}
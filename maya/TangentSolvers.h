@@ -0,0 +1,71 @@
+//*********************************************************
+// TangentSolvers.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __TANGENT_SOLVERS_H_
+#define __TANGENT_SOLVERS_H_
+
+//*********************************************************
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: TangentSolvers
+//
+// Desc:  Calculates the tangents for every key of a curve
+//        in a single pass over the key arrays.  Times are
+//        in frames and the angles are in radians, the same
+//        as the tangent kernels.  The in and out angles of
+//        a key are always the same, so the curve stays
+//        smooth through it.
+//*********************************************************
+class TangentSolvers
+{
+public:
+    enum SolverType {
+        kClamped,
+        kMonotone,
+        kCatmullRom
+    };
+
+private:
+    // Calculates the slope of each segment between keys
+    static void getSecants( const std::vector<double> &keyTimes,
+                            const std::vector<double> &keyValues,
+                            std::vector<double> &secants );
+
+    // Catmull-Rom slopes, flattened on peaks, valleys and
+    // keys with the same value as a neighbour
+    static void solveClamped( const std::vector<double> &keyTimes,
+                              const std::vector<double> &secants,
+                              std::vector<double> &slopes );
+
+    // Monotone cubic slopes (Fritsch-Butland), the curve
+    // never goes beyond the values of the keys either side
+    static void solveMonotone( const std::vector<double> &keyTimes,
+                               const std::vector<double> &secants,
+                               std::vector<double> &slopes );
+
+    // The slope between the neighbouring keys
+    static void solveCatmullRom( const std::vector<double> &keyTimes,
+                                 const std::vector<double> &secants,
+                                 std::vector<double> &slopes );
+
+public:
+    // Calculates the tangent angle of every key and the
+    // in/out weights as a fraction (weightFactor) of the
+    // length of the tangent across the neighbouring segment
+    static void solve( SolverType type,
+                       const std::vector<double> &keyTimes,
+                       const std::vector<double> &keyValues,
+                       double weightFactor,
+                       std::vector<double> &tangentAngles,
+                       std::vector<double> &inWeights,
+                       std::vector<double> &outWeights );
+};
+
+#endif
@@ -0,0 +1,180 @@
+//*********************************************************
+// ThreadPool.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "ThreadPool.h"
+#include "ErrorReporting.h"
+//*********************************************************
+
+//*********************************************************
+// Name: ThreadPool
+// Desc: Constructor
+//*********************************************************
+ThreadPool::ThreadPool()
+    : batchFunction( NULL ),
+      batchCount( 0 ),
+      nextIndex( 0 ),
+      batchNumber( 0 ),
+      numBusyWorkers( 0 ),
+      stopping( false )
+{
+}
+
+
+//*********************************************************
+// Name: ~ThreadPool
+// Desc: Destructor
+//*********************************************************
+ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+
+//*********************************************************
+// Name: start
+// Desc: Starts the worker threads.  By default one thread
+//       is started for each core other than the one used
+//       by the main thread.  The batch state is reset
+//       since the pool can be restarted after stop (the
+//       plugin being reloaded while the library stays
+//       loaded) and new workers wait for a batch number
+//       other than 0.
+//*********************************************************
+void ThreadPool::start( unsigned int numThreads )
+{
+    if( !workers.empty() )
+        return;
+
+    if( numThreads == 0 ) {
+        numThreads = std::thread::hardware_concurrency();
+        if( numThreads > 0 )
+            numThreads--;
+    }
+
+    pluginTrace( "ThreadPool", "start", MString( "Worker threads: " ) + numThreads );
+
+    {
+        std::lock_guard<std::mutex> lock( batchMutex );
+        stopping = false;
+        batchFunction = NULL;
+        batchCount = 0;
+        nextIndex = 0;
+        batchNumber = 0;
+        numBusyWorkers = 0;
+    }
+
+    for( unsigned int i = 0; i < numThreads; i++ )
+        workers.push_back( std::thread( &ThreadPool::workerLoop, this ));
+}
+
+
+//*********************************************************
+// Name: stop
+// Desc: Stops and joins the worker threads
+//*********************************************************
+void ThreadPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock( batchMutex );
+        stopping = true;
+    }
+    batchStarted.notify_all();
+
+    for( unsigned int i = 0; i < workers.size(); i++ )
+        workers[i].join();
+
+    workers.clear();
+}
+
+
+//*********************************************************
+// Name: run
+// Desc: Calls function( i ) for every i in [0, count)
+//       across the workers.  The calling thread does its
+//       share of the work and then waits for the workers
+//       to finish.  Without any workers the items are
+//       done in order on the calling thread.
+//*********************************************************
+void ThreadPool::run( unsigned int count, const std::function<void( unsigned int )> &function )
+{
+    if( workers.empty() || count < 2 ) {
+        for( unsigned int i = 0; i < count; i++ )
+            function( i );
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( batchMutex );
+        batchFunction = &function;
+        batchCount = count;
+        nextIndex = 0;
+        numBusyWorkers = (unsigned int)workers.size();
+        batchNumber++;
+    }
+    batchStarted.notify_all();
+
+    doBatchItems( function, count );
+
+    // Wait for the workers to finish their last items
+    std::unique_lock<std::mutex> lock( batchMutex );
+    while( numBusyWorkers > 0 )
+        batchFinished.wait( lock );
+
+    batchFunction = NULL;
+}
+
+
+//*********************************************************
+// Name: workerLoop
+// Desc: Waits for a batch, helps finish it and then waits
+//       for the next one until the pool is stopped
+//*********************************************************
+void ThreadPool::workerLoop()
+{
+    unsigned int lastBatchNumber = 0;
+
+    while( true ) {
+        const std::function<void( unsigned int )> *function;
+        unsigned int count;
+
+        {
+            std::unique_lock<std::mutex> lock( batchMutex );
+            while( !stopping && batchNumber == lastBatchNumber )
+                batchStarted.wait( lock );
+
+            if( stopping )
+                break;
+
+            lastBatchNumber = batchNumber;
+            function = batchFunction;
+            count = batchCount;
+        }
+
+        doBatchItems( *function, count );
+
+        {
+            std::lock_guard<std::mutex> lock( batchMutex );
+            numBusyWorkers--;
+        }
+        batchFinished.notify_one();
+    }
+}
+
+
+//*********************************************************
+// Name: doBatchItems
+// Desc: Takes the next item of the batch until none are
+//       left
+//*********************************************************
+void ThreadPool::doBatchItems( const std::function<void( unsigned int )> &function,
+                               unsigned int count )
+{
+    for( unsigned int i = nextIndex++; i < count; i = nextIndex++ )
+        function( i );
+}
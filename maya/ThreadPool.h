@@ -0,0 +1,95 @@
+//*********************************************************
+// ThreadPool.h
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+#ifndef __THREAD_POOL_H_
+#define __THREAD_POOL_H_
+
+//*********************************************************
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Class: ThreadPool
+//
+// Desc:  A set of worker threads owned by the plugin.  The
+//        threads are started when the plugin is loaded and
+//        wait for batches of work from the commands, so
+//        no threads are created while a command runs.
+//
+//        Batches must be run from the main thread and the
+//        work must not use the Maya API.
+//*********************************************************
+class ThreadPool
+{
+private:
+    // The worker threads
+    std::vector<std::thread> workers;
+
+    // Guards the batch state below
+    std::mutex batchMutex;
+
+    // Wakes the workers when a batch starts or the pool stops
+    std::condition_variable batchStarted;
+
+    // Wakes the main thread when the workers finish a batch
+    std::condition_variable batchFinished;
+
+    // The work for the current batch
+    const std::function<void( unsigned int )> *batchFunction;
+    unsigned int batchCount;
+
+    // The next item of the batch to be done
+    std::atomic<unsigned int> nextIndex;
+
+    // Incremented for every batch so the workers can tell
+    // a new batch from the one they just finished
+    unsigned int batchNumber;
+
+    // The number of workers still working on the batch
+    unsigned int numBusyWorkers;
+
+    // Indicates that the workers should exit
+    bool stopping;
+
+    // The loop run by each worker thread
+    void workerLoop();
+
+    // Does items of the current batch until none are left
+    void doBatchItems( const std::function<void( unsigned int )> &function,
+                       unsigned int count );
+
+public:
+    // Constructor/Destructor
+    ThreadPool();
+    ~ThreadPool();
+
+    // Starts the worker threads (0 uses one per core,
+    // less the main thread)
+    void start( unsigned int numThreads = 0 );
+
+    // Stops and joins the worker threads
+    void stop();
+
+    // Returns the number of worker threads
+    unsigned int numWorkers() const { return (unsigned int)workers.size(); }
+
+    // Calls function( i ) for every i in [0, count) on the
+    // workers and the calling thread.  Returns once every
+    // call has finished.
+    void run( unsigned int count, const std::function<void( unsigned int )> &function );
+};
+
+// The plugin's thread pool (see ANIMTools.cpp)
+extern ThreadPool g_threadPool;
+
+#endif
@@ -0,0 +1,379 @@
+//*********************************************************
+// ShotMaskLayoutTest.cpp
+//
+// Copyright (C) 2007-2021 Skeletal Studios
+// All rights reserved.
+//
+//*********************************************************
+
+//*********************************************************
+#include "ShotMaskLayout.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <vector>
+//*********************************************************
+
+//*********************************************************
+// Desc: Checks the shot mask layout without Maya or golden
+//       images.  The gate size is compared with the size
+//       worked out from the camera's film back for every
+//       combination of film and render aspect ratio, film
+//       fit and projection, and the layout of each is
+//       checked for the invariants the mask relies on.
+//
+//       Run with -bench to also time the layout.
+//
+//       Returns 0 when every check passes.
+//*********************************************************
+
+//*********************************************************
+// Constants
+//*********************************************************
+static const double tolerance = 1.0e-9;
+
+static const double focalLength = 35.0;
+static const double nearClip = 0.1;
+
+static const ShotMaskLayout::FilmFit filmFits[] = {
+    ShotMaskLayout::kFillFilmFit,
+    ShotMaskLayout::kHorizontalFilmFit,
+    ShotMaskLayout::kVerticalFilmFit,
+    ShotMaskLayout::kOverscanFilmFit
+};
+
+static const char *filmFitNames[] = { "fill", "horizontal", "vertical", "overscan" };
+
+static unsigned int numChecks = 0;
+static unsigned int numFailures = 0;
+
+
+//*********************************************************
+// Name: checkClose
+// Desc: Reports a failure when the values differ by more
+//       than the tolerance, relative to their size
+//*********************************************************
+static bool checkClose( double value, double expected, const char *what, const char *context )
+{
+    numChecks++;
+
+    double scale = fabs( expected ) > 1.0 ? fabs( expected ) : 1.0;
+    if( fabs( value - expected ) <= tolerance * scale )
+        return true;
+
+    numFailures++;
+    printf( "FAIL %s: %s is %.12g, expected %.12g\n", context, what, value, expected );
+    return false;
+}
+
+
+//*********************************************************
+// Name: check
+// Desc: Reports a failure when the condition is false
+//*********************************************************
+static bool check( bool condition, const char *what, const char *context )
+{
+    numChecks++;
+
+    if( condition )
+        return true;
+
+    numFailures++;
+    printf( "FAIL %s: %s\n", context, what );
+    return false;
+}
+
+
+//*********************************************************
+// Name: makeCamera
+// Desc: A camera with a film back of the aspect ratio.
+//       The angles come from the film back the same way
+//       Maya calculates them.
+//*********************************************************
+static ShotMaskLayout::Camera makeCamera( bool orthographic, ShotMaskLayout::FilmFit filmFit,
+                                          double filmAspectRatio, double &horizontalAperture,
+                                          double &verticalAperture )
+{
+    verticalAperture = 1.0;
+    horizontalAperture = verticalAperture * filmAspectRatio;
+
+    ShotMaskLayout::Camera camera;
+    camera.orthographic = orthographic;
+    camera.orthoWidth = 30.0;
+    camera.horizontalFOV = 2.0 * atan( horizontalAperture / (2.0 * focalLength) );
+    camera.verticalFOV = 2.0 * atan( verticalAperture / (2.0 * focalLength) );
+    camera.nearClip = nearClip;
+    camera.filmFit = filmFit;
+    camera.filmAspectRatio = filmAspectRatio;
+
+    return camera;
+}
+
+
+//*********************************************************
+// Name: getExpectedGateSize
+// Desc: The closed form size of the gate.  A fitted
+//       aperture is seen at distance * aperture / focal
+//       length.  Fill fits the height when the film is
+//       wider than the render, overscan when the render is
+//       wider than the film, and the width otherwise.
+//*********************************************************
+static void getExpectedGateSize( const ShotMaskLayout::Camera &camera, double aspectRatio,
+                                 double renderAspectRatio, double horizontalAperture,
+                                 double verticalAperture, double distance,
+                                 double &width, double &height )
+{
+    if( camera.orthographic ) {
+        width = camera.orthoWidth;
+        height = width / aspectRatio;
+        return;
+    }
+
+    double filmAspectRatio = camera.filmAspectRatio;
+    bool fitHeight = false;
+
+    switch( camera.filmFit ) {
+        case ShotMaskLayout::kVerticalFilmFit:
+            fitHeight = true;
+            break;
+        case ShotMaskLayout::kHorizontalFilmFit:
+            fitHeight = false;
+            break;
+        case ShotMaskLayout::kFillFilmFit:
+            fitHeight = filmAspectRatio > renderAspectRatio;
+            break;
+        case ShotMaskLayout::kOverscanFilmFit:
+            fitHeight = renderAspectRatio > filmAspectRatio;
+            break;
+    }
+
+    // The film gate is the film back whatever the fit
+    if( aspectRatio == filmAspectRatio )
+        fitHeight = false;
+
+    if( fitHeight ) {
+        height = distance * verticalAperture / focalLength;
+        width = height * aspectRatio;
+    }
+    else {
+        width = distance * horizontalAperture / focalLength;
+        height = width / aspectRatio;
+    }
+}
+
+
+//*********************************************************
+// Name: makeInput
+// Desc: Text boxes and counter slots like the ones the
+//       mask builds, five slots one digit apart
+//*********************************************************
+static ShotMaskLayout::Input makeInput( double aspectRatio, double renderAspectRatio, double maskThickness )
+{
+    ShotMaskLayout::Input input;
+    input.aspectRatio = aspectRatio;
+    input.renderAspectRatio = renderAspectRatio;
+    input.maskThickness = maskThickness;
+    input.textScales.counter = 0.5;
+    input.textScales.title = 0.53;
+    input.textScales.subtitle = 0.5;
+
+    input.titleBox.minX = 0.0;
+    input.titleBox.minY = -0.2;
+    input.titleBox.maxX = 6.0;
+    input.titleBox.maxY = 0.8;
+
+    input.bottomLeftBox.minX = 0.05;
+    input.bottomLeftBox.minY = -0.2;
+    input.bottomLeftBox.maxX = 4.0;
+    input.bottomLeftBox.maxY = 0.75;
+
+    input.bottomRightBox = input.bottomLeftBox;
+    input.bottomRightBox.maxX = 3.0;
+
+    input.digitBox.minX = 0.05;
+    input.digitBox.minY = 0.0;
+    input.digitBox.maxX = 0.55;
+    input.digitBox.maxY = 0.72;
+
+    double slotWidth = input.digitBox.width() * 1.1;
+    for( unsigned int slot = 0; slot < 5; slot++ )
+        input.slotOffsets.push_back( -(double)slot * slotWidth );
+
+    return input;
+}
+
+
+//*********************************************************
+// Name: checkLayout
+// Desc: The borders are symmetric and fill the edges of
+//       the gate, the side borders fit between the top and
+//       bottom borders, the text is in front of the
+//       borders and the counter slots run right to left
+//*********************************************************
+static void checkLayout( const ShotMaskLayout::Input &input, const ShotMaskLayout::Result &result,
+                         const char *context )
+{
+    double halfWidth = result.width / 2.0;
+    double halfHeight = result.height / 2.0;
+    double hThickness = input.maskThickness * result.height;
+    double vThickness = input.maskThickness * result.width;
+
+    checkClose( result.topPlane.ty, -result.bottomPlane.ty, "top/bottom border symmetry", context );
+    checkClose( result.leftPlane.tx, -result.rightPlane.tx, "left/right border symmetry", context );
+    checkClose( result.topPlane.tx, 0.0, "top border centre", context );
+    checkClose( result.bottomPlane.tx, 0.0, "bottom border centre", context );
+    checkClose( result.leftPlane.ty, 0.0, "left border centre", context );
+    checkClose( result.rightPlane.ty, 0.0, "right border centre", context );
+
+    checkClose( result.topPlane.sx, result.width, "top border width", context );
+    checkClose( result.topPlane.sy, hThickness, "top border thickness", context );
+    checkClose( result.leftPlane.sx, vThickness, "left border thickness", context );
+    checkClose( result.leftPlane.sy, result.height - 2.0 * hThickness, "left border height", context );
+    checkClose( result.rightPlane.sy, result.height - 2.0 * hThickness, "right border height", context );
+
+    // The outer edges sit on the gate
+    checkClose( result.topPlane.ty + result.topPlane.sy / 2.0, halfHeight, "top border outer edge", context );
+    checkClose( result.rightPlane.tx + result.rightPlane.sx / 2.0, halfWidth, "right border outer edge", context );
+
+    // The side borders meet the top and bottom borders
+    checkClose( result.leftPlane.sy / 2.0, result.topPlane.ty - result.topPlane.sy / 2.0,
+                "side border meets top border", context );
+
+    // Letterboxing starts at the edges of the gate
+    checkClose( result.letterboxTop.ty - result.letterboxTop.sy / 2.0, halfHeight, "top letterbox edge", context );
+    checkClose( result.letterboxRight.tx - result.letterboxRight.sx / 2.0, halfWidth, "right letterbox edge", context );
+
+    check( result.topPlane.tz < 0.0, "mask in front of the camera", context );
+    check( result.title.tz > result.topPlane.tz, "title in front of the borders", context );
+    check( result.keyIcon.tz > result.topPlane.tz, "key icon in front of the borders", context );
+
+    check( result.counterSlots.size() == input.slotOffsets.size(), "a transform per counter slot", context );
+    for( unsigned int slot = 1; slot < result.counterSlots.size(); slot++ )
+        check( result.counterSlots[slot].tx < result.counterSlots[slot - 1].tx,
+               "counter slots ordered right to left", context );
+
+    if( !result.counterSlots.empty() )
+        check( result.counterSlots[0].tx < halfWidth, "counter inside the gate", context );
+}
+
+
+//*********************************************************
+// Name: runSweep
+// Desc: Checks every combination of aspect ratios, film
+//       fit, gate and projection
+//*********************************************************
+static void runSweep()
+{
+    char context[256];
+
+    for( int f = 0; f <= 30; f++ ) {
+        double filmAspectRatio = 1.0 + f * 0.05;
+
+        for( int r = 0; r <= 30; r++ ) {
+            double renderAspectRatio = 1.0 + r * 0.05;
+
+            for( unsigned int fit = 0; fit < 4; fit++ ) {
+                for( int ortho = 0; ortho < 2; ortho++ ) {
+                    // The resolution gate, then the film gate
+                    for( int filmGate = 0; filmGate < 2; filmGate++ ) {
+                        double aspectRatio = filmGate ? filmAspectRatio : renderAspectRatio;
+                        double inputRenderAspectRatio = filmGate ? filmAspectRatio : renderAspectRatio;
+
+                        double horizontalAperture, verticalAperture;
+                        ShotMaskLayout::Camera camera = makeCamera( ortho != 0, filmFits[fit], filmAspectRatio,
+                                                                    horizontalAperture, verticalAperture );
+
+                        snprintf( context, sizeof( context ), "film %.2f render %.2f %s %s %s gate",
+                                  filmAspectRatio, renderAspectRatio, filmFitNames[fit],
+                                  ortho ? "ortho" : "perspective", filmGate ? "film" : "resolution" );
+
+                        double distance = 2.5;
+                        double width, height, expectedWidth, expectedHeight;
+
+                        ShotMaskLayout::getGateSize( camera, aspectRatio, inputRenderAspectRatio, distance, width, height );
+                        getExpectedGateSize( camera, aspectRatio, inputRenderAspectRatio,
+                                             horizontalAperture, verticalAperture, distance,
+                                             expectedWidth, expectedHeight );
+
+                        checkClose( width, expectedWidth, "gate width", context );
+                        checkClose( height, expectedHeight, "gate height", context );
+                        checkClose( width / height, aspectRatio, "gate aspect ratio", context );
+
+                        ShotMaskLayout::Input input = makeInput( aspectRatio, inputRenderAspectRatio, 0.1 );
+                        ShotMaskLayout::Result result;
+                        ShotMaskLayout::layout( camera, input, result );
+
+                        checkLayout( input, result, context );
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+//*********************************************************
+// Name: runBenchmark
+// Desc: Times the layout over the same sweep
+//*********************************************************
+static void runBenchmark()
+{
+    const unsigned int numRepeats = 200;
+
+    std::vector<ShotMaskLayout::Camera> cameras;
+    std::vector<ShotMaskLayout::Input> inputs;
+
+    for( int f = 0; f <= 30; f++ ) {
+        for( int r = 0; r <= 30; r++ ) {
+            for( unsigned int fit = 0; fit < 4; fit++ ) {
+                double horizontalAperture, verticalAperture;
+                double renderAspectRatio = 1.0 + r * 0.05;
+
+                cameras.push_back( makeCamera( false, filmFits[fit], 1.0 + f * 0.05,
+                                               horizontalAperture, verticalAperture ));
+                inputs.push_back( makeInput( renderAspectRatio, renderAspectRatio, 0.1 ));
+            }
+        }
+    }
+
+    ShotMaskLayout::Result result;
+    double checksum = 0.0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for( unsigned int repeat = 0; repeat < numRepeats; repeat++ ) {
+        for( size_t i = 0; i < cameras.size(); i++ ) {
+            ShotMaskLayout::layout( cameras[i], inputs[i], result );
+            checksum += result.width;
+        }
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>( end - start ).count();
+    double numLayouts = (double)numRepeats * cameras.size();
+
+    printf( "%.0f layouts in %.3f s, %.1f ns per layout (checksum %g)\n",
+            numLayouts, seconds, seconds * 1.0e9 / numLayouts, checksum );
+}
+
+
+//*********************************************************
+// Name: main
+// Desc: Runs the checks, and the benchmark with -bench
+//*********************************************************
+int main( int argc, char **argv )
+{
+    runSweep();
+
+    printf( "%u of %u checks passed\n", numChecks - numFailures, numChecks );
+
+    for( int i = 1; i < argc; i++ ) {
+        if( std::string( argv[i] ) == "-bench" )
+            runBenchmark();
+    }
+
+    return numFailures == 0 ? 0 : 1;
+}